@@ -0,0 +1,228 @@
+#include "cxx/soAlignedVector.hpp"
+#include "cxx/soDefinitions.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace {
+
+using so::utils::mem::AlignedVector;
+using so::utils::mem::ElementLayout;
+
+// A trivially copyable element larger than a SIMD register.
+struct
+Particle
+{
+  float position[3];
+  float velocity[3];
+  float color[4];
+  float lifetime;
+  float size;
+}; // struct Particle
+
+// Keeps the compiler from dropping results.
+volatile double sink{ 0.0 };
+
+// Median time of a run in seconds.
+double
+measure(std::function<void()> const& run, long const repetitions)
+{
+  std::vector<double> times;
+
+  run(); // Warm up the caches and the allocator.
+
+  for(long i{ 0 }; i < repetitions; ++i)
+  {
+    auto const start{ std::chrono::steady_clock::now() };
+
+    run();
+
+    std::chrono::duration<double> const elapsed
+      { std::chrono::steady_clock::now() - start };
+
+    times.push_back(elapsed.count());
+  }
+
+  std::sort(times.begin(), times.end());
+
+  return times[times.size() / 2];
+}
+
+void
+report(char        const* test,
+       char        const* container,
+       std::size_t        numElements,
+       double             seconds)
+{
+  printf("%-22s %-16s %10.2f\n",
+         test,
+         container,
+         seconds / static_cast<double>(numElements) * 1.0e9);
+}
+
+template <typename Vector, typename Make>
+void
+pushBack(Vector& vector, std::size_t const numElements, Make const& make)
+{
+  for(std::size_t i{ 0 }; i < numElements; ++i)
+  {
+    vector.push_back(make(i));
+  }
+
+  sink = sink + static_cast<double>(vector.size());
+}
+
+template <typename Vector>
+void
+sum(Vector const& vector)
+{
+  float total{ 0.0f };
+
+  for(float const value : vector)
+  {
+    total += value;
+  }
+
+  sink = sink + static_cast<double>(total);
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+  // Usage: aligned_vector [elements] [repetitions]
+  long const numElementsArg{ argc > 1 ? std::atol(argv[1]) : 1L << 20 };
+  long const repetitions{ argc > 2 ? std::atol(argv[2]) : 21 };
+
+  if(numElementsArg <= 0 or repetitions <= 0)
+  {
+    puts("The number of elements and repetitions have to be positive.");
+
+    return EXIT_FAILURE;
+  }
+
+  auto const numElements{ static_cast<std::size_t>(numElementsArg) };
+
+  printf("%zu elements, %ld repetitions\n\n", numElements, repetitions);
+  printf("%-22s %-16s %10s\n", "test", "container", "ns/elem");
+
+  auto const makeFloat
+    { [](std::size_t const i) { return static_cast<float>(i); } };
+
+  auto const makeParticle
+    { [](std::size_t const i)
+      {
+        Particle particle{};
+
+        particle.lifetime = static_cast<float>(i);
+
+        return particle;
+      } };
+
+  auto const makeString
+    { [](std::size_t const i)
+      { return "a string too long for the small buffer " + std::to_string(i); }
+    };
+
+  // Growth from empty, which is dominated by relocation.
+  report("push_back float",
+         "std::vector",
+         numElements,
+         measure([&]
+                 {
+                   std::vector<float> vector;
+
+                   pushBack(vector, numElements, makeFloat);
+                 },
+                 repetitions));
+
+  report("push_back float",
+         "packed",
+         numElements,
+         measure([&]
+                 {
+                   AlignedVector<float> vector(64, ElementLayout::packed);
+
+                   pushBack(vector, numElements, makeFloat);
+                 },
+                 repetitions));
+
+  report("push_back Particle",
+         "std::vector",
+         numElements,
+         measure([&]
+                 {
+                   std::vector<Particle> vector;
+
+                   pushBack(vector, numElements, makeParticle);
+                 },
+                 repetitions));
+
+  report("push_back Particle",
+         "strided 64",
+         numElements,
+         measure([&]
+                 {
+                   AlignedVector<Particle> vector(64);
+
+                   pushBack(vector, numElements, makeParticle);
+                 },
+                 repetitions));
+
+  std::size_t const numStrings{ std::max(numElements / 8, std::size_t{ 1 }) };
+
+  report("push_back std::string",
+         "std::vector",
+         numStrings,
+         measure([&]
+                 {
+                   std::vector<std::string> vector;
+
+                   pushBack(vector, numStrings, makeString);
+                 },
+                 repetitions));
+
+  report("push_back std::string",
+         "strided 64",
+         numStrings,
+         measure([&]
+                 {
+                   AlignedVector<std::string> vector(64);
+
+                   pushBack(vector, numStrings, makeString);
+                 },
+                 repetitions));
+
+  // Iteration, where the strided layout pays for its padding.
+  std::vector<float>   reference(numElements);
+  AlignedVector<float> packed(64, numElements, ElementLayout::packed);
+  AlignedVector<float> strided(16, numElements);
+
+  std::iota(reference.begin(), reference.end(), 0.0f);
+  std::iota(packed.begin(), packed.end(), 0.0f);
+  std::iota(strided.begin(), strided.end(), 0.0f);
+
+  report("sum float",
+         "std::vector",
+         numElements,
+         measure([&] { sum(reference); }, repetitions));
+
+  report("sum float",
+         "packed",
+         numElements,
+         measure([&] { sum(packed); }, repetitions));
+
+  report("sum float",
+         "strided 16",
+         numElements,
+         measure([&] { sum(strided); }, repetitions));
+
+  return EXIT_SUCCESS;
+}
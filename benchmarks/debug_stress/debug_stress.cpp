@@ -0,0 +1,195 @@
+#include "cxx/soDebugCallback.hpp"
+#include "cxx/soDefinitions.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::size_t numMessages{ 0 };
+
+// Only touched by the logging thread and by producers after a flush, so
+// ThreadSanitizer reports a race if flushDebugMessages returns early.
+std::vector<uint32_t> deliveries;
+std::size_t           numUnexpected{ 0 };
+
+// Arguments of messages the level filters out, which must not be evaluated.
+std::atomic<std::size_t> numFilteredEvaluated{ 0 };
+
+void
+countDelivery(so::DebugCode const  code,
+              std::string   const& message,
+              std::string   const& /* funcSig */,
+              so::index_t   const  /* line */,
+              std::string   const& /* file */)
+{
+  char*               end{ nullptr };
+  unsigned long const id{ std::strtoul(message.c_str(), &end, 10) };
+
+  // Anything else, e.g. the report of dropped messages, is a failure.
+  if(code not_eq so::DebugCode::info or end is_eq message.c_str() or
+     id >= deliveries.size())
+  {
+    ++numUnexpected;
+
+    return;
+  }
+
+  ++deliveries[id];
+}
+
+std::string
+getFilteredMessage()
+{
+  ++numFilteredEvaluated;
+
+  return "filtered";
+}
+
+/*
+ * Pushes the messages [first, last) in batches through every overload of
+ * pushDebugMessage, flushing after each batch. Returns the number of
+ * messages of a batch not delivered exactly once by the time the flush
+ * returned.
+ */
+std::size_t
+produce(std::size_t const first,
+        std::size_t const last,
+        std::size_t const batchSize)
+{
+  std::size_t numMisses{ 0 };
+
+  for(std::size_t begin{ first }; begin < last; begin += batchSize)
+  {
+    std::size_t const end{ std::min(begin + batchSize, last) };
+
+    for(std::size_t id{ begin }; id < end; ++id)
+    {
+      std::string message{ std::to_string(id) };
+
+      switch(id % 4)
+      {
+        case 0:
+          DEBUG_CALLBACK(info, message.c_str());
+          break;
+        case 1:
+          DEBUG_CALLBACK(info, std::move(message));
+          break;
+        case 2:
+          // Longer than a message stores inline.
+          message += std::string(200, ' ');
+          DEBUG_CALLBACK(info, message);
+          break;
+        default:
+          DEBUG_CALLBACK(info, message, produce);
+          break;
+      }
+
+      DEBUG_CALLBACK(verbose, getFilteredMessage());
+    }
+
+    so::flushDebugMessages();
+
+    for(std::size_t id{ begin }; id < end; ++id)
+    {
+      numMisses += deliveries[id] not_eq 1;
+    }
+  }
+
+  return numMisses;
+}
+
+} // namespace
+
+/*
+ * Pushes debug messages from many threads at once and checks that every
+ * message is delivered exactly once, and before the flush following it
+ * returns. Meant to be run under -fsanitize=thread, see SANITIZE.
+ */
+int
+main(int argc, char** argv)
+{
+  // Usage: debug_stress [messages per producer] [producers]
+  long const numMessagesArg{ argc > 1 ? std::atol(argv[1]) : 20000 };
+  long const numProducersArg{ argc > 2 ? std::atol(argv[2]) : 8 };
+
+  if(numMessagesArg <= 0 or numProducersArg <= 0)
+  {
+    puts("The number of messages and producers have to be positive.");
+
+    return EXIT_FAILURE;
+  }
+
+  numMessages = static_cast<std::size_t>(numMessagesArg);
+
+  auto const numProducers{ static_cast<std::size_t>(numProducersArg) };
+
+  // Keeps the messages in flight below the capacity of the queue, so none
+  // are dropped.
+  std::size_t const batchSize{ std::max<std::size_t>(512 / numProducers,
+                                                     1) };
+
+  deliveries.assign(numProducers * numMessages, 0);
+
+  so::setDebugLevel(so::DebugLevel::info);
+  so::setDebugCallback(countDelivery);
+
+  printf("%zu messages per producer, %zu producers, batches of %zu\n",
+         numMessages,
+         numProducers,
+         batchSize);
+
+  std::atomic<std::size_t> numMisses{ 0 };
+
+  std::vector<std::thread> producers;
+
+  for(std::size_t p{ 0 }; p < numProducers; ++p)
+  {
+    producers.emplace_back([&numMisses, p, batchSize]
+                           {
+                             numMisses += produce(p * numMessages,
+                                                  (p + 1) * numMessages,
+                                                  batchSize);
+                           });
+  }
+
+  for(auto& producer : producers)
+  {
+    producer.join();
+  }
+
+  so::flushDebugMessages();
+
+  std::size_t const numDuplicated
+    { static_cast<std::size_t>(std::count_if(deliveries.begin(),
+                                             deliveries.end(),
+                                             [](uint32_t const count)
+                                             { return count > 1; })) };
+
+  bool const passed{ numMisses is_eq 0 and numDuplicated is_eq 0 and
+                     numUnexpected is_eq 0 and
+                     numFilteredEvaluated is_eq 0 };
+
+  if(not passed)
+  {
+    printf("%zu messages missed a flush, %zu were delivered more than once, "
+           "%zu unexpected messages arrived and %zu filtered messages were "
+           "evaluated.\n",
+           numMisses.load(),
+           numDuplicated,
+           numUnexpected,
+           numFilteredEvaluated.load());
+
+    return EXIT_FAILURE;
+  }
+
+  puts("Every message was delivered exactly once.");
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,323 @@
+#include "cxx/soDefinitions.hpp"
+#include "cxx/soFrustumCuller.hpp"
+#include "cxx/soJobSystem.hpp"
+
+// The culler's planes assume Vulkan's clip space depth of 0 to 1.
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct
+Sphere
+{
+  glm::vec3 center;
+  float     radius;
+}; // struct Sphere
+
+struct
+Box
+{
+  glm::vec3 center;
+  glm::vec3 extent;
+}; // struct Box
+
+using Planes = std::array<glm::vec4, 6>;
+
+// The scalar reference: one object at a time, with the volumes as an array of
+// structures.
+void
+cullSpheresGlm(std::vector<Sphere> const& spheres,
+               Planes              const& planes,
+               std::vector<uint32_t>&     indices)
+{
+  indices.clear();
+
+  for(std::size_t i{ 0 }; i < spheres.size(); ++i)
+  {
+    bool visible{ true };
+
+    for(std::size_t p{ 0 }; p < planes.size() and visible; ++p)
+    {
+      visible = glm::dot(glm::vec3(planes[p]), spheres[i].center) +
+                planes[p].w >= -spheres[i].radius;
+    }
+
+    if(visible)
+    {
+      indices.push_back(static_cast<uint32_t>(i));
+    }
+  }
+}
+
+void
+cullBoxesGlm(std::vector<Box> const& boxes,
+             Planes           const& planes,
+             std::vector<uint32_t>&  indices)
+{
+  indices.clear();
+
+  for(std::size_t i{ 0 }; i < boxes.size(); ++i)
+  {
+    bool visible{ true };
+
+    for(std::size_t p{ 0 }; p < planes.size() and visible; ++p)
+    {
+      glm::vec3 const normal{ planes[p] };
+
+      float const distance{ glm::dot(normal, boxes[i].center) +
+                            planes[p].w };
+
+      visible = distance + glm::dot(glm::abs(normal), boxes[i].extent) >=
+                0.0f;
+    }
+
+    if(visible)
+    {
+      indices.push_back(static_cast<uint32_t>(i));
+    }
+  }
+}
+
+char const*
+getName(so::SimdLevel const simdLevel)
+{
+  switch(simdLevel)
+  {
+    case so::SimdLevel::scalar:
+      return "scalar";
+    case so::SimdLevel::sse:
+      return "sse";
+    case so::SimdLevel::avx2:
+      return "avx2";
+    case so::SimdLevel::avx512:
+      return "avx512";
+  }
+
+  return "unknown";
+}
+
+// Median time of a run in seconds.
+double
+measure(std::function<void()> const& run, long const repetitions)
+{
+  std::vector<double> times;
+
+  run(); // Warm up the caches and wake the workers once.
+
+  for(long i{ 0 }; i < repetitions; ++i)
+  {
+    auto const start{ std::chrono::steady_clock::now() };
+
+    run();
+
+    std::chrono::duration<double> const elapsed
+      { std::chrono::steady_clock::now() - start };
+
+    times.push_back(elapsed.count());
+  }
+
+  std::sort(times.begin(), times.end());
+
+  return times[times.size() / 2];
+}
+
+void
+report(char        const* shape,
+       char        const* kernel,
+       so::size_type      numThreads,
+       std::size_t        numObjects,
+       std::size_t        numVisible,
+       double             seconds)
+{
+  printf("%-8s %-8s %7zu %10zu %10.1f\n",
+         shape,
+         kernel,
+         numThreads,
+         numVisible,
+         static_cast<double>(numObjects) / seconds * 1.0e-6);
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+  // Usage: frustum_culling [objects] [repetitions]
+  long const numObjectsArg{ argc > 1 ? std::atol(argv[1]) : 1L << 20 };
+  long const repetitions{ argc > 2 ? std::atol(argv[2]) : 50 };
+
+  if(numObjectsArg <= 0 or repetitions <= 0)
+  {
+    puts("The number of objects and repetitions have to be positive.");
+
+    return EXIT_FAILURE;
+  }
+
+  auto const numObjects{ static_cast<std::size_t>(numObjectsArg) };
+
+  // Objects scattered through a cube around the camera, of which the view
+  // frustum sees roughly a tenth.
+  std::mt19937                          generator{ 42 };
+  std::uniform_real_distribution<float> position{ -500.0f, 500.0f };
+  std::uniform_real_distribution<float> size{ 0.5f, 4.0f };
+
+  std::vector<Sphere> spheres(numObjects);
+  std::vector<Box>    boxes(numObjects);
+
+  for(std::size_t i{ 0 }; i < numObjects; ++i)
+  {
+    glm::vec3 const center{ position(generator),
+                            position(generator),
+                            position(generator) };
+
+    spheres[i] = Sphere{ center, size(generator) };
+    boxes[i]   = Box{ center, glm::vec3{ size(generator),
+                                         size(generator),
+                                         size(generator) } };
+  }
+
+  glm::mat4 const viewProjection
+    { glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f) *
+      glm::lookAt(glm::vec3{ 0.0f }, glm::vec3{ 1.0f, 0.2f, -1.0f },
+                  glm::vec3{ 0.0f, 1.0f, 0.0f }) };
+
+  std::array<float, 16> matrix;
+
+  std::memcpy(matrix.data(), glm::value_ptr(viewProjection), sizeof(matrix));
+
+  so::FrustumCuller::Planes const planes
+    { so::FrustumCuller::getFrustumPlanes(matrix) };
+
+  Planes glmPlanes;
+
+  for(std::size_t p{ 0 }; p < planes.size(); ++p)
+  {
+    glmPlanes[p] = glm::vec4{ planes[p][0], planes[p][1],
+                              planes[p][2], planes[p][3] };
+  }
+
+  so::JobSystem jobSystem;
+
+  jobSystem.initialize();
+
+  so::FrustumCuller singleThreaded;
+  so::FrustumCuller multiThreaded;
+
+  multiThreaded.initialize(jobSystem);
+
+  for(so::FrustumCuller* culler : { &singleThreaded, &multiThreaded })
+  {
+    culler->resize(numObjects);
+
+    for(std::size_t i{ 0 }; i < numObjects; ++i)
+    {
+      culler->setSphere(i,
+                        { spheres[i].center.x,
+                          spheres[i].center.y,
+                          spheres[i].center.z },
+                        spheres[i].radius);
+
+      glm::vec3 const min{ boxes[i].center - boxes[i].extent };
+      glm::vec3 const max{ boxes[i].center + boxes[i].extent };
+
+      culler->setBox(i, { min.x, min.y, min.z }, { max.x, max.y, max.z });
+    }
+  }
+
+  printf("%zu objects, %ld repetitions, %zu threads\n\n",
+         numObjects,
+         repetitions,
+         multiThreaded.getNumThreads());
+  printf("%-8s %-8s %7s %10s %10s\n",
+         "shape", "kernel", "threads", "visible", "Mobj/s");
+
+  bool matches{ true };
+
+  for(so::BoundingShape const shape : { so::BoundingShape::sphere,
+                                        so::BoundingShape::box })
+  {
+    bool const isSphere{ shape is_eq so::BoundingShape::sphere };
+
+    char const* const shapeName{ isSphere ? "sphere" : "box" };
+
+    std::vector<uint32_t> reference;
+
+    double const referenceTime
+      { measure([&]
+                {
+                  if(isSphere)
+                  {
+                    cullSpheresGlm(spheres, glmPlanes, reference);
+                  }
+                  else
+                  {
+                    cullBoxesGlm(boxes, glmPlanes, reference);
+                  }
+                },
+                repetitions) };
+
+    report(shapeName, "glm", 1, numObjects, reference.size(), referenceTime);
+
+    so::SimdLevel const supported
+      { so::FrustumCuller::getSupportedSimdLevel() };
+
+    for(so::SimdLevel const simdLevel : { so::SimdLevel::scalar,
+                                          so::SimdLevel::sse,
+                                          so::SimdLevel::avx2,
+                                          so::SimdLevel::avx512 })
+    {
+      if(simdLevel > supported)
+      {
+        break;
+      }
+
+      for(so::FrustumCuller* culler : { &singleThreaded, &multiThreaded })
+      {
+        if(culler is_eq &multiThreaded and culler->getNumThreads() is_eq 1)
+        {
+          continue;
+        }
+
+        culler->setSimdLevel(simdLevel);
+
+        double const time{ measure([&] { culler->cull(planes, shape); },
+                                   repetitions) };
+
+        std::vector<uint32_t> indices;
+
+        culler->getVisibleIndices(indices);
+
+        report(shapeName,
+               getName(simdLevel),
+               culler->getNumThreads(),
+               numObjects,
+               indices.size(),
+               time);
+
+        if(indices not_eq reference)
+        {
+          printf("%s %s culls different objects than the reference.\n",
+                 shapeName,
+                 getName(simdLevel));
+
+          matches = false;
+        }
+      }
+    }
+  }
+
+  return matches ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,163 @@
+#include "cxx/soDefinitions.hpp"
+#include "cxx/soJobSystem.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Hits = std::unique_ptr<std::atomic<uint32_t>[]>;
+
+/*
+ * Counts the indices in [first, last) that were not hit exactly once and
+ * clears the hits for the next round.
+ */
+std::size_t
+countMisses(Hits& hits, std::size_t const first, std::size_t const last)
+{
+  std::size_t numMisses{ 0 };
+
+  for(std::size_t i{ first }; i < last; ++i)
+  {
+    if(hits[i].exchange(0) not_eq 1)
+    {
+      ++numMisses;
+    }
+  }
+
+  return numMisses;
+}
+
+/*
+ * Schedules numJobs jobs from outside the job system, through its shared
+ * queue. Each job schedules a child from the worker running it, onto that
+ * worker's deque, for the others to steal. Once wait returns every job of
+ * the producer has to have run.
+ */
+std::size_t
+produce(so::JobSystem&      jobSystem,
+        Hits&               hits,
+        std::size_t const   first,
+        std::size_t const   numJobs,
+        std::size_t const   childOffset)
+{
+  so::JobCounter counter;
+
+  for(std::size_t id{ first }; id < first + numJobs; ++id)
+  {
+    jobSystem.run([&jobSystem, &hits, &counter, id, childOffset]
+                  {
+                    ++hits[id];
+
+                    jobSystem.run([&hits, id, childOffset]
+                                  {
+                                    ++hits[childOffset + id];
+                                  },
+                                  &counter);
+                  },
+                  &counter);
+  }
+
+  jobSystem.wait(counter);
+
+  return countMisses(hits, first, first + numJobs) +
+         countMisses(hits, childOffset + first, childOffset + first + numJobs);
+}
+
+} // namespace
+
+/*
+ * Schedules jobs from many threads at once and checks that every job runs
+ * exactly once. Meant to be run under -fsanitize=thread, see SANITIZE.
+ */
+int
+main(int argc, char** argv)
+{
+  // Usage: job_stress [rounds] [producers] [threads]
+  long const rounds{ argc > 1 ? std::atol(argv[1]) : 20 };
+  long const numProducersArg{ argc > 2 ? std::atol(argv[2]) : 4 };
+  long const numThreadsArg{ argc > 3 ? std::atol(argv[3]) : 8 };
+
+  if(rounds <= 0 or numProducersArg <= 0 or numThreadsArg <= 0)
+  {
+    puts("The number of rounds, producers and threads have to be positive.");
+
+    return EXIT_FAILURE;
+  }
+
+  auto const numProducers{ static_cast<std::size_t>(numProducersArg) };
+  auto const numThreads{ static_cast<so::size_type>(numThreadsArg) };
+
+  std::size_t const numJobs{ 4096 };
+  std::size_t const numRanged{ 1 << 16 };
+  std::size_t const childOffset{ numProducers * numJobs };
+
+  so::JobSystem jobSystem;
+
+  jobSystem.initialize(numThreads);
+
+  Hits hits{ new std::atomic<uint32_t>[2 * childOffset + numRanged]{} };
+
+  printf("%ld rounds, %zu producers, %zu threads\n",
+         rounds,
+         numProducers,
+         jobSystem.getNumThreads());
+
+  std::atomic<std::size_t> numMisses{ 0 };
+
+  for(long round{ 0 }; round < rounds; ++round)
+  {
+    std::vector<std::thread> producers;
+
+    for(std::size_t p{ 0 }; p < numProducers; ++p)
+    {
+      producers.emplace_back([&, p]
+                             {
+                               numMisses += produce(jobSystem,
+                                                    hits,
+                                                    p * numJobs,
+                                                    numJobs,
+                                                    childOffset);
+                             });
+    }
+
+    // Meanwhile thread 0 splits a range into single elements, which
+    // schedules onto its own deque.
+    std::size_t const rangeOffset{ 2 * childOffset };
+
+    jobSystem.parallelFor(rangeOffset,
+                          rangeOffset + numRanged,
+                          [&hits](so::size_type const begin,
+                                  so::size_type const end)
+                          {
+                            for(so::size_type i{ begin }; i < end; ++i)
+                            {
+                              ++hits[i];
+                            }
+                          },
+                          1);
+
+    numMisses += countMisses(hits, rangeOffset, rangeOffset + numRanged);
+
+    for(auto& producer : producers)
+    {
+      producer.join();
+    }
+  }
+
+  if(numMisses > 0)
+  {
+    printf("%zu jobs did not run exactly once.\n", numMisses.load());
+
+    return EXIT_FAILURE;
+  }
+
+  puts("Every job ran exactly once.");
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,170 @@
+#include "cxx/soDefinitions.hpp"
+#include "cxx/soPoolAllocator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using so::utils::mem::makePooledShared;
+
+// About the size of a wrapper like so::vk::CommandPool.
+struct
+Wrapper
+{
+  std::shared_ptr<void> device;
+  uint64_t              handle;
+  uint32_t              flags;
+  uint32_t              family;
+}; // struct Wrapper
+
+// Keeps the compiler from dropping results.
+volatile uint64_t sink{ 0 };
+
+// Median time of a run in seconds.
+double
+measure(std::function<void()> const& run, long const repetitions)
+{
+  std::vector<double> times;
+
+  run(); // Warm up the caches and the allocator.
+
+  for(long i{ 0 }; i < repetitions; ++i)
+  {
+    auto const start{ std::chrono::steady_clock::now() };
+
+    run();
+
+    std::chrono::duration<double> const elapsed
+      { std::chrono::steady_clock::now() - start };
+
+    times.push_back(elapsed.count());
+  }
+
+  std::sort(times.begin(), times.end());
+
+  return times[times.size() / 2];
+}
+
+void
+report(char        const* test,
+       char        const* allocator,
+       std::size_t        numObjects,
+       double             seconds)
+{
+  printf("%-22s %-16s %10.2f\n",
+         test,
+         allocator,
+         seconds / static_cast<double>(numObjects) * 1.0e9);
+}
+
+/*
+ * Creates the objects in waves of a frame's worth and drops them again, like
+ * per frame command pools and retired wrappers.
+ */
+template <typename Make>
+void
+churn(std::size_t const numObjects, Make const& make)
+{
+  std::size_t const wave{ 256 };
+
+  std::vector<std::shared_ptr<Wrapper>> objects;
+
+  objects.reserve(wave);
+
+  for(std::size_t i{ 0 }; i < numObjects; i += wave)
+  {
+    for(std::size_t j{ 0 }; j < wave; ++j)
+    {
+      objects.push_back(make());
+      objects.back()->handle = i + j;
+    }
+
+    for(auto const& object : objects)
+    {
+      sink = sink + object->handle;
+    }
+
+    objects.clear();
+  }
+}
+
+template <typename Make>
+void
+churnThreads(std::size_t const numObjects,
+             unsigned    const numThreads,
+             Make const&       make)
+{
+  std::vector<std::thread> threads;
+
+  for(unsigned i{ 0 }; i < numThreads; ++i)
+  {
+    threads.emplace_back([&] { churn(numObjects / numThreads, make); });
+  }
+
+  for(auto& thread : threads)
+  {
+    thread.join();
+  }
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+  // Usage: object_pool [objects] [repetitions]
+  long const numObjectsArg{ argc > 1 ? std::atol(argv[1]) : 1L << 20 };
+  long const repetitions{ argc > 2 ? std::atol(argv[2]) : 21 };
+
+  if(numObjectsArg <= 0 or repetitions <= 0)
+  {
+    puts("The number of objects and repetitions have to be positive.");
+
+    return EXIT_FAILURE;
+  }
+
+  auto const numObjects{ static_cast<std::size_t>(numObjectsArg) };
+  auto const numThreads
+    { std::max(std::thread::hardware_concurrency(), 1u) };
+
+  printf("%zu objects, %ld repetitions, %u threads\n\n",
+         numObjects,
+         repetitions,
+         numThreads);
+  printf("%-22s %-16s %10s\n", "test", "allocator", "ns/object");
+
+  auto const makeShared{ [] { return std::make_shared<Wrapper>(); } };
+  auto const makePooled{ [] { return makePooledShared<Wrapper>(); } };
+
+  report("churn",
+         "make_shared",
+         numObjects,
+         measure([&] { churn(numObjects, makeShared); }, repetitions));
+
+  report("churn",
+         "pool",
+         numObjects,
+         measure([&] { churn(numObjects, makePooled); }, repetitions));
+
+  report("churn threads",
+         "make_shared",
+         numObjects,
+         measure([&] { churnThreads(numObjects, numThreads, makeShared); },
+                 repetitions));
+
+  report("churn threads",
+         "pool",
+         numObjects,
+         measure([&] { churnThreads(numObjects, numThreads, makePooled); },
+                 repetitions));
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,152 @@
+
+#include "soEngine.h"
+
+#include "cxx/soDebugCallback.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+// Window sizes the benchmark cycles through, one per resize.
+constexpr so::size_type sizes[][2]{ {  800, 600 },
+                                    { 1024, 768 },
+                                    {  640, 480 },
+                                    { 1280, 720 } };
+
+constexpr so::size_type numSizes{ sizeof(sizes) / sizeof(sizes[0]) };
+
+double
+percentile(std::vector<double> values, double const fraction)
+{
+  if(values.empty())
+  {
+    return 0.0;
+  }
+
+  std::sort(values.begin(), values.end());
+
+  auto const idx{ static_cast<std::size_t>
+                    (fraction * static_cast<double>(values.size() - 1)) };
+
+  return values[idx];
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+  so::setDebugCallback([](so::DebugCode const  code,
+                          std::string   const& message,
+                          std::string   const& funcSig,
+                          so::index_t   const  line,
+                          std::string   const& file)
+                       {
+                         if(code not_eq so::DebugCode::error)
+                         {
+                           return;
+                         }
+
+                         std::string debugMessage{ "<ERROR>   " };
+
+                         debugMessage.append(funcSig);
+                         debugMessage.append(": ");
+                         debugMessage.append(message);
+                         debugMessage.append(" (");
+                         debugMessage.append(file);
+                         debugMessage.append(", line ");
+                         debugMessage.append(std::to_string(line));
+                         debugMessage.append(")");
+
+                         puts(debugMessage.c_str());
+                       });
+
+  // Only errors are printed, so the others are not even queued.
+  so::setDebugLevel(so::DebugLevel::error);
+
+  // Usage: resize_storm [frames] [frames between resizes]
+  long const numFrames{ argc > 1 ? std::atol(argv[1]) : 2000 };
+  long const resizeInterval{ argc > 2 ? std::atol(argv[2]) : 4 };
+
+  so::Engine engine;
+
+  so::return_t const result(engine.initialize("Resize storm",
+                                              VK_MAKE_VERSION(0, 0, 1)));
+
+  if(result == failure)
+  {
+    return EXIT_FAILURE;
+  }
+
+  std::vector<double> frameTimes;
+  std::vector<double> recreationTimes;
+
+  frameTimes.reserve(static_cast<std::size_t>(numFrames));
+
+  uint64_t lastRecreations{ 0 };
+
+  auto const start{ std::chrono::steady_clock::now() };
+
+  for(long frame{ 0 }; frame < numFrames and not engine.windowIsClosed();
+      ++frame)
+  {
+    if(resizeInterval > 0 and frame % resizeInterval is_eq 0)
+    {
+      auto const& size{ sizes[static_cast<so::size_type>(frame /
+                                                         resizeInterval) %
+                              numSizes] };
+
+      if(engine.surfaceSetWindowSize(size[0], size[1]) is_eq failure)
+      {
+        puts("The surface provider does not support resizing the window.");
+
+        return EXIT_FAILURE;
+      }
+    }
+
+    engine.surfacePollEvents();
+
+    engine.drawFrame();
+
+    so::FrameStatistics const& stats{ engine.getFrameStatistics() };
+
+    frameTimes.push_back(stats.frameTime.count());
+
+    if(stats.swapChainRecreations not_eq lastRecreations)
+    {
+      recreationTimes.push_back(stats.swapChainRecreationTime.count());
+
+      lastRecreations = stats.swapChainRecreations;
+    }
+  }
+
+  std::chrono::duration<double> const elapsed
+    { std::chrono::steady_clock::now() - start };
+
+  printf("frames:                 %zu in %.3f s\n",
+         frameTimes.size(),
+         elapsed.count());
+  printf("frame time p50/p99/max: %.3f / %.3f / %.3f ms\n",
+         percentile(frameTimes, 0.5),
+         percentile(frameTimes, 0.99),
+         percentile(frameTimes, 1.0));
+  printf("swap chain recreations: %zu\n", recreationTimes.size());
+  printf("recreation p50/p99/max: %.3f / %.3f / %.3f ms\n",
+         percentile(recreationTimes, 0.5),
+         percentile(recreationTimes, 0.99),
+         percentile(recreationTimes, 1.0));
+
+  for(auto const& zone : engine.getGpuZoneHistories())
+  {
+    printf("gpu %-18s  %.3f ms (average of last %zu)\n",
+           (zone.first + ":").c_str(),
+           zone.second.average().count(),
+           zone.second.samples.size());
+  }
+
+  return EXIT_SUCCESS;
+}
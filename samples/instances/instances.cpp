@@ -0,0 +1,223 @@
+#include "soEngine.h"
+
+#include "cxx/soDebugCallback.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+// Draws a grid of instances of a model with GPU-driven culling, e.g. with
+//
+//   SO_SURFACE_PROVIDER=headless SO_HEADLESS_FRAMES=10 ./instances model.obj
+//
+// The view covers the central half of the grid. Once the surface closes, the
+// number of instances the GPU drew is compared against the same frustum test
+// on the CPU, so the culling pass can be checked on a software rasterizer.
+// Devices without GPU-driven drawing check the render queue instead, which
+// also samples the texture given as the third argument, if any, with the mip
+// levels streamed in for the size the instances cover on screen.
+int
+main(int argc, char** argv)
+{
+  so::setDebugCallback([](so::DebugCode const  code,
+                          std::string   const& message,
+                          std::string   const& funcSig,
+                          so::index_t   const  line,
+                          std::string   const& file)
+                       {
+                         (void) funcSig;
+
+                         if(code is_eq so::DebugCode::error)
+                         {
+                           fprintf(stderr,
+                                   "<ERROR>   %s (%s, line %d)\n",
+                                   message.c_str(),
+                                   file.c_str(),
+                                   static_cast<int>(line));
+                         }
+                       });
+
+  // Only errors are printed, so the others are not even queued.
+  so::setDebugLevel(so::DebugLevel::error);
+
+  if(argc < 2)
+  {
+    fputs("Usage: instances <model> [grid size] [texture]\n", stderr);
+
+    return EXIT_FAILURE;
+  }
+
+  long const gridSize{ argc > 2 ? std::max(std::atol(argv[2]), 1l) : 100 };
+
+  so::Engine engine;
+
+  so::return_t const result(engine.initialize("Instances",
+                                              VK_MAKE_VERSION(0, 0, 1)));
+
+  if(result == failure or engine.loadMesh(argv[1]) == failure)
+  {
+    return EXIT_FAILURE;
+  }
+
+  if(argc > 3 and engine.loadMeshTexture(argv[3]) == failure)
+  {
+    return EXIT_FAILURE;
+  }
+
+  so::vk::MeshBounds const& bounds{ engine.getMesh().getBounds() };
+
+  std::array<float, 3> center;
+
+  float radius{ 0.0f };
+
+  for(std::size_t axis{ 0 }; axis < 3; ++axis)
+  {
+    center[axis] = 0.5f * (bounds.min[axis] + bounds.max[axis]);
+    radius       = std::max(radius, bounds.max[axis] - center[axis]);
+  }
+
+  radius *= std::sqrt(3.0f);
+
+  // The frustum ends halfway between two columns of instances, which are far
+  // enough apart that no bounding sphere ends close to a plane. Rounding then
+  // cannot make the GPU and the CPU disagree.
+  float const spacing{ 4.0f * std::max(radius, 1e-3f) };
+  float const halfGrid{ 0.5f * static_cast<float>(gridSize - 1) };
+
+  std::vector<so::vk::MeshInstance> instances;
+
+  auto const numSubMeshes
+    { static_cast<uint32_t>(engine.getMesh().getSubMeshes().size()) };
+
+  for(long y{ 0 }; y < gridSize; ++y)
+  {
+    for(long x{ 0 }; x < gridSize; ++x)
+    {
+      so::vk::MeshInstance instance;
+
+      instance.transform  = { { 1.0f, 0.0f, 0.0f, 0.0f,
+                                0.0f, 1.0f, 0.0f, 0.0f,
+                                0.0f, 0.0f, 1.0f, 0.0f,
+                                0.0f, 0.0f, 0.0f, 1.0f } };
+      instance.transform[12] = (static_cast<float>(x) - halfGrid) * spacing -
+                               center[0];
+      instance.transform[13] = (static_cast<float>(y) - halfGrid) * spacing -
+                               center[1];
+      instance.transform[14] = -center[2];
+
+      for(uint32_t subMesh{ 0 }; subMesh < numSubMeshes; ++subMesh)
+      {
+        instance.subMesh = subMesh;
+
+        instances.push_back(instance);
+      }
+    }
+  }
+
+  if(engine.setMeshInstances(instances) == failure)
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Orthographic over the central half of the grid, z from -depth to depth
+  // maps to [0, 1].
+  float const halfWidth{ (std::floor(0.5f * halfGrid) + 0.5f) * spacing };
+  float const depth{ 4.0f * spacing };
+
+  std::array<float, 16> const viewProjection
+    { { 1.0f / halfWidth, 0.0f,              0.0f,                 0.0f,
+        0.0f,             -1.0f / halfWidth, 0.0f,                 0.0f,
+        0.0f,             0.0f,              0.5f / depth,         0.0f,
+        0.0f,             0.0f,              0.5f,                 1.0f } };
+
+  engine.setViewProjection(viewProjection);
+
+  while(not engine.windowIsClosed())
+  {
+    engine.surfacePollEvents();
+
+    engine.drawFrame();
+  }
+
+  // The same test as src/shaders/cull.
+  auto const planes{ so::vk::GpuDrivenRenderer::getFrustumPlanes
+                       (viewProjection) };
+
+  uint32_t expected{ 0 };
+
+  for(auto const& instance : instances)
+  {
+    so::vk::MeshBounds const& subMeshBounds
+      { engine.getMesh().getSubMeshes()[instance.subMesh].bounds };
+
+    float sphere[4]{ 0.0f, 0.0f, 0.0f, 0.0f };
+
+    for(std::size_t axis{ 0 }; axis < 3; ++axis)
+    {
+      float const extent{ subMeshBounds.max[axis] - subMeshBounds.min[axis] };
+
+      sphere[axis] = subMeshBounds.min[axis] + 0.5f * extent +
+                     instance.transform[12 + axis];
+      sphere[3]   += 0.25f * extent * extent;
+    }
+
+    sphere[3] = std::sqrt(sphere[3]);
+
+    bool const isVisible
+      { std::all_of(planes.begin(),
+                    planes.end(),
+                    [&sphere](std::array<float, 4> const& plane)
+                    {
+                      return plane[0] * sphere[0] +
+                             plane[1] * sphere[1] +
+                             plane[2] * sphere[2] +
+                             plane[3] >= -sphere[3];
+                    }) };
+
+    expected += isVisible ? 1 : 0;
+  }
+
+  if(not engine.isGpuDrivenDrawing())
+  {
+    so::vk::RenderQueueStatistics const& statistics
+      { engine.getRenderQueue().getStatistics() };
+
+    printf("Drew %zu of %zu instances with %zu instanced draws through the "
+           "render queue, expected %u.\n",
+           statistics.numItems,
+           instances.size(),
+           statistics.numDraws,
+           expected);
+
+    so::vk::TextureStreamingStatistics const streaming
+      { engine.getTextureStreamer().getStatistics() };
+
+    if(streaming.textureCount > 0)
+    {
+      printf("Streamed in %llu bytes, %llu of %llu budget bytes resident, "
+             "%llu evictions.\n",
+             static_cast<unsigned long long>(streaming.streamedInBytes),
+             static_cast<unsigned long long>(streaming.residentBytes),
+             static_cast<unsigned long long>(streaming.budget),
+             static_cast<unsigned long long>(streaming.evictions));
+    }
+
+    return statistics.numItems == expected ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  so::vk::GpuDrivenRenderer const& renderer{ engine.getGpuDrivenRenderer() };
+
+  char const* const modes[]{ "vkCmdDrawIndexedIndirectCountKHR",
+                             "multi draw vkCmdDrawIndexedIndirect",
+                             "vkCmdDrawIndexedIndirect per instance" };
+
+  printf("Drew %u of %zu instances with %s, expected %u.\n",
+         renderer.getNumVisibleInstances(),
+         instances.size(),
+         modes[static_cast<int>(renderer.getIndirectDrawMode())],
+         expected);
+
+  return renderer.getNumVisibleInstances() == expected ? EXIT_SUCCESS
+                                                       : EXIT_FAILURE;
+}
@@ -0,0 +1,100 @@
+
+#include "soEngine.h"
+
+#include "cxx/soDebugCallback.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+
+// Renders frames until the surface closes, e.g. with
+//
+//   SO_SURFACE_PROVIDER=headless SO_HEADLESS_FRAMES=100 ./offscreen out.ppm
+//
+// and writes the last frame as a binary PPM.
+int
+main(int argc, char** argv)
+{
+  so::setDebugCallback([](so::DebugCode const  code,
+                          std::string   const& message,
+                          std::string   const& funcSig,
+                          so::index_t   const  line,
+                          std::string   const& file)
+                       {
+                         (void) funcSig;
+
+                         if(code is_eq so::DebugCode::error)
+                         {
+                           fprintf(stderr,
+                                   "<ERROR>   %s (%s, line %d)\n",
+                                   message.c_str(),
+                                   file.c_str(),
+                                   static_cast<int>(line));
+                         }
+                       });
+
+  // Only errors are printed, so the others are not even queued.
+  so::setDebugLevel(so::DebugLevel::error);
+
+  char const* const outFile{ argc > 1 ? argv[1] : "frame.ppm" };
+
+  so::Engine engine;
+
+  so::return_t const result(engine.initialize("Offscreen",
+                                              VK_MAKE_VERSION(0, 0, 1)));
+
+  if(result == failure)
+  {
+    return EXIT_FAILURE;
+  }
+
+  if(engine.setFrameCaptureEnabled(true) == failure)
+  {
+    return EXIT_FAILURE;
+  }
+
+  while(not engine.windowIsClosed())
+  {
+    engine.surfacePollEvents();
+
+    engine.drawFrame();
+  }
+
+  so::vk::CapturedFrame frame;
+
+  if(engine.captureFrame(frame) == failure)
+  {
+    fputs("No frame was captured.\n", stderr);
+
+    return EXIT_FAILURE;
+  }
+
+  bool const isBGRA{ frame.format == VK_FORMAT_B8G8R8A8_UNORM or
+                     frame.format == VK_FORMAT_B8G8R8A8_SRGB };
+
+  FILE* file{ fopen(outFile, "wb") };
+
+  if(file == nullptr)
+  {
+    return EXIT_FAILURE;
+  }
+
+  fprintf(file, "P6\n%u %u\n255\n", frame.extent.width, frame.extent.height);
+
+  for(std::size_t i{ 0 }; i < frame.pixels.size(); i += 4)
+  {
+    unsigned char const rgb[]{ frame.pixels[i + (isBGRA ? 2 : 0)],
+                               frame.pixels[i + 1],
+                               frame.pixels[i + (isBGRA ? 0 : 2)] };
+
+    fwrite(rgb, 1, sizeof(rgb), file);
+  }
+
+  fclose(file);
+
+  printf("Wrote %ux%u frame to '%s'.\n",
+         frame.extent.width,
+         frame.extent.height,
+         outFile);
+
+  return EXIT_SUCCESS;
+}
@@ -48,10 +48,17 @@
  *             OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#pragma once
+
+#include "soDefinitions.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
 #include <limits>
 #include <memory>
-
-#pragma once
+#include <new>
+#include <type_traits>
 
 namespace so
 {
@@ -59,28 +66,30 @@ namespace so
   {
     namespace mem
     {
-      template<typename T>
-      struct pointer_traits
-      {
-        using reference       = T&;
-        using const_reference = const T&;
-      };
-
-// Avoid declaring a reference to void with an empty specialization
-      template<>
-      struct pointer_traits<void> { };
-
+      /**
+       * @brief Allocates storage whose start is a multiple of alignment,
+       *        which has to be a power of two. Memory allocated by one
+       *        instance may be deallocated by any other, the alignment
+       *        follows the storage when containers are assigned or swapped.
+       */
       template<typename T = void>
-      class AlignedAllocator : public pointer_traits<T>
+      class AlignedAllocator
       {
         public:
           using value_type         = T;
           using size_type          = std::size_t;
           using pointer            = T*;
           using const_pointer      = const T*;
+          using void_pointer       = void*;
           using const_void_pointer = const void*;
-          using difference_type    =
-            typename std::pointer_traits<pointer>::difference_type;
+          using difference_type    = std::ptrdiff_t;
+
+          using propagate_on_container_copy_assignment = std::true_type;
+          using propagate_on_container_move_assignment = std::true_type;
+          using propagate_on_container_swap            = std::true_type;
+
+          template<typename U>
+          struct rebind { using other = AlignedAllocator<U>; };
 
           AlignedAllocator(std::size_t alignment) noexcept
             : mAlignment(alignment) {}
@@ -89,52 +98,69 @@ namespace so
 
           template<typename U>
           AlignedAllocator(const AlignedAllocator<U>& other) noexcept
-            : mAlignment(other.mAlignment) {}
+            : mAlignment(other.alignment()) {}
 
+          /**
+           * @brief Storage for n objects of type T, throws std::bad_alloc if
+           *        there is not enough memory.
+           */
           inline pointer
-          allocate(size_t n, const_void_pointer = 0)
+          allocate(size_type n, const_void_pointer = nullptr)
           {
+            if(n > max_size())
+              throw std::bad_array_new_length();
+
+            // posix_memalign needs at least the alignment of a pointer.
+            size_type const alignment
+              (std::max({ mAlignment, alignof(T), sizeof(void*) }));
+
+            size_type const size(std::max(n * sizeof(T), size_type{ 1 }));
+
             void* data(nullptr);
 
 #if defined(_MSC_VER) || defined(__MINGW32__)
-            data = _aligned_malloc(n, mAlignment);
+            data = _aligned_malloc(size, alignment);
 #else
-            int result(posix_memalign(&data, mAlignment, n));
+            int result(posix_memalign(&data, alignment, size));
 
             if(result not_eq 0)
               data = nullptr;
 #endif
 
-            return data;
+            if(data is_eq nullptr)
+              throw std::bad_alloc();
+
+            return static_cast<pointer>(data);
           }
 
           void
-          deallocate(pointer p, size_type n)
+          deallocate(pointer p, size_type) noexcept
           {
 #if	defined(_MSC_VER) || defined(__MINGW32__)
             _aligned_free(p);
 #else
-            free(p);
+            std::free(p);
 #endif
           }
 
-          inline size_type max_size() const
+          inline size_type max_size() const noexcept
           { return std::numeric_limits<size_type>::max() / sizeof(T); }
 
-          template<typename U>
-          struct rebind { typedef AlignedAllocator<U> other; };
+          inline size_type alignment() const noexcept { return mAlignment; }
 
         private:
           std::size_t mAlignment;
       };
 
       template<typename T, typename U>
-      constexpr bool operator==(const AlignedAllocator<T>&,
-                                const AlignedAllocator<U>&) noexcept;
+      inline bool operator==(const AlignedAllocator<T>& lhs,
+                             const AlignedAllocator<U>& rhs) noexcept
+      { return lhs.alignment() is_eq rhs.alignment(); }
 
       template<typename T, typename U>
-      constexpr bool operator!=(const AlignedAllocator<T>&,
-                                const AlignedAllocator<U>&) noexcept;
+      inline bool operator!=(const AlignedAllocator<T>& lhs,
+                             const AlignedAllocator<U>& rhs) noexcept
+      { return not (lhs == rhs); }
     } // mem
   } // utils
 } // so
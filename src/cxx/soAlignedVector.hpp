@@ -50,147 +50,628 @@
 
 #pragma once
 
-#include <utils/def/soDefinitions.hpp>
-#include <utils/err/soException.hpp>
+#include "soAlignedAllocator.hpp"
+#include "soConstExpr.hpp"
+#include "soDefinitions.hpp"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
+#include <iterator>
 #include <limits>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 
 namespace so {
 namespace utils {
 namespace mem {
-      
+
+/**
+ * @brief How the elements of an AlignedVector are placed.
+ */
+enum class
+ElementLayout
+{
+  strided, // Every element starts at a multiple of the alignment.
+  packed   // Elements are sizeof(T) apart, only the first one is aligned.
+};
+
+/**
+ * @brief Random access iterator over elements stride bytes apart.
+ */
+template <typename T>
+class StridedIterator
+{
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = std::remove_cv_t<T>;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = T*;
+    using reference         = T&;
+
+    StridedIterator() noexcept : mElement(nullptr), mStride(0) {}
+
+    StridedIterator(pointer element, difference_type stride) noexcept
+      : mElement(element), mStride(stride)
+    {}
+
+    // Allows converting an iterator into a const iterator.
+    template <typename U,
+              typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+    StridedIterator(StridedIterator<U> const& other) noexcept
+      : mElement(other.operator->()), mStride(other.stride())
+    {}
+
+    reference operator*() const noexcept { return *mElement; }
+
+    pointer operator->() const noexcept { return mElement; }
+
+    reference operator[](difference_type n) const noexcept
+    { return *advance(mElement, n); }
+
+    StridedIterator& operator++() noexcept
+    { mElement = advance(mElement, 1); return *this; }
+
+    StridedIterator operator++(int) noexcept
+    { StridedIterator old(*this); ++*this; return old; }
+
+    StridedIterator& operator--() noexcept
+    { mElement = advance(mElement, -1); return *this; }
+
+    StridedIterator operator--(int) noexcept
+    { StridedIterator old(*this); --*this; return old; }
+
+    StridedIterator& operator+=(difference_type n) noexcept
+    { mElement = advance(mElement, n); return *this; }
+
+    StridedIterator& operator-=(difference_type n) noexcept
+    { mElement = advance(mElement, -n); return *this; }
+
+    friend StridedIterator operator+(StridedIterator it,
+                                     difference_type n) noexcept
+    { return it += n; }
+
+    friend StridedIterator operator+(difference_type n,
+                                     StridedIterator it) noexcept
+    { return it += n; }
+
+    friend StridedIterator operator-(StridedIterator it,
+                                     difference_type n) noexcept
+    { return it -= n; }
+
+    friend difference_type operator-(StridedIterator const& lhs,
+                                     StridedIterator const& rhs) noexcept
+    {
+      return (reinterpret_cast<uint8_t const*>(lhs.mElement) -
+              reinterpret_cast<uint8_t const*>(rhs.mElement)) /
+             lhs.mStride;
+    }
+
+    friend bool operator==(StridedIterator const& lhs,
+                           StridedIterator const& rhs) noexcept
+    { return lhs.mElement is_eq rhs.mElement; }
+
+    friend bool operator!=(StridedIterator const& lhs,
+                           StridedIterator const& rhs) noexcept
+    { return lhs.mElement not_eq rhs.mElement; }
+
+    friend bool operator<(StridedIterator const& lhs,
+                          StridedIterator const& rhs) noexcept
+    { return lhs.mElement < rhs.mElement; }
+
+    friend bool operator>(StridedIterator const& lhs,
+                          StridedIterator const& rhs) noexcept
+    { return rhs < lhs; }
+
+    friend bool operator<=(StridedIterator const& lhs,
+                           StridedIterator const& rhs) noexcept
+    { return not (rhs < lhs); }
+
+    friend bool operator>=(StridedIterator const& lhs,
+                           StridedIterator const& rhs) noexcept
+    { return not (lhs < rhs); }
+
+    difference_type stride() const noexcept { return mStride; }
+
+  private:
+    pointer         mElement;
+    difference_type mStride;
+
+    pointer
+    advance(pointer element, difference_type n) const noexcept
+    {
+      using byte_pointer = std::conditional_t<std::is_const<T>::value,
+                                              uint8_t const*,
+                                              uint8_t*>;
+
+      return reinterpret_cast<pointer>
+        (reinterpret_cast<byte_pointer>(element) + n * mStride);
+    }
+};
+
+/**
+ * @brief A growable array whose storage starts at a multiple of alignment,
+ *        which has to be a power of two.
+ *
+ * In the strided layout every element starts at a multiple of the alignment,
+ * elements are stride() bytes apart, sizeof(T) rounded up to the alignment,
+ * e.g. for dynamic uniform buffers. In the packed layout only the first
+ * element is aligned and elements are sizeof(T) apart, e.g. for streams of
+ * floats read by SIMD kernels.
+ *
+ * Growth doubles the capacity. Trivially copyable elements are relocated
+ * with a single memcpy, others are moved if their move constructor does not
+ * throw and copied otherwise, so a growth that throws leaves the vector
+ * unchanged. References and iterators are invalidated by any reallocation,
+ * as with std::vector.
+ */
 template <typename T>
 class AlignedVector
 {
   public:
     using value_type      = T;
     using size_type       = std::size_t;
+    using difference_type = std::ptrdiff_t;
     using reference       = value_type&;
-    using const_reference = const value_type&;
+    using const_reference = value_type const&;
+    using pointer         = value_type*;
+    using const_pointer   = value_type const*;
+    using iterator        = StridedIterator<value_type>;
+    using const_iterator  = StridedIterator<value_type const>;
+
+    AlignedVector() noexcept
+      : mAlignment(alignof(T)),
+        mStride(sizeof(T)),
+        mLayout(ElementLayout::strided),
+        mSize(0),
+        mCapacity(0),
+        mData(nullptr)
+    {}
+
+    /**
+     * @brief An empty vector. Throws std::invalid_argument if alignment is
+     *        not a power of two.
+     */
+    explicit AlignedVector(size_type     const alignment,
+                           ElementLayout const layout = ElementLayout::strided)
+      : AlignedVector()
+    {
+      setLayout(alignment, layout);
+    }
+
+    /**
+     * @brief Holds count value initialized elements. Throws
+     *        std::invalid_argument if alignment is not a power of two.
+     */
+    AlignedVector(size_type     const alignment,
+                  size_type     const count,
+                  ElementLayout const layout = ElementLayout::strided)
+      : AlignedVector()
+    {
+      setLayout(alignment, layout);
+
+      resize(count);
+    }
+
+    AlignedVector(size_type     const  alignment,
+                  size_type     const  count,
+                  const_reference      value,
+                  ElementLayout const  layout = ElementLayout::strided)
+      : AlignedVector()
+    {
+      setLayout(alignment, layout);
+
+      resize(count, value);
+    }
+
+    AlignedVector(AlignedVector const& other)
+      : AlignedVector()
+    {
+      mAlignment = other.mAlignment;
+      mStride    = other.mStride;
+      mLayout    = other.mLayout;
+
+      reserve(other.mSize);
+
+      constExprIf<std::is_trivially_copyable<T>> // if
+      ([&]() // then
+       {
+         if(other.mSize not_eq 0)
+           std::memcpy(mData, other.mData, other.mSize * mStride);
+
+         mSize = other.mSize;
+       },
+       [&]() // else
+       {
+         for(const_reference element : other)
+           push_back(element);
+       }
+      );
+    }
+
+    AlignedVector(AlignedVector&& other) noexcept
+      : AlignedVector()
+    {
+      swap(other);
+    }
+
+    ~AlignedVector() noexcept
+    {
+      destroyMembers();
+    }
+
+    AlignedVector& operator=(AlignedVector const& other)
+    {
+      if(this not_eq &other)
+      {
+        AlignedVector copy(other);
 
-    public:
-      explicit AlignedVector()
-        : mAlignment(0), mNumComponents(0), mComponents(nullptr) {}
+        swap(copy);
+      }
 
-      explicit AlignedVector(size_type alignment, size_type count)
-        : mAlignment(alignment), mNumComponents(count), mComponents(nullptr)
-      {
-        if(sizeof(T) > alignment)
-          utils::err::Exception<std::runtime_error>(
-            "Datatypes greater than the alignment currently not "
-            "supported!",
-            PRETTY_FUNCTION_SIG);
+      return *this;
+    }
 
-        void *data(nullptr);
+    AlignedVector& operator=(AlignedVector&& other) noexcept
+    {
+      if(this is_eq &other)
+        return *this;
 
-        if(mNumComponents not_eq 0)
-        {
-#if defined(_MSC_VER) || defined(__MINGW32__)
-          data = _aligned_malloc(mAlignment * mNumComponents, mNumComponents);
-#else
-          int result(posix_memalign(&data,
-                                    mAlignment,
-                                    mAlignment * mNumComponents));
-
-          if result not_eq 0)
-            data = nullptr;
-#endif
-        }
-        else
-          data = nullptr;
+      destroyMembers();
 
-        mComponents = static_cast<value_type*>(data);
+      mAlignment = alignof(T);
+      mStride    = sizeof(T);
+      mLayout    = ElementLayout::strided;
 
-        if((mNumComponents not_eq 0) and (mComponents is_eq nullptr))
-          utils::err::Exception<std::runtime_error>("failed to allocate "
-                                                    "aligned memory!",
-                                                    PRETTY_FUNCTION_SIG);
+      swap(other);
 
-        std::memset(mComponents, 0, mAlignment * mNumComponents);
-      }
+      return *this;
+    }
+
+    void swap(AlignedVector& other) noexcept
+    {
+      std::swap(mAlignment, other.mAlignment);
+      std::swap(mStride,    other.mStride);
+      std::swap(mLayout,    other.mLayout);
+      std::swap(mSize,      other.mSize);
+      std::swap(mCapacity,  other.mCapacity);
+      std::swap(mData,      other.mData);
+    }
+
+    /************************** Element access **************************/
+
+    reference operator[](size_type pos) noexcept
+    { return *address(pos); }
 
-      AlignedVector(AlignedVector const& other) = delete;
+    const_reference operator[](size_type pos) const noexcept
+    { return *address(pos); }
 
-      AlignedVector(AlignedVector&& other) = delete;
+    reference at(size_type pos)
+    {
+      if(pos >= mSize)
+        throw std::out_of_range("AlignedVector index out of range.");
 
-      ~AlignedVector() noexcept
+      return *address(pos);
+    }
+
+    const_reference at(size_type pos) const
+    {
+      if(pos >= mSize)
+        throw std::out_of_range("AlignedVector index out of range.");
+
+      return *address(pos);
+    }
+
+    reference front() noexcept { return *address(0); }
+
+    const_reference front() const noexcept { return *address(0); }
+
+    reference back() noexcept { return *address(mSize - 1); }
+
+    const_reference back() const noexcept { return *address(mSize - 1); }
+
+    T* data() noexcept { return reinterpret_cast<T*>(mData); }
+
+    const T* data() const noexcept
+    { return reinterpret_cast<T const*>(mData); }
+
+    /***************************** Iterators ****************************/
+
+    iterator begin() noexcept { return { data(), stride() }; }
+
+    const_iterator begin() const noexcept { return { data(), stride() }; }
+
+    const_iterator cbegin() const noexcept { return begin(); }
+
+    iterator end() noexcept { return { address(mSize), stride() }; }
+
+    const_iterator end() const noexcept
+    { return { address(mSize), stride() }; }
+
+    const_iterator cend() const noexcept { return end(); }
+
+    /***************************** Capacity *****************************/
+
+    inline bool empty() const noexcept { return mSize is_eq 0; }
+
+    inline size_type size() const noexcept { return mSize; }
+
+    inline size_type max_size() const noexcept
+    { return std::numeric_limits<size_type>::max() / mStride; }
+
+    inline size_type capacity() const noexcept { return mCapacity; }
+
+    inline size_type alignment() const noexcept { return mAlignment; }
+
+    /**
+     * @brief Distance between two elements in bytes.
+     */
+    inline difference_type stride() const noexcept
+    { return static_cast<difference_type>(mStride); }
+
+    inline ElementLayout layout() const noexcept { return mLayout; }
+
+    void reserve(size_type capacity)
+    {
+      if(capacity > mCapacity)
+      {
+        StorageGuard guard{ *this, allocate(capacity), mSize, mSize };
+
+        relocate(guard, capacity);
+      }
+    }
+
+    void shrink_to_fit()
+    {
+      if(mSize is_eq 0)
       {
         destroyMembers();
       }
+      else if(mSize < mCapacity)
+      {
+        StorageGuard guard{ *this, allocate(mSize), mSize, mSize };
+
+        relocate(guard, mSize);
+      }
+    }
+
+    /***************************** Modifiers ****************************/
+
+    void clear() noexcept
+    {
+      destroy(0, mSize);
+
+      mSize = 0;
+    }
 
-      AlignedVector& operator=(AlignedVector const& other) = delete;
+    void push_back(const_reference value) { emplace_back(value); }
 
-      AlignedVector& operator=(AlignedVector&& other)
+    void push_back(value_type&& value) { emplace_back(std::move(value)); }
+
+    template <typename... Args>
+    reference emplace_back(Args&&... args)
+    {
+      if(mSize < mCapacity)
       {
-        destroyMembers();
+        ::new(static_cast<void*>(address(mSize)))
+          T(std::forward<Args>(args)...);
+      }
+      else
+      {
+        size_type const capacity(grow(mSize + 1));
+        StorageGuard    guard{ *this, allocate(capacity), mSize, mSize };
 
-        mAlignment     = other.mAlignment;
-        mNumComponents = other.mNumComponents;
-        mComponents    = other.mComponents;
+        // Construct the new element before relocating, args may refer to
+        // an element of this vector.
+        ::new(static_cast<void*>(guard.storage + mSize * mStride))
+          T(std::forward<Args>(args)...);
 
-        other.mAlignment     = 0;
-        other.mNumComponents = 0;
-        other.mComponents    = nullptr;
+        guard.last = mSize + 1;
 
-        return *this;
+        relocate(guard, capacity);
       }
 
-      /************************** Element access **************************/
+      ++mSize;
+
+      return back();
+    }
 
-      reference operator[](size_type pos)
+    void pop_back() noexcept
+    {
+      destroy(mSize - 1, mSize);
+
+      --mSize;
+    }
+
+    void resize(size_type count)
+    {
+      if(count > mCapacity)
+        reserve(std::max(count, grow(count)));
+
+      for(; mSize < count; ++mSize)
+        ::new(static_cast<void*>(address(mSize))) T();
+
+      destroy(count, mSize);
+
+      mSize = std::min(mSize, count);
+    }
+
+    void resize(size_type count, const_reference value)
+    {
+      if(count > mCapacity)
       {
-        return *reinterpret_cast<value_type*>
-        /*     ^ Get actual value at address. */
-          (reinterpret_cast<uint8_t*>(mComponents) + (pos * mAlignment));
-        /* ^ Cast to move by bytes.                  ^ Move to next aligned
-         *                                             position. */
-      }
+        // value may be an element of this vector, which reserve relocates.
+        T const copy(value);
 
-      const_reference operator[](size_type pos) const
+        reserve(std::max(count, grow(count)));
+
+        fill(count, copy);
+      }
+      else
       {
-        return *reinterpret_cast<value_type*>
-        /*     ^ Get actual value at address. */
-          (reinterpret_cast<uint8_t*>(mComponents) + (pos * mAlignment));
-        /* ^ Cast to move by bytes.                  ^ Move to next aligned
-         *                                             position. */
+        fill(count, value);
       }
 
-      T* data() noexcept { return mComponents; }
-
-      const T* data() const noexcept { return mComponents; }
+      destroy(count, mSize);
 
-      /***************************** Capacity *****************************/
+      mSize = std::min(mSize, count);
+    }
 
-      inline auto empty() const noexcept { return mNumComponents is_eq 0; }
+  private:
+    size_type     mAlignment;
 
-      inline auto size() const noexcept { return mNumComponents; }
+    size_type     mStride;
 
-      inline auto max_size() const noexcept
-      { return std::numeric_limits<size_type>::max(); }
+    ElementLayout mLayout;
 
-      inline auto alignment() const noexcept { return mAlignment; }
+    size_type     mSize;
 
-    private:
-      size_type   mAlignment;
+    size_type     mCapacity;
 
-      size_type   mNumComponents;
+    uint8_t*      mData;
 
-      value_type* mComponents;
+    /*
+     * Owns storage that is not part of the vector yet. Unless released by
+     * relocate, destroys the elements constructed in [first, last) of it and
+     * frees it, which leaves the vector untouched if construction throws.
+     */
+    struct StorageGuard
+    {
+      AlignedVector const& vector;
+      uint8_t*             storage;
+      size_type            first;
+      size_type            last;
 
-      void
-      destroyMembers()
+      ~StorageGuard() noexcept
       {
-        if (mComponents != nullptr)
-#if  defined(_MSC_VER) || defined(__MINGW32__)
-          _aligned_free(mComponents);
-#else
-          free(mComponents);
-#endif
+        if(storage not_eq nullptr)
+        {
+          vector.destroy(storage, first, last);
+          vector.deallocate(storage);
+        }
       }
+    };
+
+    void
+    setLayout(size_type const alignment, ElementLayout const layout)
+    {
+      if((alignment is_eq 0) or ((alignment bitand (alignment - 1)) not_eq 0))
+        throw std::invalid_argument("The alignment of an AlignedVector has "
+                                    "to be a power of two.");
+
+      mAlignment = std::max(alignment, alignof(T));
+      mLayout    = layout;
+      mStride    = layout is_eq ElementLayout::strided
+        ? (sizeof(T) + mAlignment - 1) / mAlignment * mAlignment
+        : sizeof(T);
+    }
+
+    T*
+    address(size_type pos) const noexcept
+    { return reinterpret_cast<T*>(mData + pos * mStride); }
+
+    size_type
+    grow(size_type const minCapacity) const noexcept
+    { return std::max(minCapacity, mCapacity * 2); }
+
+    uint8_t*
+    allocate(size_type const capacity) const
+    {
+      if(capacity > max_size())
+        throw std::length_error("AlignedVector exceeds its maximum size.");
+
+      return AlignedAllocator<uint8_t>(mAlignment).allocate(capacity *
+                                                            mStride);
+    }
+
+    void
+    deallocate(uint8_t* const storage) const noexcept
+    {
+      if(storage not_eq nullptr)
+        AlignedAllocator<uint8_t>(mAlignment).deallocate(storage, 0);
+    }
+
+    /*
+     * Moves the elements into the storage of guard, which holds capacity
+     * elements, frees the old storage and releases guard. Elements are
+     * relocated back to front, so the ones constructed so far stay
+     * contiguous with an element emplaced at mSize. If copying one throws,
+     * guard unwinds them and the vector keeps its old storage; elements
+     * that are only movable, with a throwing move, are left moved-from.
+     */
+    void
+    relocate(StorageGuard& guard, size_type const capacity)
+    {
+      constExprIf<std::is_trivially_copyable<T>> // if
+      ([&]() // then
+       {
+         if(mSize not_eq 0)
+           std::memcpy(guard.storage, mData, mSize * mStride);
+       },
+       [&]() // else
+       {
+         for(size_type i(mSize); i > 0; --i)
+         {
+           ::new(static_cast<void*>(guard.storage + (i - 1) * mStride))
+             T(std::move_if_noexcept(*address(i - 1)));
+
+           guard.first = i - 1;
+         }
+
+         destroy(0, mSize);
+       }
+      );
+
+      deallocate(mData);
+
+      mData         = guard.storage;
+      mCapacity     = capacity;
+      guard.storage = nullptr;
+    }
+
+    void
+    fill(size_type const count, const_reference value)
+    {
+      for(; mSize < count; ++mSize)
+        ::new(static_cast<void*>(address(mSize))) T(value);
+    }
+
+    void
+    destroy(size_type const first, size_type const last) noexcept
+    {
+      destroy(mData, first, last);
+    }
+
+    void
+    destroy(uint8_t* const  storage,
+            size_type const first,
+            size_type const last) const noexcept
+    {
+      constExprIf<std::negation<std::is_trivially_destructible<T>>> // if
+      ([&]() // then
+       {
+         for(size_type i(first); i < last; ++i)
+           reinterpret_cast<T*>(storage + i * mStride)->~T();
+       }
+      );
+    }
+
+    void
+    destroyMembers() noexcept
+    {
+      destroy(0, mSize);
+
+      deallocate(mData);
+
+      mSize     = 0;
+      mCapacity = 0;
+      mData     = nullptr;
+    }
 };
 
 } // mem
 } // utils
 } // so
-
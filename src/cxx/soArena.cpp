@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "soArena.hpp"
+
+#include <algorithm>
+
+namespace {
+
+std::size_t
+alignUp(std::uintptr_t const value, std::size_t const alignment)
+{
+  return static_cast<std::size_t>((value + alignment - 1) &
+                                  ~std::uintptr_t{ alignment - 1 });
+}
+
+} // namespace
+
+so::utils::mem::Arena::Arena(std::size_t const blockSize)
+  : mAllocator(blockAlignment),
+    mBlocks(),
+    mBlockSize(std::max(blockSize, blockAlignment)),
+    mCurrent(0),
+    mOffset(0),
+    mUsedBefore(0),
+    mStatistics()
+{}
+
+so::utils::mem::Arena::~Arena() noexcept
+{
+  release();
+}
+
+void*
+so::utils::mem::Arena::allocate(std::size_t const size,
+                                std::size_t const alignment)
+{
+  for(; mCurrent < mBlocks.size(); ++mCurrent)
+  {
+    Block const& block{ mBlocks[mCurrent] };
+
+    auto const base{ reinterpret_cast<std::uintptr_t>(block.data) };
+
+    std::size_t const offset{ alignUp(base + mOffset, alignment) - base };
+
+    if((offset <= block.size) and (size <= block.size - offset))
+    {
+      mOffset = offset + size;
+
+      updateUsed();
+
+      return block.data + offset;
+    }
+
+    mUsedBefore += block.size;
+    mOffset      = 0;
+  }
+
+  // Blocks are aligned to blockAlignment, larger alignments need padding.
+  addBlock(size + (alignment > blockAlignment ? alignment : 0));
+
+  return allocate(size, alignment);
+}
+
+void
+so::utils::mem::Arena::rewind(Marker const& marker)
+{
+  mCurrent    = marker.block;
+  mOffset     = marker.offset;
+  mUsedBefore = marker.usedBefore;
+
+  updateUsed();
+}
+
+void
+so::utils::mem::Arena::reset()
+{
+  if(mBlocks.size() > 1)
+  {
+    std::size_t const capacity{ mStatistics.capacity };
+
+    release();
+
+    addBlock(capacity);
+  }
+
+  rewind(Marker{});
+}
+
+void
+so::utils::mem::Arena::release()
+{
+  for(Block const& block : mBlocks)
+  {
+    mAllocator.deallocate(block.data, block.size);
+  }
+
+  mBlocks.clear();
+
+  mCurrent    = 0;
+  mOffset     = 0;
+  mUsedBefore = 0;
+
+  mStatistics.used      = 0;
+  mStatistics.capacity  = 0;
+  mStatistics.numBlocks = 0;
+}
+
+void
+so::utils::mem::Arena::addBlock(std::size_t const minSize)
+{
+  // Growing by at least the capacity so far takes logarithmically many
+  // blocks to reach any size.
+  std::size_t const size{ std::max({ mBlockSize,
+                                     minSize,
+                                     mStatistics.capacity }) };
+
+  // Grows the list first, so a throwing push_back cannot leak the block.
+  mBlocks.reserve(mBlocks.size() + 1);
+
+  mBlocks.push_back({ mAllocator.allocate(size), size });
+
+  mStatistics.capacity += size;
+  ++mStatistics.numBlocks;
+  ++mStatistics.numBlockAllocations;
+}
+
+void
+so::utils::mem::Arena::updateUsed()
+{
+  mStatistics.used          = mUsedBefore + mOffset;
+  mStatistics.highWaterMark = std::max(mStatistics.highWaterMark,
+                                       mStatistics.used);
+}
+
+so::utils::mem::ArenaResource::ArenaResource(Arena& arena) noexcept
+  : mArena(&arena)
+{}
+
+void*
+so::utils::mem::ArenaResource::do_allocate(std::size_t const bytes,
+                                           std::size_t const alignment)
+{
+  return mArena->allocate(bytes, alignment);
+}
+
+void
+so::utils::mem::ArenaResource::do_deallocate(void*,
+                                             std::size_t,
+                                             std::size_t)
+{}
+
+bool
+so::utils::mem::ArenaResource::do_is_equal
+  (std::pmr::memory_resource const& other) const noexcept
+{
+  return this is_eq &other;
+}
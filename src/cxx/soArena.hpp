@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      cxx/soArena.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "soAlignedAllocator.hpp"
+#include "soDefinitions.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace so {
+namespace utils {
+namespace mem {
+
+/**
+ * @brief Usage of an Arena. used counts the bytes up to the top of the
+ *        arena, including alignment padding and the unused ends of blocks.
+ */
+struct
+ArenaStatistics
+{
+  std::size_t used{ 0 };
+  std::size_t highWaterMark{ 0 };
+  std::size_t capacity{ 0 };
+  std::size_t numBlocks{ 0 };
+
+  // Blocks requested from the system since construction.
+  std::size_t numBlockAllocations{ 0 };
+};
+
+/**
+ * @brief Bump allocator over blocks from an AlignedAllocator.
+ *
+ * Allocations move a pointer forward and are only freed all at once, by
+ * reset() or by rewinding to an earlier marker. If the current block is
+ * full, a new one at least as large as the arena so far is added, and
+ * reset() merges the blocks into a single one of their total size. After
+ * the first few rounds every round fits into one block and the arena no
+ * longer allocates from the system.
+ *
+ * An arena is not thread safe.
+ */
+class
+Arena
+{
+  public:
+    static constexpr std::size_t defaultBlockSize{ std::size_t{ 64 } << 10 };
+
+    static constexpr std::size_t blockAlignment{ 64 };
+
+    /**
+     * @brief A position in the arena to rewind to.
+     */
+    struct
+    Marker
+    {
+      std::size_t block{ 0 };
+      std::size_t offset{ 0 };
+      std::size_t usedBefore{ 0 };
+    };
+
+    explicit Arena(std::size_t const blockSize = defaultBlockSize);
+
+    Arena(Arena const& other) = delete;
+
+    Arena(Arena&& other) = delete;
+
+    ~Arena() noexcept;
+
+    Arena&
+    operator=(Arena const& other) = delete;
+
+    Arena&
+    operator=(Arena&& other) = delete;
+
+    /**
+     * @brief Returns size bytes aligned to alignment, a power of two. Throws
+     *        std::bad_alloc if no block can be allocated.
+     */
+    void*
+    allocate(std::size_t const size,
+             std::size_t const alignment = alignof(std::max_align_t));
+
+    inline Marker getMarker() const
+    { return { mCurrent, mOffset, mUsedBefore }; }
+
+    /**
+     * @brief Frees everything allocated after marker was taken.
+     */
+    void
+    rewind(Marker const& marker);
+
+    /**
+     * @brief Frees all allocations and merges the blocks into one.
+     */
+    void
+    reset();
+
+    /**
+     * @brief Frees all allocations and returns the blocks to the system.
+     */
+    void
+    release();
+
+    inline ArenaStatistics const& getStatistics() const
+    { return mStatistics; }
+
+  private:
+    struct
+    Block
+    {
+      uint8_t*    data;
+      std::size_t size;
+    };
+
+    AlignedAllocator<uint8_t> mAllocator;
+
+    std::vector<Block>        mBlocks;
+
+    std::size_t               mBlockSize;
+    std::size_t               mCurrent;
+    std::size_t               mOffset;
+
+    // Sizes of the blocks before mCurrent.
+    std::size_t               mUsedBefore;
+
+    ArenaStatistics           mStatistics;
+
+    void
+    addBlock(std::size_t const minSize);
+
+    void
+    updateUsed();
+};
+
+/**
+ * @brief Lets std::pmr containers allocate from an Arena. Deallocation is a
+ *        no-op, the memory returns with the arena's reset or rewind, so
+ *        containers using it must not outlive those.
+ */
+class
+ArenaResource : public std::pmr::memory_resource
+{
+  public:
+    explicit ArenaResource(Arena& arena) noexcept;
+
+    inline Arena& getArena() const { return *mArena; }
+
+  private:
+    Arena* mArena;
+
+    void*
+    do_allocate(std::size_t bytes, std::size_t alignment) override;
+
+    void
+    do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+
+    bool
+    do_is_equal(std::pmr::memory_resource const& other) const
+      noexcept override;
+};
+
+} // namespace mem
+} // namespace utils
+} // namespace so
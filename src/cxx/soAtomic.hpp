@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      cxx/soAtomic.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+
+#if defined(__SANITIZE_THREAD__)
+#define SO_THREAD_SANITIZER 1
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define SO_THREAD_SANITIZER 1
+#endif
+#endif
+
+namespace so {
+
+/**
+ * @brief Order of an atomic operation that a threadFence orders.
+ *
+ * ThreadSanitizer does not model fences. Under it threadFence does nothing
+ * and these operations are seq_cst, which orders at least as strongly, so
+ * it sees the synchronization the fences provide otherwise.
+ */
+constexpr std::memory_order
+fencedOrder(std::memory_order const order)
+{
+#ifdef SO_THREAD_SANITIZER
+  (void) order;
+
+  return std::memory_order_seq_cst;
+#else
+  return order;
+#endif
+}
+
+inline void
+threadFence(std::memory_order const order) noexcept
+{
+#ifdef SO_THREAD_SANITIZER
+  (void) order;
+#else
+  std::atomic_thread_fence(order);
+#endif
+}
+
+} // namespace so
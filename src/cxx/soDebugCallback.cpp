@@ -22,38 +22,365 @@
 
 #include "soDebugCallback.hpp"
 
-namespace so {
+#include "soAtomic.hpp"
+#include "soProfiler.hpp"
 
-static so::DebugCallback*
-getDebugCallbackInstance()
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+using so::size_type;
+
+// Constant initialized, so it can be read during static destruction.
+std::atomic<so::DebugCallback> debugCallback{ nullptr };
+std::atomic<so::DebugLevel>    debugLevel{ so::DebugLevel::verbose };
+
+/*
+ * A queued message. Short messages are copied inline, longer ones are kept
+ * as a string; the function signature and the file are formatted by the
+ * logging thread.
+ */
+struct
+DebugMessage
+{
+  static constexpr size_type inlineSize{ 128 };
+
+  so::DebugCode                code{ so::DebugCode::info };
+  so::index_t                  line{ 0 };
+  char const*                  file{ nullptr };
+  so::DebugFunctionSig         funcSig{ nullptr, nullptr };
+  std::array<char, inlineSize> shortText{};
+  size_type                    shortLength{ 0 };
+  std::string                  text;
+  bool                         isShort{ true };
+}; // struct DebugMessage
+
+/*
+ * The queue is the bounded MPMC queue of Dmitry Vyukov, with a single
+ * consumer: producers claim a slot with a CAS on the enqueue position and
+ * publish it through the slot's sequence number, so pushing takes no lock.
+ */
+class
+DebugLogger
 {
-  static DebugCallback debugCallback
+  public:
+    static constexpr size_type capacity{ 1024 };
+
+    DebugLogger()
+      : mSlots(new Slot[capacity]),
+        mEnqueuePos(0),
+        mDequeuePos(0),
+        mNumDropped(0),
+        mMutex(),
+        mWakeUp(),
+        mFlushed(),
+        mIsSleeping(false),
+        mNumWakeUps(0),
+        mNumProcessed(0),
+        mStop(false),
+        mThread()
     {
-      [](DebugCode   const  code,
-         std::string const& message,
-         std::string const& funcSig,
-         index_t     const  line,
-         std::string const& file)     
+      for(size_type i{ 0 }; i < capacity; ++i)
       {
-        (void) code;
-        (void) message;
-        (void) funcSig;
-        (void) line;
-        (void) file;
+        mSlots[i].sequence.store(i, std::memory_order_relaxed);
       }
-    };
+    }
+
+    DebugLogger(DebugLogger const& other) = delete;
+
+    DebugLogger(DebugLogger&& other) = delete;
+
+    ~DebugLogger() noexcept
+    {
+      // Messages pushed from here on, e.g. by static destructors, are
+      // dropped without touching the logger.
+      debugLevel = so::DebugLevel::none;
+
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mStop = true;
+
+        ++mNumWakeUps;
+      }
+
+      mWakeUp.notify_one();
+
+      if(mThread.joinable())
+      {
+        mThread.join();
+      }
+    }
+
+    DebugLogger&
+    operator=(DebugLogger const& other) = delete;
+
+    DebugLogger&
+    operator=(DebugLogger&& other) = delete;
+
+    void
+    start()
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+
+      if(not mThread.joinable())
+      {
+        mThread = std::thread(&DebugLogger::run, this);
+      }
+    }
+
+    void
+    push(DebugMessage& message) noexcept
+    {
+      size_type position{ mEnqueuePos.load(std::memory_order_relaxed) };
+
+      Slot* slot;
+
+      for(;;)
+      {
+        slot = &mSlots[position % capacity];
+
+        size_type const sequence
+          { slot->sequence.load(std::memory_order_acquire) };
+
+        auto const difference{ static_cast<std::ptrdiff_t>(sequence) -
+                               static_cast<std::ptrdiff_t>(position) };
+
+        if(difference is_eq 0)
+        {
+          if(mEnqueuePos.compare_exchange_weak(position,
+                                               position + 1,
+                                               std::memory_order_relaxed))
+          {
+            break;
+          }
+        }
+        else if(difference < 0)
+        {
+          ++mNumDropped;
+
+          return;
+        }
+        else
+        {
+          position = mEnqueuePos.load(std::memory_order_relaxed);
+        }
+      }
+
+      slot->message = std::move(message);
+
+      slot->sequence.store(position + 1,
+                           so::fencedOrder(std::memory_order_release));
+
+      // Pairs with the fence in run: either the logging thread going to
+      // sleep sees the message, or this sees it sleeping.
+      so::threadFence(std::memory_order_seq_cst);
+
+      if(mIsSleeping.load())
+      {
+        {
+          std::lock_guard<std::mutex> lock(mMutex);
+
+          ++mNumWakeUps;
+        }
+
+        mWakeUp.notify_one();
+      }
+    }
+
+    void
+    flush()
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+
+      if(not mThread.joinable())
+      {
+        return;
+      }
+
+      size_type const target{ mEnqueuePos.load() };
+
+      ++mNumWakeUps;
+
+      mWakeUp.notify_one();
+
+      mFlushed.wait(lock, [this, target] { return mNumProcessed >= target; });
+    }
+
+  private:
+    struct
+    Slot
+    {
+      std::atomic<size_type> sequence;
+      DebugMessage           message;
+    }; // struct Slot
+
+    std::unique_ptr<Slot[]> mSlots;
+
+    alignas(64) std::atomic<size_type> mEnqueuePos;
+
+    // Only touched by the logging thread.
+    alignas(64) size_type              mDequeuePos;
+
+    std::atomic<size_type>             mNumDropped;
+
+    std::mutex                         mMutex;
+    std::condition_variable            mWakeUp;
+    std::condition_variable            mFlushed;
+    std::atomic<bool>                  mIsSleeping;
+    uint64_t                           mNumWakeUps;
+    size_type                          mNumProcessed;
+    bool                               mStop;
+
+    std::thread                        mThread;
+
+    bool
+    pop(DebugMessage& message)
+    {
+      Slot& slot{ mSlots[mDequeuePos % capacity] };
 
-  return &debugCallback;
+      if(slot.sequence.load(std::memory_order_acquire) not_eq mDequeuePos + 1)
+      {
+        return false;
+      }
+
+      message = std::move(slot.message);
+
+      slot.sequence.store(mDequeuePos + capacity, std::memory_order_release);
+
+      ++mDequeuePos;
+
+      return true;
+    }
+
+    bool
+    isEmpty() const
+    {
+      return mSlots[mDequeuePos % capacity].sequence.load() not_eq
+             mDequeuePos + 1;
+    }
+
+    void
+    run()
+    {
+      so::setProfileThreadName("Debug messages");
+
+      DebugMessage message;
+
+      for(;;)
+      {
+        while(pop(message))
+        {
+          deliver(message);
+        }
+
+        size_type const numDropped{ mNumDropped.exchange(0) };
+
+        if(numDropped > 0)
+        {
+          so::executeDebugCallback(so::DebugCode::error,
+                                   "Dropped " + std::to_string(numDropped) +
+                                   " messages, the queue was full.",
+                                   PRETTY_FUNCTION_SIG,
+                                   __LINE__,
+                                   __FILE__);
+        }
+
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        mNumProcessed = mDequeuePos;
+
+        mFlushed.notify_all();
+
+        mIsSleeping = true;
+
+        so::threadFence(std::memory_order_seq_cst);
+
+        if(isEmpty())
+        {
+          if(mStop)
+          {
+            return;
+          }
+
+          uint64_t const numWakeUps{ mNumWakeUps };
+
+          mWakeUp.wait(lock, [this, numWakeUps]
+                             { return mNumWakeUps not_eq numWakeUps; });
+        }
+
+        mIsSleeping = false;
+      }
+    }
+
+    static void
+    deliver(DebugMessage& message)
+    {
+      std::string const text
+        { message.isShort ? std::string(message.shortText.data(),
+                                        message.shortLength)
+                          : std::move(message.text) };
+
+      std::string const funcSig
+        { message.funcSig.signature not_eq nullptr
+            ? std::string(message.funcSig.signature)
+            : message.funcSig.getSignature() };
+
+      so::executeDebugCallback(message.code,
+                               text,
+                               funcSig,
+                               message.line,
+                               message.file);
+
+      message.text.clear();
+    }
+};
+
+DebugLogger&
+getDebugLogger()
+{
+  static DebugLogger logger;
+
+  return logger;
+}
+
+void
+queueDebugMessage(DebugMessage& message) noexcept
+{
+  getDebugLogger().push(message);
 }
 
-} // namespace so
+} // namespace
 
 void
 so::setDebugCallback(DebugCallback callback)
 {
-  auto debugCallback{ getDebugCallbackInstance() };
+  if(callback not_eq nullptr)
+  {
+    getDebugLogger().start();
+  }
 
-  *debugCallback = callback;
+  debugCallback = callback;
+}
+
+void
+so::setDebugLevel(DebugLevel const level)
+{
+  debugLevel = level;
+}
+
+bool
+so::isDebugCodeEnabled(DebugCode const code) noexcept
+{
+  return debugCallback.load(std::memory_order_relaxed) not_eq nullptr and
+         getDebugLevel(code) >= debugLevel.load(std::memory_order_relaxed);
 }
 
 void
@@ -63,6 +390,81 @@ so::executeDebugCallback(DebugCode   const  code,
                          index_t     const  line,
                          std::string const& file)
 {
-  (*getDebugCallbackInstance())(code, message, funcSig, line, file);
+  DebugCallback const callback{ debugCallback.load() };
+
+  if(callback not_eq nullptr)
+  {
+    callback(code, message, funcSig, line, file);
+  }
+}
+
+void
+so::pushDebugMessage(DebugCode        const  code,
+                     char             const* message,
+                     DebugFunctionSig const  funcSig,
+                     index_t          const  line,
+                     char             const* file)
+{
+  size_type const length{ std::strlen(message) };
+
+  if(length > DebugMessage::inlineSize)
+  {
+    pushDebugMessage(code, std::string(message, length), funcSig, line, file);
+
+    return;
+  }
+
+  DebugMessage queued;
+
+  queued.code        = code;
+  queued.line        = line;
+  queued.file        = file;
+  queued.funcSig     = funcSig;
+  queued.shortLength = length;
+
+  std::copy_n(message, length, queued.shortText.data());
+
+  queueDebugMessage(queued);
+}
+
+void
+so::pushDebugMessage(DebugCode        const  code,
+                     std::string&&           message,
+                     DebugFunctionSig const  funcSig,
+                     index_t          const  line,
+                     char             const* file)
+{
+  DebugMessage queued;
+
+  queued.code    = code;
+  queued.line    = line;
+  queued.file    = file;
+  queued.funcSig = funcSig;
+  queued.text    = std::move(message);
+  queued.isShort = false;
+
+  queueDebugMessage(queued);
+}
+
+void
+so::pushDebugMessage(DebugCode        const  code,
+                     std::string      const& message,
+                     DebugFunctionSig const  funcSig,
+                     index_t          const  line,
+                     char             const* file)
+{
+  if(message.size() <= DebugMessage::inlineSize)
+  {
+    pushDebugMessage(code, message.c_str(), funcSig, line, file);
+  }
+  else
+  {
+    pushDebugMessage(code, std::string(message), funcSig, line, file);
+  }
 }
 
+void
+so::flushDebugMessages()
+{
+  getDebugLogger().flush();
+}
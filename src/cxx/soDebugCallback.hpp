@@ -55,6 +55,15 @@
 #include "soPrettyFunctionSig.hpp"
 #include "soReturnT.hpp"
 
+#include <string>
+
+/**
+ * Messages below this DebugLevel are compiled out, arguments included.
+ */
+#ifndef SO_DEBUG_LEVEL
+#define SO_DEBUG_LEVEL 0
+#endif
+
 namespace so {
 
 enum class
@@ -66,15 +75,73 @@ DebugCode
   error
 };
 
+/**
+ * @brief Severities to filter DebugCodes by, from the lowest to the highest.
+ */
+enum class
+DebugLevel
+{
+  verbose,
+  info,
+  error,
+  none
+};
+
 typedef void (*DebugCallback) (DebugCode   const,
                                std::string const&,
                                std::string const&,
                                index_t     const,
                                std::string const&);
 
+/**
+ * @brief Function signature of a message. Either signature points to a
+ *        string with static storage, or getSignature produces it, which is
+ *        deferred to the logging thread.
+ */
+struct
+DebugFunctionSig
+{
+  char const*   signature;
+  std::string (*getSignature)();
+};
+
+constexpr DebugLevel
+getDebugLevel(DebugCode const code)
+{
+  return code is_eq DebugCode::error   ? DebugLevel::error
+       : code is_eq DebugCode::verbose ? DebugLevel::verbose
+                                       : DebugLevel::info;
+}
+
+constexpr bool
+isDebugCodeCompiled(DebugCode const code)
+{
+  return static_cast<int>(getDebugLevel(code)) >= SO_DEBUG_LEVEL;
+}
+
+/**
+ * @brief Installs the callback messages are delivered to, on a thread of its
+ *        own, which is started with the first callback. nullptr drops all
+ *        messages, which is the default.
+ */
 void
 setDebugCallback(DebugCallback callback);
 
+/**
+ * @brief Drops messages below level, DebugLevel::verbose by default.
+ */
+void
+setDebugLevel(DebugLevel const level);
+
+/**
+ * @brief True if a callback is installed and code passes the runtime level.
+ */
+bool
+isDebugCodeEnabled(DebugCode const code) noexcept;
+
+/**
+ * @brief Calls the callback on the calling thread.
+ */
 void
 executeDebugCallback(DebugCode   const  code,
                      std::string const& message,
@@ -82,31 +149,82 @@ executeDebugCallback(DebugCode   const  code,
                      index_t     const  line,
                      std::string const& file);
 
+/**
+ * @brief Queues a message for the logging thread, which calls the callback.
+ *        Never blocks: if the queue is full the message is dropped and
+ *        counted. file has to have static storage.
+ *
+ * The message text is built by the caller, e.g. by concatenation at the
+ * DEBUG_CALLBACK site, once the message passed both level filters; only
+ * the function signature is produced on the logging thread. Texts of up to
+ * 128 bytes are copied into the queue slot, longer ones are kept as a
+ * string.
+ */
+void
+pushDebugMessage(DebugCode        const  code,
+                 char             const* message,
+                 DebugFunctionSig const  funcSig,
+                 index_t          const  line,
+                 char             const* file);
+
+void
+pushDebugMessage(DebugCode        const  code,
+                 std::string&&           message,
+                 DebugFunctionSig const  funcSig,
+                 index_t          const  line,
+                 char             const* file);
+
+void
+pushDebugMessage(DebugCode        const  code,
+                 std::string      const& message,
+                 DebugFunctionSig const  funcSig,
+                 index_t          const  line,
+                 char             const* file);
+
+/**
+ * @brief Waits until the callback has seen all messages queued so far, e.g.
+ *        before aborting. Messages still queued at exit are flushed
+ *        automatically. Must not be called from the callback.
+ */
+void
+flushDebugMessages();
+
 } // namespace so
 
 #define DEBUG_CALLBACK(...) MACRO_DISPATCHER(DEBUG_CALLBACK, __VA_ARGS__)
 
-#define DEBUG_CALLBACK2(code, message)          \
-  so::executeDebugCallback(code,                \
-                           message,             \
-                           PRETTY_FUNCTION_SIG, \
-                           __LINE__,            \
-                           __FILE__)
-
-#define DEBUG_CALLBACK3(code, message, function)                        \
-  so::executeDebugCallback(code,                                        \
-                           message,                                     \
-                           getPrettyFunctionSig<decltype(&function)>(), \
-                           __LINE__,                                    \
-                           __FILE__)
-
-#define DEBUG_CALLBACK4(code, message, trgClass, function)  \
-  so::executeDebugCallback                               \
-    (code,                                               \
-     message,                                            \
-     getPrettyFunctionSig<decltype(trgClass::*function)>(), \
-     __LINE__,                                           \
-     __FILE__)
+// The arguments are only evaluated if code is compiled and enabled.
+#define SO_PUSH_DEBUG_MESSAGE(code, message, funcSig)                   \
+  do                                                                    \
+  {                                                                     \
+    if(so::isDebugCodeCompiled(code) and so::isDebugCodeEnabled(code))  \
+    {                                                                   \
+      so::pushDebugMessage(code, message, funcSig, __LINE__, __FILE__); \
+    }                                                                   \
+  }                                                                     \
+  while(false)
+
+#define DEBUG_CALLBACK2(code, message)                                 \
+  SO_PUSH_DEBUG_MESSAGE(code,                                          \
+                        message,                                       \
+                        (so::DebugFunctionSig{ PRETTY_FUNCTION_SIG,    \
+                                               nullptr }))
+
+#define DEBUG_CALLBACK3(code, message, function)                       \
+  SO_PUSH_DEBUG_MESSAGE                                                \
+    (code,                                                             \
+     message,                                                          \
+     (so::DebugFunctionSig                                             \
+        { nullptr,                                                     \
+          &so::getPrettyFunctionSig<decltype(&function)> }))
+
+#define DEBUG_CALLBACK4(code, message, trgClass, function)             \
+  SO_PUSH_DEBUG_MESSAGE                                                \
+    (code,                                                             \
+     message,                                                          \
+     (so::DebugFunctionSig                                             \
+        { nullptr,                                                     \
+          &so::getPrettyFunctionSig<decltype(trgClass::*function)> }))
 
 constexpr so::DebugCode info     = so::DebugCode::info;
 
@@ -115,4 +233,3 @@ constexpr so::DebugCode infoItem = so::DebugCode::infoItem;
 constexpr so::DebugCode verbose  = so::DebugCode::verbose;
 
 constexpr so::DebugCode error    = so::DebugCode::error;
-
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "soFrameAllocator.hpp"
+
+#include <algorithm>
+
+so::utils::mem::FrameAllocator::FrameAllocator()
+  : mFrames(),
+    mFrame(0)
+{
+  initialize(1);
+}
+
+void
+so::utils::mem::FrameAllocator::initialize(size_type   const numFramesInFlight,
+                                           std::size_t const blockSize)
+{
+  mFrames.clear();
+
+  for(size_type i{ 0 }; i < std::max(numFramesInFlight, size_type{ 1 }); ++i)
+  {
+    mFrames.push_back(std::make_unique<Frame>(blockSize));
+  }
+
+  mFrame = 0;
+}
+
+void
+so::utils::mem::FrameAllocator::beginFrame(index_t const frame)
+{
+  mFrame = static_cast<size_type>(frame) % mFrames.size();
+
+  mFrames[mFrame]->arena.reset();
+}
+
+std::size_t
+so::utils::mem::FrameAllocator::getHighWaterMark() const
+{
+  std::size_t highWaterMark{ 0 };
+
+  for(auto const& frame : mFrames)
+  {
+    highWaterMark = std::max(highWaterMark,
+                             frame->arena.getStatistics().highWaterMark);
+  }
+
+  return highWaterMark;
+}
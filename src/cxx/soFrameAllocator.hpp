@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      cxx/soFrameAllocator.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "soArena.hpp"
+#include "soDefinitions.hpp"
+
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace so {
+namespace utils {
+namespace mem {
+
+/**
+ * @brief Linear allocator for data that lives for one frame.
+ *
+ * Every frame in flight has its own Arena. beginFrame resets the arena of the
+ * frame, which must happen after the fence of that frame's previous use has
+ * been waited for, so allocations stay valid until the frame slot comes
+ * around again. Not thread safe; meant for the thread recording frames.
+ */
+class
+FrameAllocator
+{
+  public:
+    FrameAllocator();
+
+    FrameAllocator(FrameAllocator const& other) = delete;
+
+    FrameAllocator(FrameAllocator&& other) = delete;
+
+    ~FrameAllocator() noexcept = default;
+
+    FrameAllocator&
+    operator=(FrameAllocator const& other) = delete;
+
+    FrameAllocator&
+    operator=(FrameAllocator&& other) = delete;
+
+    void
+    initialize(size_type   const numFramesInFlight,
+               std::size_t const blockSize = Arena::defaultBlockSize);
+
+    /**
+     * @brief Makes frame the current frame and frees its old allocations.
+     */
+    void
+    beginFrame(index_t const frame);
+
+    inline void*
+    allocate(std::size_t const size,
+             std::size_t const alignment = alignof(std::max_align_t))
+    { return mFrames[mFrame]->arena.allocate(size, alignment); }
+
+    /**
+     * @brief Resource for std::pmr containers of the current frame.
+     */
+    inline std::pmr::memory_resource* getResource()
+    { return &mFrames[mFrame]->resource; }
+
+    inline ArenaStatistics const& getStatistics(index_t const frame) const
+    { return mFrames[static_cast<size_type>(frame)]->arena.getStatistics(); }
+
+    /**
+     * @brief Largest high-water mark of all frames.
+     */
+    std::size_t
+    getHighWaterMark() const;
+
+    inline size_type getNumFrames() const { return mFrames.size(); }
+
+  private:
+    struct
+    Frame
+    {
+      explicit Frame(std::size_t const blockSize)
+        : arena(blockSize), resource(arena)
+      {}
+
+      Arena         arena;
+      ArenaResource resource;
+    };
+
+    std::vector<std::unique_ptr<Frame>> mFrames;
+
+    size_type                           mFrame;
+};
+
+} // namespace mem
+} // namespace utils
+} // namespace so
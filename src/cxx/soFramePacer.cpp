@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "soFramePacer.hpp"
+
+#include "soDefinitions.hpp"
+
+#include <thread>
+
+so::FramePacer::FramePacer()
+  : FramePacer(0.0)
+{}
+
+so::FramePacer::FramePacer(double const targetFrameRate)
+  : mTargetFrameRate(targetFrameRate),
+    mSpinThreshold(2.0),
+    mNextDeadline()
+{}
+
+void
+so::FramePacer::setTargetFrameRate(double const targetFrameRate)
+{
+  mTargetFrameRate = targetFrameRate;
+  mNextDeadline    = clock::time_point{};
+}
+
+so::FramePacer::duration
+so::FramePacer::wait()
+{
+  if(mTargetFrameRate <= 0.0)
+  {
+    return duration{ 0.0 };
+  }
+
+  clock::time_point const start{ clock::now() };
+
+  auto const period
+    { std::chrono::duration_cast<clock::duration>
+        (std::chrono::duration<double>(1.0 / mTargetFrameRate)) };
+
+  // Don't try to catch up on frames we already missed, otherwise a single
+  // hitch is followed by a burst of unpaced frames.
+  if((mNextDeadline is_eq clock::time_point{}) or (mNextDeadline < start))
+  {
+    mNextDeadline = start;
+  }
+
+  clock::time_point const deadline{ mNextDeadline };
+
+  auto const spinThreshold
+    { std::chrono::duration_cast<clock::duration>(mSpinThreshold) };
+
+  if(deadline - start > spinThreshold)
+  {
+    std::this_thread::sleep_until(deadline - spinThreshold);
+  }
+
+  while(clock::now() < deadline)
+  {
+    std::this_thread::yield();
+  }
+
+  mNextDeadline = deadline + period;
+
+  return clock::now() - start;
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      cxx/soFramePacer.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <chrono>
+
+namespace so {
+
+/**
+ * @brief Paces a render loop to a target frame rate.
+ *
+ * FramePacer::wait blocks until the next frame deadline. It sleeps for the
+ * bulk of the remaining time and spins for the last spinThreshold, since OS
+ * sleeps routinely overshoot by a scheduler quantum. A target frame rate of 0
+ * disables pacing.
+ */
+class
+FramePacer
+{
+  public:
+    using clock    = std::chrono::steady_clock;
+    using duration = std::chrono::duration<double, std::milli>;
+
+    FramePacer();
+
+    explicit FramePacer(double const targetFrameRate);
+
+    void
+    setTargetFrameRate(double const targetFrameRate);
+
+    inline double getTargetFrameRate() const { return mTargetFrameRate; }
+
+    /**
+     * @brief Sets the time before a deadline after which wait() spins instead
+     *        of sleeping.
+     */
+    inline void
+    setSpinThreshold(duration const spinThreshold)
+    { mSpinThreshold = spinThreshold; }
+
+    inline duration getSpinThreshold() const { return mSpinThreshold; }
+
+    /**
+     * @brief Blocks until the next frame deadline.
+     *
+     * @return The time spent waiting.
+     */
+    duration
+    wait();
+
+  private:
+    double            mTargetFrameRate;
+
+    duration          mSpinThreshold;
+
+    clock::time_point mNextDeadline;
+}; // class FramePacer
+
+} // namespace so
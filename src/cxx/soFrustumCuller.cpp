@@ -0,0 +1,756 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "soFrustumCuller.hpp"
+
+#include "soJobSystem.hpp"
+#include "soProfiler.hpp"
+
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <functional>
+
+#if defined(__x86_64__) or defined(_M_X64)
+#define SO_FRUSTUM_CULLER_X86
+#include <immintrin.h>
+#endif
+
+// Lets a kernel use a wider instruction set than the rest of the library is
+// built for. MSVC allows intrinsics of any instruction set without it.
+#if defined(__GNUC__)
+#define SO_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SO_TARGET(isa)
+#endif
+
+namespace {
+
+using so::size_type;
+
+using Stream = so::FrustumCuller::Stream;
+
+constexpr size_type blockSize{ so::FrustumCuller::blockSize };
+
+constexpr size_type cacheLineSize{ 64 };
+
+// Jobs cull whole chunks of a cache line worth of masks, so neighbouring
+// jobs write at most one line in common.
+
+constexpr size_type blocksPerChunk{ cacheLineSize / sizeof(uint16_t) };
+
+struct
+KernelArgs
+{
+  float const*                        volumes;
+  size_type                           streamLength;
+  so::FrustumCuller::Planes           planes;
+  std::array<std::array<float, 3>, 6> absNormals;
+  uint16_t*                           masks;
+  size_type                           firstBlock;
+  size_type                           lastBlock;
+}; // struct KernelArgs
+
+using Kernel = void (*)(KernelArgs const& args);
+
+inline float const*
+getStream(KernelArgs const& args, Stream const stream)
+{
+  return args.volumes + static_cast<size_type>(stream) * args.streamLength;
+}
+
+/*
+ * All kernels evaluate a plane as ((a * x + b * y) + c * z) + d and a box's
+ * reach as (|a| * ex + |b| * ey) + |c| * ez, without fused multiply-adds, so
+ * every level culls exactly the same objects.
+ */
+
+template <bool testSpheres, bool testBoxes>
+void
+cullScalar(KernelArgs const& args)
+{
+  float const* const sx{ getStream(args, Stream::sphereX) };
+  float const* const sy{ getStream(args, Stream::sphereY) };
+  float const* const sz{ getStream(args, Stream::sphereZ) };
+  float const* const sr{ getStream(args, Stream::sphereRadius) };
+  float const* const bx{ getStream(args, Stream::boxX) };
+  float const* const by{ getStream(args, Stream::boxY) };
+  float const* const bz{ getStream(args, Stream::boxZ) };
+  float const* const ex{ getStream(args, Stream::boxExtentX) };
+  float const* const ey{ getStream(args, Stream::boxExtentY) };
+  float const* const ez{ getStream(args, Stream::boxExtentZ) };
+
+  for(size_type block{ args.firstBlock }; block < args.lastBlock; ++block)
+  {
+    uint32_t mask{ 0 };
+
+    for(size_type lane{ 0 }; lane < blockSize; ++lane)
+    {
+      size_type const i{ block * blockSize + lane };
+
+      bool visible{ true };
+
+      for(size_type p{ 0 }; p < 6 and visible; ++p)
+      {
+        auto const& plane{ args.planes[p] };
+
+        if(testSpheres)
+        {
+          float const distance{ ((plane[0] * sx[i] + plane[1] * sy[i]) +
+                                 plane[2] * sz[i]) + plane[3] };
+
+          visible = distance >= -sr[i];
+        }
+
+        if(testBoxes and visible)
+        {
+          auto const& absNormal{ args.absNormals[p] };
+
+          float const distance{ ((plane[0] * bx[i] + plane[1] * by[i]) +
+                                 plane[2] * bz[i]) + plane[3] };
+
+          float const reach{ (absNormal[0] * ex[i] + absNormal[1] * ey[i]) +
+                             absNormal[2] * ez[i] };
+
+          visible = distance + reach >= 0.0f;
+        }
+      }
+
+      mask |= static_cast<uint32_t>(visible) << lane;
+    }
+
+    args.masks[block] = static_cast<uint16_t>(mask);
+  }
+}
+
+#if defined(SO_FRUSTUM_CULLER_X86)
+
+template <bool testSpheres, bool testBoxes>
+void
+cullSse(KernelArgs const& args)
+{
+  float const* const sx{ getStream(args, Stream::sphereX) };
+  float const* const sy{ getStream(args, Stream::sphereY) };
+  float const* const sz{ getStream(args, Stream::sphereZ) };
+  float const* const sr{ getStream(args, Stream::sphereRadius) };
+  float const* const bx{ getStream(args, Stream::boxX) };
+  float const* const by{ getStream(args, Stream::boxY) };
+  float const* const bz{ getStream(args, Stream::boxZ) };
+  float const* const ex{ getStream(args, Stream::boxExtentX) };
+  float const* const ey{ getStream(args, Stream::boxExtentY) };
+  float const* const ez{ getStream(args, Stream::boxExtentZ) };
+
+  __m128 a[6], b[6], c[6], d[6], absA[6], absB[6], absC[6];
+
+  for(size_type p{ 0 }; p < 6; ++p)
+  {
+    a[p]    = _mm_set1_ps(args.planes[p][0]);
+    b[p]    = _mm_set1_ps(args.planes[p][1]);
+    c[p]    = _mm_set1_ps(args.planes[p][2]);
+    d[p]    = _mm_set1_ps(args.planes[p][3]);
+    absA[p] = _mm_set1_ps(args.absNormals[p][0]);
+    absB[p] = _mm_set1_ps(args.absNormals[p][1]);
+    absC[p] = _mm_set1_ps(args.absNormals[p][2]);
+  }
+
+  __m128 const zero{ _mm_setzero_ps() };
+
+  for(size_type block{ args.firstBlock }; block < args.lastBlock; ++block)
+  {
+    uint32_t mask{ 0 };
+
+    for(size_type lane{ 0 }; lane < blockSize; lane += 4)
+    {
+      size_type const i{ block * blockSize + lane };
+
+      __m128 visible{ _mm_cmpeq_ps(zero, zero) };
+
+      if(testSpheres)
+      {
+        __m128 const x{ _mm_load_ps(sx + i) };
+        __m128 const y{ _mm_load_ps(sy + i) };
+        __m128 const z{ _mm_load_ps(sz + i) };
+        __m128 const negR{ _mm_sub_ps(zero, _mm_load_ps(sr + i)) };
+
+        for(size_type p{ 0 }; p < 6; ++p)
+        {
+          __m128 const distance
+            { _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(a[p], x),
+                                               _mm_mul_ps(b[p], y)),
+                                    _mm_mul_ps(c[p], z)),
+                         d[p]) };
+
+          visible = _mm_and_ps(visible, _mm_cmpge_ps(distance, negR));
+        }
+      }
+
+      if(testBoxes)
+      {
+        __m128 const x{ _mm_load_ps(bx + i) };
+        __m128 const y{ _mm_load_ps(by + i) };
+        __m128 const z{ _mm_load_ps(bz + i) };
+        __m128 const extentX{ _mm_load_ps(ex + i) };
+        __m128 const extentY{ _mm_load_ps(ey + i) };
+        __m128 const extentZ{ _mm_load_ps(ez + i) };
+
+        for(size_type p{ 0 }; p < 6; ++p)
+        {
+          __m128 const distance
+            { _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(a[p], x),
+                                               _mm_mul_ps(b[p], y)),
+                                    _mm_mul_ps(c[p], z)),
+                         d[p]) };
+
+          __m128 const reach
+            { _mm_add_ps(_mm_add_ps(_mm_mul_ps(absA[p], extentX),
+                                    _mm_mul_ps(absB[p], extentY)),
+                         _mm_mul_ps(absC[p], extentZ)) };
+
+          visible = _mm_and_ps(visible,
+                               _mm_cmpge_ps(_mm_add_ps(distance, reach),
+                                            zero));
+        }
+      }
+
+      mask |= static_cast<uint32_t>(_mm_movemask_ps(visible)) << lane;
+    }
+
+    args.masks[block] = static_cast<uint16_t>(mask);
+  }
+}
+
+template <bool testSpheres, bool testBoxes>
+SO_TARGET("avx2") void
+cullAvx2(KernelArgs const& args)
+{
+  float const* const sx{ getStream(args, Stream::sphereX) };
+  float const* const sy{ getStream(args, Stream::sphereY) };
+  float const* const sz{ getStream(args, Stream::sphereZ) };
+  float const* const sr{ getStream(args, Stream::sphereRadius) };
+  float const* const bx{ getStream(args, Stream::boxX) };
+  float const* const by{ getStream(args, Stream::boxY) };
+  float const* const bz{ getStream(args, Stream::boxZ) };
+  float const* const ex{ getStream(args, Stream::boxExtentX) };
+  float const* const ey{ getStream(args, Stream::boxExtentY) };
+  float const* const ez{ getStream(args, Stream::boxExtentZ) };
+
+  __m256 a[6], b[6], c[6], d[6], absA[6], absB[6], absC[6];
+
+  for(size_type p{ 0 }; p < 6; ++p)
+  {
+    a[p]    = _mm256_set1_ps(args.planes[p][0]);
+    b[p]    = _mm256_set1_ps(args.planes[p][1]);
+    c[p]    = _mm256_set1_ps(args.planes[p][2]);
+    d[p]    = _mm256_set1_ps(args.planes[p][3]);
+    absA[p] = _mm256_set1_ps(args.absNormals[p][0]);
+    absB[p] = _mm256_set1_ps(args.absNormals[p][1]);
+    absC[p] = _mm256_set1_ps(args.absNormals[p][2]);
+  }
+
+  __m256 const zero{ _mm256_setzero_ps() };
+
+  for(size_type block{ args.firstBlock }; block < args.lastBlock; ++block)
+  {
+    uint32_t mask{ 0 };
+
+    for(size_type lane{ 0 }; lane < blockSize; lane += 8)
+    {
+      size_type const i{ block * blockSize + lane };
+
+      __m256 visible{ _mm256_cmp_ps(zero, zero, _CMP_EQ_OQ) };
+
+      if(testSpheres)
+      {
+        __m256 const x{ _mm256_load_ps(sx + i) };
+        __m256 const y{ _mm256_load_ps(sy + i) };
+        __m256 const z{ _mm256_load_ps(sz + i) };
+        __m256 const negR{ _mm256_sub_ps(zero, _mm256_load_ps(sr + i)) };
+
+        for(size_type p{ 0 }; p < 6; ++p)
+        {
+          __m256 const distance
+            { _mm256_add_ps(_mm256_add_ps(_mm256_add_ps
+                                            (_mm256_mul_ps(a[p], x),
+                                             _mm256_mul_ps(b[p], y)),
+                                          _mm256_mul_ps(c[p], z)),
+                            d[p]) };
+
+          visible = _mm256_and_ps(visible,
+                                  _mm256_cmp_ps(distance, negR, _CMP_GE_OQ));
+        }
+      }
+
+      if(testBoxes)
+      {
+        __m256 const x{ _mm256_load_ps(bx + i) };
+        __m256 const y{ _mm256_load_ps(by + i) };
+        __m256 const z{ _mm256_load_ps(bz + i) };
+        __m256 const extentX{ _mm256_load_ps(ex + i) };
+        __m256 const extentY{ _mm256_load_ps(ey + i) };
+        __m256 const extentZ{ _mm256_load_ps(ez + i) };
+
+        for(size_type p{ 0 }; p < 6; ++p)
+        {
+          __m256 const distance
+            { _mm256_add_ps(_mm256_add_ps(_mm256_add_ps
+                                            (_mm256_mul_ps(a[p], x),
+                                             _mm256_mul_ps(b[p], y)),
+                                          _mm256_mul_ps(c[p], z)),
+                            d[p]) };
+
+          __m256 const reach
+            { _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(absA[p], extentX),
+                                          _mm256_mul_ps(absB[p], extentY)),
+                            _mm256_mul_ps(absC[p], extentZ)) };
+
+          visible = _mm256_and_ps(visible,
+                                  _mm256_cmp_ps(_mm256_add_ps(distance,
+                                                              reach),
+                                                zero,
+                                                _CMP_GE_OQ));
+        }
+      }
+
+      mask |= static_cast<uint32_t>(_mm256_movemask_ps(visible)) << lane;
+    }
+
+    args.masks[block] = static_cast<uint16_t>(mask);
+  }
+}
+
+template <bool testSpheres, bool testBoxes>
+SO_TARGET("avx512f") void
+cullAvx512(KernelArgs const& args)
+{
+  float const* const sx{ getStream(args, Stream::sphereX) };
+  float const* const sy{ getStream(args, Stream::sphereY) };
+  float const* const sz{ getStream(args, Stream::sphereZ) };
+  float const* const sr{ getStream(args, Stream::sphereRadius) };
+  float const* const bx{ getStream(args, Stream::boxX) };
+  float const* const by{ getStream(args, Stream::boxY) };
+  float const* const bz{ getStream(args, Stream::boxZ) };
+  float const* const ex{ getStream(args, Stream::boxExtentX) };
+  float const* const ey{ getStream(args, Stream::boxExtentY) };
+  float const* const ez{ getStream(args, Stream::boxExtentZ) };
+
+  __m512 a[6], b[6], c[6], d[6], absA[6], absB[6], absC[6];
+
+  for(size_type p{ 0 }; p < 6; ++p)
+  {
+    a[p]    = _mm512_set1_ps(args.planes[p][0]);
+    b[p]    = _mm512_set1_ps(args.planes[p][1]);
+    c[p]    = _mm512_set1_ps(args.planes[p][2]);
+    d[p]    = _mm512_set1_ps(args.planes[p][3]);
+    absA[p] = _mm512_set1_ps(args.absNormals[p][0]);
+    absB[p] = _mm512_set1_ps(args.absNormals[p][1]);
+    absC[p] = _mm512_set1_ps(args.absNormals[p][2]);
+  }
+
+  __m512 const zero{ _mm512_setzero_ps() };
+
+  // One block is exactly one vector.
+  for(size_type block{ args.firstBlock }; block < args.lastBlock; ++block)
+  {
+    size_type const i{ block * blockSize };
+
+    __mmask16 visible{ 0xffff };
+
+    if(testSpheres)
+    {
+      __m512 const x{ _mm512_load_ps(sx + i) };
+      __m512 const y{ _mm512_load_ps(sy + i) };
+      __m512 const z{ _mm512_load_ps(sz + i) };
+      __m512 const negR{ _mm512_sub_ps(zero, _mm512_load_ps(sr + i)) };
+
+      for(size_type p{ 0 }; p < 6; ++p)
+      {
+        __m512 const distance
+          { _mm512_add_ps(_mm512_add_ps(_mm512_add_ps
+                                          (_mm512_mul_ps(a[p], x),
+                                           _mm512_mul_ps(b[p], y)),
+                                        _mm512_mul_ps(c[p], z)),
+                          d[p]) };
+
+        visible = _mm512_mask_cmp_ps_mask(visible, distance, negR,
+                                          _CMP_GE_OQ);
+      }
+    }
+
+    if(testBoxes)
+    {
+      __m512 const x{ _mm512_load_ps(bx + i) };
+      __m512 const y{ _mm512_load_ps(by + i) };
+      __m512 const z{ _mm512_load_ps(bz + i) };
+      __m512 const extentX{ _mm512_load_ps(ex + i) };
+      __m512 const extentY{ _mm512_load_ps(ey + i) };
+      __m512 const extentZ{ _mm512_load_ps(ez + i) };
+
+      for(size_type p{ 0 }; p < 6; ++p)
+      {
+        __m512 const distance
+          { _mm512_add_ps(_mm512_add_ps(_mm512_add_ps
+                                          (_mm512_mul_ps(a[p], x),
+                                           _mm512_mul_ps(b[p], y)),
+                                        _mm512_mul_ps(c[p], z)),
+                          d[p]) };
+
+        __m512 const reach
+          { _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(absA[p], extentX),
+                                        _mm512_mul_ps(absB[p], extentY)),
+                          _mm512_mul_ps(absC[p], extentZ)) };
+
+        visible = _mm512_mask_cmp_ps_mask(visible,
+                                          _mm512_add_ps(distance, reach),
+                                          zero,
+                                          _CMP_GE_OQ);
+      }
+    }
+
+    args.masks[block] = static_cast<uint16_t>(visible);
+  }
+}
+
+#endif // SO_FRUSTUM_CULLER_X86
+
+template <bool testSpheres, bool testBoxes>
+Kernel
+getKernel(so::SimdLevel const simdLevel)
+{
+  switch(simdLevel)
+  {
+#if defined(SO_FRUSTUM_CULLER_X86)
+    case so::SimdLevel::avx512:
+      return &cullAvx512<testSpheres, testBoxes>;
+    case so::SimdLevel::avx2:
+      return &cullAvx2<testSpheres, testBoxes>;
+    case so::SimdLevel::sse:
+      return &cullSse<testSpheres, testBoxes>;
+#else
+    case so::SimdLevel::avx512:
+    case so::SimdLevel::avx2:
+    case so::SimdLevel::sse:
+#endif
+    case so::SimdLevel::scalar:
+      break;
+  }
+
+  return &cullScalar<testSpheres, testBoxes>;
+}
+
+Kernel
+getKernel(so::SimdLevel const simdLevel, so::BoundingShape const shape)
+{
+  switch(shape)
+  {
+    case so::BoundingShape::box:
+      return getKernel<false, true>(simdLevel);
+    case so::BoundingShape::sphereAndBox:
+      return getKernel<true, true>(simdLevel);
+    case so::BoundingShape::sphere:
+      break;
+  }
+
+  return getKernel<true, false>(simdLevel);
+}
+
+so::SimdLevel
+detectSimdLevel()
+{
+#if defined(SO_FRUSTUM_CULLER_X86) and defined(__GNUC__)
+  __builtin_cpu_init();
+
+  // Also checks that the OS saves the wider registers on context switches.
+  if(__builtin_cpu_supports("avx512f"))
+  {
+    return so::SimdLevel::avx512;
+  }
+
+  if(__builtin_cpu_supports("avx2"))
+  {
+    return so::SimdLevel::avx2;
+  }
+
+  return so::SimdLevel::sse;
+#elif defined(SO_FRUSTUM_CULLER_X86)
+  // SSE2 is part of x86-64; the wider levels aren't detected without GCC's
+  // builtins.
+  return so::SimdLevel::sse;
+#else
+  return so::SimdLevel::scalar;
+#endif
+}
+
+} // namespace
+
+so::FrustumCuller::FrustumCuller()
+  : mVolumes(),
+    mVisibility(),
+    mNumObjects(0),
+    mNumBlocks(0),
+    mNumVisible(0),
+    mSimdLevel(getSupportedSimdLevel()),
+    mMinObjectsPerJob(16384),
+    mJobSystem(nullptr)
+{}
+
+void
+so::FrustumCuller::initialize(JobSystem& jobSystem)
+{
+  mJobSystem = &jobSystem;
+}
+
+void
+so::FrustumCuller::resize(size_type const numObjects)
+{
+  size_type const numBlocks{ (numObjects + blockSize - 1) / blockSize };
+  size_type const numStreams{ static_cast<size_type>(Stream::count) };
+
+  utils::mem::AlignedVector<float> volumes
+    (cacheLineSize,
+     numStreams * numBlocks * blockSize,
+     utils::mem::ElementLayout::packed);
+
+  size_type const numKept{ std::min(mNumObjects, numObjects) };
+
+  if(numKept > 0)
+  {
+    for(size_type stream{ 0 }; stream < numStreams; ++stream)
+    {
+      std::copy_n(getStream(static_cast<Stream>(stream)),
+                  numKept,
+                  volumes.data() + stream * numBlocks * blockSize);
+    }
+  }
+
+  mVolumes    = std::move(volumes);
+  mNumObjects = numObjects;
+  mNumBlocks  = numBlocks;
+  mNumVisible = 0;
+
+  mVisibility.assign(numBlocks, 0);
+}
+
+void
+so::FrustumCuller::setSphere(size_type            const  idx,
+                             std::array<float, 3> const& center,
+                             float                const  radius)
+{
+  getStream(Stream::sphereX)[idx]      = center[0];
+  getStream(Stream::sphereY)[idx]      = center[1];
+  getStream(Stream::sphereZ)[idx]      = center[2];
+  getStream(Stream::sphereRadius)[idx] = radius;
+}
+
+void
+so::FrustumCuller::setBox(size_type            const  idx,
+                          std::array<float, 3> const& min,
+                          std::array<float, 3> const& max)
+{
+  getStream(Stream::boxX)[idx]       = 0.5f * (min[0] + max[0]);
+  getStream(Stream::boxY)[idx]       = 0.5f * (min[1] + max[1]);
+  getStream(Stream::boxZ)[idx]       = 0.5f * (min[2] + max[2]);
+  getStream(Stream::boxExtentX)[idx] = 0.5f * (max[0] - min[0]);
+  getStream(Stream::boxExtentY)[idx] = 0.5f * (max[1] - min[1]);
+  getStream(Stream::boxExtentZ)[idx] = 0.5f * (max[2] - min[2]);
+}
+
+so::size_type
+so::FrustumCuller::cull(Planes        const& planes,
+                        BoundingShape const  shape)
+{
+  SO_PROFILE_ZONE("FrustumCuller::cull");
+
+  mNumVisible = 0;
+
+  if(mNumBlocks is_eq 0)
+  {
+    return 0;
+  }
+
+  size_type const numChunks{ (mNumBlocks + blocksPerChunk - 1) /
+                             blocksPerChunk };
+
+  size_type const minChunksPerJob
+    { std::max(mMinObjectsPerJob / (blocksPerChunk * blockSize),
+               size_type{ 1 }) };
+
+  Task task;
+
+  task.planes = planes;
+  task.shape  = shape;
+
+  if((mJobSystem is_eq nullptr) or (numChunks <= minChunksPerJob))
+  {
+    mNumVisible = cullChunks(0, numChunks, task);
+
+    return mNumVisible;
+  }
+
+  size_type const grainSize
+    { std::max(minChunksPerJob,
+               numChunks / (mJobSystem->getNumThreads() *
+                            JobSystem::splitsPerThread)) };
+
+  mNumVisible = mJobSystem->parallelReduce
+                  (size_type{ 0 },
+                   numChunks,
+                   size_type{ 0 },
+                   [this, &task](size_type const firstChunk,
+                                 size_type const lastChunk)
+                   { return cullChunks(firstChunk, lastChunk, task); },
+                   std::plus<size_type>(),
+                   grainSize);
+
+  return mNumVisible;
+}
+
+void
+so::FrustumCuller::getVisibleIndices(std::vector<uint32_t>& indices) const
+{
+  indices.clear();
+  indices.reserve(mNumVisible);
+
+  for(size_type block{ 0 }; block < mNumBlocks; ++block)
+  {
+    uint32_t mask{ mVisibility[block] };
+
+    for(uint32_t lane{ 0 }; mask not_eq 0; ++lane, mask >>= 1)
+    {
+      if((mask bitand 1u) not_eq 0)
+      {
+        indices.push_back(static_cast<uint32_t>(block * blockSize) + lane);
+      }
+    }
+  }
+}
+
+void
+so::FrustumCuller::setSimdLevel(SimdLevel const simdLevel)
+{
+  mSimdLevel = std::min(simdLevel, getSupportedSimdLevel());
+}
+
+so::size_type
+so::FrustumCuller::getNumThreads() const
+{
+  return mJobSystem is_eq nullptr ? 1 : mJobSystem->getNumThreads();
+}
+
+so::SimdLevel
+so::FrustumCuller::getSupportedSimdLevel()
+{
+  static SimdLevel const simdLevel{ detectSimdLevel() };
+
+  return simdLevel;
+}
+
+so::FrustumCuller::Planes
+so::FrustumCuller::getFrustumPlanes
+  (std::array<float, 16> const& viewProjection)
+{
+  auto const row
+    { [&viewProjection](size_type const r)
+      {
+        return std::array<float, 4>{ { viewProjection[r],
+                                       viewProjection[4 + r],
+                                       viewProjection[8 + r],
+                                       viewProjection[12 + r] } };
+      } };
+
+  std::array<float, 4> const x{ row(0) };
+  std::array<float, 4> const y{ row(1) };
+  std::array<float, 4> const z{ row(2) };
+  std::array<float, 4> const w{ row(3) };
+
+  Planes planes;
+
+  for(size_type i{ 0 }; i < 4; ++i)
+  {
+    planes[0][i] = w[i] + x[i]; // left
+    planes[1][i] = w[i] - x[i]; // right
+    planes[2][i] = w[i] + y[i]; // top, y points down in Vulkan
+    planes[3][i] = w[i] - y[i]; // bottom
+    planes[4][i] = z[i];        // near
+    planes[5][i] = w[i] - z[i]; // far
+  }
+
+  for(auto& plane : planes)
+  {
+    float const length{ std::sqrt(plane[0] * plane[0] +
+                                  plane[1] * plane[1] +
+                                  plane[2] * plane[2]) };
+
+    if(length > 0.0f)
+    {
+      for(auto& coefficient : plane)
+      {
+        coefficient /= length;
+      }
+    }
+  }
+
+  return planes;
+}
+
+so::size_type
+so::FrustumCuller::cullChunks(size_type const  firstChunk,
+                              size_type const  lastChunk,
+                              Task      const& task)
+{
+  KernelArgs args;
+
+  args.volumes      = mVolumes.data();
+  args.streamLength = mNumBlocks * blockSize;
+  args.planes       = task.planes;
+  args.masks        = mVisibility.data();
+  args.firstBlock   = std::min(firstChunk * blocksPerChunk, mNumBlocks);
+  args.lastBlock    = std::min(lastChunk * blocksPerChunk, mNumBlocks);
+
+  for(size_type p{ 0 }; p < 6; ++p)
+  {
+    for(size_type i{ 0 }; i < 3; ++i)
+    {
+      args.absNormals[p][i] = std::abs(task.planes[p][i]);
+    }
+  }
+
+  getKernel(mSimdLevel, task.shape)(args);
+
+  // The padding behind the last object is never visible.
+  size_type const remainder{ mNumObjects % blockSize };
+
+  if((args.lastBlock is_eq mNumBlocks) and (remainder not_eq 0))
+  {
+    mVisibility[mNumBlocks - 1] = static_cast<uint16_t>
+      (mVisibility[mNumBlocks - 1] bitand ((1u << remainder) - 1u));
+  }
+
+  size_type numVisible{ 0 };
+
+  for(size_type block{ args.firstBlock }; block < args.lastBlock; ++block)
+  {
+    numVisible += std::bitset<blockSize>(mVisibility[block]).count();
+  }
+
+  return numVisible;
+}
@@ -0,0 +1,296 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      cxx/soFrustumCuller.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "soAlignedVector.hpp"
+#include "soDefinitions.hpp"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace so {
+
+class JobSystem;
+
+/**
+ * @brief Instruction sets the culling kernels are compiled for, from the
+ *        narrowest to the widest. Each kernel tests 1, 4, 8 or 16 volumes
+ *        per plane and instruction.
+ */
+enum class
+SimdLevel
+{
+  scalar,
+  sse,
+  avx2,
+  avx512
+}; // enum class SimdLevel
+
+/**
+ * @brief Bounding volumes a cull tests. sphereAndBox keeps an object only if
+ *        both its sphere and its box intersect the frustum.
+ */
+enum class
+BoundingShape
+{
+  sphere,
+  box,
+  sphereAndBox
+}; // enum class BoundingShape
+
+/**
+ * @brief Culls bounding spheres and axis aligned boxes against the six planes
+ *        of a view frustum.
+ *
+ * The volumes are kept as a structure of arrays, one stream of floats per
+ * component, padded to whole blocks of blockSize objects and aligned to a
+ * cache line. The kernels therefore only ever do aligned loads of full
+ * vectors. A cull splits the blocks into contiguous ranges culled as jobs
+ * of a JobSystem, with the calling thread helping. The result is a bit per
+ * object, stored as one 16 bit mask per block.
+ *
+ * The SIMD level is picked at runtime from what the CPU supports, so the
+ * library itself can be built for the baseline instruction set.
+ */
+class
+FrustumCuller
+{
+  public:
+    using Planes = std::array<std::array<float, 4>, 6>;
+
+    /**
+     * @brief The streams of floats, one per component of the volumes. Boxes
+     *        are stored as center and half extent.
+     */
+    enum class
+    Stream : size_type
+    {
+      sphereX,
+      sphereY,
+      sphereZ,
+      sphereRadius,
+      boxX,
+      boxY,
+      boxZ,
+      boxExtentX,
+      boxExtentY,
+      boxExtentZ,
+      count
+    }; // enum class Stream
+
+    static constexpr size_type blockSize{ 16 };
+
+    FrustumCuller();
+
+    FrustumCuller(FrustumCuller const& other) = delete;
+
+    FrustumCuller(FrustumCuller&& other) = delete;
+
+    ~FrustumCuller() noexcept = default;
+
+    FrustumCuller& operator=(FrustumCuller const& other) = delete;
+
+    FrustumCuller& operator=(FrustumCuller&& other) = delete;
+
+    /**
+     * @brief Culls on the threads of jobSystem from now on, which has to
+     *        outlive the culler. Until then culls run on the calling thread.
+     *        The volumes are kept.
+     */
+    void
+    initialize(JobSystem& jobSystem);
+
+    /**
+     * @brief Changes the number of objects. Volumes of objects below the new
+     *        size are kept, new ones are zero.
+     */
+    void
+    resize(size_type const numObjects);
+
+    inline size_type size() const { return mNumObjects; }
+
+    void
+    setSphere(size_type            const  idx,
+              std::array<float, 3> const& center,
+              float                const  radius);
+
+    void
+    setBox(size_type            const  idx,
+           std::array<float, 3> const& min,
+           std::array<float, 3> const& max);
+
+    /**
+     * @brief Direct access to a stream, e.g. to fill it in bulk. The stream
+     *        holds size() floats followed by zeroed padding up to a whole
+     *        block.
+     */
+    inline float*
+    getStream(Stream const stream)
+    {
+      return mVolumes.data() +
+             static_cast<size_type>(stream) * mNumBlocks * blockSize;
+    }
+
+    inline float const*
+    getStream(Stream const stream) const
+    {
+      return mVolumes.data() +
+             static_cast<size_type>(stream) * mNumBlocks * blockSize;
+    }
+
+    /**
+     * @brief Tests every object against planes, as returned by
+     *        getFrustumPlanes.
+     *
+     * @return The number of visible objects.
+     */
+    size_type
+    cull(Planes        const& planes,
+         BoundingShape const  shape = BoundingShape::sphere);
+
+    inline bool
+    isVisible(size_type const idx) const
+    {
+      return ((mVisibility[idx / blockSize] >> (idx % blockSize)) bitand 1u)
+             not_eq 0;
+    }
+
+    inline size_type getNumVisible() const { return mNumVisible; }
+
+    /**
+     * @brief One mask per block of blockSize objects, bit i of mask b is set
+     *        if object b * blockSize + i was visible in the last cull.
+     */
+    inline std::vector<uint16_t> const&
+    getVisibilityMasks() const { return mVisibility; }
+
+    /**
+     * @brief Replaces indices with the ascending indices of the objects that
+     *        were visible in the last cull.
+     */
+    void
+    getVisibleIndices(std::vector<uint32_t>& indices) const;
+
+    /**
+     * @brief Limits the kernels to simdLevel, or to the widest level the CPU
+     *        supports if that is narrower.
+     */
+    void
+    setSimdLevel(SimdLevel const simdLevel);
+
+    inline SimdLevel getSimdLevel() const { return mSimdLevel; }
+
+    size_type
+    getNumThreads() const;
+
+    /**
+     * @brief Minimum number of objects per job. Small sets are split into
+     *        fewer jobs, since scheduling a job costs more than testing a
+     *        few thousand volumes.
+     */
+    inline void
+    setMinObjectsPerJob(size_type const minObjectsPerJob)
+    { mMinObjectsPerJob = minObjectsPerJob; }
+
+    /**
+     * @brief The widest SIMD level both the build and the CPU support.
+     */
+    static SimdLevel
+    getSupportedSimdLevel();
+
+    /**
+     * @brief Planes a, b, c, d with a * x + b * y + c * z + d >= 0 inside
+     *        the clip volume of the column major viewProjection, normalized
+     *        so d is the distance to the origin. Near is z = 0, as in
+     *        Vulkan.
+     */
+    static Planes
+    getFrustumPlanes(std::array<float, 16> const& viewProjection);
+
+  private:
+    struct
+    Task
+    {
+      Planes        planes{};
+      BoundingShape shape{ BoundingShape::sphere };
+    }; // struct Task
+
+    // The streams one after another, each padded to whole blocks and
+    // starting on a cache line.
+    utils::mem::AlignedVector<float> mVolumes;
+
+    std::vector<uint16_t>            mVisibility;
+
+    size_type                        mNumObjects;
+
+    size_type                        mNumBlocks;
+
+    size_type                        mNumVisible;
+
+    SimdLevel                        mSimdLevel;
+
+    size_type                        mMinObjectsPerJob;
+
+    JobSystem*                       mJobSystem;
+
+    /**
+     * @brief Culls the chunks [firstChunk, lastChunk) and returns the number
+     *        of visible objects in them.
+     */
+    size_type
+    cullChunks(size_type const  firstChunk,
+               size_type const  lastChunk,
+               Task      const& task);
+
+}; // class FrustumCuller
+
+} // namespace so
@@ -0,0 +1,508 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "soJobSystem.hpp"
+
+#include "soAtomic.hpp"
+#include "soProfiler.hpp"
+
+#include <string>
+
+namespace {
+
+using so::size_type;
+
+// Marks the dependents of a counter that is done, so jobs added later run
+// right away.
+so::internal::Job closedList{};
+
+// The system the calling thread belongs to, and its index there.
+thread_local so::JobSystem const* currentSystem{ nullptr };
+thread_local size_type            currentThreadIdx{ 0 };
+
+// Failed attempts to find a job before an idle worker goes to sleep.
+constexpr size_type numSpins{ 64 };
+
+// Orders of the deque operations around its fences, seq_cst under
+// ThreadSanitizer, see so::fencedOrder.
+constexpr std::memory_order relaxedOrder
+  { so::fencedOrder(std::memory_order_relaxed) };
+constexpr std::memory_order acquireOrder
+  { so::fencedOrder(std::memory_order_acquire) };
+
+} // namespace
+
+so::JobCounter::JobCounter() noexcept
+  : mValue(0),
+    mNumSignalling(0),
+    mDependents(&closedList)
+{}
+
+bool
+so::JobCounter::isDone() const noexcept
+{
+  return mValue.load() is_eq 0 and mNumSignalling.load() is_eq 0;
+}
+
+so::JobSystem::WorkStealingDeque::WorkStealingDeque()
+  : mTop(0),
+    mBottom(0),
+    mJobs(new std::atomic<internal::Job*>[dequeCapacity])
+{}
+
+bool
+so::JobSystem::WorkStealingDeque::push(internal::Job* const job)
+{
+  int64_t const bottom{ mBottom.load(relaxedOrder) };
+  int64_t const top{ mTop.load(acquireOrder) };
+
+  if(bottom - top >= static_cast<int64_t>(dequeCapacity))
+  {
+    return false;
+  }
+
+  mJobs[static_cast<size_type>(bottom) % dequeCapacity].store
+    (job, relaxedOrder);
+
+  so::threadFence(std::memory_order_release);
+
+  mBottom.store(bottom + 1, relaxedOrder);
+
+  return true;
+}
+
+so::internal::Job*
+so::JobSystem::WorkStealingDeque::pop()
+{
+  int64_t const bottom{ mBottom.load(relaxedOrder) - 1 };
+
+  mBottom.store(bottom, relaxedOrder);
+
+  so::threadFence(std::memory_order_seq_cst);
+
+  int64_t top{ mTop.load(relaxedOrder) };
+
+  if(top > bottom)
+  {
+    mBottom.store(bottom + 1, relaxedOrder);
+
+    return nullptr;
+  }
+
+  internal::Job* job
+    { mJobs[static_cast<size_type>(bottom) % dequeCapacity].load
+        (relaxedOrder) };
+
+  // The last job, which a thief may be taking as well.
+  if(top is_eq bottom)
+  {
+    if(not mTop.compare_exchange_strong(top,
+                                        top + 1,
+                                        std::memory_order_seq_cst,
+                                        relaxedOrder))
+    {
+      job = nullptr;
+    }
+
+    mBottom.store(bottom + 1, relaxedOrder);
+  }
+
+  return job;
+}
+
+so::internal::Job*
+so::JobSystem::WorkStealingDeque::steal()
+{
+  int64_t top{ mTop.load(acquireOrder) };
+
+  so::threadFence(std::memory_order_seq_cst);
+
+  int64_t const bottom{ mBottom.load(acquireOrder) };
+
+  if(top >= bottom)
+  {
+    return nullptr;
+  }
+
+  internal::Job* const job
+    { mJobs[static_cast<size_type>(top) % dequeCapacity].load
+        (relaxedOrder) };
+
+  if(not mTop.compare_exchange_strong(top,
+                                      top + 1,
+                                      std::memory_order_seq_cst,
+                                      relaxedOrder))
+  {
+    return nullptr;
+  }
+
+  return job;
+}
+
+bool
+so::JobSystem::WorkStealingDeque::isEmpty() const
+{
+  return mTop.load(acquireOrder) >= mBottom.load(acquireOrder);
+}
+
+so::JobSystem::JobSystem()
+  : mThreads(),
+    mQueueMutex(),
+    mQueue(),
+    mQueueSize(0),
+    mSleepMutex(),
+    mWakeUp(),
+    mNumSleeping(0),
+    mNumWakeUps(0),
+    mStop(false)
+{}
+
+so::JobSystem::~JobSystem() noexcept
+{
+  stopWorkers();
+}
+
+void
+so::JobSystem::initialize(size_type const numThreads)
+{
+  stopWorkers();
+
+  size_type totalThreads{ numThreads };
+
+  if(totalThreads is_eq 0)
+  {
+    totalThreads = std::max(size_type{ std::thread::hardware_concurrency() },
+                            size_type{ 1 });
+  }
+
+  for(size_type i{ 0 }; i < totalThreads; ++i)
+  {
+    mThreads.push_back(std::make_unique<Thread>());
+  }
+
+  currentSystem    = this;
+  currentThreadIdx = 0;
+
+  // Spawned only once all threads exist, since workers steal from them.
+  for(size_type i{ 1 }; i < mThreads.size(); ++i)
+  {
+    mThreads[i]->thread = std::thread(&JobSystem::workerLoop, this, i);
+  }
+}
+
+void
+so::JobSystem::wait(JobCounter const& counter)
+{
+  size_type const threadIdx{ currentSystem is_eq this ? currentThreadIdx
+                                                      : mThreads.size() };
+
+  while(not counter.isDone())
+  {
+    internal::Job* const job{ findJob(threadIdx) };
+
+    if(job not_eq nullptr)
+    {
+      execute(*job);
+    }
+    else
+    {
+      std::this_thread::yield();
+    }
+  }
+}
+
+so::size_type
+so::JobSystem::getGrainSize(size_type const count,
+                            size_type const grainSize) const
+{
+  if(grainSize not_eq 0)
+  {
+    return grainSize;
+  }
+
+  return std::max(count / (std::max(mThreads.size(), size_type{ 1 }) *
+                           splitsPerThread),
+                  size_type{ 1 });
+}
+
+void
+so::JobSystem::increment(JobCounter& counter)
+{
+  // A counter that was done takes dependents again.
+  if(counter.mValue.fetch_add(1) is_eq 0)
+  {
+    counter.mDependents.store(nullptr);
+  }
+}
+
+void
+so::JobSystem::addDependent(JobCounter& counter, internal::Job* const job)
+{
+  internal::Job* head{ counter.mDependents.load() };
+
+  do
+  {
+    if(head is_eq &closedList)
+    {
+      submit(job);
+
+      return;
+    }
+
+    job->next = head;
+  }
+  while(not counter.mDependents.compare_exchange_weak(head, job));
+}
+
+void
+so::JobSystem::submit(internal::Job* const job)
+{
+  if(mThreads.empty())
+  {
+    execute(*job);
+
+    return;
+  }
+
+  if(currentSystem is_eq this)
+  {
+    if(not mThreads[currentThreadIdx]->deque.push(job))
+    {
+      execute(*job);
+
+      return;
+    }
+  }
+  else
+  {
+    std::lock_guard<std::mutex> lock(mQueueMutex);
+
+    mQueue.push_back(job);
+
+    ++mQueueSize;
+  }
+
+  // Pairs with the fence in workerLoop: either a worker going to sleep sees
+  // the job, or this sees the worker sleeping.
+  so::threadFence(std::memory_order_seq_cst);
+
+  if(mNumSleeping.load() > 0)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mSleepMutex);
+
+      ++mNumWakeUps;
+    }
+
+    mWakeUp.notify_one();
+  }
+}
+
+void
+so::JobSystem::execute(internal::Job& job)
+{
+  job.invoke(job);
+
+  JobCounter* const counter{ job.signal };
+
+  JobPool::deallocate(&job);
+
+  if(counter is_eq nullptr)
+  {
+    return;
+  }
+
+  ++counter->mNumSignalling;
+
+  if(counter->mValue.fetch_sub(1) is_eq 1)
+  {
+    internal::Job* dependent{ counter->mDependents.exchange(&closedList) };
+
+    while(dependent not_eq nullptr)
+    {
+      internal::Job* const next{ dependent->next };
+
+      submit(dependent);
+
+      dependent = next;
+    }
+  }
+
+  --counter->mNumSignalling;
+}
+
+so::internal::Job*
+so::JobSystem::findJob(size_type const threadIdx)
+{
+  size_type const numThreads{ mThreads.size() };
+
+  if(threadIdx < numThreads)
+  {
+    if(internal::Job* const job{ mThreads[threadIdx]->deque.pop() })
+    {
+      return job;
+    }
+  }
+
+  if(mQueueSize.load() > 0)
+  {
+    std::lock_guard<std::mutex> lock(mQueueMutex);
+
+    if(not mQueue.empty())
+    {
+      internal::Job* const job{ mQueue.front() };
+
+      mQueue.pop_front();
+
+      --mQueueSize;
+
+      return job;
+    }
+  }
+
+  // Start at the next thread, so thieves spread over the victims.
+  for(size_type i{ 1 }; i <= numThreads; ++i)
+  {
+    size_type const victim{ (threadIdx + i) % numThreads };
+
+    if(victim is_eq threadIdx)
+    {
+      continue;
+    }
+
+    if(internal::Job* const job{ mThreads[victim]->deque.steal() })
+    {
+      return job;
+    }
+  }
+
+  return nullptr;
+}
+
+bool
+so::JobSystem::hasJobs() const
+{
+  if(mQueueSize.load() > 0)
+  {
+    return true;
+  }
+
+  for(auto const& thread : mThreads)
+  {
+    if(not thread->deque.isEmpty())
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void
+so::JobSystem::workerLoop(size_type const threadIdx)
+{
+  setProfileThreadName("Job worker " + std::to_string(threadIdx));
+
+  currentSystem    = this;
+  currentThreadIdx = threadIdx;
+
+  size_type numFailures{ 0 };
+
+  while(not mStop.load())
+  {
+    if(internal::Job* const job{ findJob(threadIdx) })
+    {
+      execute(*job);
+
+      numFailures = 0;
+
+      continue;
+    }
+
+    if(++numFailures < numSpins)
+    {
+      std::this_thread::yield();
+
+      continue;
+    }
+
+    numFailures = 0;
+
+    std::unique_lock<std::mutex> lock(mSleepMutex);
+
+    ++mNumSleeping;
+
+    so::threadFence(std::memory_order_seq_cst);
+
+    if(not hasJobs())
+    {
+      uint64_t const numWakeUps{ mNumWakeUps };
+
+      mWakeUp.wait(lock, [this, numWakeUps]
+                         {
+                           return mStop.load() or
+                                  mNumWakeUps not_eq numWakeUps;
+                         });
+    }
+
+    --mNumSleeping;
+  }
+
+  currentSystem = nullptr;
+}
+
+void
+so::JobSystem::stopWorkers()
+{
+  {
+    std::lock_guard<std::mutex> lock(mSleepMutex);
+
+    mStop = true;
+  }
+
+  mWakeUp.notify_all();
+
+  for(auto& thread : mThreads)
+  {
+    if(thread->thread.joinable())
+    {
+      thread->thread.join();
+    }
+  }
+
+  // Jobs left over run here, as outside the system, so their counters
+  // finish and their blocks return to the pool.
+  if(currentSystem is_eq this)
+  {
+    currentSystem = nullptr;
+  }
+
+  while(internal::Job* const job{ findJob(mThreads.size()) })
+  {
+    execute(*job);
+  }
+
+  mThreads.clear();
+
+  mStop = false;
+}
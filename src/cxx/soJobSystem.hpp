@@ -0,0 +1,467 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      cxx/soJobSystem.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "soDefinitions.hpp"
+#include "soPoolAllocator.hpp"
+#include "soScratchAllocator.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace so {
+
+class JobCounter;
+
+namespace internal {
+
+/*
+ * A job is a closure stored inline, so scheduling one only takes a block of
+ * the job pool. A job fills two cache lines, so jobs on different threads
+ * never share one.
+ */
+struct alignas(64)
+Job
+{
+  static constexpr size_type storageSize{ 96 };
+
+  void        (*invoke)(Job& job);
+  JobCounter*   signal;
+  Job*          next;
+
+  alignas(std::max_align_t) unsigned char storage[storageSize];
+}; // struct Job
+
+static_assert(sizeof(Job) is_eq 128, "A job has to fill two cache lines.");
+
+} // namespace internal
+
+/**
+ * @brief Number of unfinished jobs that signal the counter.
+ *
+ * Scheduling a job with a counter increments it, finishing the job
+ * decrements it. Jobs can wait for a counter with JobSystem::runAfter, any
+ * thread with JobSystem::wait. A counter has to outlive its jobs and those
+ * waiting for it, and may only be reused once it is done.
+ */
+class
+JobCounter
+{
+  public:
+    JobCounter() noexcept;
+
+    JobCounter(JobCounter const& other) = delete;
+
+    JobCounter(JobCounter&& other) = delete;
+
+    ~JobCounter() noexcept = default;
+
+    JobCounter&
+    operator=(JobCounter const& other) = delete;
+
+    JobCounter&
+    operator=(JobCounter&& other) = delete;
+
+    /**
+     * @brief True once all jobs signalling the counter have finished and
+     *        those waiting for it have been scheduled.
+     */
+    bool
+    isDone() const noexcept;
+
+  private:
+    friend class JobSystem;
+
+    std::atomic<uint32_t>       mValue;
+
+    // Threads that are decrementing the counter, so it is not reported as
+    // done while one of them still touches it.
+    std::atomic<uint32_t>       mNumSignalling;
+
+    // The jobs waiting for the counter, or JobSystem's closed list once they
+    // were scheduled.
+    std::atomic<internal::Job*> mDependents;
+};
+
+/**
+ * @brief Runs small jobs on a group of worker threads that steal work from
+ *        each other.
+ *
+ * Every thread of the system owns a Chase-Lev deque: it pushes and pops the
+ * jobs it schedules at the bottom, idle threads steal from the top. The
+ * thread calling initialize is thread 0; it runs jobs whenever it waits.
+ * Other threads schedule through a shared queue. Idle workers spin briefly
+ * and then sleep until a job is scheduled.
+ *
+ * Jobs are closures of up to internal::Job::storageSize bytes. They live in
+ * a FixedSizePool, so scheduling allocates nothing once the pool is warm.
+ */
+class
+JobSystem
+{
+  public:
+    /**
+     * @brief Jobs a deque holds. A thread whose deque is full runs the jobs
+     *        it schedules right away.
+     */
+    static constexpr size_type dequeCapacity{ 4096 };
+
+    JobSystem();
+
+    JobSystem(JobSystem const& other) = delete;
+
+    JobSystem(JobSystem&& other) = delete;
+
+    ~JobSystem() noexcept;
+
+    JobSystem&
+    operator=(JobSystem const& other) = delete;
+
+    JobSystem&
+    operator=(JobSystem&& other) = delete;
+
+    /**
+     * @brief (Re)starts the workers, after running the jobs left over.
+     *
+     * @param numThreads Number of threads running jobs, including the
+     *                   calling one. 0 picks the number of hardware threads.
+     */
+    void
+    initialize(size_type const numThreads = 0);
+
+    inline size_type getNumThreads() const { return mThreads.size(); }
+
+    /**
+     * @brief Schedules func, incrementing signal until it has run.
+     */
+    template <typename Func>
+    void
+    run(Func&& func, JobCounter* const signal = nullptr)
+    {
+      submit(createJob(std::forward<Func>(func), signal));
+    }
+
+    /**
+     * @brief Schedules func once dependency is done.
+     *
+     * signal is incremented right away, so waiting for it also waits for
+     * dependency.
+     */
+    template <typename Func>
+    void
+    runAfter(JobCounter&       dependency,
+             Func&&            func,
+             JobCounter* const signal = nullptr)
+    {
+      addDependent(dependency, createJob(std::forward<Func>(func), signal));
+    }
+
+    /**
+     * @brief Runs jobs on the calling thread until counter is done.
+     */
+    void
+    wait(JobCounter const& counter);
+
+    /**
+     * @brief Calls func(begin, end) on subranges of [first, last) in
+     *        parallel and returns once all calls have returned.
+     *
+     * The range is split in halves down to grainSize. The upper halves are
+     * scheduled and the lower ones run right away, so idle threads steal
+     * large pieces. A grainSize of 0 splits into about splitsPerThread
+     * pieces per thread.
+     */
+    template <typename Func>
+    void
+    parallelFor(size_type const  first,
+                size_type const  last,
+                Func      const& func,
+                size_type const  grainSize = 0)
+    {
+      if(first >= last)
+      {
+        return;
+      }
+
+      JobCounter counter;
+
+      split(first,
+            last,
+            getGrainSize(last - first, grainSize),
+            func,
+            counter);
+
+      wait(counter);
+    }
+
+    /**
+     * @brief Combines map(begin, end) of the subranges of [first, last),
+     *        starting with identity.
+     *
+     * The subranges are grainSize long, picked as by parallelFor, and
+     * combined in order, so the result does not depend on the scheduling.
+     */
+    template <typename T, typename Map, typename Combine>
+    T
+    parallelReduce(size_type const  first,
+                   size_type const  last,
+                   T         const& identity,
+                   Map       const& map,
+                   Combine   const& combine,
+                   size_type const  grainSize = 0)
+    {
+      if(first >= last)
+      {
+        return identity;
+      }
+
+      size_type const grain{ getGrainSize(last - first, grainSize) };
+      size_type const numPieces{ (last - first + grain - 1) / grain };
+
+      utils::mem::ScratchScope scratch;
+
+      std::pmr::vector<T> results(numPieces,
+                                  identity,
+                                  scratch.getResource());
+
+      parallelFor(0,
+                  numPieces,
+                  [&](size_type const begin, size_type const end)
+                  {
+                    for(size_type piece{ begin }; piece < end; ++piece)
+                    {
+                      results[piece] = map(first + piece * grain,
+                                           std::min(first +
+                                                      (piece + 1) * grain,
+                                                    last));
+                    }
+                  },
+                  1);
+
+      T result{ identity };
+
+      for(T const& pieceResult : results)
+      {
+        result = combine(result, pieceResult);
+      }
+
+      return result;
+    }
+
+    static constexpr size_type splitsPerThread{ 4 };
+
+  private:
+    using JobPool = utils::mem::internal::PoolStorage<sizeof(internal::Job),
+                                                      alignof(internal::Job)>;
+
+    /*
+     * The deque of Chase and Lev with the memory orders of Le et al.,
+     * "Correct and Efficient Work-Stealing for Weak Memory Models", 2013.
+     */
+    class
+    WorkStealingDeque
+    {
+      public:
+        WorkStealingDeque();
+
+        /**
+         * @brief Owner only. False if the deque is full.
+         */
+        bool
+        push(internal::Job* const job);
+
+        /**
+         * @brief Owner only. The most recently pushed job, or nullptr.
+         */
+        internal::Job*
+        pop();
+
+        /**
+         * @brief Any thread. The least recently pushed job, or nullptr if
+         *        the deque is empty or another thread won the race for it.
+         */
+        internal::Job*
+        steal();
+
+        bool
+        isEmpty() const;
+
+      private:
+        alignas(64) std::atomic<int64_t> mTop;
+        alignas(64) std::atomic<int64_t> mBottom;
+
+        std::unique_ptr<std::atomic<internal::Job*>[]> mJobs;
+    };
+
+    struct
+    Thread
+    {
+      WorkStealingDeque deque;
+      std::thread       thread;
+    }; // struct Thread
+
+    // Thread 0 is the one that called initialize and has no std::thread.
+    std::vector<std::unique_ptr<Thread>> mThreads;
+
+    std::mutex                           mQueueMutex;
+    std::deque<internal::Job*>           mQueue;
+    std::atomic<size_type>               mQueueSize;
+
+    std::mutex                           mSleepMutex;
+    std::condition_variable              mWakeUp;
+    std::atomic<uint32_t>                mNumSleeping;
+    uint64_t                             mNumWakeUps;
+    std::atomic<bool>                    mStop;
+
+    template <typename Func>
+    internal::Job*
+    createJob(Func&& func, JobCounter* const signal)
+    {
+      using Closure = typename std::decay<Func>::type;
+
+      static_assert(sizeof(Closure) <= internal::Job::storageSize,
+                    "The closure of a job has to fit its storage.");
+      static_assert(alignof(Closure) <= alignof(std::max_align_t),
+                    "The closure of a job can't be over aligned.");
+
+      auto const job{ static_cast<internal::Job*>(JobPool::allocate()) };
+
+      new(job->storage) Closure(std::forward<Func>(func));
+
+      job->invoke = [](internal::Job& self)
+                    {
+                      auto& closure
+                        { *std::launder(reinterpret_cast<Closure*>
+                                          (self.storage)) };
+
+                      closure();
+                      closure.~Closure();
+                    };
+      job->signal = signal;
+      job->next   = nullptr;
+
+      if(signal not_eq nullptr)
+      {
+        increment(*signal);
+      }
+
+      return job;
+    }
+
+    template <typename Func>
+    void
+    split(size_type         first,
+          size_type         last,
+          size_type  const  grainSize,
+          Func       const& func,
+          JobCounter&       counter)
+    {
+      while(last - first > grainSize)
+      {
+        size_type const middle{ first + (last - first) / 2 };
+
+        run([this, middle, last, grainSize, &func, &counter]
+            { split(middle, last, grainSize, func, counter); },
+            &counter);
+
+        last = middle;
+      }
+
+      func(first, last);
+    }
+
+    size_type
+    getGrainSize(size_type const count, size_type const grainSize) const;
+
+    static void
+    increment(JobCounter& counter);
+
+    void
+    addDependent(JobCounter& counter, internal::Job* const job);
+
+    void
+    submit(internal::Job* const job);
+
+    void
+    execute(internal::Job& job);
+
+    /**
+     * @brief A job for thread threadIdx, or any thread outside the system
+     *        if threadIdx is getNumThreads(): its own, a queued or a stolen
+     *        one, in that order.
+     */
+    internal::Job*
+    findJob(size_type const threadIdx);
+
+    bool
+    hasJobs() const;
+
+    void
+    workerLoop(size_type const threadIdx);
+
+    void
+    stopWorkers();
+
+}; // class JobSystem
+
+} // namespace so
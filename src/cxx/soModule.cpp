@@ -126,6 +126,14 @@ so::Module::getSymbol(index_t const idx)
   return mSymbols[pos];
 }
 
+bool
+so::Module::hasSymbol(index_t const idx)
+{
+  auto const pos(static_cast<Symbols::size_type>(idx));
+
+  return (idx >= 0) and (pos < mSymbols.size()) and mSymbols[pos].isValid();
+}
+
 std::string const
 so::Module::getName()
 {
@@ -147,6 +147,13 @@ Module
     base::Symbol const&
     getSymbol(index_t const idx);
 
+    /**
+     * @brief Whether the module provides a valid symbol at the given index.
+     *        Optional symbols have to be checked before they are called.
+     */
+    bool
+    hasSymbol(index_t const idx);
+
     std::string const
     getName();
 
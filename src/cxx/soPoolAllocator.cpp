@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "soPoolAllocator.hpp"
+
+#include <algorithm>
+
+so::utils::mem::FixedSizePool::FixedSizePool(std::size_t const blockSize,
+                                             std::size_t const alignment)
+  : mMutex(),
+    mFreeList(nullptr),
+    mChunks(),
+    mBlockSize(),
+    mAlignment(std::max(alignment, alignof(FreeBlock))),
+    mBlocksPerChunk(),
+    mNumFree(0),
+    mHighWaterMark(0)
+{
+  // Free blocks hold the link of the free list.
+  std::size_t const size{ std::max(blockSize, sizeof(FreeBlock)) };
+
+  mBlockSize      = (size + mAlignment - 1) / mAlignment * mAlignment;
+  mBlocksPerChunk = std::max(chunkSize / mBlockSize, std::size_t{ 1 });
+}
+
+so::utils::mem::FixedSizePool::~FixedSizePool() noexcept
+{
+  if(mNumFree not_eq mChunks.size() * mBlocksPerChunk)
+  {
+    return;
+  }
+
+  AlignedAllocator<uint8_t> allocator(mAlignment);
+
+  for(uint8_t* const chunk : mChunks)
+  {
+    allocator.deallocate(chunk, mBlocksPerChunk * mBlockSize);
+  }
+}
+
+void*
+so::utils::mem::FixedSizePool::allocate()
+{
+  return allocateBatch(1);
+}
+
+void
+so::utils::mem::FixedSizePool::deallocate(void* const block) noexcept
+{
+  auto const freeBlock{ static_cast<FreeBlock*>(block) };
+
+  deallocateBatch(freeBlock, freeBlock, 1);
+}
+
+so::utils::mem::FixedSizePool::FreeBlock*
+so::utils::mem::FixedSizePool::allocateBatch(std::size_t const count)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+
+  while(mNumFree < count)
+  {
+    addChunk();
+  }
+
+  FreeBlock* const head{ mFreeList };
+  FreeBlock*       tail{ head };
+
+  for(std::size_t i{ 1 }; i < count; ++i)
+  {
+    tail = tail->next;
+  }
+
+  mFreeList  = tail->next;
+  tail->next = nullptr;
+  mNumFree  -= count;
+
+  mHighWaterMark = std::max(mHighWaterMark,
+                            mChunks.size() * mBlocksPerChunk - mNumFree);
+
+  return head;
+}
+
+void
+so::utils::mem::FixedSizePool::deallocateBatch
+  (FreeBlock*  const head,
+   FreeBlock*  const tail,
+   std::size_t const count) noexcept
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+
+  tail->next = mFreeList;
+  mFreeList  = head;
+  mNumFree  += count;
+}
+
+so::utils::mem::PoolStatistics
+so::utils::mem::FixedSizePool::getStatistics() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+
+  PoolStatistics statistics;
+
+  statistics.blockSize     = mBlockSize;
+  statistics.numChunks     = mChunks.size();
+  statistics.numBlocks     = mChunks.size() * mBlocksPerChunk;
+  statistics.numUsed       = statistics.numBlocks - mNumFree;
+  statistics.highWaterMark = mHighWaterMark;
+
+  return statistics;
+}
+
+void
+so::utils::mem::FixedSizePool::addChunk()
+{
+  // Grows the list first, so a throwing push_back cannot leak the chunk.
+  // Chunks are added one at a time, hence the doubling.
+  if(mChunks.size() is_eq mChunks.capacity())
+  {
+    mChunks.reserve(std::max<std::size_t>(2 * mChunks.size(), 8));
+  }
+
+  uint8_t* const chunk
+    { AlignedAllocator<uint8_t>(mAlignment).allocate(mBlocksPerChunk *
+                                                     mBlockSize) };
+
+  mChunks.push_back(chunk);
+
+  // Thread the blocks in address order, so they are handed out that way.
+  for(std::size_t i{ mBlocksPerChunk }; i > 0; --i)
+  {
+    auto const block{ reinterpret_cast<FreeBlock*>(chunk +
+                                                   (i - 1) * mBlockSize) };
+
+    block->next = mFreeList;
+    mFreeList   = block;
+  }
+
+  mNumFree += mBlocksPerChunk;
+}
+
+so::utils::mem::PoolThreadCache::PoolThreadCache(FixedSizePool& pool,
+                                                 bool& isDestroyed) noexcept
+  : mPool(pool),
+    mIsDestroyed(isDestroyed),
+    mHead(nullptr),
+    mCount(0)
+{}
+
+so::utils::mem::PoolThreadCache::~PoolThreadCache() noexcept
+{
+  trim(0);
+
+  mIsDestroyed = true;
+}
+
+void*
+so::utils::mem::PoolThreadCache::allocate()
+{
+  if(mHead is_eq nullptr)
+  {
+    mHead  = mPool.allocateBatch(batchSize);
+    mCount = batchSize;
+  }
+
+  FixedSizePool::FreeBlock* const block{ mHead };
+
+  mHead = block->next;
+  --mCount;
+
+  return block;
+}
+
+void
+so::utils::mem::PoolThreadCache::deallocate(void* const block) noexcept
+{
+  auto const freeBlock{ static_cast<FixedSizePool::FreeBlock*>(block) };
+
+  freeBlock->next = mHead;
+  mHead           = freeBlock;
+  ++mCount;
+
+  // Keep a batch for the next allocations and return the rest, so a thread
+  // that only frees does not hoard blocks.
+  if(mCount >= 2 * batchSize)
+  {
+    trim(batchSize);
+  }
+}
+
+void
+so::utils::mem::PoolThreadCache::trim(std::size_t const count) noexcept
+{
+  if(mCount <= count)
+  {
+    return;
+  }
+
+  FixedSizePool::FreeBlock* kept{ nullptr };
+
+  for(std::size_t i{ 0 }; i < count; ++i)
+  {
+    FixedSizePool::FreeBlock* const block{ mHead };
+
+    mHead       = block->next;
+    block->next = kept;
+    kept        = block;
+  }
+
+  FixedSizePool::FreeBlock* tail{ mHead };
+
+  while(tail->next not_eq nullptr)
+  {
+    tail = tail->next;
+  }
+
+  mPool.deallocateBatch(mHead, tail, mCount - count);
+
+  mHead  = kept;
+  mCount = count;
+}
@@ -0,0 +1,338 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      cxx/soPoolAllocator.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "soAlignedAllocator.hpp"
+#include "soDefinitions.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace so {
+namespace utils {
+namespace mem {
+
+struct
+PoolStatistics
+{
+  std::size_t blockSize{ 0 };
+  std::size_t numChunks{ 0 };
+  std::size_t numBlocks{ 0 };
+
+  // Blocks handed out, including those held by thread caches.
+  std::size_t numUsed{ 0 };
+  std::size_t highWaterMark{ 0 };
+};
+
+/**
+ * @brief Thread safe pool of equally sized blocks.
+ *
+ * Blocks are carved from 64 KiB chunks, so objects of a kind lie next to
+ * each other, and kept in a free list once returned. Chunks are only given
+ * back to the system when the pool is destroyed with no block in use; a
+ * pool that still has blocks in use at that point leaves its chunks to the
+ * objects in them.
+ */
+class
+FixedSizePool
+{
+  public:
+    struct
+    FreeBlock
+    {
+      FreeBlock* next;
+    };
+
+    static constexpr std::size_t chunkSize{ std::size_t{ 64 } << 10 };
+
+    FixedSizePool(std::size_t const blockSize, std::size_t const alignment);
+
+    FixedSizePool(FixedSizePool const& other) = delete;
+
+    FixedSizePool(FixedSizePool&& other) = delete;
+
+    ~FixedSizePool() noexcept;
+
+    FixedSizePool&
+    operator=(FixedSizePool const& other) = delete;
+
+    FixedSizePool&
+    operator=(FixedSizePool&& other) = delete;
+
+    /**
+     * @brief Throws std::bad_alloc if no chunk can be allocated.
+     */
+    void*
+    allocate();
+
+    void
+    deallocate(void* const block) noexcept;
+
+    /**
+     * @brief Takes count blocks with a single lock and returns them as a
+     *        list.
+     */
+    FreeBlock*
+    allocateBatch(std::size_t const count);
+
+    /**
+     * @brief Returns the count blocks of the list from head to tail.
+     */
+    void
+    deallocateBatch(FreeBlock*  const head,
+                    FreeBlock*  const tail,
+                    std::size_t const count) noexcept;
+
+    PoolStatistics
+    getStatistics() const;
+
+  private:
+    mutable std::mutex    mMutex;
+
+    FreeBlock*            mFreeList;
+
+    std::vector<uint8_t*> mChunks;
+
+    std::size_t           mBlockSize;
+    std::size_t           mAlignment;
+    std::size_t           mBlocksPerChunk;
+
+    std::size_t           mNumFree;
+    std::size_t           mHighWaterMark;
+
+    void
+    addChunk();
+};
+
+/**
+ * @brief Blocks of a FixedSizePool kept by one thread, so allocations only
+ *        take the pool's lock once per batch.
+ *
+ * Destroying the cache, e.g. when its thread exits, returns its blocks and
+ * sets isDestroyed, after which the thread uses the pool directly.
+ */
+class
+PoolThreadCache
+{
+  public:
+    static constexpr std::size_t batchSize{ 32 };
+
+    PoolThreadCache(FixedSizePool& pool, bool& isDestroyed) noexcept;
+
+    PoolThreadCache(PoolThreadCache const& other) = delete;
+
+    PoolThreadCache(PoolThreadCache&& other) = delete;
+
+    ~PoolThreadCache() noexcept;
+
+    PoolThreadCache&
+    operator=(PoolThreadCache const& other) = delete;
+
+    PoolThreadCache&
+    operator=(PoolThreadCache&& other) = delete;
+
+    void*
+    allocate();
+
+    void
+    deallocate(void* const block) noexcept;
+
+  private:
+    FixedSizePool&            mPool;
+
+    bool&                     mIsDestroyed;
+
+    FixedSizePool::FreeBlock* mHead;
+
+    std::size_t               mCount;
+
+    /**
+     * @brief Returns all but the first count blocks to the pool.
+     */
+    void
+    trim(std::size_t const count) noexcept;
+};
+
+namespace internal {
+
+/*
+ * The pool and caches of one block size and alignment, shared by all types
+ * of that size.
+ */
+template <std::size_t Size, std::size_t Alignment>
+struct
+PoolStorage
+{
+  static FixedSizePool&
+  getPool()
+  {
+    static FixedSizePool pool(Size, Alignment);
+
+    return pool;
+  }
+
+  static bool&
+  isCacheDestroyed()
+  {
+    thread_local bool isDestroyed{ false };
+
+    return isDestroyed;
+  }
+
+  static PoolThreadCache&
+  getCache()
+  {
+    thread_local PoolThreadCache cache(getPool(), isCacheDestroyed());
+
+    return cache;
+  }
+
+  static void*
+  allocate()
+  {
+    if(isCacheDestroyed())
+    {
+      return getPool().allocate();
+    }
+
+    return getCache().allocate();
+  }
+
+  static void
+  deallocate(void* const block) noexcept
+  {
+    if(isCacheDestroyed())
+    {
+      getPool().deallocate(block);
+
+      return;
+    }
+
+    getCache().deallocate(block);
+  }
+};
+
+} // namespace internal
+
+/**
+ * @brief Allocates single objects from a FixedSizePool per size and
+ *        alignment, arrays from an AlignedAllocator.
+ *
+ * Used with std::allocate_shared, the object and its control block share
+ * one block, see makePooledShared.
+ */
+template <typename T>
+class
+PoolAllocator
+{
+  public:
+    using value_type = T;
+
+    PoolAllocator() noexcept = default;
+
+    template <typename U>
+    PoolAllocator(PoolAllocator<U> const&) noexcept
+    {}
+
+    T*
+    allocate(std::size_t const n)
+    {
+      if(n is_eq 1)
+      {
+        return static_cast<T*>
+          (internal::PoolStorage<sizeof(T), alignof(T)>::allocate());
+      }
+
+      return AlignedAllocator<T>(alignof(T)).allocate(n);
+    }
+
+    void
+    deallocate(T* const p, std::size_t const n) noexcept
+    {
+      if(n is_eq 1)
+      {
+        internal::PoolStorage<sizeof(T), alignof(T)>::deallocate(p);
+
+        return;
+      }
+
+      AlignedAllocator<T>(alignof(T)).deallocate(p, n);
+    }
+};
+
+template <typename T, typename U>
+inline bool
+operator==(PoolAllocator<T> const&, PoolAllocator<U> const&) noexcept
+{ return true; }
+
+template <typename T, typename U>
+inline bool
+operator!=(PoolAllocator<T> const&, PoolAllocator<U> const&) noexcept
+{ return false; }
+
+/**
+ * @brief std::make_shared with the object and its control block in a pool.
+ */
+template <typename T, typename... Args>
+inline std::shared_ptr<T>
+makePooledShared(Args&&... args)
+{
+  return std::allocate_shared<T>(PoolAllocator<T>(),
+                                 std::forward<Args>(args)...);
+}
+
+} // namespace mem
+} // namespace utils
+} // namespace so
@@ -0,0 +1,252 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "soProfiler.hpp"
+
+#include "soAtomic.hpp"
+#include "soDebugCallback.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct
+ProfileRecord
+{
+  so::ProfileZoneSite const* site;
+  uint64_t                   begin;
+  uint64_t                   end;
+};
+
+// 64k zones, 1.5 MiB per thread.
+constexpr uint64_t bufferCapacity{ uint64_t{ 1 } << 16 };
+
+struct
+ThreadBuffer
+{
+  std::unique_ptr<ProfileRecord[]> records
+    { std::make_unique<ProfileRecord[]>(bufferCapacity) };
+
+  // Number of zones ever recorded. Only the owning thread writes it.
+  std::atomic<uint64_t> head{ 0 };
+
+  uint32_t    threadId{ 0 };
+
+  // Guarded by Registry::mutex.
+  std::string name;
+};
+
+// Buffers are never freed, so the zones of finished threads can still be
+// written.
+struct
+Registry
+{
+  std::mutex                                 mutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+  // Reference point of the calibration in writeProfileTrace.
+  uint64_t                              startTicks{ so::getProfileTicks() };
+  std::chrono::steady_clock::time_point startTime
+    { std::chrono::steady_clock::now() };
+};
+
+Registry&
+getRegistry()
+{
+  static Registry registry;
+
+  return registry;
+}
+
+thread_local ThreadBuffer* threadBuffer{ nullptr };
+
+ThreadBuffer&
+getThreadBuffer()
+{
+  if(threadBuffer is_eq nullptr)
+  {
+    Registry& registry{ getRegistry() };
+
+    std::lock_guard<std::mutex> lock{ registry.mutex };
+
+    registry.buffers.push_back(std::make_unique<ThreadBuffer>());
+
+    threadBuffer           = registry.buffers.back().get();
+    threadBuffer->threadId = static_cast<uint32_t>(registry.buffers.size());
+  }
+
+  return *threadBuffer;
+}
+
+void
+writeEscaped(std::ofstream& file, char const* string)
+{
+  for(; *string not_eq '\0'; ++string)
+  {
+    if(*string is_eq '"' or *string is_eq '\\')
+    {
+      file << '\\';
+    }
+
+    file << *string;
+  }
+}
+
+} // namespace
+
+void
+so::recordProfileZone(ProfileZoneSite const& site,
+                      uint64_t        const  begin,
+                      uint64_t        const  end) noexcept
+{
+  ThreadBuffer& buffer{ getThreadBuffer() };
+
+  uint64_t const head{ buffer.head.load(std::memory_order_relaxed) };
+
+  buffer.records[head bitand (bufferCapacity - 1)] = { &site, begin, end };
+
+  buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void
+so::setProfileThreadName(std::string const& name)
+{
+  ThreadBuffer& buffer{ getThreadBuffer() };
+
+  std::lock_guard<std::mutex> lock{ getRegistry().mutex };
+
+  buffer.name = name;
+}
+
+so::return_t
+so::writeProfileTrace(std::string const& filename)
+{
+  Registry& registry{ getRegistry() };
+
+  // Calibrate the profiling clock over the whole run, which makes the
+  // error of the two clock reads negligible.
+  uint64_t const ticks{ getProfileTicks() };
+
+  std::chrono::duration<double, std::micro> const elapsed
+    { std::chrono::steady_clock::now() - registry.startTime };
+
+  double const ticksPerMicrosecond
+    { elapsed.count() > 0.0
+        ? static_cast<double>(ticks - registry.startTicks) / elapsed.count()
+        : 1.0 };
+
+  std::ofstream file(filename, std::ios::trunc);
+
+  if(not file)
+  {
+    DEBUG_CALLBACK(error, "Failed to open " + filename + " for writing.");
+
+    return failure;
+  }
+
+  file << std::fixed << std::setprecision(3);
+
+  file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+  char const* separator{ "\n" };
+
+  std::vector<ProfileRecord> records;
+
+  std::lock_guard<std::mutex> lock{ registry.mutex };
+
+  for(auto const& buffer : registry.buffers)
+  {
+    if(not buffer->name.empty())
+    {
+      file << separator
+           << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":"
+           << buffer->threadId << ",\"args\":{\"name\":\"";
+      writeEscaped(file, buffer->name.c_str());
+      file << "\"}}";
+
+      separator = ",\n";
+    }
+
+    uint64_t const head{ buffer->head.load(std::memory_order_acquire) };
+    uint64_t const first{ head - std::min(head, bufferCapacity) };
+
+    records.clear();
+
+    for(uint64_t i{ first }; i < head; ++i)
+    {
+      records.push_back(buffer->records[i bitand (bufferCapacity - 1)]);
+    }
+
+    // Records the owner wrapped around to while they were copied may be
+    // torn, so only keep the ones it cannot have reached.
+    so::threadFence(std::memory_order_acquire);
+
+    uint64_t const newHead
+      { buffer->head.load(so::fencedOrder(std::memory_order_relaxed)) };
+    uint64_t const firstValid{ newHead >= bufferCapacity
+                                 ? newHead - bufferCapacity + 1
+                                 : 0 };
+
+    for(uint64_t i{ std::max(first, firstValid) }; i < head; ++i)
+    {
+      ProfileRecord const& record{ records[i - first] };
+
+      // Zones may have begun before the registry was created.
+      double const begin
+        { static_cast<double>(static_cast<int64_t>(record.begin -
+                                                   registry.startTicks)) /
+          ticksPerMicrosecond };
+      double const duration
+        { static_cast<double>(record.end - record.begin) /
+          ticksPerMicrosecond };
+
+      file << separator << "{\"ph\":\"X\",\"name\":\"";
+      writeEscaped(file, record.site->name);
+      file << "\",\"pid\":1,\"tid\":" << buffer->threadId
+           << ",\"ts\":" << begin
+           << ",\"dur\":" << duration
+           << ",\"args\":{\"file\":\"";
+      writeEscaped(file, record.site->file);
+      file << "\",\"line\":" << record.site->line << "}}";
+
+      separator = ",\n";
+    }
+  }
+
+  file << "\n]}\n";
+
+  if(not file)
+  {
+    DEBUG_CALLBACK(error, "Failed to write the profile trace " + filename);
+
+    return failure;
+  }
+
+  return success;
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      cxx/soProfiler.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "soDefinitions.hpp"
+#include "soReturnT.hpp"
+
+#include <chrono>
+#include <string>
+
+#if defined(__x86_64__) or defined(__i386__)
+
+#include <x86intrin.h>
+
+#endif
+
+namespace so {
+
+/**
+ * @brief Static description of a profiling zone, one per SO_PROFILE_ZONE.
+ */
+struct
+ProfileZoneSite
+{
+  char const* name;
+  char const* file;
+  uint32_t    line;
+};
+
+/**
+ * @brief Current value of the profiling clock.
+ *
+ * This is the time stamp counter where available, which is assumed to be
+ * invariant, i.e. to tick at a constant rate across cores and power states.
+ * writeProfileTrace calibrates it against std::chrono::steady_clock.
+ */
+inline uint64_t
+getProfileTicks() noexcept
+{
+#if defined(__x86_64__) or defined(__i386__)
+
+  return __rdtsc();
+
+#else
+
+  return static_cast<uint64_t>
+           (std::chrono::duration_cast<std::chrono::nanoseconds>
+              (std::chrono::steady_clock::now().time_since_epoch()).count());
+
+#endif
+}
+
+/**
+ * @brief Appends a finished zone to the ring buffer of the calling thread.
+ *
+ * Each thread owns its buffer, so recording takes no lock. Once a buffer is
+ * full, the oldest zones are overwritten.
+ */
+void
+recordProfileZone(ProfileZoneSite const& site,
+                  uint64_t        const  begin,
+                  uint64_t        const  end) noexcept;
+
+/**
+ * @brief Names the calling thread in written traces.
+ */
+void
+setProfileThreadName(std::string const& name);
+
+/**
+ * @brief Writes the zones currently held by all threads as Chrome trace
+ *        event JSON, which chrome://tracing and Perfetto can open.
+ *
+ * May be called while other threads keep recording. Zones overwritten while
+ * being collected are left out.
+ */
+return_t
+writeProfileTrace(std::string const& filename);
+
+class
+ProfileZone
+{
+  public:
+    explicit ProfileZone(ProfileZoneSite const& site) noexcept
+      : mSite(site),
+        mBegin(getProfileTicks())
+    {}
+
+    ProfileZone(ProfileZone const& other) = delete;
+
+    ProfileZone(ProfileZone&& other) = delete;
+
+    ~ProfileZone() noexcept
+    { recordProfileZone(mSite, mBegin, getProfileTicks()); }
+
+    ProfileZone&
+    operator=(ProfileZone const& other) = delete;
+
+    ProfileZone&
+    operator=(ProfileZone&& other) = delete;
+
+  private:
+    ProfileZoneSite const& mSite;
+    uint64_t               mBegin;
+};
+
+} // namespace so
+
+#define SO_PROFILE_CONCAT_IMPL(a, b) a##b
+
+#define SO_PROFILE_CONCAT(a, b) SO_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef SO_PROFILING
+
+/**
+ * @brief Profiles the rest of the enclosing scope as a zone called name,
+ *        which has to be a string literal.
+ */
+#define SO_PROFILE_ZONE(name)                                                \
+  static constexpr so::ProfileZoneSite                                       \
+    SO_PROFILE_CONCAT(soProfileZoneSite, __LINE__){ name,                    \
+                                                    __FILE__,                \
+                                                    __LINE__ };              \
+  so::ProfileZone const                                                      \
+    SO_PROFILE_CONCAT(soProfileZone, __LINE__)                               \
+      { SO_PROFILE_CONCAT(soProfileZoneSite, __LINE__) }
+
+#else
+
+#define SO_PROFILE_ZONE(name) static_cast<void>(0)
+
+#endif // SO_PROFILING
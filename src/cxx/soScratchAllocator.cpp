@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "soScratchAllocator.hpp"
+
+namespace {
+
+std::size_t const scratchBlockSize{ std::size_t{ 256 } << 10 };
+
+so::utils::mem::Arena&
+getThreadArena()
+{
+  thread_local so::utils::mem::Arena arena{ scratchBlockSize };
+
+  return arena;
+}
+
+} // namespace
+
+so::utils::mem::ScratchScope::ScratchScope()
+  : mArena(getThreadArena()),
+    mMarker(mArena.getMarker()),
+    mResource(mArena)
+{}
+
+so::utils::mem::ScratchScope::~ScratchScope() noexcept
+{
+  bool const isOutermost{ mMarker.block      is_eq 0 and
+                          mMarker.offset     is_eq 0 and
+                          mMarker.usedBefore is_eq 0 };
+
+  if(isOutermost)
+  {
+    mArena.reset();
+  }
+  else
+  {
+    mArena.rewind(mMarker);
+  }
+}
+
+so::utils::mem::ArenaStatistics const&
+so::utils::mem::ScratchScope::getThreadStatistics()
+{
+  return getThreadArena().getStatistics();
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      cxx/soScratchAllocator.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "soArena.hpp"
+
+#include <memory_resource>
+
+namespace so {
+namespace utils {
+namespace mem {
+
+/**
+ * @brief Temporary memory from a stack owned by the calling thread.
+ *
+ * A scope marks the top of the thread's scratch Arena and frees everything
+ * allocated through it when it is destroyed. Scopes nest and have to be
+ * destroyed on the thread that created them, in reverse order, so they are
+ * meant to live on the stack, declared before the containers using them:
+ *
+ *     ScratchScope scratch;
+ *
+ *     std::pmr::vector<uint32_t> indices{ scratch.getResource() };
+ *
+ * Once the outermost scope closes the arena is reset, merging its blocks, so
+ * a thread's scratch memory settles into a single block.
+ */
+class
+ScratchScope
+{
+  public:
+    ScratchScope();
+
+    ScratchScope(ScratchScope const& other) = delete;
+
+    ScratchScope(ScratchScope&& other) = delete;
+
+    ~ScratchScope() noexcept;
+
+    ScratchScope&
+    operator=(ScratchScope const& other) = delete;
+
+    ScratchScope&
+    operator=(ScratchScope&& other) = delete;
+
+    inline void*
+    allocate(std::size_t const size,
+             std::size_t const alignment = alignof(std::max_align_t))
+    { return mArena.allocate(size, alignment); }
+
+    inline std::pmr::memory_resource* getResource() { return &mResource; }
+
+    /**
+     * @brief Usage of the scratch arena of the calling thread.
+     */
+    static ArenaStatistics const&
+    getThreadStatistics();
+
+  private:
+    Arena&        mArena;
+    Arena::Marker mMarker;
+    ArenaResource mResource;
+};
+
+} // namespace mem
+} // namespace utils
+} // namespace so
@@ -99,6 +99,15 @@ so::base::Surface::getWindowSize(size_type& width, size_type& height)
   height = static_cast<size_type>(iHeight);
 }
 
+void
+so::base::Surface::setWindowSize(size_type const width,
+                                 size_type const height)
+{
+  glfwSetWindowSize(mWindow,
+                    static_cast<int>(width),
+                    static_cast<int>(height));
+}
+
 void
 so::base::Surface::deleteMembers()
 {
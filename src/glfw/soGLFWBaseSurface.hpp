@@ -87,6 +87,9 @@ Surface
     void
     getWindowSize(size_type& width, size_type& height);
 
+    void
+    setWindowSize(size_type const width, size_type const height);
+
     inline
     void setFrameBuffersAreResized(bool const areResized)
     {
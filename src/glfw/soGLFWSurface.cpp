@@ -105,6 +105,20 @@ soGLFWSurfaceGetWindowSize(void*          surface,
 bool
 soGLFWSurfaceFramebuffersAreResized(void* surface)
 {
-  return static_cast<so::base::Surface*>(surface)->framebuffersAreResized();
+  auto baseSurface{ static_cast<so::base::Surface*>(surface) };
+
+  bool const areResized{ baseSurface->framebuffersAreResized() };
+
+  baseSurface->setFrameBuffersAreResized(false);
+
+  return areResized;
+}
+
+void
+soGLFWSurfaceSetWindowSize(void*               surface,
+                           so::size_type const width,
+                           so::size_type const height)
+{
+  static_cast<so::vk::GLFWSurface*>(surface)->setWindowSize(width, height);
 }
 
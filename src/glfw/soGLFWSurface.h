@@ -98,6 +98,11 @@ soGLFWSurfaceGetWindowSize(void*          surface,
 bool
 soGLFWSurfaceFramebuffersAreResized(void* surface);
 
+void
+soGLFWSurfaceSetWindowSize(void*               surface,
+                           so::size_type const width,
+                           so::size_type const height);
+
 #ifdef __cplusplus
 
 } // extern "C"
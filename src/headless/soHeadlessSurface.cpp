@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "soHeadlessSurface.h"
+
+#include "soVkHeadlessSurface.hpp"
+
+so::return_t
+soVkHeadlessSurfaceInitialize(void** surface)
+{
+  auto tmpSurfacePtr{ new so::vk::HeadlessSurface() };
+
+  if(tmpSurfacePtr->initialize() is_eq failure)
+  {
+    delete tmpSurfacePtr;
+
+    *surface = nullptr;
+
+    return failure;
+  }
+
+  *surface = tmpSurfacePtr;
+
+  return success;
+}
+
+void
+soVkHeadlessSurfaceTerminate(void* surface)
+{
+  delete static_cast<so::vk::HeadlessSurface*>(surface);
+}
+
+so::return_t
+soVkHeadlessGetInstanceExtensions(void const*    surface,
+                                  char const***  extensions,
+                                  so::size_type* count)
+{
+  return static_cast<so::vk::HeadlessSurface const*>
+           (surface)->getInstanceExtensions(extensions, count);
+}
+
+so::return_t
+soVkHeadlessSurfaceCreateWindow(void*                surface,
+                                std::string   const& title,
+                                so::size_type const  width,
+                                so::size_type const  height)
+{
+  return static_cast<so::vk::HeadlessSurface*>(surface)->createWindow(title,
+                                                                      width,
+                                                                      height);
+}
+
+so::return_t
+soVkHeadlessSurfaceCreateSurface(void* surface, VkInstance instance)
+{
+  return static_cast<so::vk::HeadlessSurface*>
+           (surface)->createSurface(instance);
+}
+
+VkSurfaceKHR
+soVkHeadlessSurfaceGetVkSurfaceKHR(void const* surface)
+{
+  return static_cast<so::vk::HeadlessSurface const*>
+           (surface)->getVkSurfaceKHR();
+}
+
+bool
+soVkHeadlessSurfaceWindowIsClosed(void* surface)
+{
+  return static_cast<so::vk::HeadlessSurface*>(surface)->windowIsClosed();
+}
+
+void
+soVkHeadlessSurfacePollEvents()
+{
+  // There are no events without a window.
+}
+
+void
+soHeadlessSurfaceGetWindowSize(void*          surface,
+                               so::size_type* width,
+                               so::size_type* height)
+{
+  static_cast<so::vk::HeadlessSurface*>(surface)->getWindowSize(*width,
+                                                                *height);
+}
+
+bool
+soHeadlessSurfaceFramebuffersAreResized(void* surface)
+{
+  return static_cast<so::vk::HeadlessSurface*>
+           (surface)->framebuffersAreResized();
+}
+
+void
+soHeadlessSurfaceSetWindowSize(void*               surface,
+                               so::size_type const width,
+                               so::size_type const height)
+{
+  static_cast<so::vk::HeadlessSurface*>(surface)->setWindowSize(width,
+                                                                height);
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "soVkHeadlessSurface.hpp"
+
+#include <cstdlib>
+
+namespace {
+
+char const* instanceExtensions[]{ VK_KHR_SURFACE_EXTENSION_NAME,
+                                  VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME };
+
+} // namespace
+
+so::vk::HeadlessSurface::HeadlessSurface()
+  : mSurface(VK_NULL_HANDLE),
+    mInstance(VK_NULL_HANDLE),
+    mWidth(0),
+    mHeight(0),
+    mFramebuffersResized(false),
+    mFrameLimit(0),
+    mFrameCount(0)
+{}
+
+so::vk::HeadlessSurface::~HeadlessSurface() noexcept { deleteMembers(); }
+
+so::vk::HeadlessSurface&
+so::vk::HeadlessSurface::operator=(HeadlessSurface&& other) noexcept
+{
+  if(this is_eq &other)
+  {
+    return *this;
+  }
+
+  deleteMembers();
+
+  mSurface             = other.mSurface;
+  mInstance            = other.mInstance;
+  mWidth               = other.mWidth;
+  mHeight              = other.mHeight;
+  mFramebuffersResized = other.mFramebuffersResized;
+  mFrameLimit          = other.mFrameLimit;
+  mFrameCount          = other.mFrameCount;
+
+  other.mSurface             = VK_NULL_HANDLE;
+  other.mInstance            = VK_NULL_HANDLE;
+  other.mWidth               = 0;
+  other.mHeight              = 0;
+  other.mFramebuffersResized = false;
+  other.mFrameLimit          = 0;
+  other.mFrameCount          = 0;
+
+  return *this;
+}
+
+so::return_t
+so::vk::HeadlessSurface::initialize()
+{
+  char const* const frameLimit{ std::getenv("SO_HEADLESS_FRAMES") };
+
+  mFrameLimit = frameLimit is_eq nullptr
+                  ? 0
+                  : std::strtoull(frameLimit, nullptr, 10);
+
+  mFrameCount = 0;
+
+  return success;
+}
+
+so::return_t
+so::vk::HeadlessSurface::getInstanceExtensions(char const*** extensions,
+                                               size_type*    count) const
+{
+  *extensions = instanceExtensions;
+  *count      = sizeof(instanceExtensions) / sizeof(instanceExtensions[0]);
+
+  return success;
+}
+
+so::return_t
+so::vk::HeadlessSurface::createWindow(std::string const& title,
+                                      size_type   const  width,
+                                      size_type   const  height)
+{
+  (void) title;
+
+  mWidth  = width;
+  mHeight = height;
+
+  return success;
+}
+
+so::return_t
+so::vk::HeadlessSurface::createSurface(VkInstance instance)
+{
+  auto const createHeadlessSurface
+    { reinterpret_cast<PFN_vkCreateHeadlessSurfaceEXT>
+        (vkGetInstanceProcAddr(instance, "vkCreateHeadlessSurfaceEXT")) };
+
+  if(createHeadlessSurface is_eq nullptr)
+  {
+    return failure;
+  }
+
+  VkHeadlessSurfaceCreateInfoEXT createInfo{};
+
+  createInfo.sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT;
+
+  VkResult const result{ createHeadlessSurface(instance,
+                                               &createInfo,
+                                               nullptr,
+                                               &mSurface) };
+
+  if(result not_eq VK_SUCCESS)
+  {
+    mSurface = VK_NULL_HANDLE;
+
+    return failure;
+  }
+
+  mInstance = instance;
+
+  return success;
+}
+
+bool
+so::vk::HeadlessSurface::windowIsClosed()
+{
+  if((mFrameLimit > 0) and (mFrameCount >= mFrameLimit))
+  {
+    return true;
+  }
+
+  ++mFrameCount;
+
+  return false;
+}
+
+void
+so::vk::HeadlessSurface::getWindowSize(size_type& width,
+                                       size_type& height) const
+{
+  width  = mWidth;
+  height = mHeight;
+}
+
+void
+so::vk::HeadlessSurface::setWindowSize(size_type const width,
+                                       size_type const height)
+{
+  // Keep an earlier resize that has not been consumed yet.
+  mFramebuffersResized = mFramebuffersResized      or
+                         (width  not_eq mWidth)    or
+                         (height not_eq mHeight);
+
+  mWidth  = width;
+  mHeight = height;
+}
+
+bool
+so::vk::HeadlessSurface::framebuffersAreResized()
+{
+  bool const areResized{ mFramebuffersResized };
+
+  mFramebuffersResized = false;
+
+  return areResized;
+}
+
+void
+so::vk::HeadlessSurface::deleteMembers()
+{
+  if((mSurface not_eq VK_NULL_HANDLE) and (mInstance not_eq VK_NULL_HANDLE))
+  {
+    vkDestroySurfaceKHR(mInstance, mSurface, nullptr);
+  }
+
+  mSurface  = VK_NULL_HANDLE;
+  mInstance = VK_NULL_HANDLE;
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      soVkHeadlessSurface.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "soDefinitions.hpp"
+#include "soReturnT.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <string>
+
+namespace so {
+namespace vk {
+
+/**
+ * @brief Surface provider without a window, based on VK_EXT_headless_surface.
+ *
+ * The swap chain images are ordinary device local images that are never
+ * shown; read them back with so::Engine::captureFrame. Works with software
+ * implementations like lavapipe, so the render loop runs on machines
+ * without a display.
+ *
+ * If SO_HEADLESS_FRAMES is set to N > 0, the "window" closes after N frames,
+ * i.e. windowIsClosed returns true from its N + 1st call on.
+ */
+class
+HeadlessSurface
+{
+  public:
+    HeadlessSurface();
+
+    HeadlessSurface(HeadlessSurface const& other) = delete;
+
+    HeadlessSurface(HeadlessSurface&& other) = delete;
+
+    ~HeadlessSurface() noexcept;
+
+    HeadlessSurface&
+    operator=(HeadlessSurface const& other) = delete;
+
+    HeadlessSurface&
+    operator=(HeadlessSurface&& other) noexcept;
+
+    return_t
+    initialize();
+
+    return_t
+    getInstanceExtensions(char const*** extensions, size_type* count) const;
+
+    return_t
+    createWindow(std::string const& title,
+                 size_type   const  width,
+                 size_type   const  height);
+
+    return_t
+    createSurface(VkInstance instance);
+
+    inline VkSurfaceKHR getVkSurfaceKHR() const { return mSurface; }
+
+    bool
+    windowIsClosed();
+
+    void
+    getWindowSize(size_type& width, size_type& height) const;
+
+    void
+    setWindowSize(size_type const width, size_type const height);
+
+    /**
+     * @brief Whether setWindowSize was called since the last call.
+     */
+    bool
+    framebuffersAreResized();
+
+  private:
+    VkSurfaceKHR mSurface;
+
+    VkInstance   mInstance;
+
+    size_type    mWidth;
+    size_type    mHeight;
+
+    bool         mFramebuffersResized;
+
+    uint64_t     mFrameLimit;
+    uint64_t     mFrameCount;
+
+    void
+    deleteMembers();
+
+}; // class HeadlessSurface
+
+} // namespace vk
+} // namespace so
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "soVkBuffer.hpp"
+
+#include "cxx/soDebugCallback.hpp"
+#include "cxx/soDefinitions.hpp"
+
+so::vk::Buffer::Buffer()
+  : mBuffer(VK_NULL_HANDLE),
+    mSize(0),
+    mAllocation(),
+    mAllocator(MemoryAllocator::getSharedPtrNullMemoryAllocator())
+{}
+
+so::vk::Buffer::~Buffer() noexcept
+{
+  destroyMembers();
+}
+
+so::vk::Buffer&
+so::vk::Buffer::operator=(Buffer&& other) noexcept
+{
+  if(this is_eq &other)
+  {
+    return *this;
+  }
+
+  destroyMembers();
+
+  mBuffer     = other.mBuffer;
+  mSize       = other.mSize;
+  mAllocation = other.mAllocation;
+  mAllocator  = other.mAllocator;
+
+  other.mBuffer     = VK_NULL_HANDLE;
+  other.mSize       = 0;
+  other.mAllocation = Allocation();
+  other.mAllocator  = MemoryAllocator::getSharedPtrNullMemoryAllocator();
+
+  return *this;
+}
+
+so::return_t
+so::vk::Buffer::initialize(SharedPtrMemoryAllocator const& allocator,
+                           VkDeviceSize             const  size,
+                           VkBufferUsageFlags       const  usage,
+                           AllocationInfo           const& allocationInfo)
+{
+  destroyMembers();
+
+  mAllocator = allocator;
+  mSize      = size;
+
+  VkDevice device{ mAllocator->getDevice()->getVkDevice() };
+
+  VkBufferCreateInfo bufferInfo{};
+
+  bufferInfo.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  bufferInfo.size        = size;
+  bufferInfo.usage       = usage;
+  bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+  if(vkCreateBuffer(device, &bufferInfo, nullptr, &mBuffer) not_eq VK_SUCCESS)
+  {
+    DEBUG_CALLBACK(error, "Failed to create a buffer.", vkCreateBuffer);
+
+    return failure;
+  }
+
+  VkMemoryRequirements requirements;
+
+  vkGetBufferMemoryRequirements(device, mBuffer, &requirements);
+
+  AllocationInfo linearInfo{ allocationInfo };
+
+  linearInfo.isLinear = true;
+
+  if(mAllocator->allocate(requirements, linearInfo, mAllocation) is_eq
+     failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to allocate memory for a buffer.",
+                   MemoryAllocator::allocate);
+
+    return failure;
+  }
+
+  if(vkBindBufferMemory(device,
+                        mBuffer,
+                        mAllocation.memory,
+                        mAllocation.offset) not_eq VK_SUCCESS)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to bind the memory of a buffer.",
+                   vkBindBufferMemory);
+
+    return failure;
+  }
+
+  return success;
+}
+
+void
+so::vk::Buffer::destroyMembers()
+{
+  VkDevice device{ mAllocator->getDevice()->getVkDevice() };
+
+  if((device not_eq VK_NULL_HANDLE) and (mBuffer not_eq VK_NULL_HANDLE))
+  {
+    vkDestroyBuffer(device, mBuffer, nullptr);
+  }
+
+  mAllocator->free(mAllocation);
+
+  mBuffer = VK_NULL_HANDLE;
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      soVkBuffer.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "soVkMemoryAllocator.hpp"
+
+namespace so {
+namespace vk {
+
+/**
+ * @brief A VkBuffer bound to memory of a so::vk::MemoryAllocator.
+ */
+class
+Buffer
+{
+  public:
+    Buffer();
+
+    Buffer(Buffer const& other) = delete;
+
+    Buffer(Buffer&& other) = delete;
+
+    ~Buffer() noexcept;
+
+    Buffer&
+    operator=(Buffer const& other) = delete;
+
+    Buffer&
+    operator=(Buffer&& other) noexcept;
+
+    return_t
+    initialize(SharedPtrMemoryAllocator const& allocator,
+               VkDeviceSize             const  size,
+               VkBufferUsageFlags       const  usage,
+               AllocationInfo           const& allocationInfo);
+
+    inline VkBuffer getVkBuffer() const { return mBuffer; }
+
+    inline VkDeviceSize getSize() const { return mSize; }
+
+    inline Allocation const& getAllocation() const { return mAllocation; }
+
+    /**
+     * @brief The buffer contents if its memory is host visible, nullptr
+     *        otherwise.
+     */
+    inline void* getMappedData() const { return mAllocation.mapped; }
+
+    inline return_t
+    flush(VkDeviceSize const offset = 0,
+          VkDeviceSize const size = VK_WHOLE_SIZE) const
+    { return mAllocator->flush(mAllocation, offset, size); }
+
+    inline return_t
+    invalidate(VkDeviceSize const offset = 0,
+               VkDeviceSize const size = VK_WHOLE_SIZE) const
+    { return mAllocator->invalidate(mAllocation, offset, size); }
+
+  private:
+    VkBuffer                 mBuffer;
+    VkDeviceSize             mSize;
+    Allocation               mAllocation;
+    SharedPtrMemoryAllocator mAllocator;
+
+    void
+    destroyMembers();
+};
+
+} // namespace vk
+} // namespace so
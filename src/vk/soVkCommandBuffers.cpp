@@ -24,11 +24,14 @@
 
 #include "cxx/soDebugCallback.hpp"
 #include "cxx/soDefinitions.hpp"
+#include "cxx/soPoolAllocator.hpp"
+
+#include <algorithm>
 
 so::vk::CommandBuffers::CommandBuffers()
   : mCommandBuffers(),
     mDevice(LogicalDevice::getSharedPtrNullDevice()),
-    mCommandPool(CommandPool::getSharedPtrNullCommandPool())
+    mCommandPools()
 {}
 
 so::vk::CommandBuffers::~CommandBuffers() noexcept
@@ -46,34 +49,26 @@ so::vk::CommandBuffers::operator=(CommandBuffers&& other) noexcept
           
   destroyMembers();
 
-  mCommandBuffers = other.mCommandBuffers;
+  mCommandBuffers = std::move(other.mCommandBuffers);
   mDevice         = other.mDevice;
-  mCommandPool    = other.mCommandPool;
+  mCommandPools   = std::move(other.mCommandPools);
  
   other.mCommandBuffers = std::vector<VkCommandBuffer>();
   other.mDevice         = LogicalDevice::getSharedPtrNullDevice();
-  other.mCommandPool    = CommandPool::getSharedPtrNullCommandPool();
+  other.mCommandPools   = std::vector<SharedPtrCommandPool>();
 
   return *this;
 }
 
 so::return_t
-so::vk::CommandBuffers::initialize(SharedPtrLogicalDevice const& device,
-                                   SharedPtrCommandPool   const& commandPool,
-                                   Framebuffers           const& framebuffers,
-                                   RenderPass             const& renderPass,
-                                   SwapChain              const& swapChain,
-                                   Pipeline               const& pipeline)
+so::vk::CommandBuffers::initialize
+  (SharedPtrLogicalDevice const& device,
+   Surface                const& surface,
+   size_type              const  numFramesInFlight)
 {
-  mDevice      = device;
-  mCommandPool = commandPool;
-
-  return_t result{ initializeMembers(framebuffers,
-                                     renderPass,
-                                     swapChain,
-                                     pipeline) };
+  mDevice = device;
 
-  if(result is_eq failure)
+  if(initializeMembers(surface, numFramesInFlight) is_eq failure)
   {
     DEBUG_CALLBACK(error,
                    "Failed to create a command buffer during initialization.",
@@ -86,23 +81,30 @@ so::vk::CommandBuffers::initialize(SharedPtrLogicalDevice const& device,
 }
 
 so::return_t
-so::vk::CommandBuffers::reset(Framebuffers const& framebuffers,
-                              RenderPass   const& renderPass,
-                              SwapChain    const& swapChain,
-                              Pipeline     const& pipeline)
+so::vk::CommandBuffers::begin(index_t const frame)
 {
-  destroyMembers();
+  auto const idx{ static_cast<size_type>(frame) };
+
+  if(mCommandPools[idx]->reset() is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to reset the command pool of a frame.",
+                   CommandPool::reset);
+
+    return failure;
+  }
+
+  VkCommandBufferBeginInfo beginInfo{};
 
-  return_t result{ initializeMembers(framebuffers,
-                                     renderPass,
-                                     swapChain,
-                                     pipeline) };
+  beginInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  beginInfo.pInheritanceInfo = nullptr;
 
-  if(result is_eq failure)
+  if(vkBeginCommandBuffer(mCommandBuffers[idx], &beginInfo) not_eq VK_SUCCESS)
   {
     DEBUG_CALLBACK(error,
-                   "Failed to create a command buffer while resetting.",
-                   CommandBuffers::initializeMembers);
+                   "Failed to begin recording a command buffer.",
+                   vkBeginCommandBuffer);
 
     return failure;
   }
@@ -111,96 +113,67 @@ so::vk::CommandBuffers::reset(Framebuffers const& framebuffers,
 }
 
 so::return_t
-so::vk::CommandBuffers::initializeMembers(Framebuffers const& framebuffers,
-                                          RenderPass   const& renderPass,
-                                          SwapChain    const& swapChain,
-                                          Pipeline     const& pipeline)
+so::vk::CommandBuffers::end(index_t const frame)
 {
-  auto&         vkFramebuffers{ framebuffers.getVkFramebuffersRef() };
-
-  VkCommandPool vkCommandPool{ mCommandPool->getVkCommandPool() };
-  VkDevice      vkDevice{ mDevice->getVkDevice() };
-  VkExtent2D    vkExtent{ swapChain.getVkExtent() };
-  VkPipeline    vkPipeline{ pipeline.getVkPipeline() };
-  VkRenderPass  vkRenderPass{ renderPass.getVkRenderPass() };
-    
-  mCommandBuffers.resize(vkFramebuffers.size());
-
-  VkCommandBufferAllocateInfo allocInfo{};
-
-  allocInfo.sType              =
-    VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-  allocInfo.commandPool        = vkCommandPool;
-  allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-  allocInfo.commandBufferCount = static_cast<uint32_t>(mCommandBuffers.size());
-
-  VkResult result{ vkAllocateCommandBuffers(vkDevice,
-                                            &allocInfo,
-                                            mCommandBuffers.data()) };
-  
-  if(result not_eq VK_SUCCESS)
+  VkCommandBuffer commandBuffer{ getVkCommandBuffer(frame) };
+
+  if(vkEndCommandBuffer(commandBuffer) not_eq VK_SUCCESS)
   {
     DEBUG_CALLBACK(error,
-                   "Failed to allocate command buffers.",
-                   vkAllocateCommandBuffers);
+                   "Failed to record command buffer.",
+                   vkEndCommandBuffer);
 
     return failure;
   }
 
-  auto begin{ mCommandBuffers.begin() };
-  auto end{ mCommandBuffers.end() };
+  return success;
+}
 
-  for(auto it{ begin }; it not_eq end; ++it)
+so::return_t
+so::vk::CommandBuffers::initializeMembers(Surface   const& surface,
+                                          size_type const  numFramesInFlight)
+{
+  VkDevice vkDevice{ mDevice->getVkDevice() };
+
+  mCommandPools.resize(numFramesInFlight);
+  mCommandBuffers.resize(numFramesInFlight, VK_NULL_HANDLE);
+
+  for(size_type i{ 0 }; i < numFramesInFlight; ++i)
   {
-    VkCommandBufferBeginInfo beginInfo{};
-    
-    beginInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.flags            = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
-    beginInfo.pInheritanceInfo = nullptr; // Optional
+    mCommandPools[i] = utils::mem::makePooledShared<CommandPool>();
 
-    if (vkBeginCommandBuffer(*it, &beginInfo) not_eq VK_SUCCESS)
+    return_t poolResult{ mCommandPools[i]->initialize
+                           (mDevice,
+                            surface,
+                            VK_COMMAND_POOL_CREATE_TRANSIENT_BIT) };
+
+    if(poolResult is_eq failure)
     {
       DEBUG_CALLBACK(error,
-                     "Failed to begin recording a command buffer.",
-                     vkBeginCommandBuffer);
-    
+                     "Failed to create a command pool.",
+                     CommandPool::initialize);
+
       return failure;
     }
 
-    auto const idx{ static_cast<std::size_t>(std::distance(begin, it)) };
-
-    VkRenderPassBeginInfo renderPassInfo{};
-
-    renderPassInfo.sType             =
-      VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass        = vkRenderPass;
-    renderPassInfo.framebuffer       = vkFramebuffers[idx];
-    renderPassInfo.renderArea.offset = { 0, 0 };
-    renderPassInfo.renderArea.extent = vkExtent;
-
-    VkClearValue clearColor{ 0.0f, 0.0f, 0.0f, 1.0f };
-
-    renderPassInfo.clearValueCount   = 1;
-    renderPassInfo.pClearValues      = &clearColor;
+    VkCommandBufferAllocateInfo allocInfo{};
 
-    vkCmdBeginRenderPass(*it,
-                         &renderPassInfo,
-                         VK_SUBPASS_CONTENTS_INLINE);
-    
-    vkCmdBindPipeline(*it,
-                      VK_PIPELINE_BIND_POINT_GRAPHICS,
-                      vkPipeline);
+    allocInfo.sType              =
+      VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool        = mCommandPools[i]->getVkCommandPool();
+    allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
 
-    vkCmdDraw(*it, 3, 1, 0, 0);
+    VkResult result{ vkAllocateCommandBuffers(vkDevice,
+                                              &allocInfo,
+                                              &mCommandBuffers[i]) };
 
-    vkCmdEndRenderPass(*it);
-
-    if(vkEndCommandBuffer(*it) not_eq VK_SUCCESS)
+    if(result not_eq VK_SUCCESS)
     {
       DEBUG_CALLBACK(error,
-                     "Failed to record command buffer.",
-                     vkEndCommandBuffer);
-    
+                     "Failed to allocate command buffers.",
+                     vkAllocateCommandBuffers);
+
       return failure;
     }
   }
@@ -211,25 +184,28 @@ so::vk::CommandBuffers::initializeMembers(Framebuffers const& framebuffers,
 void
 so::vk::CommandBuffers::destroyMembers()
 {
-  VkCommandPool commandPool(mCommandPool->getVkCommandPool());
-  VkDevice      device(mDevice->getVkDevice());
+  VkDevice device(mDevice->getVkDevice());
 
   if(device not_eq VK_NULL_HANDLE)
   {
-    if(commandPool not_eq VK_NULL_HANDLE)
+    auto const numBuffers{ std::min(mCommandPools.size(),
+                                    mCommandBuffers.size()) };
+
+    for(size_type i{ 0 }; i < numBuffers; ++i)
     {
-      if(not mCommandBuffers.empty())
+      VkCommandPool commandPool{ mCommandPools[i]->getVkCommandPool() };
+
+      if((commandPool not_eq VK_NULL_HANDLE) and
+         (mCommandBuffers[i] not_eq VK_NULL_HANDLE))
       {
-        vkFreeCommandBuffers(device,
-                             commandPool,
-                             static_cast<uint32_t>(mCommandBuffers.size()),
-                             mCommandBuffers.data());
-
-        std::fill(mCommandBuffers.begin(),
-                  mCommandBuffers.end(),
-                  static_cast<VkCommandBuffer>(VK_NULL_HANDLE)); 
+        vkFreeCommandBuffers(device, commandPool, 1, &mCommandBuffers[i]);
       }
     }
   }
-}
 
+  std::fill(mCommandBuffers.begin(),
+            mCommandBuffers.end(),
+            static_cast<VkCommandBuffer>(VK_NULL_HANDLE));
+
+  mCommandPools.clear();
+}
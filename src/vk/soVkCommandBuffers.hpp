@@ -55,7 +55,17 @@
 
 namespace so {
 namespace vk {
-   
+
+/**
+ * @brief One primary command buffer per frame in flight, each allocated from
+ *        its own transient command pool.
+ *
+ * Command buffers are re-recorded every frame. begin() resets the whole pool
+ * of a frame, which is much cheaper than freeing and reallocating the command
+ * buffers, so dynamic scenes can be recorded from scratch each frame. The
+ * caller has to make sure the previous submission of the frame has finished,
+ * e.g. by waiting on the frame's in-flight fence.
+ */
 class
 CommandBuffers
 {
@@ -76,31 +86,33 @@ CommandBuffers
 
     return_t
     initialize(SharedPtrLogicalDevice const& device,
-               SharedPtrCommandPool   const& commandPool,
-               Framebuffers           const& framebuffers,
-               RenderPass             const& renderPass,
-               SwapChain              const& swapChain,
-               Pipeline               const& pipeline);
+               Surface                const& surface,
+               size_type              const  numFramesInFlight);
 
+    /**
+     * @brief Resets the command pool of a frame and begins recording its
+     *        command buffer for one time submission.
+     */
     return_t
-    reset(Framebuffers const& framebuffers,
-          RenderPass   const& renderPass,
-          SwapChain    const& swapChain,
-          Pipeline     const& pipeline);
+    begin(index_t const frame);
+
+    return_t
+    end(index_t const frame);
+
+    inline VkCommandBuffer getVkCommandBuffer(index_t const frame)
+    { return mCommandBuffers[static_cast<size_type>(frame)]; }
 
     inline auto& getVkCommandBuffersRef() { return mCommandBuffers; }
 
   private:
-    std::vector<VkCommandBuffer> mCommandBuffers;
+    std::vector<VkCommandBuffer>      mCommandBuffers;
 
-    SharedPtrLogicalDevice       mDevice;
-    SharedPtrCommandPool         mCommandPool;
+    SharedPtrLogicalDevice            mDevice;
+    std::vector<SharedPtrCommandPool> mCommandPools;
 
     return_t
-    initializeMembers(Framebuffers const& framebuffers,
-                      RenderPass   const& renderPass,
-                      SwapChain    const& swapChain,
-                      Pipeline     const& pipeline);
+    initializeMembers(Surface   const& surface,
+                      size_type const  numFramesInFlight);
 
     void
     destroyMembers();
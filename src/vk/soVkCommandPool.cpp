@@ -26,11 +26,13 @@
 
 #include "cxx/soDebugCallback.hpp"
 #include "cxx/soDefinitions.hpp"
+#include "cxx/soPoolAllocator.hpp"
 
 so::vk::SharedPtrCommandPool const&
 so::vk::CommandPool::getSharedPtrNullCommandPool()
 {
-  static SharedPtrCommandPool commandPool{ std::make_shared<CommandPool>() };
+  static SharedPtrCommandPool commandPool
+    { utils::mem::makePooledShared<CommandPool>() };
 
   return commandPool;
 }
@@ -65,23 +67,33 @@ so::vk::CommandPool::operator=(CommandPool&& other) noexcept
 }
 
 so::return_t
-so::vk::CommandPool::initialize(SharedPtrLogicalDevice const& device,
-                                Surface                const& surface)
+so::vk::CommandPool::initialize(SharedPtrLogicalDevice   const& device,
+                                Surface                  const& surface,
+                                VkCommandPoolCreateFlags const  flags)
 {
-  mDevice = device;
-
-  auto vkPhysicalDevice{ mDevice->getVkPhysicalDevice() };
+  auto vkPhysicalDevice{ device->getVkPhysicalDevice() };
 
   QueueFamilyIndices queueFamilyIndices{ vkPhysicalDevice, surface };
 
   uint32_t graphicsFamily{ static_cast<uint32_t>
                              (queueFamilyIndices.getGraphicsFamily()) };
 
+  return initializeForQueueFamily(device, graphicsFamily, flags);
+}
+
+so::return_t
+so::vk::CommandPool::initializeForQueueFamily
+  (SharedPtrLogicalDevice   const& device,
+   uint32_t                 const  queueFamilyIndex,
+   VkCommandPoolCreateFlags const  flags)
+{
+  mDevice = device;
+
   VkCommandPoolCreateInfo poolInfo{};
 
   poolInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-  poolInfo.queueFamilyIndex = graphicsFamily;
-  poolInfo.flags            = 0; // Optional
+  poolInfo.queueFamilyIndex = queueFamilyIndex;
+  poolInfo.flags            = flags;
 
   auto vkDevice{ mDevice->getVkDevice() };
 
@@ -102,6 +114,23 @@ so::vk::CommandPool::initialize(SharedPtrLogicalDevice const& device,
   return success;
 }
 
+so::return_t
+so::vk::CommandPool::reset(VkCommandPoolResetFlags const flags)
+{
+  VkResult result{ vkResetCommandPool(mDevice->getVkDevice(),
+                                      mCommandPool,
+                                      flags) };
+
+  if(result not_eq VK_SUCCESS)
+  {
+    DEBUG_CALLBACK(error, "Failed to reset a command pool.", vkResetCommandPool);
+
+    return failure;
+  }
+
+  return success;
+}
+
 void
 so::vk::CommandPool::destroyMembers()
 {
@@ -81,8 +81,27 @@ CommandPool : public std::enable_shared_from_this<CommandPool>
 
     CommandPool& operator=(CommandPool&& other) noexcept; 
 
-		return_t
-		initialize(SharedPtrLogicalDevice const& device, Surface const& surface);
+    return_t
+    initialize(SharedPtrLogicalDevice   const& device,
+               Surface                  const& surface,
+               VkCommandPoolCreateFlags const  flags = 0);
+
+    /**
+     * @brief Creates a pool for the queue family queueFamilyIndex instead of
+     *        the graphics family.
+     */
+    return_t
+    initializeForQueueFamily(SharedPtrLogicalDevice   const& device,
+                             uint32_t                 const  queueFamilyIndex,
+                             VkCommandPoolCreateFlags const  flags = 0);
+
+    /**
+     * @brief Resets all command buffers allocated from this pool at once.
+     *
+     * None of the command buffers may be pending execution.
+     */
+    return_t
+    reset(VkCommandPoolResetFlags const flags = 0);
  
     inline VkCommandPool getVkCommandPool() { return mCommandPool; }
 
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "soVkComputePipeline.hpp"
+
+#include "cxx/soDebugCallback.hpp"
+#include "cxx/soPoolAllocator.hpp"
+
+so::vk::ComputePipeline::ComputePipeline()
+  : mPipeline(VK_NULL_HANDLE),
+    mPipelineLayout(VK_NULL_HANDLE),
+    mDevice(LogicalDevice::getSharedPtrNullDevice())
+{}
+
+so::vk::ComputePipeline::~ComputePipeline() noexcept
+{
+  destroyMembers();
+}
+
+so::vk::ComputePipeline&
+so::vk::ComputePipeline::operator=(ComputePipeline&& other) noexcept
+{
+  if(this is_eq &other)
+  {
+    return *this;
+  }
+
+  destroyMembers();
+
+  mPipeline       = other.mPipeline;
+  mPipelineLayout = other.mPipelineLayout;
+  mDevice         = other.mDevice;
+
+  other.mPipeline       = VK_NULL_HANDLE;
+  other.mPipelineLayout = VK_NULL_HANDLE;
+  other.mDevice         = LogicalDevice::getSharedPtrNullDevice();
+
+  return *this;
+}
+
+so::return_t
+so::vk::ComputePipeline::initialize
+  (SharedPtrLogicalDevice             const& device,
+   std::string                        const& shaderFile,
+   std::vector<VkDescriptorSetLayout> const& descriptorSetLayouts,
+   uint32_t                           const  pushConstantSize,
+   SharedPtrPipelineCache             const& pipelineCache,
+   SharedPtrShaderModuleCache         const& shaderModuleCache)
+{
+  destroyMembers();
+
+  mDevice = device;
+
+  SharedPtrShaderModule shader;
+
+  if(shaderModuleCache not_eq
+     ShaderModuleCache::getSharedPtrNullShaderModuleCache())
+  {
+    shader = shaderModuleCache->get(shaderFile);
+  }
+  else
+  {
+    shader = utils::mem::makePooledShared<ShaderModule>(mDevice, shaderFile);
+  }
+
+  if(shader is_eq nullptr or shader->getVkShaderModule() is_eq VK_NULL_HANDLE)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to load the compute shader '" + shaderFile + "'.");
+
+    return failure;
+  }
+
+  VkPushConstantRange pushConstantRange{};
+
+  pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+  pushConstantRange.offset     = 0;
+  pushConstantRange.size       = pushConstantSize;
+
+  VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+
+  pipelineLayoutInfo.sType                  =
+    VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+  pipelineLayoutInfo.setLayoutCount         =
+    static_cast<uint32_t>(descriptorSetLayouts.size());
+  pipelineLayoutInfo.pSetLayouts            = descriptorSetLayouts.data();
+  pipelineLayoutInfo.pushConstantRangeCount = pushConstantSize > 0 ? 1 : 0;
+  pipelineLayoutInfo.pPushConstantRanges    = &pushConstantRange;
+
+  VkDevice const vkDevice{ mDevice->getVkDevice() };
+
+  if(vkCreatePipelineLayout(vkDevice,
+                            &pipelineLayoutInfo,
+                            nullptr,
+                            &mPipelineLayout) not_eq VK_SUCCESS)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to create a compute pipeline layout.",
+                   vkCreatePipelineLayout);
+
+    return failure;
+  }
+
+  VkComputePipelineCreateInfo pipelineInfo{};
+
+  pipelineInfo.sType        = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+  pipelineInfo.stage.sType  =
+    VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  pipelineInfo.stage.stage  = VK_SHADER_STAGE_COMPUTE_BIT;
+  pipelineInfo.stage.module = shader->getVkShaderModule();
+  pipelineInfo.stage.pName  = "main";
+  pipelineInfo.layout       = mPipelineLayout;
+
+  if(vkCreateComputePipelines(vkDevice,
+                              pipelineCache->getVkPipelineCache(),
+                              1,
+                              &pipelineInfo,
+                              nullptr,
+                              &mPipeline) not_eq VK_SUCCESS)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to create a compute pipeline.",
+                   vkCreateComputePipelines);
+
+    return failure;
+  }
+
+  return success;
+}
+
+void
+so::vk::ComputePipeline::destroyMembers()
+{
+  VkDevice device(mDevice->getVkDevice());
+
+  if(device not_eq VK_NULL_HANDLE)
+  {
+    if(mPipeline not_eq VK_NULL_HANDLE)
+    {
+      vkDestroyPipeline(device, mPipeline, nullptr);
+
+      mPipeline = VK_NULL_HANDLE;
+    }
+
+    if(mPipelineLayout not_eq VK_NULL_HANDLE)
+    {
+      vkDestroyPipelineLayout(device, mPipelineLayout, nullptr);
+
+      mPipelineLayout = VK_NULL_HANDLE;
+    }
+  }
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      soVkComputePipeline.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "soVkLogicalDevice.hpp"
+#include "soVkPipelineCache.hpp"
+#include "soVkShaderModuleCache.hpp"
+
+#include <string>
+#include <vector>
+
+namespace so {
+namespace vk {
+
+/**
+ * @brief A compute pipeline and its layout.
+ */
+class
+ComputePipeline
+{
+  public:
+    ComputePipeline();
+
+    ComputePipeline(ComputePipeline const& other) = delete;
+
+    ComputePipeline(ComputePipeline&& other) = delete;
+
+    ~ComputePipeline() noexcept;
+
+    ComputePipeline&
+    operator=(ComputePipeline const& other) = delete;
+
+    ComputePipeline&
+    operator=(ComputePipeline&& other) noexcept;
+
+    /**
+     * @param shaderFile           SPIR-V of the compute shader.
+     * @param descriptorSetLayouts Layouts of the descriptor sets the shader
+     *                             reads, by set number. They have to
+     *                             outlive the pipeline.
+     * @param pushConstantSize     Bytes of push constants the shader reads,
+     *                             0 for none.
+     */
+    return_t
+    initialize(SharedPtrLogicalDevice             const& device,
+               std::string                        const& shaderFile,
+               std::vector<VkDescriptorSetLayout> const& descriptorSetLayouts,
+               uint32_t                           const  pushConstantSize,
+               SharedPtrPipelineCache             const& pipelineCache =
+                 PipelineCache::getSharedPtrNullPipelineCache(),
+               SharedPtrShaderModuleCache         const& shaderModuleCache =
+                 ShaderModuleCache::getSharedPtrNullShaderModuleCache());
+
+    inline VkPipeline getVkPipeline() const { return mPipeline; }
+
+    inline VkPipelineLayout getVkPipelineLayout() const
+    { return mPipelineLayout; }
+
+  private:
+    VkPipeline             mPipeline;
+    VkPipelineLayout       mPipelineLayout;
+
+    SharedPtrLogicalDevice mDevice;
+
+    void
+    destroyMembers();
+};
+
+} // namespace vk
+} // namespace so
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "soVkDeletionQueue.hpp"
+
+so::vk::DeletionQueue::DeletionQueue()
+  : mDeleters(),
+    mSubmittedFrames(0)
+{}
+
+so::vk::DeletionQueue::~DeletionQueue() noexcept
+{
+  flush();
+}
+
+void
+so::vk::DeletionQueue::push(deleter_t deleter)
+{
+  mDeleters.emplace_back(mSubmittedFrames, std::move(deleter));
+}
+
+void
+so::vk::DeletionQueue::collect(uint64_t const completedFrames)
+{
+  while((not mDeleters.empty()) and
+        (mDeleters.front().first <= completedFrames))
+  {
+    deleter_t deleter{ std::move(mDeleters.front().second) };
+
+    mDeleters.pop_front();
+
+    deleter();
+  }
+}
+
+void
+so::vk::DeletionQueue::flush()
+{
+  while(not mDeleters.empty())
+  {
+    deleter_t deleter{ std::move(mDeleters.front().second) };
+
+    mDeleters.pop_front();
+
+    deleter();
+  }
+}
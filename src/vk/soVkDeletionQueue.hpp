@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      soVkDeletionQueue.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "cxx/soDefinitions.hpp"
+#include "cxx/soPoolAllocator.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <utility>
+
+namespace so {
+namespace vk {
+
+/**
+ * @brief Defers the destruction of Vulkan objects until the GPU is done with
+ *        them, without waiting for the device to become idle.
+ *
+ * Deleters are tagged with the number of frames submitted when they were
+ * pushed. Any of those frames may still be using the object, so a deleter
+ * runs once collect() is told that at least that many frames have completed.
+ * Deleters run in the order they were pushed.
+ */
+class
+DeletionQueue
+{
+  public:
+    using deleter_t = std::function<void()>;
+
+    DeletionQueue();
+
+    DeletionQueue(DeletionQueue const& other) = delete;
+
+    DeletionQueue(DeletionQueue&& other) = delete;
+
+    ~DeletionQueue() noexcept;
+
+    DeletionQueue&
+    operator=(DeletionQueue const& other) = delete;
+
+    DeletionQueue&
+    operator=(DeletionQueue&& other) = delete;
+
+    void
+    push(deleter_t deleter);
+
+    /**
+     * @brief Takes ownership of a wrapper object, e.g. ImageViews or
+     *        Framebuffers, and destroys it once it is safe to do so.
+     */
+    template<typename T>
+    void
+    retire(T&& object)
+    {
+      auto retired
+        { utils::mem::makePooledShared<typename std::decay<T>::type>() };
+
+      *retired = std::move(object);
+
+      push([retired]() mutable { retired.reset(); });
+    }
+
+    /**
+     * @brief Sets the number of frames submitted so far. Deleters pushed from
+     *        now on wait for these frames.
+     */
+    inline void
+    setSubmittedFrames(uint64_t const submittedFrames)
+    { mSubmittedFrames = submittedFrames; }
+
+    /**
+     * @brief Runs all deleters whose frames have completed.
+     */
+    void
+    collect(uint64_t const completedFrames);
+
+    /**
+     * @brief Runs all deleters. The device must be idle.
+     */
+    void
+    flush();
+
+    inline size_type size() const { return mDeleters.size(); }
+
+  private:
+    std::deque<std::pair<uint64_t, deleter_t>> mDeleters;
+
+    uint64_t                                   mSubmittedFrames;
+}; // class DeletionQueue
+
+} // namespace vk
+} // namespace so
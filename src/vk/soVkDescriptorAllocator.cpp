@@ -0,0 +1,372 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "soVkDescriptorAllocator.hpp"
+
+#include "cxx/soDebugCallback.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+
+namespace {
+
+// Pools stop doubling here, larger ones only waste memory on lists that
+// rarely need them.
+uint32_t const maxSetsPerPool{ 4096 };
+
+} // namespace
+
+so::vk::DescriptorAllocator::DescriptorAllocator()
+  : mDevice(LogicalDevice::getSharedPtrNullDevice()),
+    mFramePools(),
+    mCachePools(),
+    mCurrentFrame(0),
+    mCache(),
+    mRatios(),
+    mSetsPerPool(0),
+    mStatistics()
+{}
+
+so::vk::DescriptorAllocator::~DescriptorAllocator() noexcept
+{
+  destroyMembers();
+}
+
+std::vector<so::vk::DescriptorPoolSizeRatio>
+so::vk::DescriptorAllocator::getDefaultPoolSizeRatios()
+{
+  return { { VK_DESCRIPTOR_TYPE_SAMPLER,                0.5f },
+           { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f },
+           { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,          2.0f },
+           { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,          1.0f },
+           { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,         2.0f },
+           { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f },
+           { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,         2.0f },
+           { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 0.5f } };
+}
+
+so::return_t
+so::vk::DescriptorAllocator::initialize
+  (SharedPtrLogicalDevice               const& device,
+   size_type                            const  numFramesInFlight,
+   uint32_t                             const  setsPerPool,
+   std::vector<DescriptorPoolSizeRatio> const& ratios)
+{
+  destroyMembers();
+
+  if(setsPerPool is_eq 0 or ratios.empty())
+  {
+    DEBUG_CALLBACK(error,
+                   "Descriptor pools need at least one set and one "
+                   "descriptor type.");
+
+    return failure;
+  }
+
+  mDevice       = device;
+  mRatios       = ratios;
+  mSetsPerPool  = setsPerPool;
+  mCurrentFrame = 0;
+  mStatistics   = DescriptorAllocatorStatistics{};
+
+  mFramePools.resize(numFramesInFlight);
+
+  // Pools are created on first use, so lists that are never allocated from
+  // cost nothing.
+  for(auto& poolList : mFramePools)
+  {
+    poolList.nextSetsPerPool = mSetsPerPool;
+  }
+
+  mCachePools.nextSetsPerPool = mSetsPerPool;
+
+  return success;
+}
+
+void
+so::vk::DescriptorAllocator::beginFrame(index_t const frame)
+{
+  mCurrentFrame = frame;
+
+  resetList(mFramePools[static_cast<size_type>(frame)]);
+
+  mStatistics.numFrameSets = 0;
+}
+
+so::return_t
+so::vk::DescriptorAllocator::allocate(DescriptorSetLayout const& layout,
+                                      void                const* data,
+                                      VkDescriptorSet&           set)
+{
+  if(allocateFromList(mFramePools[static_cast<size_type>(mCurrentFrame)],
+                      layout.getVkDescriptorSetLayout(),
+                      set) is_eq failure)
+  {
+    return failure;
+  }
+
+  layout.write(set, data);
+
+  ++mStatistics.numFrameSets;
+
+  return success;
+}
+
+so::return_t
+so::vk::DescriptorAllocator::getCached(DescriptorSetLayout const& layout,
+                                       void                const* data,
+                                       VkDescriptorSet&           set)
+{
+  VkDescriptorSetLayout const vkLayout{ layout.getVkDescriptorSetLayout() };
+
+  auto& candidates{ mCache[layout.hash(data)] };
+
+  for(auto const& candidate : candidates)
+  {
+    if(candidate.layout is_eq vkLayout and
+       layout.equal(candidate.data.data(), data))
+    {
+      set = candidate.set;
+
+      ++mStatistics.cacheHits;
+
+      return success;
+    }
+  }
+
+  if(allocateFromList(mCachePools, vkLayout, set) is_eq failure)
+  {
+    return failure;
+  }
+
+  layout.write(set, data);
+
+  std::vector<char> copy(layout.getDataSize());
+
+  std::memcpy(copy.data(), data, copy.size());
+
+  std::vector<uint64_t> handles;
+
+  layout.getHandles(data, handles);
+
+  candidates.push_back({ vkLayout, std::move(copy), std::move(handles), set });
+
+  ++mStatistics.cacheMisses;
+  ++mStatistics.numCachedSets;
+
+  return success;
+}
+
+void
+so::vk::DescriptorAllocator::clearCache()
+{
+  resetList(mCachePools);
+
+  mCache.clear();
+
+  mStatistics.numCachedSets = 0;
+}
+
+void
+so::vk::DescriptorAllocator::forgetHandle(uint64_t const handle)
+{
+  auto const refersTo = [handle](CachedSet const& candidate)
+                        {
+                          return std::find(candidate.handles.begin(),
+                                           candidate.handles.end(),
+                                           handle) not_eq
+                                 candidate.handles.end();
+                        };
+
+  for(auto entry{ mCache.begin() }; entry not_eq mCache.end();)
+  {
+    auto& candidates{ entry->second };
+
+    auto const forgotten{ std::remove_if(candidates.begin(),
+                                         candidates.end(),
+                                         refersTo) };
+
+    mStatistics.numCachedSets -=
+      static_cast<size_type>(candidates.end() - forgotten);
+
+    candidates.erase(forgotten, candidates.end());
+
+    entry = candidates.empty() ? mCache.erase(entry) : std::next(entry);
+  }
+}
+
+so::return_t
+so::vk::DescriptorAllocator::allocateFromList
+  (PoolList&                   poolList,
+   VkDescriptorSetLayout const layout,
+   VkDescriptorSet&            set)
+{
+  VkDescriptorSetAllocateInfo allocateInfo{};
+
+  allocateInfo.sType              =
+    VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+  allocateInfo.descriptorSetCount = 1;
+  allocateInfo.pSetLayouts        = &layout;
+
+  while(true)
+  {
+    bool const isNewPool{ poolList.current is_eq poolList.pools.size() };
+
+    if(isNewPool and createPool(poolList) is_eq failure)
+    {
+      return failure;
+    }
+
+    allocateInfo.descriptorPool = poolList.pools[poolList.current];
+
+    VkResult const result{ vkAllocateDescriptorSets(mDevice->getVkDevice(),
+                                                    &allocateInfo,
+                                                    &set) };
+
+    if(result is_eq VK_SUCCESS)
+    {
+      return success;
+    }
+
+    if(not isNewPool)
+    {
+      // Without VK_KHR_maintenance1 an exhausted pool may fail with any
+      // error, so every failure of a used pool moves on to the next one; a
+      // real error repeats on the new pool.
+      ++poolList.current;
+
+      continue;
+    }
+
+    if(result is_eq VK_ERROR_OUT_OF_POOL_MEMORY_KHR or
+       result is_eq VK_ERROR_FRAGMENTED_POOL)
+    {
+      DEBUG_CALLBACK(error,
+                     "A descriptor set does not fit into an empty pool, its "
+                     "layout exceeds the pool size ratios.");
+    }
+    else
+    {
+      DEBUG_CALLBACK(error,
+                     "Failed to allocate a descriptor set.",
+                     vkAllocateDescriptorSets);
+    }
+
+    return failure;
+  }
+}
+
+so::return_t
+so::vk::DescriptorAllocator::createPool(PoolList& poolList)
+{
+  uint32_t const maxSets{ poolList.nextSetsPerPool };
+
+  std::vector<VkDescriptorPoolSize> poolSizes;
+
+  poolSizes.reserve(mRatios.size());
+
+  for(auto const& ratio : mRatios)
+  {
+    auto const count
+      { static_cast<uint32_t>(std::ceil(ratio.ratio *
+                                        static_cast<float>(maxSets))) };
+
+    poolSizes.push_back({ ratio.type, std::max(count, 1u) });
+  }
+
+  VkDescriptorPoolCreateInfo poolInfo{};
+
+  poolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+  poolInfo.maxSets       = maxSets;
+  poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+  poolInfo.pPoolSizes    = poolSizes.data();
+
+  VkDescriptorPool pool{ VK_NULL_HANDLE };
+
+  if(vkCreateDescriptorPool(mDevice->getVkDevice(),
+                            &poolInfo,
+                            nullptr,
+                            &pool) not_eq VK_SUCCESS)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to create a descriptor pool.",
+                   vkCreateDescriptorPool);
+
+    return failure;
+  }
+
+  poolList.pools.push_back(pool);
+
+  poolList.nextSetsPerPool = std::min(maxSets * 2, maxSetsPerPool);
+
+  if(&poolList is_eq &mCachePools)
+  {
+    ++mStatistics.numCachePools;
+  }
+  else
+  {
+    ++mStatistics.numFramePools;
+  }
+
+  return success;
+}
+
+void
+so::vk::DescriptorAllocator::resetList(PoolList& poolList)
+{
+  // Only the pools allocated from since the last reset hold sets.
+  size_type const numUsed{ std::min(poolList.current + 1,
+                                    poolList.pools.size()) };
+
+  for(size_type i{ 0 }; i < numUsed; ++i)
+  {
+    vkResetDescriptorPool(mDevice->getVkDevice(), poolList.pools[i], 0);
+  }
+
+  poolList.current = 0;
+}
+
+void
+so::vk::DescriptorAllocator::destroyMembers()
+{
+  VkDevice const device{ mDevice->getVkDevice() };
+
+  for(auto& poolList : mFramePools)
+  {
+    for(auto const pool : poolList.pools)
+    {
+      vkDestroyDescriptorPool(device, pool, nullptr);
+    }
+  }
+
+  for(auto const pool : mCachePools.pools)
+  {
+    vkDestroyDescriptorPool(device, pool, nullptr);
+  }
+
+  mFramePools.clear();
+  mCachePools = PoolList();
+  mCache.clear();
+}
@@ -0,0 +1,237 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      soVkDescriptorAllocator.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "soVkDescriptorSetLayout.hpp"
+
+#include "cxx/soDefinitions.hpp"
+
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace so {
+namespace vk {
+
+/**
+ * @brief Number of descriptors of a type a pool holds per set.
+ */
+struct
+DescriptorPoolSizeRatio
+{
+  VkDescriptorType type;
+  float            ratio;
+};
+
+struct
+DescriptorAllocatorStatistics
+{
+  size_type numFramePools{ 0 };
+  size_type numCachePools{ 0 };
+  size_type numFrameSets{ 0 };
+  size_type numCachedSets{ 0 };
+  uint64_t  cacheHits{ 0 };
+  uint64_t  cacheMisses{ 0 };
+};
+
+/**
+ * @brief Hands out descriptor sets from pools that grow on demand.
+ *
+ * Sets allocated with allocate live for one frame. Every frame in flight owns
+ * its own list of pools, which beginFrame resets in one vkResetDescriptorPool
+ * per pool once the fence of that frame has signaled, so no set is ever freed
+ * individually. Sets that stay the same over many frames, e.g. material
+ * textures, are requested with getCached instead, which returns the set
+ * already written with the same descriptors if there is one.
+ *
+ * A pool that runs out of memory is not an error: the allocation moves on to
+ * the next pool of the list, creating one twice the size of the last if
+ * there is none left. Not thread safe.
+ *
+ * Cached sets are found by the handles their descriptors refer to, and a
+ * destroyed handle may be reused by the driver for a new object. Every
+ * sampler, image view, buffer or buffer view a cached set refers to has to
+ * be passed to forget before it is destroyed, unless the cache is cleared
+ * first.
+ */
+class
+DescriptorAllocator
+{
+  public:
+    DescriptorAllocator();
+
+    DescriptorAllocator(DescriptorAllocator const& other) = delete;
+
+    DescriptorAllocator(DescriptorAllocator&& other) = delete;
+
+    ~DescriptorAllocator() noexcept;
+
+    DescriptorAllocator&
+    operator=(DescriptorAllocator const& other) = delete;
+
+    DescriptorAllocator&
+    operator=(DescriptorAllocator&& other) = delete;
+
+    /**
+     * @param setsPerPool Number of sets of the first pool of every list.
+     * @param ratios      Descriptors per set each pool holds, by type.
+     */
+    return_t
+    initialize(SharedPtrLogicalDevice               const& device,
+               size_type                            const  numFramesInFlight,
+               uint32_t                             const  setsPerPool = 256,
+               std::vector<DescriptorPoolSizeRatio> const& ratios
+                 = getDefaultPoolSizeRatios());
+
+    static std::vector<DescriptorPoolSizeRatio>
+    getDefaultPoolSizeRatios();
+
+    /**
+     * @brief Resets the pools of frame and allocates from them until the
+     *        next call. The last submission of frame has to be finished.
+     */
+    void
+    beginFrame(index_t const frame);
+
+    /**
+     * @brief Allocates a set of layout for the current frame and writes data
+     *        into it.
+     */
+    return_t
+    allocate(DescriptorSetLayout const& layout,
+             void                const* data,
+             VkDescriptorSet&           set);
+
+    /**
+     * @brief Returns a long-lived set of layout holding the descriptors in
+     *        data, allocating and writing it only if no such set exists yet.
+     */
+    return_t
+    getCached(DescriptorSetLayout const& layout,
+              void                const* data,
+              VkDescriptorSet&           set);
+
+    /**
+     * @brief Frees all sets returned by getCached. None of them may be in use
+     *        by the device anymore.
+     */
+    void
+    clearCache();
+
+    /**
+     * @brief Drops the cached sets referring to handle, which is about to be
+     *        destroyed. Their memory is reclaimed by the next clearCache.
+     */
+    template<typename Handle>
+    void
+    forget(Handle const handle)
+    {
+      uint64_t value{ 0 };
+
+      std::memcpy(&value, &handle, sizeof(handle));
+
+      forgetHandle(value);
+    }
+
+    inline DescriptorAllocatorStatistics const& getStatistics() const
+    { return mStatistics; }
+
+  private:
+    struct
+    PoolList
+    {
+      std::vector<VkDescriptorPool> pools;
+      size_type                     current{ 0 };
+      uint32_t                      nextSetsPerPool{ 0 };
+    };
+
+    struct
+    CachedSet
+    {
+      VkDescriptorSetLayout layout;
+      std::vector<char>     data;
+      std::vector<uint64_t> handles;
+      VkDescriptorSet       set;
+    };
+
+    SharedPtrLogicalDevice mDevice;
+
+    std::vector<PoolList>  mFramePools;
+    PoolList               mCachePools;
+    index_t                mCurrentFrame;
+
+    std::unordered_map<uint64_t, std::vector<CachedSet>> mCache;
+
+    std::vector<DescriptorPoolSizeRatio> mRatios;
+    uint32_t                             mSetsPerPool;
+
+    DescriptorAllocatorStatistics        mStatistics;
+
+    return_t
+    allocateFromList(PoolList&                   poolList,
+                     VkDescriptorSetLayout const layout,
+                     VkDescriptorSet&            set);
+
+    return_t
+    createPool(PoolList& poolList);
+
+    void
+    resetList(PoolList& poolList);
+
+    void
+    forgetHandle(uint64_t const handle);
+
+    void
+    destroyMembers();
+};
+
+} // namespace vk
+} // namespace so
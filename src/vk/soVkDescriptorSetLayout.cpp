@@ -0,0 +1,535 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "soVkDescriptorSetLayout.hpp"
+
+#include "cxx/soDebugCallback.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+enum class
+DescriptorKind
+{
+  image,
+  buffer,
+  texelBuffer
+};
+
+DescriptorKind
+getDescriptorKind(VkDescriptorType const type)
+{
+  switch(type)
+  {
+    case VK_DESCRIPTOR_TYPE_SAMPLER:
+    case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+    case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+    case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+    case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+      return DescriptorKind::image;
+    case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+    case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+      return DescriptorKind::texelBuffer;
+    default:
+      return DescriptorKind::buffer;
+  }
+}
+
+so::size_type
+getDescriptorSize(DescriptorKind const kind)
+{
+  switch(kind)
+  {
+    case DescriptorKind::image:
+      return sizeof(VkDescriptorImageInfo);
+    case DescriptorKind::texelBuffer:
+      return sizeof(VkBufferView);
+    default:
+      return sizeof(VkDescriptorBufferInfo);
+  }
+}
+
+template<typename T>
+T const&
+getDescriptor(void const*                  const data,
+              so::vk::DescriptorBinding const& binding,
+              uint32_t                     const element)
+{
+  return *reinterpret_cast<T const*>(static_cast<char const*>(data) +
+                                     binding.offset +
+                                     element * binding.stride);
+}
+
+// FNV-1a, as used for the shader module cache.
+void
+hashValue(uint64_t& hash, uint64_t const value)
+{
+  for(so::size_type byte{ 0 }; byte < sizeof(value); ++byte)
+  {
+    hash ^= (value >> (8 * byte)) bitand 0xffu;
+    hash *= 1099511628211ull;
+  }
+}
+
+// Non-dispatchable handles are pointers or 64 bit integers depending on the
+// platform.
+template<typename Handle>
+uint64_t
+toInteger(Handle const handle)
+{
+  uint64_t value{ 0 };
+
+  std::memcpy(&value, &handle, sizeof(handle));
+
+  return value;
+}
+
+} // namespace
+
+so::vk::DescriptorSetLayout::DescriptorSetLayout()
+  : mDevice(LogicalDevice::getSharedPtrNullDevice()),
+    mLayout(VK_NULL_HANDLE),
+    mUpdateTemplate(VK_NULL_HANDLE),
+    mDestroyUpdateTemplate(nullptr),
+    mUpdateWithTemplate(nullptr),
+    mBindings(),
+    mDataSize(0)
+{}
+
+so::vk::DescriptorSetLayout::~DescriptorSetLayout() noexcept
+{
+  destroyMembers();
+}
+
+so::vk::DescriptorSetLayout&
+so::vk::DescriptorSetLayout::operator=(DescriptorSetLayout&& other) noexcept
+{
+  if(this is_eq &other)
+  {
+    return *this;
+  }
+
+  destroyMembers();
+
+  mDevice                = other.mDevice;
+  mLayout                = other.mLayout;
+  mUpdateTemplate        = other.mUpdateTemplate;
+  mDestroyUpdateTemplate = other.mDestroyUpdateTemplate;
+  mUpdateWithTemplate    = other.mUpdateWithTemplate;
+  mBindings              = std::move(other.mBindings);
+  mDataSize              = other.mDataSize;
+
+  other.mDevice         = LogicalDevice::getSharedPtrNullDevice();
+  other.mLayout         = VK_NULL_HANDLE;
+  other.mUpdateTemplate = VK_NULL_HANDLE;
+  other.mDataSize       = 0;
+
+  return *this;
+}
+
+so::return_t
+so::vk::DescriptorSetLayout::initialize
+  (SharedPtrLogicalDevice         const& device,
+   std::vector<DescriptorBinding> const& bindings)
+{
+  destroyMembers();
+
+  mDevice   = device;
+  mBindings = bindings;
+  mDataSize = 0;
+
+  std::vector<VkDescriptorSetLayoutBinding> layoutBindings;
+  std::vector<VkDescriptorUpdateTemplateEntryKHR> entries;
+
+  layoutBindings.reserve(mBindings.size());
+  entries.reserve(mBindings.size());
+
+  for(auto& binding : mBindings)
+  {
+    size_type const descriptorSize
+      { getDescriptorSize(getDescriptorKind(binding.type)) };
+
+    if(binding.stride is_eq 0)
+    {
+      binding.stride = descriptorSize;
+    }
+
+    if(binding.count > 0)
+    {
+      mDataSize = std::max(mDataSize,
+                           binding.offset +
+                           (binding.count - 1) * binding.stride +
+                           descriptorSize);
+    }
+
+    layoutBindings.push_back({ binding.binding,
+                               binding.type,
+                               binding.count,
+                               binding.stages,
+                               nullptr });
+
+    entries.push_back({ binding.binding,
+                        0,
+                        binding.count,
+                        binding.type,
+                        binding.offset,
+                        binding.stride });
+  }
+
+  VkDescriptorSetLayoutCreateInfo layoutInfo{};
+
+  layoutInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+  layoutInfo.bindingCount = static_cast<uint32_t>(layoutBindings.size());
+  layoutInfo.pBindings    = layoutBindings.data();
+
+  if(vkCreateDescriptorSetLayout(mDevice->getVkDevice(),
+                                 &layoutInfo,
+                                 nullptr,
+                                 &mLayout) not_eq VK_SUCCESS)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to create a descriptor set layout.",
+                   vkCreateDescriptorSetLayout);
+
+    return failure;
+  }
+
+  if(entries.empty() or
+     not mDevice->isExtensionEnabled
+           (VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME))
+  {
+    return success;
+  }
+
+  VkDevice const vkDevice{ mDevice->getVkDevice() };
+
+  auto const createUpdateTemplate
+    { reinterpret_cast<PFN_vkCreateDescriptorUpdateTemplateKHR>
+        (vkGetDeviceProcAddr(vkDevice,
+                             "vkCreateDescriptorUpdateTemplateKHR")) };
+
+  mDestroyUpdateTemplate =
+    reinterpret_cast<PFN_vkDestroyDescriptorUpdateTemplateKHR>
+      (vkGetDeviceProcAddr(vkDevice, "vkDestroyDescriptorUpdateTemplateKHR"));
+
+  mUpdateWithTemplate =
+    reinterpret_cast<PFN_vkUpdateDescriptorSetWithTemplateKHR>
+      (vkGetDeviceProcAddr(vkDevice, "vkUpdateDescriptorSetWithTemplateKHR"));
+
+  if(createUpdateTemplate is_eq nullptr or
+     mDestroyUpdateTemplate is_eq nullptr or
+     mUpdateWithTemplate is_eq nullptr)
+  {
+    return success;
+  }
+
+  VkDescriptorUpdateTemplateCreateInfoKHR templateInfo{};
+
+  templateInfo.sType                      =
+    VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO_KHR;
+  templateInfo.descriptorUpdateEntryCount =
+    static_cast<uint32_t>(entries.size());
+  templateInfo.pDescriptorUpdateEntries   = entries.data();
+  templateInfo.templateType               =
+    VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET_KHR;
+  templateInfo.descriptorSetLayout        = mLayout;
+
+  // Writes fall back to vkUpdateDescriptorSets if this fails.
+  if(createUpdateTemplate(vkDevice,
+                          &templateInfo,
+                          nullptr,
+                          &mUpdateTemplate) not_eq VK_SUCCESS)
+  {
+    DEBUG_CALLBACK(info,
+                   "Failed to create a descriptor update template, "
+                   "falling back to vkUpdateDescriptorSets.");
+
+    mUpdateTemplate = VK_NULL_HANDLE;
+  }
+
+  return success;
+}
+
+void
+so::vk::DescriptorSetLayout::write(VkDescriptorSet const set,
+                                   void const*     const data) const
+{
+  if(mUpdateTemplate not_eq VK_NULL_HANDLE)
+  {
+    mUpdateWithTemplate(mDevice->getVkDevice(), set, mUpdateTemplate, data);
+
+    return;
+  }
+
+  size_type numImages{ 0 };
+  size_type numBuffers{ 0 };
+  size_type numTexelBuffers{ 0 };
+
+  for(auto const& binding : mBindings)
+  {
+    switch(getDescriptorKind(binding.type))
+    {
+      case DescriptorKind::image:
+        numImages += binding.count;
+        break;
+      case DescriptorKind::texelBuffer:
+        numTexelBuffers += binding.count;
+        break;
+      default:
+        numBuffers += binding.count;
+        break;
+    }
+  }
+
+  // Reserved up front, the writes point into these.
+  std::vector<VkDescriptorImageInfo>  imageInfos;
+  std::vector<VkDescriptorBufferInfo> bufferInfos;
+  std::vector<VkBufferView>           texelBufferViews;
+  std::vector<VkWriteDescriptorSet>   writes;
+
+  imageInfos.reserve(numImages);
+  bufferInfos.reserve(numBuffers);
+  texelBufferViews.reserve(numTexelBuffers);
+  writes.reserve(mBindings.size());
+
+  for(auto const& binding : mBindings)
+  {
+    if(binding.count is_eq 0)
+    {
+      continue;
+    }
+
+    VkWriteDescriptorSet descriptorWrite{};
+
+    descriptorWrite.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet          = set;
+    descriptorWrite.dstBinding      = binding.binding;
+    descriptorWrite.dstArrayElement = 0;
+    descriptorWrite.descriptorCount = binding.count;
+    descriptorWrite.descriptorType  = binding.type;
+
+    for(uint32_t element{ 0 }; element < binding.count; ++element)
+    {
+      switch(getDescriptorKind(binding.type))
+      {
+        case DescriptorKind::image:
+          imageInfos.push_back
+            (getDescriptor<VkDescriptorImageInfo>(data, binding, element));
+          break;
+        case DescriptorKind::texelBuffer:
+          texelBufferViews.push_back
+            (getDescriptor<VkBufferView>(data, binding, element));
+          break;
+        default:
+          bufferInfos.push_back
+            (getDescriptor<VkDescriptorBufferInfo>(data, binding, element));
+          break;
+      }
+    }
+
+    switch(getDescriptorKind(binding.type))
+    {
+      case DescriptorKind::image:
+        descriptorWrite.pImageInfo = &imageInfos.back() -
+                                     (binding.count - 1);
+        break;
+      case DescriptorKind::texelBuffer:
+        descriptorWrite.pTexelBufferView = &texelBufferViews.back() -
+                                           (binding.count - 1);
+        break;
+      default:
+        descriptorWrite.pBufferInfo = &bufferInfos.back() -
+                                      (binding.count - 1);
+        break;
+    }
+
+    writes.push_back(descriptorWrite);
+  }
+
+  vkUpdateDescriptorSets(mDevice->getVkDevice(),
+                         static_cast<uint32_t>(writes.size()),
+                         writes.data(),
+                         0,
+                         nullptr);
+}
+
+uint64_t
+so::vk::DescriptorSetLayout::hash(void const* const data) const
+{
+  uint64_t result{ 14695981039346656037ull };
+
+  for(auto const& binding : mBindings)
+  {
+    for(uint32_t element{ 0 }; element < binding.count; ++element)
+    {
+      switch(getDescriptorKind(binding.type))
+      {
+        case DescriptorKind::image:
+        {
+          auto const& image
+            { getDescriptor<VkDescriptorImageInfo>(data, binding, element) };
+
+          hashValue(result, toInteger(image.sampler));
+          hashValue(result, toInteger(image.imageView));
+          hashValue(result, static_cast<uint64_t>(image.imageLayout));
+          break;
+        }
+        case DescriptorKind::texelBuffer:
+          hashValue(result,
+                    toInteger(getDescriptor<VkBufferView>(data,
+                                                          binding,
+                                                          element)));
+          break;
+        default:
+        {
+          auto const& buffer
+            { getDescriptor<VkDescriptorBufferInfo>(data, binding, element) };
+
+          hashValue(result, toInteger(buffer.buffer));
+          hashValue(result, buffer.offset);
+          hashValue(result, buffer.range);
+          break;
+        }
+      }
+    }
+  }
+
+  return result;
+}
+
+bool
+so::vk::DescriptorSetLayout::equal(void const* const lhs,
+                                   void const* const rhs) const
+{
+  for(auto const& binding : mBindings)
+  {
+    for(uint32_t element{ 0 }; element < binding.count; ++element)
+    {
+      switch(getDescriptorKind(binding.type))
+      {
+        case DescriptorKind::image:
+        {
+          auto const& a
+            { getDescriptor<VkDescriptorImageInfo>(lhs, binding, element) };
+          auto const& b
+            { getDescriptor<VkDescriptorImageInfo>(rhs, binding, element) };
+
+          if(a.sampler not_eq b.sampler or
+             a.imageView not_eq b.imageView or
+             a.imageLayout not_eq b.imageLayout)
+          {
+            return false;
+          }
+          break;
+        }
+        case DescriptorKind::texelBuffer:
+          if(getDescriptor<VkBufferView>(lhs, binding, element) not_eq
+             getDescriptor<VkBufferView>(rhs, binding, element))
+          {
+            return false;
+          }
+          break;
+        default:
+        {
+          auto const& a
+            { getDescriptor<VkDescriptorBufferInfo>(lhs, binding, element) };
+          auto const& b
+            { getDescriptor<VkDescriptorBufferInfo>(rhs, binding, element) };
+
+          if(a.buffer not_eq b.buffer or
+             a.offset not_eq b.offset or
+             a.range not_eq b.range)
+          {
+            return false;
+          }
+          break;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+void
+so::vk::DescriptorSetLayout::getHandles(void const* const      data,
+                                        std::vector<uint64_t>& handles) const
+{
+  auto const append = [&handles](uint64_t const handle)
+                      {
+                        if(handle not_eq 0)
+                        {
+                          handles.push_back(handle);
+                        }
+                      };
+
+  for(auto const& binding : mBindings)
+  {
+    for(uint32_t element{ 0 }; element < binding.count; ++element)
+    {
+      switch(getDescriptorKind(binding.type))
+      {
+        case DescriptorKind::image:
+        {
+          auto const& image
+            { getDescriptor<VkDescriptorImageInfo>(data, binding, element) };
+
+          append(toInteger(image.sampler));
+          append(toInteger(image.imageView));
+          break;
+        }
+        case DescriptorKind::texelBuffer:
+          append(toInteger(getDescriptor<VkBufferView>(data,
+                                                       binding,
+                                                       element)));
+          break;
+        default:
+          append(toInteger(getDescriptor<VkDescriptorBufferInfo>
+                             (data, binding, element).buffer));
+          break;
+      }
+    }
+  }
+}
+
+void
+so::vk::DescriptorSetLayout::destroyMembers()
+{
+  VkDevice const device{ mDevice->getVkDevice() };
+
+  if(mUpdateTemplate not_eq VK_NULL_HANDLE)
+  {
+    mDestroyUpdateTemplate(device, mUpdateTemplate, nullptr);
+
+    mUpdateTemplate = VK_NULL_HANDLE;
+  }
+
+  if(mLayout not_eq VK_NULL_HANDLE)
+  {
+    vkDestroyDescriptorSetLayout(device, mLayout, nullptr);
+
+    mLayout = VK_NULL_HANDLE;
+  }
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      soVkDescriptorSetLayout.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "soVkLogicalDevice.hpp"
+
+#include "cxx/soDefinitions.hpp"
+
+#include <vector>
+
+namespace so {
+namespace vk {
+
+/**
+ * @brief A binding of a descriptor set layout and where its descriptors are
+ *        read from when a set is written.
+ *
+ * Descriptor i of the binding is read from offset + i * stride of the data
+ * passed to DescriptorSetLayout::write, as a VkDescriptorImageInfo,
+ * VkDescriptorBufferInfo or VkBufferView depending on type, i.e. the data is
+ * usually a struct with one member per binding.
+ */
+struct
+DescriptorBinding
+{
+  uint32_t           binding{ 0 };
+  VkDescriptorType   type{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER };
+  uint32_t           count{ 1 };
+  VkShaderStageFlags stages{ 0 };
+  size_type          offset{ 0 };
+  size_type          stride{ 0 };
+};
+
+/**
+ * @brief A descriptor set layout and the update template writing all of its
+ *        bindings at once.
+ *
+ * Writes go through vkUpdateDescriptorSetWithTemplateKHR if the device
+ * enabled VK_KHR_descriptor_update_template, so the driver reads the
+ * descriptors straight out of the data instead of a VkWriteDescriptorSet per
+ * binding. Without the extension the same data is turned into a single
+ * vkUpdateDescriptorSets call.
+ */
+class
+DescriptorSetLayout
+{
+  public:
+    DescriptorSetLayout();
+
+    DescriptorSetLayout(DescriptorSetLayout const& other) = delete;
+
+    DescriptorSetLayout(DescriptorSetLayout&& other) = delete;
+
+    ~DescriptorSetLayout() noexcept;
+
+    DescriptorSetLayout&
+    operator=(DescriptorSetLayout const& other) = delete;
+
+    DescriptorSetLayout&
+    operator=(DescriptorSetLayout&& other) noexcept;
+
+    return_t
+    initialize(SharedPtrLogicalDevice         const& device,
+               std::vector<DescriptorBinding> const& bindings);
+
+    /**
+     * @brief Writes every binding of set from data, laid out as described
+     *        by the bindings.
+     */
+    void
+    write(VkDescriptorSet const set, void const* const data) const;
+
+    /**
+     * @brief Hash of the descriptors in data. Only the members Vulkan reads
+     *        are hashed, so padding does not matter.
+     */
+    uint64_t
+    hash(void const* const data) const;
+
+    /**
+     * @brief Whether lhs and rhs describe the same descriptors.
+     */
+    bool
+    equal(void const* const lhs, void const* const rhs) const;
+
+    /**
+     * @brief Appends the samplers, image views, buffers and buffer views data
+     *        refers to as integers, leaving out null handles.
+     */
+    void
+    getHandles(void const* const data, std::vector<uint64_t>& handles) const;
+
+    /**
+     * @brief Number of bytes of the data read by write.
+     */
+    inline size_type getDataSize() const { return mDataSize; }
+
+    inline VkDescriptorSetLayout getVkDescriptorSetLayout() const
+    { return mLayout; }
+
+    inline std::vector<DescriptorBinding> const& getBindings() const
+    { return mBindings; }
+
+    inline bool usesUpdateTemplate() const
+    { return mUpdateTemplate not_eq VK_NULL_HANDLE; }
+
+  private:
+    SharedPtrLogicalDevice         mDevice;
+    VkDescriptorSetLayout          mLayout;
+    VkDescriptorUpdateTemplateKHR  mUpdateTemplate;
+
+    PFN_vkDestroyDescriptorUpdateTemplateKHR mDestroyUpdateTemplate;
+    PFN_vkUpdateDescriptorSetWithTemplateKHR mUpdateWithTemplate;
+
+    std::vector<DescriptorBinding> mBindings;
+    size_type                      mDataSize;
+
+    void
+    destroyMembers();
+};
+
+} // namespace vk
+} // namespace so
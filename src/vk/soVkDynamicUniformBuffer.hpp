@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      soVkDynamicUniformBuffer.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "soVkBuffer.hpp"
+
+#include "cxx/soAlignedVector.hpp"
+#include "cxx/soDebugCallback.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace so {
+namespace vk {
+
+/**
+ * @brief Per-object uniform data of type T, e.g. model matrices, in a ring of
+ *        one region per frame in flight, bound as a
+ *        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC.
+ *
+ * Objects are written into a host side AlignedVector whose stride is
+ * minUniformBufferOffsetAlignment, so the region of a frame is a single
+ * memcpy into the persistently mapped buffer and a single flush. A draw then
+ * selects its object with a dynamic offset, so every object shares one
+ * descriptor set pointing at getVkDescriptorBufferInfo().
+ */
+template<typename T>
+class
+DynamicUniformBuffer
+{
+  public:
+    DynamicUniformBuffer();
+
+    DynamicUniformBuffer(DynamicUniformBuffer const& other) = delete;
+
+    DynamicUniformBuffer(DynamicUniformBuffer&& other) = delete;
+
+    ~DynamicUniformBuffer() noexcept = default;
+
+    DynamicUniformBuffer&
+    operator=(DynamicUniformBuffer const& other) = delete;
+
+    DynamicUniformBuffer&
+    operator=(DynamicUniformBuffer&& other) = delete;
+
+    /**
+     * @param capacity Maximum number of objects per frame.
+     */
+    return_t
+    initialize(SharedPtrMemoryAllocator const& allocator,
+               size_type                const  numFramesInFlight,
+               size_type                const  capacity);
+
+    /**
+     * @brief Host copy of an object of the frame being recorded.
+     */
+    inline T& operator[](size_type const idx) { return mObjects[idx]; }
+
+    inline T const& operator[](size_type const idx) const
+    { return mObjects[idx]; }
+
+    inline size_type getCapacity() const { return mObjects.size(); }
+
+    inline VkDeviceSize getStride() const { return mObjects.stride(); }
+
+    /**
+     * @brief Copies the first count objects into the region of frame and
+     *        flushes it. The previous submission of frame has to be finished.
+     */
+    return_t
+    flush(index_t const frame, size_type const count);
+
+    /**
+     * @brief Dynamic offset of object idx in the region of frame.
+     */
+    inline uint32_t
+    getDynamicOffset(index_t const frame, size_type const idx) const
+    {
+      return static_cast<uint32_t>
+               (static_cast<VkDeviceSize>(frame) * mFrameSize +
+                idx * getStride());
+    }
+
+    /**
+     * @brief Describes a single object, the range a dynamic offset moves.
+     */
+    inline VkDescriptorBufferInfo
+    getVkDescriptorBufferInfo() const
+    { return { mBuffer.getVkBuffer(), 0, sizeof(T) }; }
+
+    inline Buffer const& getBuffer() const { return mBuffer; }
+
+    static inline VkDescriptorSetLayoutBinding
+    getVkDescriptorSetLayoutBinding(uint32_t           const binding,
+                                    VkShaderStageFlags const stages)
+    {
+      return { binding,
+               VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+               1,
+               stages,
+               nullptr };
+    }
+
+    /**
+     * @brief Binds descriptorSet, whose only dynamic descriptor is this
+     *        buffer, with the offset of object idx.
+     */
+    inline void
+    bind(VkCommandBuffer  const commandBuffer,
+         VkPipelineLayout const pipelineLayout,
+         uint32_t         const set,
+         VkDescriptorSet  const descriptorSet,
+         index_t          const frame,
+         size_type        const idx) const
+    {
+      uint32_t const dynamicOffset{ getDynamicOffset(frame, idx) };
+
+      vkCmdBindDescriptorSets(commandBuffer,
+                              VK_PIPELINE_BIND_POINT_GRAPHICS,
+                              pipelineLayout,
+                              set,
+                              1,
+                              &descriptorSet,
+                              1,
+                              &dynamicOffset);
+    }
+
+  private:
+    utils::mem::AlignedVector<T> mObjects;
+
+    Buffer                       mBuffer;
+
+    VkDeviceSize                 mFrameSize;
+    size_type                    mNumFrames;
+}; // class DynamicUniformBuffer
+
+} // namespace vk
+} // namespace so
+
+template<typename T>
+so::vk::DynamicUniformBuffer<T>::DynamicUniformBuffer()
+  : mObjects(),
+    mBuffer(),
+    mFrameSize(0),
+    mNumFrames(0)
+{}
+
+template<typename T>
+so::return_t
+so::vk::DynamicUniformBuffer<T>::initialize
+  (SharedPtrMemoryAllocator const& allocator,
+   size_type                const  numFramesInFlight,
+   size_type                const  capacity)
+{
+  VkPhysicalDeviceLimits const& limits
+    { allocator->getDevice()->getVkPhysicalDeviceProperties().limits };
+
+  auto const alignment
+    { std::max(static_cast<size_type>(limits.minUniformBufferOffsetAlignment),
+               size_type{ 16 }) };
+
+  if(sizeof(T) > limits.maxUniformBufferRange)
+  {
+    DEBUG_CALLBACK(error,
+                   "A dynamic uniform buffer object exceeds "
+                   "maxUniformBufferRange.");
+
+    return failure;
+  }
+
+  mObjects   = utils::mem::AlignedVector<T>(alignment, capacity);
+  mFrameSize = capacity * mObjects.stride();
+  mNumFrames = numFramesInFlight;
+
+  VkDeviceSize const size{ mFrameSize * mNumFrames };
+
+  // Dynamic offsets are 32 bit.
+  if(size > std::numeric_limits<uint32_t>::max())
+  {
+    DEBUG_CALLBACK(error,
+                   "A dynamic uniform buffer ring exceeds 4 GiB.");
+
+    return failure;
+  }
+
+  AllocationInfo allocationInfo{};
+
+  allocationInfo.requiredFlags  = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+  allocationInfo.preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+  if(mBuffer.initialize(allocator,
+                        std::max(size, VkDeviceSize{ 1 }),
+                        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                        allocationInfo) is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to create a dynamic uniform buffer.",
+                   Buffer::initialize);
+
+    return failure;
+  }
+
+  return success;
+}
+
+template<typename T>
+so::return_t
+so::vk::DynamicUniformBuffer<T>::flush(index_t   const frame,
+                                       size_type const count)
+{
+  size_type const numObjects{ std::min(count, mObjects.size()) };
+
+  if(numObjects is_eq 0)
+  {
+    return success;
+  }
+
+  VkDeviceSize const offset{ static_cast<VkDeviceSize>(frame) * mFrameSize };
+  VkDeviceSize const size{ numObjects * getStride() };
+
+  std::memcpy(static_cast<char*>(mBuffer.getMappedData()) + offset,
+              mObjects.data(),
+              static_cast<size_type>(size));
+
+  return mBuffer.flush(offset, size);
+}
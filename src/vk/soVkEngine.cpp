@@ -23,12 +23,117 @@
 #include "soVkEngine.hpp"
 
 #include "cxx/soDebugCallback.hpp"
+#include "cxx/soFileSystem.hpp"
+#include "cxx/soPoolAllocator.hpp"
+#include "cxx/soProfiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+
+namespace {
+
+// Weight of the newest sample in the moving averages of so::FrameStatistics.
+constexpr double statisticsSmoothing{ 0.1 };
+
+struct
+MaterialDescriptors
+{
+  VkDescriptorImageInfo albedo;
+};
+
+/*
+ * Pixels a bounding sphere covers along the height of the viewport, for a
+ * column major view projection matrix whose view part does not scale.
+ */
+float
+getScreenSize(float                 const  x,
+              float                 const  y,
+              float                 const  z,
+              float                 const  radius,
+              std::array<float, 16> const& viewProjection,
+              uint32_t              const  height)
+{
+  std::array<float, 16> const& m{ viewProjection };
+
+  // Clip space y per unit of length, and w of the center.
+  float const scaleY{ std::sqrt(m[1] * m[1] + m[5] * m[5] + m[9] * m[9]) };
+  float const w{ m[3] * x + m[7] * y + m[11] * z + m[15] };
+
+  // Spheres covering the whole viewport or reaching behind the camera.
+  if(w <= radius * scaleY)
+  {
+    return static_cast<float>(height);
+  }
+
+  return radius * scaleY / w * static_cast<float>(height);
+}
+
+/*
+ * Bounding sphere, center and radius, of bounds moved by the column major
+ * transform. The radius grows with the largest scale of the transform.
+ */
+std::array<float, 4>
+getBoundingSphere(so::vk::MeshBounds    const& bounds,
+                  std::array<float, 16> const& transform)
+{
+  std::array<float, 3> center;
+
+  float squaredRadius{ 0.0f };
+
+  for(so::size_type i{ 0 }; i < 3; ++i)
+  {
+    float const halfExtent{ 0.5f * (bounds.max[i] - bounds.min[i]) };
+
+    center[i]      = 0.5f * (bounds.max[i] + bounds.min[i]);
+    squaredRadius += halfExtent * halfExtent;
+  }
+
+  std::array<float, 4> sphere;
+
+  float maxSquaredScale{ 0.0f };
+
+  for(so::size_type row{ 0 }; row < 3; ++row)
+  {
+    sphere[row] = transform[row]     * center[0] +
+                  transform[4 + row] * center[1] +
+                  transform[8 + row] * center[2] +
+                  transform[12 + row];
+  }
+
+  for(so::size_type column{ 0 }; column < 3; ++column)
+  {
+    float const* const axis{ transform.data() + 4 * column };
+
+    maxSquaredScale = std::max(maxSquaredScale,
+                               axis[0] * axis[0] +
+                               axis[1] * axis[1] +
+                               axis[2] * axis[2]);
+  }
+
+  sphere[3] = std::sqrt(squaredRadius * maxSquaredScale);
+
+  return sphere;
+}
+
+} // namespace
 
 
 so::Engine::Engine()
-  : mDebugCallback(),
+  : mJobSystem(),
+    mDebugCallback(),
     mSurface(), 
+    mDeletionQueue(),
     mSwapChain(),
+    mMemoryAllocator(vk::MemoryAllocator::getSharedPtrNullMemoryAllocator()),
+    mUploader(),
+    mTextureStreamer(),
+    mDescriptorAllocator(),
+    mFrameAllocator(),
+    mPipelineCache(vk::PipelineCache::getSharedPtrNullPipelineCache()),
+    mShaderModuleCache
+      (vk::ShaderModuleCache::getSharedPtrNullShaderModuleCache()),
     mRenderPass(),
     mPipeline(),
     mFramebuffers(),
@@ -36,8 +141,45 @@ so::Engine::Engine()
     mImageAvailableSemaphores(),
     mRenderFinishedSemaphores(),
     mInFlightFences(),
+    mCommandRecorder(),
+    mDrawCommands{ { 3, 1, 0, 0 } },
+    mMesh(),
+    mMeshPipeline(),
+    mMeshDrawCommands(),
+    mGpuDrivenRenderer(),
+    mMeshInstances(),
+    mViewProjection(),
+    mHasViewProjection(false),
+    mGpuDrivenDrawing(false),
+    mRenderQueue(),
+    mMaterialSetLayout(),
+    mQueuePipeline(),
+    mQueuePipelineId(0),
+    mMeshTexture(vk::invalidTexture),
+    mInstanceCuller(),
+    mVisibleInstances(),
+    mFrameCapture(),
+    mRenderGraph(),
+    mSwapChainImage(vk::RenderGraph::invalidId),
+    mDrawBuffer(vk::RenderGraph::invalidId),
+    mDrawCountBuffer(vk::RenderGraph::invalidId),
+    mCullResetPass(vk::RenderGraph::invalidId),
+    mCullPass(vk::RenderGraph::invalidId),
+    mInstancesPass(vk::RenderGraph::invalidId),
+    mScenePass(vk::RenderGraph::invalidId),
+    mCapturePass(vk::RenderGraph::invalidId),
+    mGpuProfiler(),
+    mImagesInFlight(),
     mCurrentFrame(0),
-    mFramebuffersResized(false)
+    mImageIndex(0),
+    mSubmittedFrames(0),
+    mFrameCaptureEnabled(false),
+    mFramebuffersResized(false),
+    mFrameStatistics(),
+    mLastFrameStart(),
+    mFramePacer(),
+    mLastInputTime(),
+    mLastPacingWaitTime(0.0)
 {}
 
 so::Engine::~Engine() noexcept
@@ -47,6 +189,15 @@ so::Engine::~Engine() noexcept
   if(device not_eq VK_NULL_HANDLE)
   {
     vkDeviceWaitIdle(device);
+
+    mPipelineCache->save();
+  }
+
+  char const* const traceFile{ std::getenv("SO_PROFILE_TRACE") };
+
+  if(traceFile not_eq nullptr)
+  {
+    writeProfileTrace(traceFile);
   }
 }
 
@@ -54,8 +205,13 @@ so::Engine::~Engine() noexcept
 so::return_t
 so::Engine::initialize(std::string const& applicationName,
                        uint32_t    const  applicationVersion,
-                       size_type   const  maxFramesInFlight)
+                       size_type   const  maxFramesInFlight,
+                       size_type   const  numThreads)
 {
+  SO_PROFILE_ZONE("Engine::initialize");
+
+  mJobSystem.initialize(numThreads);
+
   so::return_t result;
 
   if(mSurface.initialize() is_eq failure)
@@ -63,7 +219,8 @@ so::Engine::initialize(std::string const& applicationName,
     return failure;
   }
  
-  vk::SharedPtrInstance instance{ std::make_shared<vk::Instance>() };
+  vk::SharedPtrInstance instance
+    { utils::mem::makePooledShared<vk::Instance>() };
 
   std::vector<char const*> instanceExtensions;
 
@@ -98,7 +255,8 @@ so::Engine::initialize(std::string const& applicationName,
     return failure;
   }
 
-  vk::SharedPtrLogicalDevice device{ std::make_shared<vk::LogicalDevice>() };
+  vk::SharedPtrLogicalDevice device
+    { utils::mem::makePooledShared<vk::LogicalDevice>() };
 
   if(device->initialize(instance, mSurface) is_eq failure)
   {
@@ -110,27 +268,101 @@ so::Engine::initialize(std::string const& applicationName,
     return failure;
   }
 
-  vk::SharedPtrCommandPool commandPool{ std::make_shared<vk::CommandPool>() };
+  if(mRenderPass.initialize(device, mSwapChain) is_eq failure)
+  {
+    std::string message{ "Failed to create a render pass." };
+
+    DEBUG_CALLBACK(error, message, vk::RenderPass::initialize);
+
+    return failure;
+  }
+
+  mMemoryAllocator = utils::mem::makePooledShared<vk::MemoryAllocator>();
+
+  if(mMemoryAllocator->initialize(device) is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to create the memory allocator.",
+                   vk::MemoryAllocator::initialize);
+
+    return failure;
+  }
+
+  if(mUploader.initialize(device, mMemoryAllocator) is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to create the uploader.",
+                   vk::Uploader::initialize);
+
+    return failure;
+  }
+
+  result = mTextureStreamer.initialize(device,
+                                       mMemoryAllocator,
+                                       mUploader,
+                                       mDeletionQueue);
 
-  if(commandPool->initialize(device, mSurface) is_eq failure)
+  if(result is_eq failure)
   {
-    std::string message{ "Failed to create a command pool." };
+    DEBUG_CALLBACK(error,
+                   "Failed to create the texture streamer.",
+                   vk::TextureStreamer::initialize);
+
+    return failure;
+  }
 
-    DEBUG_CALLBACK(error, message, vk::CommandPool::initialize);
+  vk::DescriptorBinding albedo;
+
+  albedo.binding = 0;
+  albedo.type    = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+  albedo.stages  = VK_SHADER_STAGE_FRAGMENT_BIT;
+  albedo.offset  = offsetof(MaterialDescriptors, albedo);
+
+  if(mMaterialSetLayout.initialize(device, { albedo }) is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to create the material descriptor set layout.",
+                   vk::DescriptorSetLayout::initialize);
 
     return failure;
   }
 
-  if(mRenderPass.initialize(device, mSwapChain) is_eq failure)
+  if(mDescriptorAllocator.initialize(device,
+                                     maxFramesInFlight) is_eq failure)
   {
-    std::string message{ "Failed to create a render pass." };
- 
-    DEBUG_CALLBACK(error, message, vk::RenderPass::initialize);
+    DEBUG_CALLBACK(error,
+                   "Failed to create the descriptor allocator.",
+                   vk::DescriptorAllocator::initialize);
 
     return failure;
   }
 
-  if(mPipeline.initialize(device, mSwapChain, mRenderPass) is_eq failure)
+  mFrameAllocator.initialize(maxFramesInFlight);
+
+  mPipelineCache = utils::mem::makePooledShared<vk::PipelineCache>();
+
+  result = mPipelineCache->initialize(device,
+                                      BIN_DIR + "/data/pipeline_cache.bin");
+
+  if(result is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to create the pipeline cache.",
+                   vk::PipelineCache::initialize);
+
+    return failure;
+  }
+
+  mShaderModuleCache = utils::mem::makePooledShared<vk::ShaderModuleCache>();
+
+  mShaderModuleCache->initialize(device);
+
+  result = mPipeline.initialize(device,
+                                mRenderPass,
+                                mPipelineCache,
+                                mShaderModuleCache);
+
+  if(result is_eq failure)
   {
     std::string message{ "Failed to create a graphics pipeline." };
 
@@ -139,6 +371,49 @@ so::Engine::initialize(std::string const& applicationName,
     return failure;
   }
 
+  {
+    std::string message{ "Created the graphics pipeline in " };
+
+    message += std::to_string(mPipeline.getCreationTime().count());
+    message += mPipelineCache->isWarm() ? " ms (warm pipeline cache)."
+                                        : " ms (cold pipeline cache).";
+
+    DEBUG_CALLBACK(info, message);
+  }
+
+  // Without it meshes are still drawn, just not their instances.
+  mGpuDrivenDrawing = mGpuDrivenRenderer.initialize(device,
+                                                    mMemoryAllocator,
+                                                    mUploader,
+                                                    mDescriptorAllocator,
+                                                    mDeletionQueue,
+                                                    maxFramesInFlight,
+                                                    mPipelineCache,
+                                                    mShaderModuleCache)
+                      is_eq success;
+
+  result = mRenderQueue.initialize(device,
+                                   mMemoryAllocator,
+                                   mDescriptorAllocator,
+                                   mDeletionQueue,
+                                   maxFramesInFlight);
+
+  if(result is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to create the render queue.",
+                   vk::RenderQueue::initialize);
+
+    return failure;
+  }
+
+  mQueuePipelineId = mRenderQueue.addPipeline(mQueuePipeline);
+
+  if(not mGpuDrivenDrawing)
+  {
+    mInstanceCuller.initialize(mJobSystem);
+  }
+
   if(mFramebuffers.initialize(device, mSwapChain, mRenderPass) is_eq failure)
   {
     std::string message{ "Failed to create framebuffers." };
@@ -148,12 +423,7 @@ so::Engine::initialize(std::string const& applicationName,
     return failure;
   }
 
-  result = mCommandBuffers.initialize(device,
-                                      commandPool,
-                                      mFramebuffers,
-                                      mRenderPass,
-                                      mSwapChain,
-                                      mPipeline);
+  result = mCommandBuffers.initialize(device, mSurface, maxFramesInFlight);
   
   if(result is_eq failure)
   {
@@ -164,6 +434,20 @@ so::Engine::initialize(std::string const& applicationName,
     return failure;
   }
 
+  result = mCommandRecorder.initialize(device,
+                                       mSurface,
+                                       maxFramesInFlight,
+                                       mJobSystem);
+
+  if(result is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to create the command recording slices.",
+                   vk::ParallelCommandRecorder::initialize);
+
+    return failure;
+  }
+
   result = mImageAvailableSemaphores.initialize(device, maxFramesInFlight);
   result = result is_eq failure
              ? failure
@@ -187,20 +471,159 @@ so::Engine::initialize(std::string const& applicationName,
     return failure;
   }
 
+  result = mFrameCapture.initialize(mMemoryAllocator, maxFramesInFlight);
+
+  if(result is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to set up frame capture.",
+                   vk::FrameCapture::initialize);
+
+    return failure;
+  }
+
+  result = mRenderGraph.initialize(device,
+                                   mMemoryAllocator,
+                                   mDeletionQueue,
+                                   maxFramesInFlight);
+
+  if((result is_eq failure) or (buildRenderGraph() is_eq failure))
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to set up the render graph.",
+                   Engine::buildRenderGraph);
+
+    return failure;
+  }
+
+  if(mGpuProfiler.initialize(device, mSurface, maxFramesInFlight) is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to set up GPU profiling.",
+                   vk::GpuProfiler::initialize);
+
+    return failure;
+  }
+
+  mImagesInFlight.assign(mSwapChain.getVkImages().size(), VK_NULL_HANDLE);
+
   return success;
 }
 
+so::return_t
+so::Engine::setFrameCaptureEnabled(bool const enabled)
+{
+  bool const isSupported{ (mSwapChain.getVkImageUsage() bitand
+                           VK_IMAGE_USAGE_TRANSFER_SRC_BIT) not_eq 0 };
+
+  if(enabled and not isSupported)
+  {
+    DEBUG_CALLBACK(error,
+                   "The swap chain images of this surface cannot be read "
+                   "back.");
+
+    return failure;
+  }
+
+  mFrameCaptureEnabled = enabled;
+
+  mRenderGraph.setPassEnabled(mCapturePass, enabled);
+
+  return success;
+}
+
+so::return_t
+so::Engine::captureFrame(vk::CapturedFrame& capturedFrame)
+{
+  if(mSubmittedFrames is_eq 0)
+  {
+    return failure;
+  }
+
+  size_type const maxFramesInFlight
+    { mImageAvailableSemaphores.getVkSemaphoresRef().size() };
+
+  auto const lastFrame
+    { static_cast<index_t>((mSubmittedFrames - 1) % maxFramesInFlight) };
+
+  FrameStatistics::duration waitTime{ 0.0 };
+
+  waitForFence(mInFlightFences[lastFrame], waitTime);
+
+  return mFrameCapture.read(lastFrame, capturedFrame);
+}
+
+void
+so::Engine::surfacePollEvents()
+{
+  {
+    SO_PROFILE_ZONE("Engine::pace");
+
+    mLastPacingWaitTime = mFramePacer.wait();
+  }
+
+  mLastInputTime = clock::now();
+
+  mSurface.pollEvents();
+}
+
+so::return_t
+so::Engine::setPresentPolicy(vk::PresentPolicy const policy)
+{
+  if(policy is_eq mSwapChain.getPresentPolicy())
+  {
+    return success;
+  }
+
+  mSwapChain.setPresentPolicy(policy);
+
+  if(mSwapChain.getVkSwapchainKHR() is_eq VK_NULL_HANDLE)
+  {
+    return success;
+  }
+
+  return recreateSwapChain();
+}
+
 so::return_t
 so::Engine::drawFrame()
 {
+  SO_PROFILE_ZONE("Engine::drawFrame");
+
+  clock::time_point const frameStart{ clock::now() };
+
+  FrameStatistics::duration fenceWaitTime{ 0.0 };
+
   VkDevice device{ mSwapChain.getDevice()->getVkDevice() };
 
-  vkWaitForFences(device,
-                  1,
-                  &mInFlightFences[mCurrentFrame],
-                  VK_TRUE,
-                  std::numeric_limits<uint64_t>::max());
- 
+  // Images the streamer replaces may still be sampled by frames in flight.
+  mDeletionQueue.setSubmittedFrames(mSubmittedFrames);
+
+  mTextureStreamer.update();
+
+  mGpuDrivenRenderer.update();
+
+  // Uploads requested since the last frame run on their own queue while the
+  // CPU waits and records.
+  mUploader.submit();
+
+  waitForFence(mInFlightFences[mCurrentFrame], fenceWaitTime);
+
+  size_type const maxFramesInFlight
+    { mImageAvailableSemaphores.getVkSemaphoresRef().size() };
+
+  // The fence we just waited for belongs to the submission maxFramesInFlight
+  // frames ago, and all submissions before it were waited for earlier.
+  if(mSubmittedFrames >= maxFramesInFlight)
+  {
+    mDeletionQueue.collect(mSubmittedFrames - maxFramesInFlight + 1);
+  }
+
+  // Every set and temporary allocated for this frame slot was last used by
+  // the submission we just waited for.
+  mDescriptorAllocator.beginFrame(mCurrentFrame);
+  mFrameAllocator.beginFrame(mCurrentFrame);
+
   uint32_t imageIndex;
 
   VkSemaphore imageAvailableSemaphore
@@ -209,17 +632,25 @@ so::Engine::drawFrame()
   VkSemaphore renderFinishedSemaphore
     { mRenderFinishedSemaphores.getVkSemaphoresRef()[mCurrentFrame] };
 
-  VkResult result{ vkAcquireNextImageKHR(getVkDevice(),
-                                         mSwapChain.getVkSwapchainKHR(),
-                                         std::numeric_limits<uint64_t>::max(),
-                                         imageAvailableSemaphore,
-                                         VK_NULL_HANDLE,
-                                         &imageIndex) };
+  VkResult result{ VK_SUCCESS };
+
+  {
+    SO_PROFILE_ZONE("vkAcquireNextImageKHR");
+
+    result = vkAcquireNextImageKHR(getVkDevice(),
+                                   mSwapChain.getVkSwapchainKHR(),
+                                   std::numeric_limits<uint64_t>::max(),
+                                   imageAvailableSemaphore,
+                                   VK_NULL_HANDLE,
+                                   &imageIndex);
+  }
 
   if(result is_eq VK_ERROR_OUT_OF_DATE_KHR)
   {
     recreateSwapChain();
 
+    updateFrameStatistics(frameStart, fenceWaitTime);
+
     return success;
   }
   else if((result not_eq VK_SUCCESS) and (result not_eq VK_SUBOPTIMAL_KHR))
@@ -231,6 +662,87 @@ so::Engine::drawFrame()
     return failure;
   }
 
+  // The image may still be in use by an older frame whose fence is not the
+  // one we just waited for, e.g. if the swap chain returns images out of order
+  // or has more images than frames in flight.
+  VkFence& imageInFlight{ mImagesInFlight[imageIndex] };
+
+  if(imageInFlight not_eq VK_NULL_HANDLE)
+  {
+    waitForFence(imageInFlight, fenceWaitTime);
+  }
+
+  imageInFlight = mInFlightFences[mCurrentFrame];
+
+  // The fence of this frame has signaled, so its command pools can be reset.
+  VkCommandBuffer commandBuffer
+    { mCommandBuffers.getVkCommandBuffer(mCurrentFrame) };
+
+  return_t recordResult{ mCommandBuffers.begin(mCurrentFrame) };
+
+  if(recordResult is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to begin the command buffer of a frame.",
+                   vk::CommandBuffers::begin);
+  }
+  else
+  {
+    SO_PROFILE_ZONE("Engine::record");
+
+    mGpuProfiler.beginFrame(commandBuffer, mCurrentFrame);
+
+    mUploader.acquire(commandBuffer);
+
+    vk::GpuProfiler::ScopedZone const frameZone
+      { mGpuProfiler, commandBuffer, mCurrentFrame, "frame" };
+
+    mImageIndex = imageIndex;
+
+    mRenderGraph.setImage(mSwapChainImage,
+                          mSwapChain.getVkImages()[imageIndex]);
+
+    bool const drawInstances{ drawsGpuDrivenInstances() };
+
+    mRenderGraph.setPassEnabled(mCullResetPass, drawInstances);
+    mRenderGraph.setPassEnabled(mCullPass, drawInstances);
+    mRenderGraph.setPassEnabled(mInstancesPass, drawInstances);
+    mRenderGraph.setPassEnabled(mScenePass, not drawInstances);
+
+    mRenderGraph.setBuffer(mDrawBuffer,
+                           mGpuDrivenRenderer.getVkDrawBuffer());
+    mRenderGraph.setBuffer(mDrawCountBuffer,
+                           mGpuDrivenRenderer.getVkCountBuffer());
+
+    recordResult = mRenderGraph.execute(commandBuffer, mCurrentFrame);
+
+    if(recordResult is_eq failure)
+    {
+      DEBUG_CALLBACK(error,
+                     "Failed to record the render graph of a frame.",
+                     vk::RenderGraph::execute);
+    }
+
+    if(not mFrameCaptureEnabled)
+    {
+      mFrameCapture.discard(mCurrentFrame);
+    }
+  }
+
+  if(recordResult is_eq failure)
+  {
+    return failure;
+  }
+
+  if(mCommandBuffers.end(mCurrentFrame) is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to end the command buffer of a frame.",
+                   vk::CommandBuffers::end);
+
+    return failure;
+  }
+
   VkSubmitInfo submitInfo{};
 
   submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -244,8 +756,7 @@ so::Engine::drawFrame()
   submitInfo.pWaitSemaphores      = waitSemaphores;
   submitInfo.pWaitDstStageMask    = waitStages;
   submitInfo.commandBufferCount   = 1;
-  submitInfo.pCommandBuffers      =
-    &mCommandBuffers.getVkCommandBuffersRef()[imageIndex];
+  submitInfo.pCommandBuffers      = &commandBuffer;
 
   VkSemaphore signalSemaphores[]{ renderFinishedSemaphore };
 
@@ -254,10 +765,14 @@ so::Engine::drawFrame()
 
   vkResetFences(device, 1, &mInFlightFences[mCurrentFrame]);
 
-  result = vkQueueSubmit(mSwapChain.getDevice()->getGraphicsVkQueue(),
-                         1,
-                         &submitInfo,
-                         mInFlightFences[mCurrentFrame]);
+  {
+    SO_PROFILE_ZONE("vkQueueSubmit");
+
+    result = vkQueueSubmit(mSwapChain.getDevice()->getGraphicsVkQueue(),
+                           1,
+                           &submitInfo,
+                           mInFlightFences[mCurrentFrame]);
+  }
   
   if(result not_eq VK_SUCCESS)
   {
@@ -267,6 +782,13 @@ so::Engine::drawFrame()
   
     return failure;
   }
+
+  // Advance right after submitting, so that the frame index always matches
+  // the number of submissions, even if presenting fails below.
+  ++mSubmittedFrames;
+
+  mCurrentFrame = (mCurrentFrame + 1) %
+                  static_cast<index_t>(maxFramesInFlight);
   
   VkPresentInfoKHR presentInfo{};
 
@@ -281,12 +803,22 @@ so::Engine::drawFrame()
   presentInfo.pImageIndices  = &imageIndex;
   presentInfo.pResults       = nullptr; // optional
 
-  result = vkQueuePresentKHR(mSwapChain.getDevice()->getPresentVkQueue(),
-                             &presentInfo);
+  {
+    SO_PROFILE_ZONE("vkQueuePresentKHR");
+
+    result = vkQueuePresentKHR(mSwapChain.getDevice()->getPresentVkQueue(),
+                               &presentInfo);
+  }
+
+  clock::time_point const presentTime{ clock::now() };
 
   bool const outOfDateSwapChain{  result is_eq VK_ERROR_OUT_OF_DATE_KHR };
   bool const suboptimalSwapChain{ result is_eq VK_SUBOPTIMAL_KHR };
 
+  // Not every platform reports a resize through the present result.
+  mFramebuffersResized = mFramebuffersResized or
+                         mSurface.framebuffersAreResized();
+
   if(outOfDateSwapChain or suboptimalSwapChain or mFramebuffersResized)
   {
     recreateSwapChain();
@@ -302,77 +834,722 @@ so::Engine::drawFrame()
     return failure;
   }
 
-  vkQueueWaitIdle(mSwapChain.getDevice()->getPresentVkQueue());
+  updateFrameStatistics(frameStart, fenceWaitTime);
 
-  size_type const maxFramesInFlight
-    { mImageAvailableSemaphores.getVkSemaphoresRef().size() };
+  if(mLastInputTime not_eq clock::time_point{})
+  {
+    FrameStatistics& stats{ mFrameStatistics };
 
-  mCurrentFrame = (mCurrentFrame + 1) %
-                  static_cast<index_t>(maxFramesInFlight); 
+    stats.inputToPresentLatency = presentTime - mLastInputTime;
+
+    stats.averageInputToPresentLatency =
+      stats.frameCount <= 1
+        ? stats.inputToPresentLatency
+        : stats.averageInputToPresentLatency +
+          statisticsSmoothing * (stats.inputToPresentLatency -
+                                 stats.averageInputToPresentLatency);
+
+    // Only measure frames whose input was actually polled.
+    mLastInputTime = clock::time_point{};
+  }
 
   return success;
 }
 
+void
+so::Engine::waitForFence(VkFence                    fence,
+                         FrameStatistics::duration& waitTime)
+{
+  VkDevice device{ getVkDevice() };
+
+  // Only take the time if we actually block.
+  if(vkGetFenceStatus(device, fence) is_eq VK_SUCCESS)
+  {
+    return;
+  }
+
+  SO_PROFILE_ZONE("Engine::waitForFence");
+
+  clock::time_point const waitStart{ clock::now() };
+
+  vkWaitForFences(device,
+                  1,
+                  &fence,
+                  VK_TRUE,
+                  std::numeric_limits<uint64_t>::max());
+
+  waitTime += clock::now() - waitStart;
+}
+
+void
+so::Engine::updateFrameStatistics
+  (clock::time_point         const frameStart,
+   FrameStatistics::duration const fenceWaitTime)
+{
+  clock::time_point const lastFrameStart{ mLastFrameStart };
+
+  mLastFrameStart = frameStart;
+
+  // The frame time is measured from the start of one drawFrame call to the
+  // next one, so the first frame has nothing to compare against.
+  if(lastFrameStart is_eq clock::time_point{})
+  {
+    return;
+  }
+
+  FrameStatistics& stats{ mFrameStatistics };
+
+  stats.frameTime      = frameStart - lastFrameStart;
+  stats.fenceWaitTime  = fenceWaitTime;
+  stats.pacingWaitTime = mLastPacingWaitTime;
+  stats.cpuGpuOverlap =
+    stats.frameTime.count() > 0.0
+      ? 1.0 - std::min(1.0, fenceWaitTime.count() / stats.frameTime.count())
+      : 0.0;
+
+  if(stats.frameCount is_eq 0)
+  {
+    stats.averageFrameTime     = stats.frameTime;
+    stats.averageFenceWaitTime = stats.fenceWaitTime;
+    stats.averageCpuGpuOverlap = stats.cpuGpuOverlap;
+  }
+  else
+  {
+    stats.averageFrameTime     += statisticsSmoothing *
+                                  (stats.frameTime - stats.averageFrameTime);
+    stats.averageFenceWaitTime += statisticsSmoothing *
+                                  (stats.fenceWaitTime -
+                                   stats.averageFenceWaitTime);
+    stats.averageCpuGpuOverlap += statisticsSmoothing *
+                                  (stats.cpuGpuOverlap -
+                                   stats.averageCpuGpuOverlap);
+  }
+
+  ++stats.frameCount;
+}
+
 so::return_t
-so::Engine::recreateSwapChain()
+so::Engine::loadMesh(std::string const& filename)
 {
-  vkDeviceWaitIdle(mSwapChain.getDevice()->getVkDevice());
+  SO_PROFILE_ZONE("Engine::loadMesh");
 
-  if(mSwapChain.reset(mSurface) is_eq failure)
+  vk::Mesh mesh;
+
+  if(mesh.initialize(mMemoryAllocator, mUploader, filename) is_eq failure)
   {
     DEBUG_CALLBACK(error,
-                   "Failed to reset the swap chain during swap chain "
-                   "recreation.",
-                   vk::SwapChain::reset);
+                   "Failed to load the mesh " + filename + ".",
+                   vk::Mesh::initialize);
 
     return failure;
   }
 
-  if(mRenderPass.reset(mSwapChain) is_eq failure)
+  // The old mesh and pipeline may still be drawn by frames in flight.
+  mDeletionQueue.setSubmittedFrames(mSubmittedFrames);
+
+  bool const needsPipeline
+    { mMeshPipeline.getVkPipeline() is_eq VK_NULL_HANDLE
+      or mMeshPipeline.getVertexFormat() not_eq mesh.getVertexFormat() };
+
+  if(needsPipeline)
+  {
+    mDeletionQueue.retire(std::move(mMeshPipeline));
+
+    return_t const result{ mMeshPipeline.initialize(mSwapChain.getDevice(),
+                                                    mRenderPass,
+                                                    mPipelineCache,
+                                                    mShaderModuleCache,
+                                                    mesh.getVertexFormat()) };
+
+    if(result is_eq failure)
+    {
+      DEBUG_CALLBACK(error,
+                     "Failed to create the mesh pipeline.",
+                     vk::Pipeline::initialize);
+
+      return failure;
+    }
+  }
+
+  mDeletionQueue.retire(std::move(mMesh));
+
+  mMesh             = std::move(mesh);
+  mMeshDrawCommands = mMesh.getDrawCommands();
+
+  if(not mMeshInstances.empty())
+  {
+    return setMeshInstances(std::move(mMeshInstances));
+  }
+
+  return success;
+}
+
+so::return_t
+so::Engine::loadMeshTexture(std::string const& filename, bool const isSrgb)
+{
+  SO_PROFILE_ZONE("Engine::loadMeshTexture");
+
+  vk::TextureHandle texture{ vk::invalidTexture };
+
+  if(mTextureStreamer.load(filename, texture, isSrgb) is_eq failure)
   {
     DEBUG_CALLBACK(error,
-                   "Failed to reset the render pass during swap chain "
-                   "recreation.",
-                   vk::RenderPass::reset);
+                   "Failed to load the texture " + filename + ".",
+                   vk::TextureStreamer::load);
 
     return failure;
   }
 
-  if(mPipeline.reset(mSwapChain, mRenderPass) is_eq failure)
+  mMeshTexture = texture;
+
+  // The queue pipeline has to sample the texture from now on.
+  if(mMesh.isValid() and not mGpuDrivenDrawing)
+  {
+    mDeletionQueue.setSubmittedFrames(mSubmittedFrames);
+
+    return setQueuedInstances();
+  }
+
+  return success;
+}
+
+so::return_t
+so::Engine::setMeshInstances(std::vector<vk::MeshInstance> instances)
+{
+  mMeshInstances = std::move(instances);
+
+  if(not mMesh.isValid())
+  {
+    return success;
+  }
+
+  mDeletionQueue.setSubmittedFrames(mSubmittedFrames);
+
+  if(not mGpuDrivenDrawing)
+  {
+    return setQueuedInstances();
+  }
+
+  if(mGpuDrivenRenderer.setInstances(mMesh,
+                                     mRenderPass,
+                                     mMeshInstances) is_eq failure)
   {
     DEBUG_CALLBACK(error,
-                   "Failed to reset the graphics pipeline during swap chain "
-                   "recreation.",
-                   vk::Pipeline::reset);
+                   "Failed to set the mesh instances.",
+                   vk::GpuDrivenRenderer::setInstances);
 
     return failure;
   }
 
-  if(mFramebuffers.reset(mSwapChain, mRenderPass) is_eq failure)
+  return success;
+}
+
+std::array<float, 16>
+so::Engine::getMeshTransform() const
+{
+  vk::MeshBounds const& bounds{ mMesh.getBounds() };
+  VkExtent2D const      extent{ mSwapChain.getVkExtent() };
+
+  float center[3];
+  float halfSize[3];
+
+  for(size_type axis{ 0 }; axis < 3; ++axis)
+  {
+    center[axis]   = 0.5f * (bounds.min[axis] + bounds.max[axis]);
+    halfSize[axis] = std::max(0.5f * (bounds.max[axis] - bounds.min[axis]),
+                              1e-6f);
+  }
+
+  float const aspect{ static_cast<float>(std::max(extent.width, 1u)) /
+                      static_cast<float>(std::max(extent.height, 1u)) };
+
+  // Leave a small margin and keep pixels square.
+  float const scale{ 0.9f / std::max(halfSize[0] / aspect, halfSize[1]) };
+
+  float const scaleX{ scale / aspect };
+  float const scaleY{ -scale };                   // Vulkan's y points down.
+  float const scaleZ{ -0.5f / halfSize[2] };      // Larger z is closer.
+
+  return { { scaleX,              0.0f,                0.0f,        0.0f,
+             0.0f,                scaleY,              0.0f,        0.0f,
+             0.0f,                0.0f,                scaleZ,      0.0f,
+             -center[0] * scaleX, -center[1] * scaleY,
+             0.5f - center[2] * scaleZ,                             1.0f } };
+}
+
+so::return_t
+so::Engine::setQueuedInstances()
+{
+  // Nothing is drawn through the queue until the instances are complete.
+  mInstanceCuller.resize(0);
+
+  std::vector<vk::SubMesh> const& subMeshes{ mMesh.getSubMeshes() };
+
+  for(auto const& instance : mMeshInstances)
+  {
+    if(instance.subMesh >= subMeshes.size())
+    {
+      DEBUG_CALLBACK(error, "A mesh instance refers to a missing sub-mesh.");
+
+      return failure;
+    }
+  }
+
+  if(mMeshInstances.empty())
+  {
+    return success;
+  }
+
+  bool const isTextured
+    { mQueuePipeline.getVkDescriptorSetLayouts().size() > 1 };
+
+  bool const needsPipeline
+    { mQueuePipeline.getVkPipeline() is_eq VK_NULL_HANDLE
+      or mQueuePipeline.getVertexFormat() not_eq mMesh.getVertexFormat()
+      or isTextured not_eq usesMeshTexture() };
+
+  if(needsPipeline and (createQueuePipeline() is_eq failure))
+  {
+    return failure;
+  }
+
+  mInstanceCuller.resize(mMeshInstances.size());
+
+  for(size_type i{ 0 }; i < mMeshInstances.size(); ++i)
+  {
+    vk::MeshInstance const& instance{ mMeshInstances[i] };
+
+    std::array<float, 4> const sphere
+      { getBoundingSphere(subMeshes[instance.subMesh].bounds,
+                          instance.transform) };
+
+    mInstanceCuller.setSphere(i,
+                              { { sphere[0], sphere[1], sphere[2] } },
+                              sphere[3]);
+  }
+
+  return success;
+}
+
+so::return_t
+so::Engine::createQueuePipeline()
+{
+  mDeletionQueue.retire(std::move(mQueuePipeline));
+
+  std::vector<VkDescriptorSetLayout> layouts
+    { mRenderQueue.getInstanceSetLayout().getVkDescriptorSetLayout() };
+
+  if(usesMeshTexture())
+  {
+    layouts.push_back(mMaterialSetLayout.getVkDescriptorSetLayout());
+  }
+
+  return_t const result
+    { mQueuePipeline.initialize(mSwapChain.getDevice(),
+                                mRenderPass,
+                                mPipelineCache,
+                                mShaderModuleCache,
+                                mMesh.getVertexFormat(),
+                                layouts,
+                                usesMeshTexture() ? "textured"
+                                                  : "queued") };
+
+  if(result is_eq failure)
   {
     DEBUG_CALLBACK(error,
-                   "Failed to reset the render pass during swap chain "
+                   "Failed to create the render queue pipeline.",
+                   vk::Pipeline::initialize);
+
+    return failure;
+  }
+
+  return success;
+}
+
+bool
+so::Engine::usesMeshTexture() const
+{
+  return mMeshTexture not_eq vk::invalidTexture and
+         mMesh.getVertexFormat().has(vk::VertexAttribute::texCoord);
+}
+
+so::return_t
+so::Engine::recordQueuedInstances(VkCommandBuffer const commandBuffer,
+                                  VkFramebuffer   const framebuffer)
+{
+  std::array<float, 16> const viewProjection
+    { mHasViewProjection ? mViewProjection : getMeshTransform() };
+
+  FrustumCuller::Planes const planes
+    { FrustumCuller::getFrustumPlanes(viewProjection) };
+
+  mInstanceCuller.cull(planes);
+  mInstanceCuller.getVisibleIndices(mVisibleInstances);
+
+  std::vector<vk::SubMesh> const& subMeshes{ mMesh.getSubMeshes() };
+
+  float const* const x
+    { mInstanceCuller.getStream(FrustumCuller::Stream::sphereX) };
+  float const* const y
+    { mInstanceCuller.getStream(FrustumCuller::Stream::sphereY) };
+  float const* const z
+    { mInstanceCuller.getStream(FrustumCuller::Stream::sphereZ) };
+  float const* const radius
+    { mInstanceCuller.getStream(FrustumCuller::Stream::sphereRadius) };
+
+  auto const& nearPlane{ planes[4] };
+
+  mRenderQueue.clear();
+
+  VkDescriptorSet materialSet{ VK_NULL_HANDLE };
+
+  if(usesMeshTexture())
+  {
+    // Streamed levels only change in update(), so the set written for this
+    // frame stays valid until its submission has finished.
+    VkImageView const view{ mTextureStreamer.getVkImageView(mMeshTexture) };
+
+    // Nothing is drawn until the mip tail of the texture is resident.
+    if(view is_eq VK_NULL_HANDLE)
+    {
+      mVisibleInstances.clear();
+    }
+    else
+    {
+      MaterialDescriptors descriptors{};
+
+      descriptors.albedo = { mTextureStreamer.getVkSampler(),
+                             view,
+                             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+
+      if(mDescriptorAllocator.allocate(mMaterialSetLayout,
+                                       &descriptors,
+                                       materialSet) is_eq failure)
+      {
+        DEBUG_CALLBACK(error,
+                       "Failed to allocate the material descriptor set.",
+                       vk::DescriptorAllocator::allocate);
+
+        return failure;
+      }
+    }
+  }
+
+  uint32_t const height{ mSwapChain.getVkExtent().height };
+
+  float maxScreenSize{ 0.0f };
+
+  for(uint32_t const idx : mVisibleInstances)
+  {
+    vk::MeshInstance const& instance{ mMeshInstances[idx] };
+
+    vk::RenderItem item;
+
+    item.transform   = instance.transform;
+    item.mesh        = &mMesh;
+    item.subMesh     = instance.subMesh;
+    item.pipeline    = mQueuePipelineId;
+    item.material    = std::min(subMeshes[instance.subMesh].materialIndex,
+                                vk::RenderQueue::maxMaterials - 1);
+    item.materialSet = materialSet;
+
+    // Front to back, by the distance of the center from the near plane.
+    item.depth       = nearPlane[0] * x[idx] + nearPlane[1] * y[idx] +
+                       nearPlane[2] * z[idx] + nearPlane[3];
+
+    mRenderQueue.submit(item);
+
+    maxScreenSize = std::max(maxScreenSize,
+                             getScreenSize(x[idx],
+                                           y[idx],
+                                           z[idx],
+                                           radius[idx],
+                                           viewProjection,
+                                           height));
+  }
+
+  // The finest level any visible instance needs, fed into the next update.
+  if(materialSet not_eq VK_NULL_HANDLE)
+  {
+    mTextureStreamer.reportUsage(mMeshTexture, maxScreenSize);
+  }
+
+  return mRenderQueue.record(commandBuffer,
+                             mCurrentFrame,
+                             framebuffer,
+                             mRenderPass,
+                             mSwapChain,
+                             viewProjection);
+}
+
+so::return_t
+so::Engine::buildRenderGraph()
+{
+  mRenderGraph.clear();
+
+  // The first pass waits for the acquire semaphore at the color attachment
+  // output stage, which also orders the transition from UNDEFINED after it.
+  mSwapChainImage = mRenderGraph.importImage
+    ("swapChainImage",
+     VK_IMAGE_ASPECT_COLOR_BIT,
+     VK_IMAGE_LAYOUT_UNDEFINED,
+     VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+     VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+  // Written by the culling compute pass and read by the indirect draws. The
+  // regions of a frame are only reused after its fence has signaled.
+  mDrawBuffer      = mRenderGraph.importBuffer("draws");
+  mDrawCountBuffer = mRenderGraph.importBuffer("drawCount");
+
+  mCullResetPass = mRenderGraph.addPass
+    ("cullReset",
+     { { mDrawBuffer,      vk::ResourceAccess::transferWrite },
+       { mDrawCountBuffer, vk::ResourceAccess::transferWrite } },
+     [this](VkCommandBuffer const commandBuffer)
+     {
+       mGpuDrivenRenderer.recordReset(commandBuffer, mCurrentFrame);
+
+       return success;
+     });
+
+  mCullPass = mRenderGraph.addPass
+    ("cull",
+     { { mDrawBuffer,      vk::ResourceAccess::computeShaderWrite },
+       { mDrawCountBuffer, vk::ResourceAccess::computeShaderWrite } },
+     [this](VkCommandBuffer const commandBuffer)
+     {
+       vk::GpuProfiler::ScopedZone const cullZone
+         { mGpuProfiler, commandBuffer, mCurrentFrame, "cull" };
+
+       return mGpuDrivenRenderer.recordCulling
+         (commandBuffer,
+          mCurrentFrame,
+          mHasViewProjection ? mViewProjection : getMeshTransform());
+     });
+
+  mInstancesPass = mRenderGraph.addPass
+    ("instances",
+     { { mSwapChainImage,  vk::ResourceAccess::colorAttachmentWrite },
+       { mDrawBuffer,      vk::ResourceAccess::indirectRead },
+       { mDrawCountBuffer, vk::ResourceAccess::indirectRead } },
+     [this](VkCommandBuffer const commandBuffer)
+     {
+       vk::GpuProfiler::ScopedZone const sceneZone
+         { mGpuProfiler, commandBuffer, mCurrentFrame, "scene" };
+
+       return mGpuDrivenRenderer.record
+         (commandBuffer,
+          mCurrentFrame,
+          mFramebuffers.getVkFramebuffersRef()[mImageIndex],
+          mRenderPass,
+          mSwapChain,
+          mMesh,
+          mHasViewProjection ? mViewProjection : getMeshTransform());
+     });
+
+  mScenePass = mRenderGraph.addPass
+    ("scene",
+     { { mSwapChainImage, vk::ResourceAccess::colorAttachmentWrite } },
+     [this](VkCommandBuffer const commandBuffer)
+     {
+       return recordScene(commandBuffer);
+     });
+
+  mRenderGraph.setPassEnabled(mCullResetPass, false);
+  mRenderGraph.setPassEnabled(mCullPass, false);
+  mRenderGraph.setPassEnabled(mInstancesPass, false);
+
+  mCapturePass = mRenderGraph.addPass
+    ("capture",
+     { { mSwapChainImage, vk::ResourceAccess::transferRead } },
+     [this](VkCommandBuffer const commandBuffer)
+     {
+       vk::GpuProfiler::ScopedZone const captureZone
+         { mGpuProfiler, commandBuffer, mCurrentFrame, "capture" };
+
+       return mFrameCapture.record
+         (commandBuffer,
+          mCurrentFrame,
+          mRenderGraph.getVkImage(mSwapChainImage),
+          mSwapChain.getVkExtent(),
+          mSwapChain.getVkFormat());
+     });
+
+  mRenderGraph.setPassEnabled(mCapturePass, mFrameCaptureEnabled);
+
+  return mRenderGraph.compile();
+}
+
+bool
+so::Engine::drawsGpuDrivenInstances() const
+{
+  bool const drawMesh{ mMesh.isValid() and
+                       mUploader.isComplete(mMesh.getUploadTicket()) };
+
+  // The render queue takes precedence, as it did when both were recorded
+  // from the scene pass.
+  bool const drawQueuedInstances{ not mGpuDrivenDrawing and
+                                  mInstanceCuller.size() > 0 };
+
+  return drawMesh                          and
+         not drawQueuedInstances           and
+         mGpuDrivenRenderer.isReady(mMesh);
+}
+
+so::return_t
+so::Engine::recordScene(VkCommandBuffer const commandBuffer)
+{
+  vk::GpuProfiler::ScopedZone const sceneZone
+    { mGpuProfiler, commandBuffer, mCurrentFrame, "scene" };
+
+  VkFramebuffer const framebuffer
+    { mFramebuffers.getVkFramebuffersRef()[mImageIndex] };
+
+  bool const drawMesh{ mMesh.isValid() and
+                       mUploader.isComplete(mMesh.getUploadTicket()) };
+
+  bool const drawQueuedInstances{ drawMesh and
+                                  not mGpuDrivenDrawing and
+                                  mInstanceCuller.size() > 0 };
+
+  return drawQueuedInstances
+    ? recordQueuedInstances(commandBuffer, framebuffer)
+    : drawMesh
+    ? mCommandRecorder.recordIndexed(commandBuffer,
+                                     mCurrentFrame,
+                                     framebuffer,
+                                     mRenderPass,
+                                     mSwapChain,
+                                     mMeshPipeline,
+                                     mMesh,
+                                     getMeshTransform(),
+                                     mMeshDrawCommands)
+    : mCommandRecorder.record(commandBuffer,
+                              mCurrentFrame,
+                              framebuffer,
+                              mRenderPass,
+                              mSwapChain,
+                              mPipeline,
+                              mDrawCommands);
+}
+
+so::return_t
+so::Engine::recreateSwapChain()
+{
+  SO_PROFILE_ZONE("Engine::recreateSwapChain");
+
+  clock::time_point const start{ clock::now() };
+
+  // Everything retired below may still be used by frames in flight, so it is
+  // destroyed through the deletion queue instead of waiting for the device.
+  mDeletionQueue.setSubmittedFrames(mSubmittedFrames);
+
+  vk::SharedPtrLogicalDevice device{ mSwapChain.getDevice() };
+
+  VkFormat const oldFormat{ mSwapChain.getVkFormat() };
+
+  mDeletionQueue.retire(std::move(mFramebuffers));
+
+  if(mSwapChain.reset(mSurface, mDeletionQueue) is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to reset the swap chain during swap chain "
                    "recreation.",
-                   vk::Framebuffers::reset);
+                   vk::SwapChain::reset);
 
     return failure;
   }
 
-  return_t result{ mCommandBuffers.reset(mFramebuffers,
-                                         mRenderPass,
-                                         mSwapChain,
-                                         mPipeline) };
+  // The render pass, and with it the pipeline, only depends on the format of
+  // the swap chain, which almost never changes on a resize.
+  if(mSwapChain.getVkFormat() not_eq oldFormat)
+  {
+    mDeletionQueue.retire(std::move(mPipeline));
+    mDeletionQueue.retire(std::move(mRenderPass));
+
+    if(mRenderPass.initialize(device, mSwapChain) is_eq failure)
+    {
+      DEBUG_CALLBACK(error,
+                     "Failed to recreate the render pass during swap chain "
+                     "recreation.",
+                     vk::RenderPass::initialize);
+
+      return failure;
+    }
+
+    return_t const result{ mPipeline.initialize(device,
+                                                mRenderPass,
+                                                mPipelineCache,
+                                                mShaderModuleCache) };
+
+    if(result is_eq failure)
+    {
+      DEBUG_CALLBACK(error,
+                     "Failed to recreate the graphics pipeline during swap "
+                     "chain recreation.",
+                     vk::Pipeline::initialize);
+
+      return failure;
+    }
+
+    if(mMesh.isValid())
+    {
+      mDeletionQueue.retire(std::move(mMeshPipeline));
+
+      return_t const meshResult{ mMeshPipeline.initialize
+                                   (device,
+                                    mRenderPass,
+                                    mPipelineCache,
+                                    mShaderModuleCache,
+                                    mMesh.getVertexFormat()) };
+
+      if(meshResult is_eq failure)
+      {
+        DEBUG_CALLBACK(error,
+                       "Failed to recreate the mesh pipeline during swap "
+                       "chain recreation.",
+                       vk::Pipeline::initialize);
+
+        return failure;
+      }
+    }
+
+    if((mQueuePipeline.getVkPipeline() not_eq VK_NULL_HANDLE) and
+       (createQueuePipeline() is_eq failure))
+    {
+      return failure;
+    }
+
+    if(mGpuDrivenRenderer.setRenderPass(mRenderPass) is_eq failure)
+    {
+      DEBUG_CALLBACK(error,
+                     "Failed to recreate the instanced pipeline during swap "
+                     "chain recreation.",
+                     vk::GpuDrivenRenderer::setRenderPass);
+
+      return failure;
+    }
+  }
 
-  if(result is_eq failure)
+  if(mFramebuffers.initialize(device, mSwapChain, mRenderPass) is_eq failure)
   {
     DEBUG_CALLBACK(error,
-                   "Failed to reset the command buffers during swap chain "
+                   "Failed to recreate the framebuffers during swap chain "
                    "recreation.",
-                   vk::CommandBuffers::reset);
+                   vk::Framebuffers::initialize);
 
     return failure;
   }
 
+  // The new swap chain may have a different number of images and none of
+  // them has been acquired yet.
+  mImagesInFlight.assign(mSwapChain.getVkImages().size(), VK_NULL_HANDLE);
+
+  FrameStatistics& stats{ mFrameStatistics };
+
+  stats.swapChainRecreationTime = clock::now() - start;
+
+  ++stats.swapChainRecreations;
+
   return success;
 }
-
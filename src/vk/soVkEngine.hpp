@@ -52,18 +52,71 @@
 
 #include "soVkCommandBuffers.hpp"
 #include "soVkDebugReportCallbackEXT.hpp"
+#include "soVkDeletionQueue.hpp"
+#include "soVkDescriptorAllocator.hpp"
 #include "soVkFences.hpp"
+#include "soVkFrameCapture.hpp"
 #include "soVkFramebuffers.hpp"
+#include "soVkGpuDrivenRenderer.hpp"
+#include "soVkGpuProfiler.hpp"
 #include "soVkInstance.hpp"
 #include "soVkLogicalDevice.hpp"
+#include "soVkMemoryAllocator.hpp"
+#include "soVkMesh.hpp"
+#include "soVkParallelCommandRecorder.hpp"
 #include "soVkPipeline.hpp"
+#include "soVkRenderGraph.hpp"
+#include "soVkRenderQueue.hpp"
 #include "soVkSemaphores.hpp"
 #include "soVkSurface.hpp"
+#include "soVkTextureStreamer.hpp"
+#include "soVkUploader.hpp"
 
 #include "cxx/soDefinitions.hpp"
+#include "cxx/soFrameAllocator.hpp"
+#include "cxx/soFramePacer.hpp"
+#include "cxx/soJobSystem.hpp"
+#include "cxx/soFrustumCuller.hpp"
+
+#include <array>
+#include <chrono>
+#include <vector>
 
 namespace so {
 
+/**
+ * @brief Timings of the last frame submitted by so::Engine::drawFrame.
+ *
+ * fenceWaitTime is the time the CPU spent blocked on in-flight fences, i.e.
+ * waiting for the GPU. cpuGpuOverlap is the fraction of the frame time the CPU
+ * was not blocked on the GPU: 1 means full overlap, 0 means fully serialized.
+ * inputToPresentLatency is the time from the last surfacePollEvents call to
+ * the return of vkQueuePresentKHR, i.e. the CPU side of input latency; it does
+ * not include the time the image spends queued in the presentation engine.
+ * swapChainRecreationTime is the CPU time the last swap chain recreation took.
+ * The average* members are exponential moving averages of the same values.
+ */
+struct
+FrameStatistics
+{
+  using duration = std::chrono::duration<double, std::milli>;
+
+  duration frameTime{ 0.0 };
+  duration fenceWaitTime{ 0.0 };
+  double   cpuGpuOverlap{ 0.0 };
+  duration inputToPresentLatency{ 0.0 };
+  duration pacingWaitTime{ 0.0 };
+  duration swapChainRecreationTime{ 0.0 };
+
+  duration averageFrameTime{ 0.0 };
+  duration averageFenceWaitTime{ 0.0 };
+  double   averageCpuGpuOverlap{ 0.0 };
+  duration averageInputToPresentLatency{ 0.0 };
+
+  uint64_t frameCount{ 0 };
+  uint64_t swapChainRecreations{ 0 };
+};
+
 class
 Engine
 {
@@ -72,14 +125,31 @@ Engine
 
     ~Engine() noexcept;
 
+    /**
+     * @param numThreads Number of threads running jobs, e.g. culling and
+     *                   recording draw commands, including the calling one.
+     *                   0 picks one per hardware thread.
+     */
     so::return_t
     initialize(std::string const& applicationName,
                uint32_t    const  applicationVersion,
-               size_type   const  maxFramesInFlight = 2);
+               size_type   const  maxFramesInFlight = 2,
+               size_type   const  numThreads = 0);
 
     inline bool windowIsClosed() { return mSurface.windowIsClosed(); } 
 
-    inline void surfacePollEvents() { mSurface.pollEvents(); } 
+    /**
+     * @brief Waits for the frame pacer, then polls the window events.
+     *
+     * Pacing happens before polling so that input is sampled as late as
+     * possible before the frame is recorded.
+     */
+    void
+    surfacePollEvents();
+
+    inline return_t
+    surfaceSetWindowSize(size_type const width, size_type const height)
+    { return mSurface.setWindowSize(width, height); }
 
     inline VkDevice getVkDevice()
     { return mSwapChain.getDevice()->getVkDevice(); }
@@ -87,10 +157,178 @@ Engine
     return_t
     drawFrame();
 
+    inline FrameStatistics const&
+    getFrameStatistics() const { return mFrameStatistics; }
+
+    /**
+     * @brief Sets the present policy of the swap chain. Recreates the swap
+     *        chain if the engine is already initialized.
+     */
+    return_t
+    setPresentPolicy(vk::PresentPolicy const policy);
+
+    inline vk::PresentPolicy getPresentPolicy() const
+    { return mSwapChain.getPresentPolicy(); }
+
+    /**
+     * @brief Sets the frame rate surfacePollEvents paces to. 0 disables
+     *        pacing.
+     */
+    inline void setTargetFrameRate(double const targetFrameRate)
+    { mFramePacer.setTargetFrameRate(targetFrameRate); }
+
+    inline double getTargetFrameRate() const
+    { return mFramePacer.getTargetFrameRate(); }
+
+    /**
+     * @brief Sets the draws recorded every frame. Each worker thread records
+     *        a contiguous slice of the list.
+     */
+    inline void
+    setDrawCommands(std::vector<vk::DrawCommand> drawCommands)
+    { mDrawCommands = std::move(drawCommands); }
+
+    inline std::vector<vk::DrawCommand> const&
+    getDrawCommands() const { return mDrawCommands; }
+
+    /**
+     * @brief Imports a model file and draws it, fitted into the window,
+     *        instead of the draw commands once its upload has finished.
+     *        Replaces the previously loaded mesh.
+     */
+    return_t
+    loadMesh(std::string const& filename);
+
+    inline vk::Mesh const& getMesh() const { return mMesh; }
+
+    /**
+     * @brief Draws the mesh once per instance instead, culled on the GPU,
+     *        once the instances are uploaded. The instances are kept for
+     *        meshes loaded later. An empty list draws the mesh once again.
+     *        If the device does not support GPU-driven drawing, the
+     *        instances are culled on the CPU and drawn through the render
+     *        queue.
+     */
+    return_t
+    setMeshInstances(std::vector<vk::MeshInstance> instances);
+
+    /**
+     * @brief Column major view projection matrix the mesh instances are
+     *        drawn and culled with. Until set, the one fitting the mesh into
+     *        the window is used.
+     */
+    inline void
+    setViewProjection(std::array<float, 16> const& viewProjection)
+    {
+      mViewProjection    = viewProjection;
+      mHasViewProjection = true;
+    }
+
+    /**
+     * @brief Loads a texture through the texture streamer, which the mesh
+     *        instances drawn through the render queue sample with the
+     *        texture coordinates of the mesh. Its mip levels follow the size
+     *        the visible instances cover on screen. Meshes without texture
+     *        coordinates are drawn untextured.
+     */
+    return_t
+    loadMeshTexture(std::string const& filename, bool const isSrgb = true);
+
+    inline vk::GpuDrivenRenderer const& getGpuDrivenRenderer() const
+    { return mGpuDrivenRenderer; }
+
+    /**
+     * @brief Whether mesh instances are culled on the GPU. Otherwise they are
+     *        culled on the CPU and drawn through getRenderQueue().
+     */
+    inline bool isGpuDrivenDrawing() const { return mGpuDrivenDrawing; }
+
+    inline vk::RenderQueue const& getRenderQueue() const
+    { return mRenderQueue; }
+
+    /**
+     * @brief Copies every following frame into host memory, so it can be
+     *        read with captureFrame. Costs a copy per frame. Fails if the
+     *        swap chain images do not support being read back.
+     */
+    return_t
+    setFrameCaptureEnabled(bool const enabled);
+
+    inline bool isFrameCaptureEnabled() const { return mFrameCaptureEnabled; }
+
+    /**
+     * @brief Waits for the last submitted frame and returns its pixels.
+     *        Fails if that frame was not captured.
+     */
+    return_t
+    captureFrame(vk::CapturedFrame& capturedFrame);
+
+    /**
+     * @brief Allocator for the device memory of buffers and images.
+     */
+    inline vk::SharedPtrMemoryAllocator const&
+    getMemoryAllocator() const { return mMemoryAllocator; }
+
+    inline vk::MemoryStatistics
+    getMemoryStatistics() const { return mMemoryAllocator->getStatistics(); }
+
+    /**
+     * @brief Uploads submitted by drawFrame; their resources may be used by
+     *        draws once their tickets are complete.
+     */
+    inline vk::Uploader& getUploader() { return mUploader; }
+
+    /**
+     * @brief Textures whose mip levels drawFrame streams in and evicts
+     *        according to the usage reported for the frame.
+     */
+    inline vk::TextureStreamer& getTextureStreamer()
+    { return mTextureStreamer; }
+
+    /**
+     * @brief Descriptor sets for the frame being recorded, reset once its
+     *        frame slot comes around again, and long-lived cached sets.
+     */
+    inline vk::DescriptorAllocator& getDescriptorAllocator()
+    { return mDescriptorAllocator; }
+
+    /**
+     * @brief Host memory for temporaries of the frame being recorded, e.g.
+     *        through std::pmr containers, freed once its frame slot comes
+     *        around again.
+     */
+    inline utils::mem::FrameAllocator& getFrameAllocator()
+    { return mFrameAllocator; }
+
+    /**
+     * @brief Runs the culling and command recording jobs, and can run the
+     *        application's, e.g. to decode assets.
+     */
+    inline JobSystem& getJobSystem() { return mJobSystem; }
+
+    /**
+     * @brief GPU timings of the zones recorded by drawFrame, keyed by zone
+     *        name. Timings lag maxFramesInFlight frames behind.
+     */
+    inline std::map<std::string, vk::GpuZoneHistory, std::less<>> const&
+    getGpuZoneHistories() const { return mGpuProfiler.getZoneHistories(); }
+
   private:
+    using clock = std::chrono::steady_clock;
+
+    // Declared first, so it outlives everything running jobs on it.
+    JobSystem                  mJobSystem;
     vk::DebugReportCallbackEXT mDebugCallback;
     vk::Surface                mSurface;
+    vk::DeletionQueue          mDeletionQueue;
     vk::SwapChain              mSwapChain;
+    vk::SharedPtrMemoryAllocator mMemoryAllocator;
+    vk::Uploader               mUploader;
+    vk::TextureStreamer        mTextureStreamer;
+    vk::DescriptorAllocator    mDescriptorAllocator;
+    utils::mem::FrameAllocator mFrameAllocator;
+    vk::SharedPtrPipelineCache mPipelineCache;
+    vk::SharedPtrShaderModuleCache mShaderModuleCache;
 		vk::RenderPass             mRenderPass;
 	  vk::Pipeline               mPipeline;
     vk::Framebuffers           mFramebuffers;
@@ -99,13 +337,129 @@ Engine
     vk::Semaphores             mRenderFinishedSemaphores;
     vk::Fences<>               mInFlightFences;
 
+    vk::ParallelCommandRecorder  mCommandRecorder;
+    std::vector<vk::DrawCommand> mDrawCommands;
+
+    vk::Mesh                     mMesh;
+    vk::Pipeline                 mMeshPipeline;
+    std::vector<vk::DrawIndexedCommand> mMeshDrawCommands;
+
+    vk::GpuDrivenRenderer        mGpuDrivenRenderer;
+    std::vector<vk::MeshInstance> mMeshInstances;
+    std::array<float, 16>        mViewProjection;
+    bool                         mHasViewProjection;
+    bool                         mGpuDrivenDrawing;
+
+    // Draws the instances if GPU-driven drawing is not supported.
+    vk::RenderQueue              mRenderQueue;
+    vk::DescriptorSetLayout      mMaterialSetLayout;
+    vk::Pipeline                 mQueuePipeline;
+    uint32_t                     mQueuePipelineId;
+    vk::TextureHandle            mMeshTexture;
+    FrustumCuller                mInstanceCuller;
+    std::vector<uint32_t>        mVisibleInstances;
+
+    vk::FrameCapture           mFrameCapture;
+
+    // Records the passes of a frame and transitions the swap chain image
+    // between them.
+    vk::RenderGraph            mRenderGraph;
+    vk::RenderGraph::ResourceId mSwapChainImage;
+    vk::RenderGraph::ResourceId mDrawBuffer;
+    vk::RenderGraph::ResourceId mDrawCountBuffer;
+    vk::RenderGraph::PassId    mCullResetPass;
+    vk::RenderGraph::PassId    mCullPass;
+    vk::RenderGraph::PassId    mInstancesPass;
+    vk::RenderGraph::PassId    mScenePass;
+    vk::RenderGraph::PassId    mCapturePass;
+
+    vk::GpuProfiler            mGpuProfiler;
+
+    /**
+     * In-flight fence of the frame currently rendering to a swap chain image,
+     * indexed by the image index. VK_NULL_HANDLE if the image is unused.
+     */
+    std::vector<VkFence>       mImagesInFlight;
+
     index_t                    mCurrentFrame;
 
+    // Swap chain image of the frame being recorded.
+    uint32_t                   mImageIndex;
+
+    uint64_t                   mSubmittedFrames;
+
+    bool                       mFrameCaptureEnabled;
+
     bool                       mFramebuffersResized;
 
+    FrameStatistics            mFrameStatistics;
+
+    clock::time_point          mLastFrameStart;
+
+    FramePacer                 mFramePacer;
+
+    clock::time_point          mLastInputTime;
+
+    FramePacer::duration       mLastPacingWaitTime;
+
     return_t
     recreateSwapChain();
 
+    void
+    waitForFence(VkFence fence, FrameStatistics::duration& waitTime);
+
+    /**
+     * @brief Column major transform that fits the bounds of mMesh into the
+     *        swap chain extent, preserving its aspect ratio.
+     */
+    std::array<float, 16>
+    getMeshTransform() const;
+
+    /**
+     * @brief Prepares the CPU culling of mMeshInstances and the pipeline
+     *        drawing them through the render queue.
+     */
+    return_t
+    setQueuedInstances();
+
+    return_t
+    createQueuePipeline();
+
+    /**
+     * @brief Whether the queued instances sample mMeshTexture.
+     */
+    bool
+    usesMeshTexture() const;
+
+    /**
+     * @brief Culls the instances on the CPU and records the visible ones
+     *        through the render queue.
+     */
+    return_t
+    recordQueuedInstances(VkCommandBuffer const commandBuffer,
+                          VkFramebuffer   const framebuffer);
+
+    return_t
+    buildRenderGraph();
+
+    /**
+     * @brief Whether this frame draws the mesh instances culled on the GPU,
+     *        through the cull and instances passes instead of the scene
+     *        pass.
+     */
+    bool
+    drawsGpuDrivenInstances() const;
+
+    /**
+     * @brief Records the scene into the framebuffer of mImageIndex.
+     */
+    return_t
+    recordScene(VkCommandBuffer const commandBuffer);
+
+    void
+    updateFrameStatistics(clock::time_point         const frameStart,
+                          FrameStatistics::duration const fenceWaitTime);
+
 };
 
 } // namespace so
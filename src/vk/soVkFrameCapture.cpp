@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "soVkFrameCapture.hpp"
+
+#include "cxx/soDebugCallback.hpp"
+#include "cxx/soDefinitions.hpp"
+
+#include <cstring>
+
+namespace {
+
+// Capture only supports the 4 byte per pixel formats swap chains use.
+constexpr VkDeviceSize bytesPerPixel{ 4 };
+
+} // namespace
+
+so::vk::FrameCapture::FrameCapture()
+  : mReadbacks(),
+    mAllocator(MemoryAllocator::getSharedPtrNullMemoryAllocator())
+{}
+
+so::vk::FrameCapture::~FrameCapture() noexcept
+{
+  destroyMembers();
+}
+
+so::vk::FrameCapture&
+so::vk::FrameCapture::operator=(FrameCapture&& other) noexcept
+{
+  if(this is_eq &other)
+  {
+    return *this;
+  }
+
+  destroyMembers();
+
+  mReadbacks = std::move(other.mReadbacks);
+  mAllocator = other.mAllocator;
+
+  other.mReadbacks = std::vector<Readback>();
+  other.mAllocator = MemoryAllocator::getSharedPtrNullMemoryAllocator();
+
+  return *this;
+}
+
+so::return_t
+so::vk::FrameCapture::initialize
+  (SharedPtrMemoryAllocator const& allocator,
+   size_type                const  numFramesInFlight)
+{
+  destroyMembers();
+
+  mAllocator = allocator;
+
+  mReadbacks = std::vector<Readback>(numFramesInFlight);
+
+  return success;
+}
+
+so::return_t
+so::vk::FrameCapture::record(VkCommandBuffer const commandBuffer,
+                             index_t         const frame,
+                             VkImage         const image,
+                             VkExtent2D      const extent,
+                             VkFormat        const format)
+{
+  Readback& readback{ mReadbacks[static_cast<size_type>(frame)] };
+
+  readback.isValid = false;
+
+  VkDeviceSize const size{ VkDeviceSize{ extent.width } * extent.height *
+                           bytesPerPixel };
+
+  if(readback.buffer.getSize() < size)
+  {
+    // The fence of this frame has been waited for, so the old buffer is no
+    // longer in use.
+    readback.buffer = Buffer();
+
+    // Cached memory makes the host read fast, coherent memory saves the
+    // invalidate. Prefer both, require only host visibility.
+    AllocationInfo allocationInfo{};
+
+    allocationInfo.requiredFlags  = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+    allocationInfo.preferredFlags = VK_MEMORY_PROPERTY_HOST_CACHED_BIT bitor
+                                    VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+    if(readback.buffer.initialize(mAllocator,
+                                  size,
+                                  VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                  allocationInfo) is_eq failure)
+    {
+      DEBUG_CALLBACK(error,
+                     "Failed to create a frame capture buffer.",
+                     Buffer::initialize);
+
+      readback.buffer = Buffer();
+
+      return failure;
+    }
+  }
+
+  VkBufferImageCopy region{};
+
+  region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  region.imageSubresource.layerCount = 1;
+  region.imageExtent                 = { extent.width, extent.height, 1 };
+
+  vkCmdCopyImageToBuffer(commandBuffer,
+                         image,
+                         VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                         readback.buffer.getVkBuffer(),
+                         1,
+                         &region);
+
+  VkBufferMemoryBarrier hostBarrier{};
+
+  hostBarrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+  hostBarrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+  hostBarrier.dstAccessMask       = VK_ACCESS_HOST_READ_BIT;
+  hostBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  hostBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  hostBarrier.buffer              = readback.buffer.getVkBuffer();
+  hostBarrier.offset              = 0;
+  hostBarrier.size                = size;
+
+  vkCmdPipelineBarrier(commandBuffer,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_PIPELINE_STAGE_HOST_BIT,
+                       0,
+                       0,
+                       nullptr,
+                       1,
+                       &hostBarrier,
+                       0,
+                       nullptr);
+
+  readback.isValid = true;
+  readback.extent  = extent;
+  readback.format  = format;
+
+  return success;
+}
+
+void
+so::vk::FrameCapture::discard(index_t const frame)
+{
+  mReadbacks[static_cast<size_type>(frame)].isValid = false;
+}
+
+so::return_t
+so::vk::FrameCapture::read(index_t       const  frame,
+                           CapturedFrame&        capturedFrame) const
+{
+  Readback const& readback{ mReadbacks[static_cast<size_type>(frame)] };
+
+  if(not readback.isValid)
+  {
+    return failure;
+  }
+
+  VkExtent2D const extent{ readback.extent };
+
+  auto const size{ static_cast<size_type>
+                     (VkDeviceSize{ extent.width } * extent.height *
+                      bytesPerPixel) };
+
+  if(readback.buffer.invalidate(0, size) is_eq failure)
+  {
+    return failure;
+  }
+
+  capturedFrame.pixels.resize(size);
+  capturedFrame.extent = readback.extent;
+  capturedFrame.format = readback.format;
+
+  std::memcpy(capturedFrame.pixels.data(),
+              readback.buffer.getMappedData(),
+              size);
+
+  return success;
+}
+
+void
+so::vk::FrameCapture::destroyMembers()
+{
+  mReadbacks.clear();
+}
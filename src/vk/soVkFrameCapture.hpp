@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      soVkFrameCapture.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "soVkBuffer.hpp"
+
+#include <vector>
+
+namespace so {
+namespace vk {
+
+/**
+ * @brief A frame read back to host memory.
+ *
+ * pixels is tightly packed, rowwise from the top, in the given format.
+ */
+struct
+CapturedFrame
+{
+  std::vector<uint8_t> pixels;
+  VkExtent2D           extent{ 0, 0 };
+  VkFormat             format{ VK_FORMAT_UNDEFINED };
+};
+
+/**
+ * @brief Copies rendered swap chain images into host visible buffers.
+ *
+ * Every frame in flight has its own readback buffer, which is only touched
+ * again once the in-flight fence of that frame has been waited for. The
+ * swap chain images need VK_IMAGE_USAGE_TRANSFER_SRC_BIT.
+ */
+class
+FrameCapture
+{
+  public:
+    FrameCapture();
+
+    FrameCapture(FrameCapture const& other) = delete;
+
+    FrameCapture(FrameCapture&& other) = delete;
+
+    ~FrameCapture() noexcept;
+
+    FrameCapture&
+    operator=(FrameCapture const& other) = delete;
+
+    FrameCapture&
+    operator=(FrameCapture&& other) noexcept;
+
+    return_t
+    initialize(SharedPtrMemoryAllocator const& allocator,
+               size_type                const  numFramesInFlight);
+
+    /**
+     * @brief Records a copy of image into the readback buffer of the frame.
+     *        The image has to be in TRANSFER_SRC_OPTIMAL layout with the
+     *        writes to it made visible to transfer reads, see RenderGraph.
+     */
+    return_t
+    record(VkCommandBuffer const commandBuffer,
+           index_t         const frame,
+           VkImage         const image,
+           VkExtent2D      const extent,
+           VkFormat        const format);
+
+    /**
+     * @brief Skips the frame, e.g. because capturing is disabled.
+     */
+    void
+    discard(index_t const frame);
+
+    /**
+     * @brief Reads the capture of a frame. The in-flight fence of the frame
+     *        must have been waited for.
+     */
+    return_t
+    read(index_t const frame, CapturedFrame& capturedFrame) const;
+
+  private:
+    struct
+    Readback
+    {
+      Buffer     buffer;
+      bool       isValid{ false };
+      VkExtent2D extent{ 0, 0 };
+      VkFormat   format{ VK_FORMAT_UNDEFINED };
+    };
+
+    std::vector<Readback>    mReadbacks;
+
+    SharedPtrMemoryAllocator mAllocator;
+
+    void
+    destroyMembers();
+};
+
+} // namespace vk
+} // namespace so
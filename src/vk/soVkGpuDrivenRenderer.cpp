@@ -0,0 +1,773 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "soVkGpuDrivenRenderer.hpp"
+
+#include "cxx/soDebugCallback.hpp"
+#include "cxx/soFileSystem.hpp"
+#include "cxx/soFrustumCuller.hpp"
+#include "cxx/soProfiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+namespace {
+
+// Layouts shared with src/shaders/cull and src/shaders/instanced.
+struct
+GpuSubMesh
+{
+  uint32_t             indexCount;
+  uint32_t             firstIndex;
+  int32_t              vertexOffset;
+  uint32_t             padding;
+  std::array<float, 4> boundingSphere;
+};
+
+struct
+CullConstants
+{
+  std::array<std::array<float, 4>, 6> frustumPlanes;
+  uint32_t                            numInstances;
+};
+
+struct
+CullDescriptors
+{
+  VkDescriptorBufferInfo instances;
+  VkDescriptorBufferInfo subMeshes;
+  VkDescriptorBufferInfo draws;
+  VkDescriptorBufferInfo count;
+};
+
+struct
+DrawDescriptors
+{
+  VkDescriptorBufferInfo instances;
+};
+
+static_assert(sizeof(so::vk::MeshInstance) is_eq 80,
+              "MeshInstance has to match the std430 layout of the shaders.");
+
+static_assert(sizeof(GpuSubMesh) is_eq 32,
+              "GpuSubMesh has to match the std430 layout of the shaders.");
+
+uint32_t const cullGroupSize{ 64 };
+
+VkDeviceSize const drawStride{ sizeof(VkDrawIndexedIndirectCommand) };
+
+VkDeviceSize
+alignUp(VkDeviceSize const value, VkDeviceSize const alignment)
+{
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+so::vk::DescriptorBinding
+storageBufferBinding(uint32_t           const binding,
+                     VkShaderStageFlags const stages,
+                     so::size_type      const offset)
+{
+  so::vk::DescriptorBinding descriptorBinding;
+
+  descriptorBinding.binding = binding;
+  descriptorBinding.type    = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+  descriptorBinding.count   = 1;
+  descriptorBinding.stages  = stages;
+  descriptorBinding.offset  = offset;
+
+  return descriptorBinding;
+}
+
+} // namespace
+
+so::vk::GpuDrivenRenderer::GpuDrivenRenderer()
+  : mDevice(LogicalDevice::getSharedPtrNullDevice()),
+    mAllocator(MemoryAllocator::getSharedPtrNullMemoryAllocator()),
+    mUploader(nullptr),
+    mDescriptorAllocator(nullptr),
+    mDeletionQueue(nullptr),
+    mPipelineCache(PipelineCache::getSharedPtrNullPipelineCache()),
+    mShaderModuleCache(ShaderModuleCache::getSharedPtrNullShaderModuleCache()),
+    mCullSetLayout(),
+    mDrawSetLayout(),
+    mCullPipeline(),
+    mDrawPipeline(),
+    mCurrent(),
+    mPending(),
+    mDrawIndexedIndirectCount(nullptr),
+    mMode(IndirectDrawMode::drawIndirect),
+    mNumFrames(0),
+    mNumVisible(0)
+{}
+
+so::return_t
+so::vk::GpuDrivenRenderer::initialize
+  (SharedPtrLogicalDevice     const& device,
+   SharedPtrMemoryAllocator   const& allocator,
+   Uploader&                         uploader,
+   DescriptorAllocator&              descriptorAllocator,
+   DeletionQueue&                    deletionQueue,
+   size_type                  const  numFramesInFlight,
+   SharedPtrPipelineCache     const& pipelineCache,
+   SharedPtrShaderModuleCache const& shaderModuleCache)
+{
+  mDevice              = device;
+  mAllocator           = allocator;
+  mUploader            = &uploader;
+  mDescriptorAllocator = &descriptorAllocator;
+  mDeletionQueue       = &deletionQueue;
+  mNumFrames           = numFramesInFlight;
+  mPipelineCache       = pipelineCache;
+  mShaderModuleCache   = shaderModuleCache;
+
+  VkPhysicalDeviceFeatures const& features{ mDevice->getEnabledVkFeatures() };
+
+  // Draws find their instance through firstInstance.
+  if(not features.drawIndirectFirstInstance)
+  {
+    DEBUG_CALLBACK(info,
+                   "The device does not support drawIndirectFirstInstance, "
+                   "GPU-driven drawing is disabled.");
+
+    return failure;
+  }
+
+  mDrawIndexedIndirectCount = nullptr;
+
+  if(mDevice->isExtensionEnabled(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME))
+  {
+    mDrawIndexedIndirectCount =
+      reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>
+        (vkGetDeviceProcAddr(mDevice->getVkDevice(),
+                             "vkCmdDrawIndexedIndirectCountKHR"));
+  }
+
+  mMode = mDrawIndexedIndirectCount not_eq nullptr
+            ? IndirectDrawMode::indirectCount
+            : features.multiDrawIndirect ? IndirectDrawMode::multiDrawIndirect
+                                         : IndirectDrawMode::drawIndirect;
+
+  return_t result{ mCullSetLayout.initialize
+    (mDevice,
+     { storageBufferBinding(0,
+                            VK_SHADER_STAGE_COMPUTE_BIT,
+                            offsetof(CullDescriptors, instances)),
+       storageBufferBinding(1,
+                            VK_SHADER_STAGE_COMPUTE_BIT,
+                            offsetof(CullDescriptors, subMeshes)),
+       storageBufferBinding(2,
+                            VK_SHADER_STAGE_COMPUTE_BIT,
+                            offsetof(CullDescriptors, draws)),
+       storageBufferBinding(3,
+                            VK_SHADER_STAGE_COMPUTE_BIT,
+                            offsetof(CullDescriptors, count)) }) };
+
+  if(result is_eq success)
+  {
+    result = mDrawSetLayout.initialize
+      (mDevice,
+       { storageBufferBinding(0,
+                              VK_SHADER_STAGE_VERTEX_BIT,
+                              offsetof(DrawDescriptors, instances)) });
+  }
+
+  if(result is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to create the GPU-driven descriptor set layouts.",
+                   DescriptorSetLayout::initialize);
+
+    return failure;
+  }
+
+  result = mCullPipeline.initialize
+    (mDevice,
+     BIN_DIR + "/data/shaders/cull/comp.spv",
+     { mCullSetLayout.getVkDescriptorSetLayout() },
+     sizeof(CullConstants),
+     mPipelineCache,
+     mShaderModuleCache);
+
+  if(result is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to create the culling pipeline.",
+                   ComputePipeline::initialize);
+
+    return failure;
+  }
+
+  return success;
+}
+
+so::return_t
+so::vk::GpuDrivenRenderer::setInstances
+  (Mesh                      const& mesh,
+   RenderPass                const& renderPass,
+   std::vector<MeshInstance> const& instances)
+{
+  SO_PROFILE_ZONE("GpuDrivenRenderer::setInstances");
+
+  std::vector<SubMesh> const& subMeshes{ mesh.getSubMeshes() };
+
+  for(auto const& instance : instances)
+  {
+    if(instance.subMesh >= subMeshes.size())
+    {
+      DEBUG_CALLBACK(error, "A mesh instance refers to a missing sub-mesh.");
+
+      return failure;
+    }
+  }
+
+  // The current instances may still be drawn by frames in flight.
+  if(mPending)
+  {
+    mDeletionQueue->retire(std::move(mPending));
+  }
+
+  if(instances.empty())
+  {
+    if(mCurrent)
+    {
+      mDeletionQueue->retire(std::move(mCurrent));
+    }
+
+    return success;
+  }
+
+  bool const needsPipeline
+    { mDrawPipeline.getVkPipeline() is_eq VK_NULL_HANDLE
+      or mDrawPipeline.getVertexFormat() not_eq mesh.getVertexFormat() };
+
+  if(needsPipeline)
+  {
+    mDeletionQueue->retire(std::move(mDrawPipeline));
+
+    return_t const result
+      { mDrawPipeline.initialize(mDevice,
+                                 renderPass,
+                                 mPipelineCache,
+                                 mShaderModuleCache,
+                                 mesh.getVertexFormat(),
+                                 { mDrawSetLayout.getVkDescriptorSetLayout() },
+                                 "instanced") };
+
+    if(result is_eq failure)
+    {
+      DEBUG_CALLBACK(error,
+                     "Failed to create the instanced pipeline.",
+                     Pipeline::initialize);
+
+      return failure;
+    }
+  }
+
+  std::vector<GpuSubMesh> gpuSubMeshes;
+
+  gpuSubMeshes.reserve(subMeshes.size());
+
+  for(auto const& subMesh : subMeshes)
+  {
+    GpuSubMesh gpuSubMesh{};
+
+    gpuSubMesh.indexCount   = subMesh.indexCount;
+    gpuSubMesh.firstIndex   = subMesh.firstIndex;
+    gpuSubMesh.vertexOffset = subMesh.vertexOffset;
+
+    float squaredRadius{ 0.0f };
+
+    for(size_type axis{ 0 }; axis < 3; ++axis)
+    {
+      float const extent{ subMesh.bounds.max[axis] -
+                          subMesh.bounds.min[axis] };
+
+      gpuSubMesh.boundingSphere[axis] = subMesh.bounds.min[axis] +
+                                        0.5f * extent;
+
+      squaredRadius += 0.25f * extent * extent;
+    }
+
+    gpuSubMesh.boundingSphere[3] = std::sqrt(squaredRadius);
+
+    gpuSubMeshes.push_back(gpuSubMesh);
+  }
+
+  auto pending{ std::make_unique<Instances>() };
+
+  VkPhysicalDeviceLimits const& limits
+    { mDevice->getVkPhysicalDeviceProperties().limits };
+
+  VkDeviceSize const alignment
+    { std::max(limits.minStorageBufferOffsetAlignment, VkDeviceSize{ 4 }) };
+
+  pending->numInstances    = static_cast<uint32_t>(instances.size());
+  pending->vertexBuffer    = mesh.getVertexBuffer().getVkBuffer();
+  pending->drawRegionSize  = alignUp(instances.size() * drawStride,
+                                     alignment);
+  pending->countRegionSize = alignUp(sizeof(uint32_t), alignment);
+
+  VkDeviceSize const instancesSize{ instances.size() *
+                                    sizeof(MeshInstance) };
+  VkDeviceSize const subMeshesSize{ gpuSubMeshes.size() *
+                                    sizeof(GpuSubMesh) };
+
+  AllocationInfo deviceLocal{};
+
+  deviceLocal.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+  // The count is read back for statistics.
+  AllocationInfo hostVisible{};
+
+  hostVisible.requiredFlags  = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+  hostVisible.preferredFlags = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+
+  VkBufferUsageFlags const storage{ VK_BUFFER_USAGE_STORAGE_BUFFER_BIT bitor
+                                    VK_BUFFER_USAGE_TRANSFER_DST_BIT };
+
+  VkBufferUsageFlags const indirect{ storage bitor
+                                     VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT };
+
+  return_t result{ pending->instanceBuffer.initialize(mAllocator,
+                                                      instancesSize,
+                                                      storage,
+                                                      deviceLocal) };
+
+  if(result is_eq success)
+  {
+    result = pending->subMeshBuffer.initialize(mAllocator,
+                                               subMeshesSize,
+                                               storage,
+                                               deviceLocal);
+  }
+
+  if(result is_eq success)
+  {
+    result = pending->drawBuffer.initialize(mAllocator,
+                                            pending->drawRegionSize *
+                                            mNumFrames,
+                                            indirect,
+                                            deviceLocal);
+  }
+
+  if(result is_eq success)
+  {
+    result = pending->countBuffer.initialize(mAllocator,
+                                             pending->countRegionSize *
+                                             mNumFrames,
+                                             indirect,
+                                             hostVisible);
+  }
+
+  if(result is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to create the GPU-driven instance buffers.",
+                   Buffer::initialize);
+
+    return failure;
+  }
+
+  std::memset(pending->countBuffer.getMappedData(),
+              0,
+              static_cast<size_type>(pending->countBuffer.getSize()));
+
+  pending->countBuffer.flush();
+
+  VkPipelineStageFlags const dstStage{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+                                       bitor
+                                       VK_PIPELINE_STAGE_VERTEX_SHADER_BIT };
+
+  result = mUploader->uploadBufferInPieces(pending->instanceBuffer,
+                                           0,
+                                           instances.data(),
+                                           instancesSize,
+                                           dstStage,
+                                           VK_ACCESS_SHADER_READ_BIT,
+                                           pending->uploadTicket);
+
+  if(result is_eq success)
+  {
+    result = mUploader->uploadBufferInPieces(pending->subMeshBuffer,
+                                             0,
+                                             gpuSubMeshes.data(),
+                                             subMeshesSize,
+                                             dstStage,
+                                             VK_ACCESS_SHADER_READ_BIT,
+                                             pending->uploadTicket);
+  }
+
+  if(result is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to upload the mesh instances.",
+                   Uploader::uploadBufferInPieces);
+
+    return failure;
+  }
+
+  mPending = std::move(pending);
+
+  return success;
+}
+
+so::return_t
+so::vk::GpuDrivenRenderer::setRenderPass(RenderPass const& renderPass)
+{
+  if(mDrawPipeline.getVkPipeline() is_eq VK_NULL_HANDLE)
+  {
+    return success;
+  }
+
+  VertexFormat const vertexFormat{ mDrawPipeline.getVertexFormat() };
+
+  mDeletionQueue->retire(std::move(mDrawPipeline));
+
+  return mDrawPipeline.initialize(mDevice,
+                                  renderPass,
+                                  mPipelineCache,
+                                  mShaderModuleCache,
+                                  vertexFormat,
+                                  { mDrawSetLayout.getVkDescriptorSetLayout() },
+                                  "instanced");
+}
+
+void
+so::vk::GpuDrivenRenderer::update()
+{
+  if(mPending and mUploader->isComplete(mPending->uploadTicket))
+  {
+    if(mCurrent)
+    {
+      mDeletionQueue->retire(std::move(mCurrent));
+    }
+
+    mCurrent    = std::move(mPending);
+    mNumVisible = 0;
+  }
+}
+
+bool
+so::vk::GpuDrivenRenderer::isReady(Mesh const& mesh) const
+{
+  return mCurrent
+         and mCurrent->numInstances > 0
+         and mCurrent->vertexBuffer is_eq mesh.getVertexBuffer().getVkBuffer()
+         and mDrawPipeline.getVkPipeline() not_eq VK_NULL_HANDLE
+         and mDrawPipeline.getVertexFormat() is_eq mesh.getVertexFormat();
+}
+
+so::return_t
+so::vk::GpuDrivenRenderer::record(VkCommandBuffer       const  commandBuffer,
+                                  index_t               const  frame,
+                                  VkFramebuffer         const  framebuffer,
+                                  RenderPass            const& renderPass,
+                                  SwapChain             const& swapChain,
+                                  Mesh                  const& mesh,
+                                  std::array<float, 16> const& viewProjection)
+{
+  SO_PROFILE_ZONE("GpuDrivenRenderer::record");
+
+  VkRenderPassBeginInfo renderPassInfo{};
+
+  renderPassInfo.sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+  renderPassInfo.renderPass        = renderPass.getVkRenderPass();
+  renderPassInfo.framebuffer       = framebuffer;
+  renderPassInfo.renderArea.offset = { 0, 0 };
+  renderPassInfo.renderArea.extent = swapChain.getVkExtent();
+
+  VkClearValue clearColor{ 0.0f, 0.0f, 0.0f, 1.0f };
+
+  renderPassInfo.clearValueCount   = 1;
+  renderPassInfo.pClearValues      = &clearColor;
+
+  vkCmdBeginRenderPass(commandBuffer,
+                       &renderPassInfo,
+                       VK_SUBPASS_CONTENTS_INLINE);
+
+  VkViewport viewport{};
+
+  viewport.width    = static_cast<float>(swapChain.getVkExtent().width);
+  viewport.height   = static_cast<float>(swapChain.getVkExtent().height);
+  viewport.maxDepth = 1.0f;
+
+  VkRect2D scissor{};
+
+  scissor.extent = swapChain.getVkExtent();
+
+  vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+  vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+  return_t const result{ recordDraws(commandBuffer,
+                                     frame,
+                                     mesh,
+                                     viewProjection) };
+
+  vkCmdEndRenderPass(commandBuffer);
+
+  return result;
+}
+
+std::array<std::array<float, 4>, 6>
+so::vk::GpuDrivenRenderer::getFrustumPlanes
+  (std::array<float, 16> const& viewProjection)
+{
+  return FrustumCuller::getFrustumPlanes(viewProjection);
+}
+
+void
+so::vk::GpuDrivenRenderer::recordReset(VkCommandBuffer const commandBuffer,
+                                       index_t         const frame)
+{
+  Instances const& current{ *mCurrent };
+
+  VkDeviceSize const drawOffset{ static_cast<VkDeviceSize>(frame) *
+                                 current.drawRegionSize };
+  VkDeviceSize const countOffset{ static_cast<VkDeviceSize>(frame) *
+                                  current.countRegionSize };
+  VkDeviceSize const drawsSize{ current.numInstances * drawStride };
+
+  // The previous submission of frame is finished, so is its count.
+  current.countBuffer.invalidate(countOffset, current.countRegionSize);
+
+  std::memcpy(&mNumVisible,
+              static_cast<char const*>(current.countBuffer.getMappedData()) +
+              countOffset,
+              sizeof(mNumVisible));
+
+  vkCmdFillBuffer(commandBuffer,
+                  current.countBuffer.getVkBuffer(),
+                  countOffset,
+                  sizeof(uint32_t),
+                  0);
+
+  // Without a draw count every slot is drawn, so culled ones must be empty.
+  if(mMode not_eq IndirectDrawMode::indirectCount)
+  {
+    vkCmdFillBuffer(commandBuffer,
+                    current.drawBuffer.getVkBuffer(),
+                    drawOffset,
+                    drawsSize,
+                    0);
+  }
+}
+
+so::return_t
+so::vk::GpuDrivenRenderer::recordCulling
+  (VkCommandBuffer       const  commandBuffer,
+   index_t               const  frame,
+   std::array<float, 16> const& viewProjection)
+{
+  Instances const& current{ *mCurrent };
+
+  VkDeviceSize const drawOffset{ static_cast<VkDeviceSize>(frame) *
+                                 current.drawRegionSize };
+  VkDeviceSize const countOffset{ static_cast<VkDeviceSize>(frame) *
+                                  current.countRegionSize };
+
+  CullDescriptors descriptors{};
+
+  descriptors.instances = { current.instanceBuffer.getVkBuffer(),
+                            0,
+                            VK_WHOLE_SIZE };
+  descriptors.subMeshes = { current.subMeshBuffer.getVkBuffer(),
+                            0,
+                            VK_WHOLE_SIZE };
+  descriptors.draws     = { current.drawBuffer.getVkBuffer(),
+                            drawOffset,
+                            current.drawRegionSize };
+  descriptors.count     = { current.countBuffer.getVkBuffer(),
+                            countOffset,
+                            sizeof(uint32_t) };
+
+  VkDescriptorSet descriptorSet{ VK_NULL_HANDLE };
+
+  if(mDescriptorAllocator->allocate(mCullSetLayout,
+                                    &descriptors,
+                                    descriptorSet) is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to allocate the culling descriptor set.",
+                   DescriptorAllocator::allocate);
+
+    return failure;
+  }
+
+  CullConstants constants{};
+
+  constants.frustumPlanes = getFrustumPlanes(viewProjection);
+  constants.numInstances  = current.numInstances;
+
+  vkCmdBindPipeline(commandBuffer,
+                    VK_PIPELINE_BIND_POINT_COMPUTE,
+                    mCullPipeline.getVkPipeline());
+
+  vkCmdBindDescriptorSets(commandBuffer,
+                          VK_PIPELINE_BIND_POINT_COMPUTE,
+                          mCullPipeline.getVkPipelineLayout(),
+                          0,
+                          1,
+                          &descriptorSet,
+                          0,
+                          nullptr);
+
+  vkCmdPushConstants(commandBuffer,
+                     mCullPipeline.getVkPipelineLayout(),
+                     VK_SHADER_STAGE_COMPUTE_BIT,
+                     0,
+                     sizeof(constants),
+                     &constants);
+
+  vkCmdDispatch(commandBuffer,
+                (current.numInstances + cullGroupSize - 1) / cullGroupSize,
+                1,
+                1);
+
+  // The count is also read back by the host once the frame is finished,
+  // which is outside of what a render graph orders.
+  VkBufferMemoryBarrier hostBarrier{};
+
+  hostBarrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+  hostBarrier.srcAccessMask       = VK_ACCESS_SHADER_WRITE_BIT;
+  hostBarrier.dstAccessMask       = VK_ACCESS_HOST_READ_BIT;
+  hostBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  hostBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  hostBarrier.buffer              = current.countBuffer.getVkBuffer();
+  hostBarrier.offset              = countOffset;
+  hostBarrier.size                = sizeof(uint32_t);
+
+  vkCmdPipelineBarrier(commandBuffer,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_PIPELINE_STAGE_HOST_BIT,
+                       0,
+                       0,
+                       nullptr,
+                       1,
+                       &hostBarrier,
+                       0,
+                       nullptr);
+
+  return success;
+}
+
+so::return_t
+so::vk::GpuDrivenRenderer::recordDraws
+  (VkCommandBuffer       const  commandBuffer,
+   index_t               const  frame,
+   Mesh                  const& mesh,
+   std::array<float, 16> const& viewProjection)
+{
+  Instances const& current{ *mCurrent };
+
+  DrawDescriptors descriptors{};
+
+  descriptors.instances = { current.instanceBuffer.getVkBuffer(),
+                            0,
+                            VK_WHOLE_SIZE };
+
+  VkDescriptorSet descriptorSet{ VK_NULL_HANDLE };
+
+  if(mDescriptorAllocator->allocate(mDrawSetLayout,
+                                    &descriptors,
+                                    descriptorSet) is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to allocate the instanced descriptor set.",
+                   DescriptorAllocator::allocate);
+
+    return failure;
+  }
+
+  vkCmdBindPipeline(commandBuffer,
+                    VK_PIPELINE_BIND_POINT_GRAPHICS,
+                    mDrawPipeline.getVkPipeline());
+
+  vkCmdBindDescriptorSets(commandBuffer,
+                          VK_PIPELINE_BIND_POINT_GRAPHICS,
+                          mDrawPipeline.getVkPipelineLayout(),
+                          0,
+                          1,
+                          &descriptorSet,
+                          0,
+                          nullptr);
+
+  vkCmdPushConstants(commandBuffer,
+                     mDrawPipeline.getVkPipelineLayout(),
+                     VK_SHADER_STAGE_VERTEX_BIT,
+                     0,
+                     sizeof(viewProjection),
+                     viewProjection.data());
+
+  mesh.bind(commandBuffer);
+
+  VkBuffer const drawBuffer{ current.drawBuffer.getVkBuffer() };
+
+  VkDeviceSize const drawOffset{ static_cast<VkDeviceSize>(frame) *
+                                 current.drawRegionSize };
+
+  uint32_t const maxDrawCount
+    { std::min(current.numInstances,
+               mDevice->getVkPhysicalDeviceProperties()
+                 .limits.maxDrawIndirectCount) };
+
+  switch(mMode)
+  {
+    case IndirectDrawMode::indirectCount:
+      mDrawIndexedIndirectCount(commandBuffer,
+                                drawBuffer,
+                                drawOffset,
+                                current.countBuffer.getVkBuffer(),
+                                static_cast<VkDeviceSize>(frame) *
+                                current.countRegionSize,
+                                maxDrawCount,
+                                static_cast<uint32_t>(drawStride));
+      break;
+    case IndirectDrawMode::multiDrawIndirect:
+      for(uint32_t first{ 0 };
+          first < current.numInstances;
+          first += maxDrawCount)
+      {
+        vkCmdDrawIndexedIndirect
+          (commandBuffer,
+           drawBuffer,
+           drawOffset + first * drawStride,
+           std::min(maxDrawCount, current.numInstances - first),
+           static_cast<uint32_t>(drawStride));
+      }
+      break;
+    case IndirectDrawMode::drawIndirect:
+      for(uint32_t i{ 0 }; i < current.numInstances; ++i)
+      {
+        vkCmdDrawIndexedIndirect(commandBuffer,
+                                 drawBuffer,
+                                 drawOffset + i * drawStride,
+                                 1,
+                                 static_cast<uint32_t>(drawStride));
+      }
+      break;
+  }
+
+  return success;
+}
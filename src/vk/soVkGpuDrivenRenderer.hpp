@@ -0,0 +1,284 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      soVkGpuDrivenRenderer.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "soVkBuffer.hpp"
+#include "soVkComputePipeline.hpp"
+#include "soVkDeletionQueue.hpp"
+#include "soVkDescriptorAllocator.hpp"
+#include "soVkDescriptorSetLayout.hpp"
+#include "soVkMesh.hpp"
+#include "soVkPipeline.hpp"
+#include "soVkUploader.hpp"
+
+#include "cxx/soDefinitions.hpp"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace so {
+namespace vk {
+
+/**
+ * @brief A sub-mesh placed in the world, laid out as in the cull and
+ *        instanced shaders.
+ */
+struct
+MeshInstance
+{
+  std::array<float, 16> transform{};  // Column major model matrix.
+  uint32_t              subMesh{ 0 };
+  uint32_t              padding[3]{};
+}; // struct MeshInstance
+
+/**
+ * @brief How the culled draws are issued, from the cheapest to the most
+ *        expensive on the CPU.
+ */
+enum class
+IndirectDrawMode
+{
+  indirectCount,     // VK_KHR_draw_indirect_count, one call.
+  multiDrawIndirect, // One call over all instances, culled ones are empty.
+  drawIndirect       // One call per instance.
+};
+
+/**
+ * @brief Draws instances of a mesh with the CPU cost of a frame independent
+ *        of the number of instances.
+ *
+ * Instances and the sub-meshes they refer to live in device local storage
+ * buffers. Every frame a compute pass tests the bounding sphere of each
+ * instance against the frustum and appends a VkDrawIndexedIndirectCommand
+ * for each visible one, with the instance index as firstInstance, plus a
+ * draw count. The render pass then draws them with a single
+ * vkCmdDrawIndexedIndirectCountKHR, or vkCmdDrawIndexedIndirect over every
+ * slot, zeroed beforehand, if the extension is missing. Draw and count
+ * buffers have one region per frame in flight.
+ *
+ * Needs the drawIndirectFirstInstance feature.
+ */
+class
+GpuDrivenRenderer
+{
+  public:
+    GpuDrivenRenderer();
+
+    GpuDrivenRenderer(GpuDrivenRenderer const& other) = delete;
+
+    GpuDrivenRenderer(GpuDrivenRenderer&& other) = delete;
+
+    ~GpuDrivenRenderer() noexcept = default;
+
+    GpuDrivenRenderer&
+    operator=(GpuDrivenRenderer const& other) = delete;
+
+    GpuDrivenRenderer&
+    operator=(GpuDrivenRenderer&& other) = delete;
+
+    /**
+     * @brief Fails if the device lacks drawIndirectFirstInstance; the
+     *        caller then has to draw on the CPU.
+     */
+    return_t
+    initialize(SharedPtrLogicalDevice     const& device,
+               SharedPtrMemoryAllocator   const& allocator,
+               Uploader&                         uploader,
+               DescriptorAllocator&              descriptorAllocator,
+               DeletionQueue&                    deletionQueue,
+               size_type                  const  numFramesInFlight,
+               SharedPtrPipelineCache     const& pipelineCache,
+               SharedPtrShaderModuleCache const& shaderModuleCache);
+
+    /**
+     * @brief Uploads instances of the sub-meshes of mesh. They replace the
+     *        previous instances once the upload is complete. Creates the
+     *        graphics pipeline for the vertex format of mesh if necessary.
+     */
+    return_t
+    setInstances(Mesh                      const& mesh,
+                 RenderPass                const& renderPass,
+                 std::vector<MeshInstance> const& instances);
+
+    /**
+     * @brief Recreates the graphics pipeline, e.g. after the swap chain
+     *        format changed.
+     */
+    return_t
+    setRenderPass(RenderPass const& renderPass);
+
+    /**
+     * @brief Switches to the latest instances once their upload is done.
+     *        Call once per frame before recording.
+     */
+    void
+    update();
+
+    /**
+     * @brief Whether there are instances of mesh to draw.
+     */
+    bool
+    isReady(Mesh const& mesh) const;
+
+    /**
+     * @brief Resets the draw count of frame, and the draws if there is no
+     *        draw count, with transfer writes. The previous submission of
+     *        frame has to be finished.
+     */
+    void
+    recordReset(VkCommandBuffer const commandBuffer, index_t const frame);
+
+    /**
+     * @brief Records the compute dispatch culling the instances into the
+     *        draws and the draw count of frame. The writes of recordReset
+     *        have to be visible to it, e.g. through a render graph.
+     */
+    return_t
+    recordCulling(VkCommandBuffer       const  commandBuffer,
+                  index_t               const  frame,
+                  std::array<float, 16> const& viewProjection);
+
+    /**
+     * @brief Records a render pass with the indirect draws of frame, which
+     *        have to wait for recordCulling. The command buffer has to be
+     *        outside of a render pass.
+     */
+    return_t
+    record(VkCommandBuffer       const  commandBuffer,
+           index_t               const  frame,
+           VkFramebuffer         const  framebuffer,
+           RenderPass            const& renderPass,
+           SwapChain             const& swapChain,
+           Mesh                  const& mesh,
+           std::array<float, 16> const& viewProjection);
+
+    /**
+     * @brief Planes a, b, c, d with a * x + b * y + c * z + d >= 0 inside
+     *        the clip volume of the column major viewProjection, normalized
+     *        so d is the distance to the origin. Near is z = 0, as in
+     *        Vulkan.
+     */
+    static std::array<std::array<float, 4>, 6>
+    getFrustumPlanes(std::array<float, 16> const& viewProjection);
+
+    inline IndirectDrawMode getIndirectDrawMode() const { return mMode; }
+
+    inline size_type getNumInstances() const
+    { return mCurrent ? mCurrent->numInstances : 0; }
+
+    /**
+     * @brief Buffer of the draws recordCulling writes, in one region per
+     *        frame in flight. Changes with setInstances.
+     */
+    inline VkBuffer getVkDrawBuffer() const
+    { return mCurrent ? mCurrent->drawBuffer.getVkBuffer() : VK_NULL_HANDLE; }
+
+    /**
+     * @brief Buffer of the draw counts recordCulling writes.
+     */
+    inline VkBuffer getVkCountBuffer() const
+    { return mCurrent ? mCurrent->countBuffer.getVkBuffer() : VK_NULL_HANDLE; }
+
+    /**
+     * @brief Instances that passed culling, numFramesInFlight frames ago.
+     */
+    inline uint32_t getNumVisibleInstances() const { return mNumVisible; }
+
+  private:
+    /**
+     * Buffers replaced as a whole by setInstances.
+     */
+    struct
+    Instances
+    {
+      Buffer       instanceBuffer;
+      Buffer       subMeshBuffer;
+      Buffer       drawBuffer;
+      Buffer       countBuffer;
+      VkDeviceSize drawRegionSize{ 0 };
+      VkDeviceSize countRegionSize{ 0 };
+      uint32_t     numInstances{ 0 };
+      VkBuffer     vertexBuffer{ VK_NULL_HANDLE };
+      uint64_t     uploadTicket{ 0 };
+    };
+
+    SharedPtrLogicalDevice     mDevice;
+    SharedPtrMemoryAllocator   mAllocator;
+    Uploader*                  mUploader;
+    DescriptorAllocator*       mDescriptorAllocator;
+    DeletionQueue*             mDeletionQueue;
+    SharedPtrPipelineCache     mPipelineCache;
+    SharedPtrShaderModuleCache mShaderModuleCache;
+
+    DescriptorSetLayout        mCullSetLayout;
+    DescriptorSetLayout        mDrawSetLayout;
+    ComputePipeline            mCullPipeline;
+    Pipeline                   mDrawPipeline;
+
+    std::unique_ptr<Instances> mCurrent;
+    std::unique_ptr<Instances> mPending;
+
+    PFN_vkCmdDrawIndexedIndirectCountKHR mDrawIndexedIndirectCount;
+
+    IndirectDrawMode           mMode;
+    size_type                  mNumFrames;
+    uint32_t                   mNumVisible;
+
+    return_t
+    recordDraws(VkCommandBuffer       const  commandBuffer,
+                index_t               const  frame,
+                Mesh                  const& mesh,
+                std::array<float, 16> const& viewProjection);
+};
+
+} // namespace vk
+} // namespace so
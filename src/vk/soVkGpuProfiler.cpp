@@ -0,0 +1,355 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "soVkGpuProfiler.hpp"
+#include "soVkQueueFamilyIndices.hpp"
+
+#include "cxx/soDebugCallback.hpp"
+#include "cxx/soDefinitions.hpp"
+
+so::vk::GpuZoneHistory::duration
+so::vk::GpuZoneHistory::latest() const
+{
+  return samples.empty() ? duration{ 0.0 } : samples.back();
+}
+
+so::vk::GpuZoneHistory::duration
+so::vk::GpuZoneHistory::average() const
+{
+  if(samples.empty())
+  {
+    return duration{ 0.0 };
+  }
+
+  duration sum{ 0.0 };
+
+  for(duration const sample : samples)
+  {
+    sum += sample;
+  }
+
+  return sum / static_cast<double>(samples.size());
+}
+
+so::vk::GpuProfiler::ScopedZone::ScopedZone(GpuProfiler&          profiler,
+                                            VkCommandBuffer const commandBuffer,
+                                            index_t         const frame,
+                                            char const*     const name)
+  : mProfiler(profiler),
+    mCommandBuffer(commandBuffer),
+    mFrame(frame),
+    mZone(profiler.beginZone(commandBuffer, frame, name))
+{}
+
+so::vk::GpuProfiler::ScopedZone::~ScopedZone() noexcept
+{
+  mProfiler.endZone(mCommandBuffer, mFrame, mZone);
+}
+
+so::vk::GpuProfiler::GpuProfiler()
+  : mQueryPools(),
+    mFrames(),
+    mZoneHistories(),
+    mResults(),
+    mDevice(LogicalDevice::getSharedPtrNullDevice()),
+    mMaxZonesPerFrame(0),
+    mHistorySize(0),
+    mTimestampMask(0),
+    mTimestampPeriod(0.0)
+{}
+
+so::vk::GpuProfiler::~GpuProfiler() noexcept
+{
+  destroyMembers();
+}
+
+so::vk::GpuProfiler&
+so::vk::GpuProfiler::operator=(GpuProfiler&& other) noexcept
+{
+  if(this is_eq &other)
+  {
+    return *this;
+  }
+
+  destroyMembers();
+
+  mQueryPools       = std::move(other.mQueryPools);
+  mFrames           = std::move(other.mFrames);
+  mZoneHistories    = std::move(other.mZoneHistories);
+  mResults          = std::move(other.mResults);
+  mDevice           = other.mDevice;
+  mMaxZonesPerFrame = other.mMaxZonesPerFrame;
+  mHistorySize      = other.mHistorySize;
+  mTimestampMask    = other.mTimestampMask;
+  mTimestampPeriod  = other.mTimestampPeriod;
+
+  other.mQueryPools = std::vector<VkQueryPool>();
+  other.mFrames     = std::vector<Frame>();
+  other.mDevice     = LogicalDevice::getSharedPtrNullDevice();
+
+  return *this;
+}
+
+so::return_t
+so::vk::GpuProfiler::initialize(SharedPtrLogicalDevice const& device,
+                                Surface                const& surface,
+                                size_type              const  numFramesInFlight,
+                                uint32_t               const  maxZonesPerFrame,
+                                size_type              const  historySize)
+{
+  destroyMembers();
+
+  mDevice           = device;
+  mMaxZonesPerFrame = maxZonesPerFrame;
+  mHistorySize      = historySize;
+
+  VkPhysicalDevice physicalDevice{ mDevice->getVkPhysicalDevice() };
+
+  QueueFamilyIndices indices(physicalDevice, surface);
+
+  uint32_t queueFamilyCount{ 0 };
+
+  vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice,
+                                           &queueFamilyCount,
+                                           nullptr);
+
+  std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+
+  vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice,
+                                           &queueFamilyCount,
+                                           queueFamilies.data());
+
+  auto const graphicsFamily
+    { static_cast<size_type>(indices.getGraphicsFamily()) };
+
+  uint32_t const validBits{ graphicsFamily < queueFamilies.size()
+                              ? queueFamilies[graphicsFamily].timestampValidBits
+                              : 0 };
+
+  if(validBits is_eq 0 or maxZonesPerFrame is_eq 0)
+  {
+    DEBUG_CALLBACK(info,
+                   "The graphics queue does not support timestamps, GPU "
+                   "profiling is disabled.");
+
+    return success;
+  }
+
+  mTimestampMask   = validBits >= 64 ? ~uint64_t{ 0 }
+                                     : (uint64_t{ 1 } << validBits) - 1;
+  mTimestampPeriod = static_cast<double>
+                       (mDevice->getVkPhysicalDeviceProperties()
+                          .limits.timestampPeriod);
+
+  VkQueryPoolCreateInfo createInfo{};
+
+  createInfo.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+  createInfo.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+  createInfo.queryCount = 2 * maxZonesPerFrame;
+
+  mQueryPools.resize(numFramesInFlight, VK_NULL_HANDLE);
+  mFrames.resize(numFramesInFlight);
+
+  for(VkQueryPool& queryPool : mQueryPools)
+  {
+    if(vkCreateQueryPool(mDevice->getVkDevice(),
+                         &createInfo,
+                         nullptr,
+                         &queryPool) not_eq VK_SUCCESS)
+    {
+      DEBUG_CALLBACK(error,
+                     "Failed to create a timestamp query pool.",
+                     vkCreateQueryPool);
+
+      destroyMembers();
+
+      return failure;
+    }
+  }
+
+  // A value and an availability word per query.
+  mResults.resize(4 * size_type{ maxZonesPerFrame });
+
+  return success;
+}
+
+void
+so::vk::GpuProfiler::beginFrame(VkCommandBuffer const commandBuffer,
+                                index_t         const frame)
+{
+  if(not isSupported())
+  {
+    return;
+  }
+
+  collect(frame);
+
+  auto const idx{ static_cast<size_type>(frame) };
+
+  vkCmdResetQueryPool(commandBuffer,
+                      mQueryPools[idx],
+                      0,
+                      2 * mMaxZonesPerFrame);
+
+  mFrames[idx].zoneNames.clear();
+  mFrames[idx].isPending = true;
+}
+
+uint32_t
+so::vk::GpuProfiler::beginZone(VkCommandBuffer const commandBuffer,
+                               index_t         const frame,
+                               char const*     const name)
+{
+  if(not isSupported())
+  {
+    return invalidZone;
+  }
+
+  auto const idx{ static_cast<size_type>(frame) };
+
+  std::vector<char const*>& zoneNames{ mFrames[idx].zoneNames };
+
+  if(zoneNames.size() >= mMaxZonesPerFrame)
+  {
+    return invalidZone;
+  }
+
+  auto const zone{ static_cast<uint32_t>(zoneNames.size()) };
+
+  zoneNames.push_back(name);
+
+  vkCmdWriteTimestamp(commandBuffer,
+                      VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                      mQueryPools[idx],
+                      2 * zone);
+
+  return zone;
+}
+
+void
+so::vk::GpuProfiler::endZone(VkCommandBuffer const commandBuffer,
+                             index_t         const frame,
+                             uint32_t        const zone)
+{
+  if(zone is_eq invalidZone)
+  {
+    return;
+  }
+
+  vkCmdWriteTimestamp(commandBuffer,
+                      VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                      mQueryPools[static_cast<size_type>(frame)],
+                      2 * zone + 1);
+}
+
+void
+so::vk::GpuProfiler::collect(index_t const frame)
+{
+  auto const idx{ static_cast<size_type>(frame) };
+
+  Frame& data{ mFrames[idx] };
+
+  if(not data.isPending or data.zoneNames.empty())
+  {
+    return;
+  }
+
+  data.isPending = false;
+
+  auto const numQueries{ static_cast<uint32_t>(2 * data.zoneNames.size()) };
+
+  // VK_NOT_READY only means some zones are not available yet, which the
+  // availability words tell apart.
+  VkResult const result
+    { vkGetQueryPoolResults(mDevice->getVkDevice(),
+                            mQueryPools[idx],
+                            0,
+                            numQueries,
+                            mResults.size() * sizeof(uint64_t),
+                            mResults.data(),
+                            2 * sizeof(uint64_t),
+                            VK_QUERY_RESULT_64_BIT bitor
+                            VK_QUERY_RESULT_WITH_AVAILABILITY_BIT) };
+
+  if(result not_eq VK_SUCCESS and result not_eq VK_NOT_READY)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to read back timestamp queries.",
+                   vkGetQueryPoolResults);
+
+    return;
+  }
+
+  for(size_type zone{ 0 }; zone < data.zoneNames.size(); ++zone)
+  {
+    uint64_t const* begin{ &mResults[4 * zone] };
+    uint64_t const* end{ begin + 2 };
+
+    if(begin[1] is_eq 0 or end[1] is_eq 0)
+    {
+      continue;
+    }
+
+    uint64_t const ticks{ (end[0] - begin[0]) bitand mTimestampMask };
+
+    // timestampPeriod is in nanoseconds per tick.
+    GpuZoneHistory::duration const time
+      { static_cast<double>(ticks) * mTimestampPeriod * 1e-6 };
+
+    char const* const name{ data.zoneNames[zone] };
+
+    auto history{ mZoneHistories.find(name) };
+
+    if(history is_eq mZoneHistories.end())
+    {
+      history = mZoneHistories.emplace(name, GpuZoneHistory{}).first;
+    }
+
+    history->second.samples.push_back(time);
+
+    while(history->second.samples.size() > mHistorySize)
+    {
+      history->second.samples.pop_front();
+    }
+  }
+}
+
+void
+so::vk::GpuProfiler::destroyMembers()
+{
+  VkDevice device{ mDevice->getVkDevice() };
+
+  if(device not_eq VK_NULL_HANDLE)
+  {
+    for(VkQueryPool const queryPool : mQueryPools)
+    {
+      if(queryPool not_eq VK_NULL_HANDLE)
+      {
+        vkDestroyQueryPool(device, queryPool, nullptr);
+      }
+    }
+  }
+
+  mQueryPools.clear();
+  mFrames.clear();
+}
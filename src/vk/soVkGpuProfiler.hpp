@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      soVkGpuProfiler.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "soVkLogicalDevice.hpp"
+#include "soVkSurface.hpp"
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace so {
+namespace vk {
+
+/**
+ * @brief The most recent GPU timings of one zone, oldest first.
+ */
+struct
+GpuZoneHistory
+{
+  using duration = std::chrono::duration<double, std::milli>;
+
+  std::deque<duration> samples;
+
+  duration
+  latest() const;
+
+  duration
+  average() const;
+};
+
+/**
+ * @brief Measures GPU time spent in zones of the recorded commands with
+ *        timestamp queries.
+ *
+ * Every frame in flight has its own query pool. The results of a frame are
+ * read back when its slot is recorded again, i.e. after its in-flight fence
+ * has been waited for, without VK_QUERY_RESULT_WAIT_BIT; zones whose queries
+ * are not available yet are dropped instead of stalling. Zones are recorded
+ * into the primary command buffer from the recording thread only.
+ */
+class
+GpuProfiler
+{
+  public:
+    static constexpr uint32_t invalidZone{ ~0u };
+
+    /**
+     * @brief Ends a zone when leaving scope.
+     */
+    class
+    ScopedZone
+    {
+      public:
+        ScopedZone(GpuProfiler&          profiler,
+                   VkCommandBuffer const commandBuffer,
+                   index_t         const frame,
+                   char const*     const name);
+
+        ScopedZone(ScopedZone const& other) = delete;
+
+        ScopedZone(ScopedZone&& other) = delete;
+
+        ~ScopedZone() noexcept;
+
+        ScopedZone&
+        operator=(ScopedZone const& other) = delete;
+
+        ScopedZone&
+        operator=(ScopedZone&& other) = delete;
+
+      private:
+        GpuProfiler&    mProfiler;
+        VkCommandBuffer mCommandBuffer;
+        index_t         mFrame;
+        uint32_t        mZone;
+    };
+
+    GpuProfiler();
+
+    GpuProfiler(GpuProfiler const& other) = delete;
+
+    GpuProfiler(GpuProfiler&& other) = delete;
+
+    ~GpuProfiler() noexcept;
+
+    GpuProfiler&
+    operator=(GpuProfiler const& other) = delete;
+
+    GpuProfiler&
+    operator=(GpuProfiler&& other) noexcept;
+
+    /**
+     * @param maxZonesPerFrame Zones beyond this many per frame are ignored.
+     * @param historySize      Number of samples kept per zone.
+     *
+     * Succeeds without creating query pools if the graphics queue does not
+     * support timestamps; all zones are ignored then.
+     */
+    return_t
+    initialize(SharedPtrLogicalDevice const& device,
+               Surface                const& surface,
+               size_type              const  numFramesInFlight,
+               uint32_t               const  maxZonesPerFrame = 64,
+               size_type              const  historySize = 128);
+
+    inline bool isSupported() const { return not mQueryPools.empty(); }
+
+    /**
+     * @brief Collects the results of the previous use of the frame slot and
+     *        records the reset of its queries. Must be recorded outside of a
+     *        render pass, before any zone of the frame.
+     */
+    void
+    beginFrame(VkCommandBuffer const commandBuffer, index_t const frame);
+
+    /**
+     * @param name Must outlive the frame, e.g. a string literal.
+     *
+     * @return The zone to pass to endZone, invalidZone if it is ignored.
+     */
+    uint32_t
+    beginZone(VkCommandBuffer const commandBuffer,
+              index_t         const frame,
+              char const*     const name);
+
+    void
+    endZone(VkCommandBuffer const commandBuffer,
+            index_t         const frame,
+            uint32_t        const zone);
+
+    inline std::map<std::string, GpuZoneHistory, std::less<>> const&
+    getZoneHistories() const { return mZoneHistories; }
+
+  private:
+    struct
+    Frame
+    {
+      std::vector<char const*> zoneNames;
+      bool                     isPending{ false };
+    };
+
+    std::vector<VkQueryPool> mQueryPools;
+    std::vector<Frame>       mFrames;
+
+    std::map<std::string, GpuZoneHistory, std::less<>> mZoneHistories;
+
+    std::vector<uint64_t>    mResults;
+
+    SharedPtrLogicalDevice   mDevice;
+
+    uint32_t                 mMaxZonesPerFrame;
+    size_type                mHistorySize;
+    uint64_t                 mTimestampMask;
+    double                   mTimestampPeriod;
+
+    void
+    collect(index_t const frame);
+
+    void
+    destroyMembers();
+};
+
+} // namespace vk
+} // namespace so
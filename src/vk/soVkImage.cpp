@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "soVkImage.hpp"
+
+#include "cxx/soDebugCallback.hpp"
+#include "cxx/soDefinitions.hpp"
+
+so::vk::Image::Image()
+  : mImage(VK_NULL_HANDLE),
+    mExtent{ 0, 0, 0 },
+    mFormat(VK_FORMAT_UNDEFINED),
+    mMipLevels(0),
+    mAllocation(),
+    mAllocator(MemoryAllocator::getSharedPtrNullMemoryAllocator())
+{}
+
+so::vk::Image::~Image() noexcept
+{
+  destroyMembers();
+}
+
+so::vk::Image&
+so::vk::Image::operator=(Image&& other) noexcept
+{
+  if(this is_eq &other)
+  {
+    return *this;
+  }
+
+  destroyMembers();
+
+  mImage      = other.mImage;
+  mExtent     = other.mExtent;
+  mFormat     = other.mFormat;
+  mMipLevels  = other.mMipLevels;
+  mAllocation = other.mAllocation;
+  mAllocator  = other.mAllocator;
+
+  other.mImage      = VK_NULL_HANDLE;
+  other.mExtent     = { 0, 0, 0 };
+  other.mFormat     = VK_FORMAT_UNDEFINED;
+  other.mMipLevels  = 0;
+  other.mAllocation = Allocation();
+  other.mAllocator  = MemoryAllocator::getSharedPtrNullMemoryAllocator();
+
+  return *this;
+}
+
+so::return_t
+so::vk::Image::initialize(SharedPtrMemoryAllocator const& allocator,
+                          VkImageCreateInfo        const& imageInfo,
+                          AllocationInfo           const& allocationInfo)
+{
+  destroyMembers();
+
+  mAllocator = allocator;
+  mExtent    = imageInfo.extent;
+  mFormat    = imageInfo.format;
+  mMipLevels = imageInfo.mipLevels;
+
+  VkDevice device{ mAllocator->getDevice()->getVkDevice() };
+
+  if(vkCreateImage(device, &imageInfo, nullptr, &mImage) not_eq VK_SUCCESS)
+  {
+    DEBUG_CALLBACK(error, "Failed to create an image.", vkCreateImage);
+
+    return failure;
+  }
+
+  VkMemoryRequirements requirements;
+
+  vkGetImageMemoryRequirements(device, mImage, &requirements);
+
+  AllocationInfo imageAllocationInfo{ allocationInfo };
+
+  imageAllocationInfo.isLinear = imageInfo.tiling is_eq VK_IMAGE_TILING_LINEAR;
+
+  if(mAllocator->allocate(requirements,
+                          imageAllocationInfo,
+                          mAllocation) is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to allocate memory for an image.",
+                   MemoryAllocator::allocate);
+
+    return failure;
+  }
+
+  if(vkBindImageMemory(device,
+                       mImage,
+                       mAllocation.memory,
+                       mAllocation.offset) not_eq VK_SUCCESS)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to bind the memory of an image.",
+                   vkBindImageMemory);
+
+    return failure;
+  }
+
+  return success;
+}
+
+void
+so::vk::Image::destroyMembers()
+{
+  VkDevice device{ mAllocator->getDevice()->getVkDevice() };
+
+  if((device not_eq VK_NULL_HANDLE) and (mImage not_eq VK_NULL_HANDLE))
+  {
+    vkDestroyImage(device, mImage, nullptr);
+  }
+
+  mAllocator->free(mAllocation);
+
+  mImage = VK_NULL_HANDLE;
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      soVkImage.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "soVkMemoryAllocator.hpp"
+
+namespace so {
+namespace vk {
+
+/**
+ * @brief A VkImage bound to memory of a so::vk::MemoryAllocator.
+ */
+class
+Image
+{
+  public:
+    Image();
+
+    Image(Image const& other) = delete;
+
+    Image(Image&& other) = delete;
+
+    ~Image() noexcept;
+
+    Image&
+    operator=(Image const& other) = delete;
+
+    Image&
+    operator=(Image&& other) noexcept;
+
+    /**
+     * @brief Creates the image. Whether its memory is linear is derived
+     *        from imageInfo.tiling.
+     */
+    return_t
+    initialize(SharedPtrMemoryAllocator const& allocator,
+               VkImageCreateInfo        const& imageInfo,
+               AllocationInfo           const& allocationInfo);
+
+    inline VkImage getVkImage() const { return mImage; }
+
+    inline VkExtent3D getVkExtent() const { return mExtent; }
+
+    inline VkFormat getVkFormat() const { return mFormat; }
+
+    inline uint32_t getMipLevels() const { return mMipLevels; }
+
+    inline Allocation const& getAllocation() const { return mAllocation; }
+
+  private:
+    VkImage                  mImage;
+    VkExtent3D               mExtent;
+    VkFormat                 mFormat;
+    uint32_t                 mMipLevels;
+    Allocation               mAllocation;
+    SharedPtrMemoryAllocator mAllocator;
+
+    void
+    destroyMembers();
+};
+
+} // namespace vk
+} // namespace so
@@ -25,6 +25,7 @@
 #include "cxx/soDebugCallback.hpp"
 #include "cxx/soDefinitions.hpp"
 #include "cxx/soMemory.hpp"
+#include "cxx/soPoolAllocator.hpp"
 #include "cxx/soSpan.hpp"
 
 #include <cstring>
@@ -37,7 +38,7 @@ std::shared_ptr<so::vk::Instance> const
 so::vk::Instance::getSharedPtrNullInstance()
 {
   static std::shared_ptr<so::vk::Instance> 
-    sharedPtrNullInstance{ std::make_shared<so::vk::Instance>() };
+    sharedPtrNullInstance{ utils::mem::makePooledShared<so::vk::Instance>() };
 
   return sharedPtrNullInstance;
 }
@@ -25,13 +25,15 @@
 #include "soVkQueueFamilyIndices.hpp"
 
 #include "cxx/soMemory.hpp"
+#include "cxx/soPoolAllocator.hpp"
 
 #include <set>
 
 so::vk::SharedPtrLogicalDevice const&
 so::vk::LogicalDevice::getSharedPtrNullDevice()
 {
-  static SharedPtrLogicalDevice device{ std::make_shared<LogicalDevice>() };
+  static SharedPtrLogicalDevice device
+    { utils::mem::makePooledShared<LogicalDevice>() };
 
   return device;
 }
@@ -40,7 +42,12 @@ so::vk::LogicalDevice::LogicalDevice()
   : PhysicalDevice(),
     mDevice(VK_NULL_HANDLE),
     mGraphicsQueue(VK_NULL_HANDLE),
-    mPresentQueue(VK_NULL_HANDLE)
+    mPresentQueue(VK_NULL_HANDLE),
+    mTransferQueue(VK_NULL_HANDLE),
+    mGraphicsFamily(VK_QUEUE_FAMILY_IGNORED),
+    mTransferFamily(VK_QUEUE_FAMILY_IGNORED),
+    mEnabledExtensions(),
+    mEnabledFeatures()
 {}
 
 so::vk::LogicalDevice::~LogicalDevice() noexcept { destroyMembers(); }
@@ -57,13 +64,25 @@ so::vk::LogicalDevice::operator=(so::vk::LogicalDevice&& other) noexcept
 
   destroyMembers();
 
-  mDevice        = other.mDevice;
-  mGraphicsQueue = other.mGraphicsQueue;
-  mPresentQueue  = other.mPresentQueue;
+  mDevice         = other.mDevice;
+  mGraphicsQueue  = other.mGraphicsQueue;
+  mPresentQueue   = other.mPresentQueue;
+  mTransferQueue  = other.mTransferQueue;
+  mGraphicsFamily = other.mGraphicsFamily;
+  mTransferFamily = other.mTransferFamily;
 
-  other.mDevice        = VK_NULL_HANDLE;
-  other.mGraphicsQueue = VK_NULL_HANDLE;
-  other.mPresentQueue  = VK_NULL_HANDLE;
+  mEnabledExtensions = std::move(other.mEnabledExtensions);
+  mEnabledFeatures   = other.mEnabledFeatures;
+
+  other.mDevice         = VK_NULL_HANDLE;
+  other.mGraphicsQueue  = VK_NULL_HANDLE;
+  other.mPresentQueue   = VK_NULL_HANDLE;
+  other.mTransferQueue  = VK_NULL_HANDLE;
+  other.mGraphicsFamily = VK_QUEUE_FAMILY_IGNORED;
+  other.mTransferFamily = VK_QUEUE_FAMILY_IGNORED;
+
+  other.mEnabledExtensions.clear();
+  other.mEnabledFeatures = VkPhysicalDeviceFeatures{};
 
   return *this;
 }
@@ -84,6 +103,11 @@ so::vk::LogicalDevice::initialize(SharedPtrInstance const& instance,
   std::set<int> uniqueQueueFamilies = { indices.getGraphicsFamily(),
                                         indices.getPresentFamily() };
 
+  if(indices.getTransferFamily() >= 0)
+  {
+    uniqueQueueFamilies.insert(indices.getTransferFamily());
+  }
+
   auto queuePriority(make_unique<float>(1.0f));
 
   for(auto const queueFamily : uniqueQueueFamilies)
@@ -105,8 +129,48 @@ so::vk::LogicalDevice::initialize(SharedPtrInstance const& instance,
 
   auto deviceFeatures{ make_unique<VkPhysicalDeviceFeatures>() };
 
+  VkPhysicalDeviceFeatures supportedFeatures{};
+
+  vkGetPhysicalDeviceFeatures(mPhysicalDevice, &supportedFeatures);
+
   deviceFeatures->samplerAnisotropy = VK_TRUE;
 
+  // GPU-driven drawing writes many draws with per instance firstInstance.
+  deviceFeatures->multiDrawIndirect         =
+    supportedFeatures.multiDrawIndirect;
+  deviceFeatures->drawIndirectFirstInstance =
+    supportedFeatures.drawIndirectFirstInstance;
+
+  uint32_t extensionCount{ 0 };
+
+  vkEnumerateDeviceExtensionProperties(mPhysicalDevice,
+                                       nullptr,
+                                       &extensionCount,
+                                       nullptr);
+
+  std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+
+  vkEnumerateDeviceExtensionProperties(mPhysicalDevice,
+                                       nullptr,
+                                       &extensionCount,
+                                       availableExtensions.data());
+
+  std::vector<char const*> extensions(DEVICE_EXTENSIONS.begin(),
+                                      DEVICE_EXTENSIONS.end());
+
+  for(auto const optionalExtension : OPTIONAL_DEVICE_EXTENSIONS)
+  {
+    for(auto const& extension : availableExtensions)
+    {
+      if(std::string(extension.extensionName) is_eq optionalExtension)
+      {
+        extensions.push_back(optionalExtension);
+
+        break;
+      }
+    }
+  }
+
   VkDeviceCreateInfo createInfo({});
 
   createInfo.sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -115,8 +179,8 @@ so::vk::LogicalDevice::initialize(SharedPtrInstance const& instance,
     static_cast<uint32_t>(queueCreateInfos.size());
   createInfo.pEnabledFeatures        = deviceFeatures.get();
   createInfo.enabledExtensionCount   =
-    static_cast<uint32_t>(DEVICE_EXTENSIONS.size());
-  createInfo.ppEnabledExtensionNames = DEVICE_EXTENSIONS.data();
+    static_cast<uint32_t>(extensions.size());
+  createInfo.ppEnabledExtensionNames = extensions.data();
 
   if(ENABLE_VALIDATION_LAYERS)
   {
@@ -139,6 +203,9 @@ so::vk::LogicalDevice::initialize(SharedPtrInstance const& instance,
     return failure;
   }   
 
+  mEnabledExtensions = { extensions.begin(), extensions.end() };
+  mEnabledFeatures   = *deviceFeatures;
+
   vkGetDeviceQueue(mDevice,
                    static_cast<uint32_t>(indices.getGraphicsFamily()),
                    0,
@@ -149,6 +216,15 @@ so::vk::LogicalDevice::initialize(SharedPtrInstance const& instance,
                    0,
                    &mPresentQueue);
 
+  mGraphicsFamily = static_cast<uint32_t>(indices.getGraphicsFamily());
+
+  if(indices.getTransferFamily() >= 0)
+  {
+    mTransferFamily = static_cast<uint32_t>(indices.getTransferFamily());
+
+    vkGetDeviceQueue(mDevice, mTransferFamily, 0, &mTransferQueue);
+  }
+
   return success;
 }
  
@@ -159,5 +235,7 @@ so::vk::LogicalDevice::destroyMembers()
   {
     vkDestroyDevice(mDevice, nullptr);
   }
+
+  mEnabledExtensions.clear();
 }
 
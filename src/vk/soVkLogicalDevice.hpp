@@ -53,6 +53,9 @@
 #include <soVkPhysicalDevice.hpp>
 #include <soVkSurface.hpp>
 
+#include <set>
+#include <string>
+
 #if defined(__GNUC__) || defined(__clang__)
 #pragma GCC diagnostic ignored "-Wnon-virtual-dtor"
 #endif
@@ -95,10 +98,42 @@ LogicalDevice : public PhysicalDevice,
 
     inline VkQueue getPresentVkQueue() { return mPresentQueue; }
 
+    /**
+     * @brief The queue of a transfer-only family, VK_NULL_HANDLE if the
+     *        device has none.
+     */
+    inline VkQueue getTransferVkQueue() { return mTransferQueue; }
+
+    inline uint32_t getGraphicsQueueFamily() const { return mGraphicsFamily; }
+
+    inline uint32_t getTransferQueueFamily() const { return mTransferFamily; }
+
+    /**
+     * @brief Whether extensionName, required or optional, was enabled on
+     *        device creation.
+     */
+    inline bool
+    isExtensionEnabled(char const* const extensionName) const
+    { return mEnabledExtensions.count(extensionName) not_eq 0; }
+
+    /**
+     * @brief Features enabled on device creation. Optional ones, like
+     *        multiDrawIndirect, are only set if the device supports them.
+     */
+    inline VkPhysicalDeviceFeatures const& getEnabledVkFeatures() const
+    { return mEnabledFeatures; }
+
   private:
     VkDevice mDevice;
     VkQueue  mGraphicsQueue;
     VkQueue  mPresentQueue;
+    VkQueue  mTransferQueue;
+    uint32_t mGraphicsFamily;
+    uint32_t mTransferFamily;
+
+    std::set<std::string, std::less<>> mEnabledExtensions;
+
+    VkPhysicalDeviceFeatures mEnabledFeatures;
 
     void
     destroyMembers();
@@ -0,0 +1,1012 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "soVkMemoryAllocator.hpp"
+
+#include "cxx/soDebugCallback.hpp"
+#include "cxx/soDefinitions.hpp"
+#include "cxx/soPoolAllocator.hpp"
+
+#include <algorithm>
+
+namespace {
+
+constexpr uint32_t invalidNode{ ~0u };
+
+// Every power of two size class is split into 2^secondLevelBits lists.
+constexpr uint32_t secondLevelBits{ 5 };
+constexpr uint32_t secondLevelCount{ 1u << secondLevelBits };
+constexpr uint32_t firstLevelCount{ 64 - secondLevelBits + 1 };
+
+inline uint32_t
+log2(VkDeviceSize const value)
+{
+  return 63u - static_cast<uint32_t>(__builtin_clzll(value));
+}
+
+inline VkDeviceSize
+alignUp(VkDeviceSize const value, VkDeviceSize const alignment)
+{
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * Two-level segregated fit allocator over the range [0, size).
+ *
+ * Free ranges are kept in lists by size class: the first level is the power
+ * of two, the second level splits it linearly. Bitmaps of the non-empty
+ * lists find a fitting range with two bit scans. Adjacent free ranges are
+ * merged right away, so a free range's neighbours are always in use.
+ */
+class
+Tlsf
+{
+  public:
+    explicit Tlsf(VkDeviceSize const size)
+      : mNodes(),
+        mUnusedNodes(),
+        mFirstLevelBitmap(0),
+        mSecondLevelBitmaps(),
+        mFreeLists(),
+        mSize(size),
+        mUsedBytes(0),
+        mAllocationCount(0)
+    {
+      for(auto& lists : mFreeLists)
+      {
+        lists.fill(invalidNode);
+      }
+
+      mSecondLevelBitmaps.fill(0);
+
+      uint32_t const node{ createNode() };
+
+      mNodes[node].offset = 0;
+      mNodes[node].size   = size;
+
+      insertFree(node);
+    }
+
+    /**
+     * @return The node of the range, invalidNode if nothing fits.
+     */
+    uint32_t
+    allocate(VkDeviceSize const size,
+             VkDeviceSize const alignment,
+             VkDeviceSize&      offset)
+    {
+      // Any range found for this size fits the allocation at any alignment.
+      VkDeviceSize const searchSize{ size + alignment - 1 };
+
+      uint32_t firstLevel;
+      uint32_t secondLevel;
+
+      if(not findFree(searchSize, firstLevel, secondLevel))
+      {
+        return invalidNode;
+      }
+
+      uint32_t const node{ mFreeLists[firstLevel][secondLevel] };
+
+      removeFree(node);
+
+      VkDeviceSize const aligned{ alignUp(mNodes[node].offset, alignment) };
+      VkDeviceSize const padding{ aligned - mNodes[node].offset };
+
+      if(padding > 0)
+      {
+        uint32_t const front{ createNode() };
+
+        mNodes[front].offset = mNodes[node].offset;
+        mNodes[front].size   = padding;
+
+        linkBefore(front, node);
+
+        mNodes[node].offset  = aligned;
+        mNodes[node].size   -= padding;
+
+        insertFree(front);
+      }
+
+      if(mNodes[node].size > size)
+      {
+        uint32_t const back{ createNode() };
+
+        mNodes[back].offset = aligned + size;
+        mNodes[back].size   = mNodes[node].size - size;
+
+        linkAfter(back, node);
+
+        mNodes[node].size = size;
+
+        insertFree(back);
+      }
+
+      mNodes[node].isFree = false;
+
+      mUsedBytes += size;
+      ++mAllocationCount;
+
+      offset = aligned;
+
+      return node;
+    }
+
+    void
+    free(uint32_t node)
+    {
+      mUsedBytes -= mNodes[node].size;
+      --mAllocationCount;
+
+      uint32_t const prev{ mNodes[node].prevPhysical };
+
+      if(prev not_eq invalidNode and mNodes[prev].isFree)
+      {
+        removeFree(prev);
+
+        mNodes[prev].size += mNodes[node].size;
+
+        unlink(node);
+        releaseNode(node);
+
+        node = prev;
+      }
+
+      uint32_t const next{ mNodes[node].nextPhysical };
+
+      if(next not_eq invalidNode and mNodes[next].isFree)
+      {
+        removeFree(next);
+
+        mNodes[node].size += mNodes[next].size;
+
+        unlink(next);
+        releaseNode(next);
+      }
+
+      insertFree(node);
+    }
+
+    inline bool isEmpty() const { return mAllocationCount is_eq 0; }
+
+    inline VkDeviceSize getSize() const { return mSize; }
+
+    inline VkDeviceSize getUsedBytes() const { return mUsedBytes; }
+
+    inline uint64_t getAllocationCount() const { return mAllocationCount; }
+
+    void
+    getFreeRanges(VkDeviceSize& largest, uint64_t& count) const
+    {
+      for(auto const& lists : mFreeLists)
+      {
+        for(uint32_t node : lists)
+        {
+          for(; node not_eq invalidNode; node = mNodes[node].nextFree)
+          {
+            largest = std::max(largest, mNodes[node].size);
+
+            ++count;
+          }
+        }
+      }
+    }
+
+  private:
+    struct
+    Node
+    {
+      VkDeviceSize offset{ 0 };
+      VkDeviceSize size{ 0 };
+      uint32_t     prevPhysical{ invalidNode };
+      uint32_t     nextPhysical{ invalidNode };
+      uint32_t     prevFree{ invalidNode };
+      uint32_t     nextFree{ invalidNode };
+      bool         isFree{ false };
+    };
+
+    std::vector<Node>     mNodes;
+    std::vector<uint32_t> mUnusedNodes;
+
+    uint64_t                                mFirstLevelBitmap;
+    std::array<uint32_t, firstLevelCount>   mSecondLevelBitmaps;
+    std::array<std::array<uint32_t, secondLevelCount>, firstLevelCount>
+                                            mFreeLists;
+
+    VkDeviceSize mSize;
+    VkDeviceSize mUsedBytes;
+    uint64_t     mAllocationCount;
+
+    static void
+    mapping(VkDeviceSize const size,
+            uint32_t&          firstLevel,
+            uint32_t&          secondLevel)
+    {
+      if(size < secondLevelCount)
+      {
+        firstLevel  = 0;
+        secondLevel = static_cast<uint32_t>(size);
+
+        return;
+      }
+
+      uint32_t const bit{ log2(size) };
+
+      firstLevel  = bit - secondLevelBits + 1;
+      secondLevel = static_cast<uint32_t>(size >> (bit - secondLevelBits)) xor
+                    secondLevelCount;
+    }
+
+    bool
+    findFree(VkDeviceSize size,
+             uint32_t&    firstLevel,
+             uint32_t&    secondLevel) const
+    {
+      // Round up to the next size class, so that every range in the list
+      // found is large enough.
+      if(size >= secondLevelCount)
+      {
+        size += (VkDeviceSize{ 1 } << (log2(size) - secondLevelBits)) - 1;
+      }
+
+      mapping(size, firstLevel, secondLevel);
+
+      if(firstLevel >= firstLevelCount)
+      {
+        return false;
+      }
+
+      uint32_t secondLevelMap{ mSecondLevelBitmaps[firstLevel] bitand
+                               (~0u << secondLevel) };
+
+      if(secondLevelMap is_eq 0)
+      {
+        uint64_t const firstLevelMap{ mFirstLevelBitmap bitand
+                                      (~uint64_t{ 0 } << (firstLevel + 1)) };
+
+        if(firstLevelMap is_eq 0)
+        {
+          return false;
+        }
+
+        firstLevel     = static_cast<uint32_t>(__builtin_ctzll(firstLevelMap));
+        secondLevelMap = mSecondLevelBitmaps[firstLevel];
+      }
+
+      secondLevel = static_cast<uint32_t>(__builtin_ctz(secondLevelMap));
+
+      return true;
+    }
+
+    void
+    insertFree(uint32_t const node)
+    {
+      uint32_t firstLevel;
+      uint32_t secondLevel;
+
+      mapping(mNodes[node].size, firstLevel, secondLevel);
+
+      uint32_t& head{ mFreeLists[firstLevel][secondLevel] };
+
+      mNodes[node].isFree   = true;
+      mNodes[node].prevFree = invalidNode;
+      mNodes[node].nextFree = head;
+
+      if(head not_eq invalidNode)
+      {
+        mNodes[head].prevFree = node;
+      }
+
+      head = node;
+
+      mFirstLevelBitmap               |= uint64_t{ 1 } << firstLevel;
+      mSecondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+    }
+
+    void
+    removeFree(uint32_t const node)
+    {
+      uint32_t firstLevel;
+      uint32_t secondLevel;
+
+      mapping(mNodes[node].size, firstLevel, secondLevel);
+
+      Node& data{ mNodes[node] };
+
+      if(data.prevFree not_eq invalidNode)
+      {
+        mNodes[data.prevFree].nextFree = data.nextFree;
+      }
+      else
+      {
+        mFreeLists[firstLevel][secondLevel] = data.nextFree;
+      }
+
+      if(data.nextFree not_eq invalidNode)
+      {
+        mNodes[data.nextFree].prevFree = data.prevFree;
+      }
+
+      if(mFreeLists[firstLevel][secondLevel] is_eq invalidNode)
+      {
+        mSecondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+
+        if(mSecondLevelBitmaps[firstLevel] is_eq 0)
+        {
+          mFirstLevelBitmap &= ~(uint64_t{ 1 } << firstLevel);
+        }
+      }
+
+      data.isFree   = false;
+      data.prevFree = invalidNode;
+      data.nextFree = invalidNode;
+    }
+
+    uint32_t
+    createNode()
+    {
+      if(not mUnusedNodes.empty())
+      {
+        uint32_t const node{ mUnusedNodes.back() };
+
+        mUnusedNodes.pop_back();
+
+        mNodes[node] = Node{};
+
+        return node;
+      }
+
+      mNodes.emplace_back();
+
+      return static_cast<uint32_t>(mNodes.size() - 1);
+    }
+
+    void
+    releaseNode(uint32_t const node)
+    {
+      mUnusedNodes.push_back(node);
+    }
+
+    void
+    linkBefore(uint32_t const node, uint32_t const next)
+    {
+      uint32_t const prev{ mNodes[next].prevPhysical };
+
+      mNodes[node].prevPhysical = prev;
+      mNodes[node].nextPhysical = next;
+      mNodes[next].prevPhysical = node;
+
+      if(prev not_eq invalidNode)
+      {
+        mNodes[prev].nextPhysical = node;
+      }
+    }
+
+    void
+    linkAfter(uint32_t const node, uint32_t const prev)
+    {
+      uint32_t const next{ mNodes[prev].nextPhysical };
+
+      mNodes[node].prevPhysical = prev;
+      mNodes[node].nextPhysical = next;
+      mNodes[prev].nextPhysical = node;
+
+      if(next not_eq invalidNode)
+      {
+        mNodes[next].prevPhysical = node;
+      }
+    }
+
+    void
+    unlink(uint32_t const node)
+    {
+      uint32_t const prev{ mNodes[node].prevPhysical };
+      uint32_t const next{ mNodes[node].nextPhysical };
+
+      if(prev not_eq invalidNode)
+      {
+        mNodes[prev].nextPhysical = next;
+      }
+
+      if(next not_eq invalidNode)
+      {
+        mNodes[next].prevPhysical = prev;
+      }
+    }
+};
+
+} // namespace
+
+namespace so {
+namespace vk {
+
+struct
+MemoryBlock
+{
+  VkDeviceMemory memory;
+  void*          mapped;
+  Tlsf           tlsf;
+  size_type      pool;
+};
+
+} // namespace vk
+} // namespace so
+
+double
+so::vk::MemoryTypeStatistics::fragmentation() const
+{
+  VkDeviceSize const freeBytes{ blockBytes - usedBytes };
+
+  if(freeBytes is_eq 0)
+  {
+    return 0.0;
+  }
+
+  return 1.0 - static_cast<double>(largestFreeRange) /
+               static_cast<double>(freeBytes);
+}
+
+so::vk::SharedPtrMemoryAllocator const&
+so::vk::MemoryAllocator::getSharedPtrNullMemoryAllocator()
+{
+  static SharedPtrMemoryAllocator nullAllocator
+    { utils::mem::makePooledShared<MemoryAllocator>() };
+
+  return nullAllocator;
+}
+
+so::vk::MemoryAllocator::MemoryAllocator()
+  : mPools(),
+    mMemoryProperties(),
+    mDeviceAllocationCount(0),
+    mDevice(LogicalDevice::getSharedPtrNullDevice()),
+    mBlockSize(0),
+    mBufferImageGranularity(1),
+    mNonCoherentAtomSize(1),
+    mMaxDeviceAllocationCount(0)
+{}
+
+so::vk::MemoryAllocator::~MemoryAllocator() noexcept
+{
+  destroyMembers();
+}
+
+so::return_t
+so::vk::MemoryAllocator::initialize(SharedPtrLogicalDevice const& device,
+                                    VkDeviceSize           const  blockSize)
+{
+  destroyMembers();
+
+  mDevice    = device;
+  mBlockSize = blockSize;
+
+  vkGetPhysicalDeviceMemoryProperties(mDevice->getVkPhysicalDevice(),
+                                      &mMemoryProperties);
+
+  VkPhysicalDeviceLimits const& limits
+    { mDevice->getVkPhysicalDeviceProperties().limits };
+
+  mBufferImageGranularity   = std::max(limits.bufferImageGranularity,
+                                       VkDeviceSize{ 1 });
+  mNonCoherentAtomSize      = std::max(limits.nonCoherentAtomSize,
+                                       VkDeviceSize{ 1 });
+  mMaxDeviceAllocationCount = limits.maxMemoryAllocationCount;
+
+  return success;
+}
+
+so::return_t
+so::vk::MemoryAllocator::allocate(VkMemoryRequirements const& requirements,
+                                  AllocationInfo       const& allocationInfo,
+                                  Allocation&                 allocation)
+{
+  uint32_t const memoryType{ findMemoryType(requirements.memoryTypeBits,
+                                            allocationInfo.requiredFlags,
+                                            allocationInfo.preferredFlags) };
+
+  if(memoryType is_eq ~0u)
+  {
+    DEBUG_CALLBACK(error, "No memory type fits the allocation.");
+
+    return failure;
+  }
+
+  bool const isDedicated{ allocationInfo.isDedicated or
+                          requirements.size >= getBlockSize(memoryType) / 2 };
+
+  return_t const result
+    { isDedicated
+        ? allocateDedicated(requirements, memoryType, allocation)
+        : allocateFromPool(requirements,
+                           memoryType,
+                           allocationInfo.isLinear,
+                           allocation) };
+
+  if(result is_eq failure)
+  {
+    return failure;
+  }
+
+  allocation.memoryType    = memoryType;
+  allocation.propertyFlags =
+    mMemoryProperties.memoryTypes[memoryType].propertyFlags;
+
+  return success;
+}
+
+void
+so::vk::MemoryAllocator::free(Allocation& allocation)
+{
+  if(not allocation.isValid())
+  {
+    return;
+  }
+
+  if(allocation.block is_eq nullptr)
+  {
+    {
+      Pool& pool{ mPools[getPoolIndex(allocation.memoryType, true)] };
+
+      std::lock_guard<std::mutex> lock{ pool.mutex };
+
+      --pool.dedicatedCount;
+      pool.dedicatedBytes -= allocation.size;
+    }
+
+    freeDeviceMemory(allocation.memory);
+
+    allocation = Allocation{};
+
+    return;
+  }
+
+  Pool& pool{ mPools[allocation.block->pool] };
+
+  std::unique_ptr<MemoryBlock> emptyBlock;
+
+  {
+    std::lock_guard<std::mutex> lock{ pool.mutex };
+
+    allocation.block->tlsf.free(allocation.node);
+
+    // Keep one empty block around, so that allocating and freeing a
+    // single resource repeatedly does not allocate device memory each time.
+    if(allocation.block->tlsf.isEmpty())
+    {
+      auto const numEmpty
+        { std::count_if(pool.blocks.begin(),
+                        pool.blocks.end(),
+                        [](std::unique_ptr<MemoryBlock> const& block)
+                        { return block->tlsf.isEmpty(); }) };
+
+      if(numEmpty > 1)
+      {
+        auto const block
+          { std::find_if(pool.blocks.begin(),
+                         pool.blocks.end(),
+                         [&allocation](std::unique_ptr<MemoryBlock> const& b)
+                         { return b.get() is_eq allocation.block; }) };
+
+        emptyBlock = std::move(*block);
+
+        pool.blocks.erase(block);
+      }
+    }
+  }
+
+  if(emptyBlock)
+  {
+    freeDeviceMemory(emptyBlock->memory);
+  }
+
+  allocation = Allocation{};
+}
+
+so::return_t
+so::vk::MemoryAllocator::flush(Allocation   const& allocation,
+                               VkDeviceSize const  offset,
+                               VkDeviceSize const  size) const
+{
+  if(allocation.propertyFlags bitand VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+  {
+    return success;
+  }
+
+  VkMappedMemoryRange const range{ getMappedRange(allocation, offset, size) };
+
+  if(vkFlushMappedMemoryRanges(mDevice->getVkDevice(), 1, &range) not_eq
+     VK_SUCCESS)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to flush mapped memory.",
+                   vkFlushMappedMemoryRanges);
+
+    return failure;
+  }
+
+  return success;
+}
+
+so::return_t
+so::vk::MemoryAllocator::invalidate(Allocation   const& allocation,
+                                    VkDeviceSize const  offset,
+                                    VkDeviceSize const  size) const
+{
+  if(allocation.propertyFlags bitand VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+  {
+    return success;
+  }
+
+  VkMappedMemoryRange const range{ getMappedRange(allocation, offset, size) };
+
+  if(vkInvalidateMappedMemoryRanges(mDevice->getVkDevice(), 1, &range) not_eq
+     VK_SUCCESS)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to invalidate mapped memory.",
+                   vkInvalidateMappedMemoryRanges);
+
+    return failure;
+  }
+
+  return success;
+}
+
+so::vk::MemoryStatistics
+so::vk::MemoryAllocator::getStatistics() const
+{
+  MemoryStatistics statistics;
+
+  statistics.memoryTypes.resize(mMemoryProperties.memoryTypeCount);
+
+  for(size_type i{ 0 }; i < 2 * mMemoryProperties.memoryTypeCount; ++i)
+  {
+    Pool const& pool{ mPools[i] };
+
+    MemoryTypeStatistics& type{ statistics.memoryTypes[i / 2] };
+
+    std::lock_guard<std::mutex> lock{ pool.mutex };
+
+    for(auto const& block : pool.blocks)
+    {
+      ++type.blockCount;
+
+      type.allocationCount += block->tlsf.getAllocationCount();
+      type.blockBytes      += block->tlsf.getSize();
+      type.usedBytes       += block->tlsf.getUsedBytes();
+
+      block->tlsf.getFreeRanges(type.largestFreeRange, type.freeRangeCount);
+    }
+
+    type.dedicatedCount  += pool.dedicatedCount;
+    type.dedicatedBytes  += pool.dedicatedBytes;
+    type.allocationCount += pool.dedicatedCount;
+  }
+
+  MemoryTypeStatistics& total{ statistics.total };
+
+  for(MemoryTypeStatistics const& type : statistics.memoryTypes)
+  {
+    total.blockCount       += type.blockCount;
+    total.dedicatedCount   += type.dedicatedCount;
+    total.allocationCount  += type.allocationCount;
+    total.blockBytes       += type.blockBytes;
+    total.usedBytes        += type.usedBytes;
+    total.dedicatedBytes   += type.dedicatedBytes;
+    total.largestFreeRange  = std::max(total.largestFreeRange,
+                                       type.largestFreeRange);
+    total.freeRangeCount   += type.freeRangeCount;
+  }
+
+  statistics.deviceAllocationCount = mDeviceAllocationCount.load();
+
+  return statistics;
+}
+
+uint32_t
+so::vk::MemoryAllocator::findMemoryType
+  (uint32_t              const typeBits,
+   VkMemoryPropertyFlags const required,
+   VkMemoryPropertyFlags const preferred) const
+{
+  uint32_t fallback{ ~0u };
+
+  for(uint32_t i{ 0 }; i < mMemoryProperties.memoryTypeCount; ++i)
+  {
+    VkMemoryPropertyFlags const flags
+      { mMemoryProperties.memoryTypes[i].propertyFlags };
+
+    if(not (typeBits bitand (1u << i)) or
+       ((flags bitand required) not_eq required))
+    {
+      continue;
+    }
+
+    if((flags bitand preferred) is_eq preferred)
+    {
+      return i;
+    }
+
+    if(fallback is_eq ~0u)
+    {
+      fallback = i;
+    }
+  }
+
+  return fallback;
+}
+
+so::return_t
+so::vk::MemoryAllocator::allocateDeviceMemory(VkDeviceSize const size,
+                                              uint32_t     const memoryType,
+                                              VkDeviceMemory&    memory,
+                                              void*&             mapped)
+{
+  if(mDeviceAllocationCount.fetch_add(1) >= mMaxDeviceAllocationCount)
+  {
+    --mDeviceAllocationCount;
+
+    DEBUG_CALLBACK(error,
+                   "Reached maxMemoryAllocationCount of the device.");
+
+    return failure;
+  }
+
+  VkDevice device{ mDevice->getVkDevice() };
+
+  VkMemoryAllocateInfo allocInfo{};
+
+  allocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+  allocInfo.allocationSize  = size;
+  allocInfo.memoryTypeIndex = memoryType;
+
+  if(vkAllocateMemory(device, &allocInfo, nullptr, &memory) not_eq VK_SUCCESS)
+  {
+    --mDeviceAllocationCount;
+
+    DEBUG_CALLBACK(error,
+                   "Failed to allocate device memory.",
+                   vkAllocateMemory);
+
+    return failure;
+  }
+
+  mapped = nullptr;
+
+  VkMemoryPropertyFlags const flags
+    { mMemoryProperties.memoryTypes[memoryType].propertyFlags };
+
+  if((flags bitand VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) and
+     (vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &mapped) not_eq
+      VK_SUCCESS))
+  {
+    DEBUG_CALLBACK(error, "Failed to map device memory.", vkMapMemory);
+
+    freeDeviceMemory(memory);
+
+    return failure;
+  }
+
+  return success;
+}
+
+void
+so::vk::MemoryAllocator::freeDeviceMemory(VkDeviceMemory const memory)
+{
+  // Mapped memory is implicitly unmapped.
+  vkFreeMemory(mDevice->getVkDevice(), memory, nullptr);
+
+  --mDeviceAllocationCount;
+}
+
+so::return_t
+so::vk::MemoryAllocator::allocateFromPool
+  (VkMemoryRequirements const& requirements,
+   uint32_t             const  memoryType,
+   bool                 const  isLinear,
+   Allocation&                 allocation)
+{
+  size_type const poolIndex{ getPoolIndex(memoryType, isLinear) };
+
+  Pool& pool{ mPools[poolIndex] };
+
+  std::unique_lock<std::mutex> lock{ pool.mutex };
+
+  auto const place = [&requirements, &allocation](MemoryBlock& block)
+                     {
+                       VkDeviceSize offset{ 0 };
+
+                       uint32_t const node
+                         { block.tlsf.allocate(requirements.size,
+                                               requirements.alignment,
+                                               offset) };
+
+                       if(node is_eq invalidNode)
+                       {
+                         return false;
+                       }
+
+                       allocation.memory = block.memory;
+                       allocation.offset = offset;
+                       allocation.size   = requirements.size;
+                       allocation.block  = &block;
+                       allocation.node   = node;
+                       allocation.mapped =
+                         block.mapped is_eq nullptr
+                           ? nullptr
+                           : static_cast<char*>(block.mapped) + offset;
+
+                       return true;
+                     };
+
+  // Newer blocks are tried first, they are the least likely to be full.
+  for(auto block{ pool.blocks.rbegin() }; block not_eq pool.blocks.rend();
+      ++block)
+  {
+    if(place(**block))
+    {
+      return success;
+    }
+  }
+
+  VkDeviceSize const blockSize{ getBlockSize(memoryType) };
+
+  // Everything that may throw happens before the device memory exists, so
+  // it cannot leak.
+  auto block{ std::make_unique<MemoryBlock>
+                (MemoryBlock{ VK_NULL_HANDLE,
+                              nullptr,
+                              Tlsf(blockSize),
+                              poolIndex }) };
+
+  pool.blocks.reserve(pool.blocks.size() + 1);
+
+  if(allocateDeviceMemory(blockSize,
+                          memoryType,
+                          block->memory,
+                          block->mapped) is_eq failure)
+  {
+    return failure;
+  }
+
+  pool.blocks.push_back(std::move(block));
+
+  if(not place(*pool.blocks.back()))
+  {
+    DEBUG_CALLBACK(error, "An allocation does not fit into a new block.");
+
+    return failure;
+  }
+
+  return success;
+}
+
+so::return_t
+so::vk::MemoryAllocator::allocateDedicated
+  (VkMemoryRequirements const& requirements,
+   uint32_t             const  memoryType,
+   Allocation&                 allocation)
+{
+  VkDeviceMemory memory{ VK_NULL_HANDLE };
+  void*          mapped{ nullptr };
+
+  if(allocateDeviceMemory(requirements.size,
+                          memoryType,
+                          memory,
+                          mapped) is_eq failure)
+  {
+    return failure;
+  }
+
+  allocation.memory = memory;
+  allocation.offset = 0;
+  allocation.size   = requirements.size;
+  allocation.mapped = mapped;
+  allocation.block  = nullptr;
+  allocation.node   = invalidNode;
+
+  // Dedicated allocations are accounted to the linear pool of their type,
+  // since free() cannot tell the kind of resource apart.
+  Pool& pool{ mPools[getPoolIndex(memoryType, true)] };
+
+  std::lock_guard<std::mutex> lock{ pool.mutex };
+
+  ++pool.dedicatedCount;
+  pool.dedicatedBytes += requirements.size;
+
+  return success;
+}
+
+VkMappedMemoryRange
+so::vk::MemoryAllocator::getMappedRange(Allocation   const& allocation,
+                                        VkDeviceSize const  offset,
+                                        VkDeviceSize const  size) const
+{
+  VkDeviceSize const memorySize{ allocation.block is_eq nullptr
+                                   ? allocation.size
+                                   : allocation.block->tlsf.getSize() };
+
+  VkDeviceSize const begin{ allocation.offset + offset };
+  VkDeviceSize const end{ size is_eq VK_WHOLE_SIZE
+                            ? allocation.offset + allocation.size
+                            : begin + size };
+
+  // Ranges have to be multiples of nonCoherentAtomSize, unless they end at
+  // the end of the memory.
+  VkDeviceSize const alignedBegin{ begin / mNonCoherentAtomSize *
+                                   mNonCoherentAtomSize };
+  VkDeviceSize const alignedEnd
+    { std::min(alignUp(end, mNonCoherentAtomSize), memorySize) };
+
+  VkMappedMemoryRange range{};
+
+  range.sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+  range.memory = allocation.memory;
+  range.offset = alignedBegin;
+  range.size   = alignedEnd is_eq memorySize ? VK_WHOLE_SIZE
+                                             : alignedEnd - alignedBegin;
+
+  return range;
+}
+
+VkDeviceSize
+so::vk::MemoryAllocator::getBlockSize(uint32_t const memoryType) const
+{
+  uint32_t const heap
+    { mMemoryProperties.memoryTypes[memoryType].heapIndex };
+
+  // Small heaps, e.g. device local host visible memory, would otherwise be
+  // used up by a few mostly empty blocks.
+  return std::min(mBlockSize, mMemoryProperties.memoryHeaps[heap].size / 8);
+}
+
+so::size_type
+so::vk::MemoryAllocator::getPoolIndex(uint32_t const memoryType,
+                                      bool     const isLinear) const
+{
+  // Without a granularity to respect, all resources can share blocks.
+  bool const isSeparate{ mBufferImageGranularity > 1 and not isLinear };
+
+  return 2 * size_type{ memoryType } + (isSeparate ? 1 : 0);
+}
+
+void
+so::vk::MemoryAllocator::destroyMembers()
+{
+  if(mDevice->getVkDevice() not_eq VK_NULL_HANDLE)
+  {
+    for(Pool& pool : mPools)
+    {
+      std::lock_guard<std::mutex> lock{ pool.mutex };
+
+      for(auto const& block : pool.blocks)
+      {
+        freeDeviceMemory(block->memory);
+      }
+
+      pool.blocks.clear();
+    }
+  }
+
+  mDevice = LogicalDevice::getSharedPtrNullDevice();
+}
@@ -0,0 +1,294 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      soVkMemoryAllocator.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "soVkLogicalDevice.hpp"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace so {
+namespace vk {
+
+class
+MemoryAllocator;
+
+using SharedPtrMemoryAllocator = std::shared_ptr<MemoryAllocator>;
+
+struct
+MemoryBlock;
+
+/**
+ * @brief Requirements on the memory of an allocation.
+ *
+ * isLinear tells buffers and linear images apart from optimally tiled images,
+ * which must not share a bufferImageGranularity page. isDedicated requests a
+ * VkDeviceMemory of its own, e.g. for render targets that are recreated as a
+ * whole.
+ */
+struct
+AllocationInfo
+{
+  VkMemoryPropertyFlags requiredFlags{ 0 };
+  VkMemoryPropertyFlags preferredFlags{ 0 };
+  bool                  isLinear{ true };
+  bool                  isDedicated{ false };
+};
+
+/**
+ * @brief A range of device memory handed out by so::vk::MemoryAllocator.
+ *
+ * mapped points to offset if the memory is host visible, nullptr otherwise.
+ * block and node identify the range within the allocator; block is nullptr
+ * for dedicated allocations.
+ */
+struct
+Allocation
+{
+  VkDeviceMemory        memory{ VK_NULL_HANDLE };
+  VkDeviceSize          offset{ 0 };
+  VkDeviceSize          size{ 0 };
+  void*                 mapped{ nullptr };
+  uint32_t              memoryType{ ~0u };
+  VkMemoryPropertyFlags propertyFlags{ 0 };
+
+  MemoryBlock*          block{ nullptr };
+  uint32_t              node{ ~0u };
+
+  inline bool isValid() const { return memory not_eq VK_NULL_HANDLE; }
+};
+
+/**
+ * @brief Usage of one memory type. fragmentation is 0 if all free memory of
+ *        the blocks is one range and approaches 1 as it splits up.
+ */
+struct
+MemoryTypeStatistics
+{
+  uint32_t     blockCount{ 0 };
+  uint32_t     dedicatedCount{ 0 };
+  uint64_t     allocationCount{ 0 };
+  VkDeviceSize blockBytes{ 0 };
+  VkDeviceSize usedBytes{ 0 };
+  VkDeviceSize dedicatedBytes{ 0 };
+  VkDeviceSize largestFreeRange{ 0 };
+  uint64_t     freeRangeCount{ 0 };
+
+  double
+  fragmentation() const;
+};
+
+struct
+MemoryStatistics
+{
+  std::vector<MemoryTypeStatistics> memoryTypes;
+  MemoryTypeStatistics              total;
+
+  /**
+   * Number of live VkDeviceMemory objects, bounded by the device's
+   * maxMemoryAllocationCount.
+   */
+  uint32_t                          deviceAllocationCount{ 0 };
+};
+
+/**
+ * @brief Sub-allocates buffers and images from large VkDeviceMemory blocks.
+ *
+ * Every memory type has two pools of blocks, one for linear and one for
+ * optimal resources, unless bufferImageGranularity is 1. Ranges within a
+ * block are placed with a two-level segregated fit (TLSF) allocator, which
+ * allocates and frees in constant time with low fragmentation. Allocations
+ * of at least half a block get a dedicated VkDeviceMemory. Host visible
+ * blocks stay mapped for their whole lifetime.
+ *
+ * Every pool has its own lock, so threads allocating from different memory
+ * types or resource kinds do not contend. There is no per-thread cache in
+ * front of the locks. Allocations come from creating buffers, images and
+ * render graph transients rather than from per-frame work, and a TLSF
+ * allocation or free under the lock takes constant time. Per-frame data
+ * goes through the staging ring, dynamic uniform buffers and the frame
+ * allocator instead.
+ */
+class
+MemoryAllocator : public std::enable_shared_from_this<MemoryAllocator>
+{
+  public:
+    static SharedPtrMemoryAllocator const&
+    getSharedPtrNullMemoryAllocator();
+
+    MemoryAllocator();
+
+    MemoryAllocator(MemoryAllocator const& other) = delete;
+
+    MemoryAllocator(MemoryAllocator&& other) = delete;
+
+    ~MemoryAllocator() noexcept;
+
+    MemoryAllocator&
+    operator=(MemoryAllocator const& other) = delete;
+
+    MemoryAllocator&
+    operator=(MemoryAllocator&& other) = delete;
+
+    /**
+     * @param blockSize Size of the blocks allocations are placed in. Clamped
+     *                  to an eighth of the memory heap.
+     */
+    return_t
+    initialize(SharedPtrLogicalDevice const& device,
+               VkDeviceSize           const  blockSize = VkDeviceSize{ 64 }
+                                                         << 20);
+
+    return_t
+    allocate(VkMemoryRequirements const& requirements,
+             AllocationInfo       const& allocationInfo,
+             Allocation&                 allocation);
+
+    /**
+     * @brief Returns the memory of allocation and resets it. The memory must
+     *        no longer be in use by the device.
+     */
+    void
+    free(Allocation& allocation);
+
+    /**
+     * @brief Makes host writes to a non-coherent allocation visible to the
+     *        device. A no-op for coherent memory.
+     */
+    return_t
+    flush(Allocation   const& allocation,
+          VkDeviceSize const  offset = 0,
+          VkDeviceSize const  size = VK_WHOLE_SIZE) const;
+
+    /**
+     * @brief Makes device writes to a non-coherent allocation visible to the
+     *        host. A no-op for coherent memory.
+     */
+    return_t
+    invalidate(Allocation   const& allocation,
+               VkDeviceSize const  offset = 0,
+               VkDeviceSize const  size = VK_WHOLE_SIZE) const;
+
+    MemoryStatistics
+    getStatistics() const;
+
+    inline SharedPtrLogicalDevice const& getDevice() const { return mDevice; }
+
+  private:
+    struct
+    Pool
+    {
+      mutable std::mutex                        mutex;
+      std::vector<std::unique_ptr<MemoryBlock>> blocks;
+      uint32_t                                  dedicatedCount{ 0 };
+      VkDeviceSize                              dedicatedBytes{ 0 };
+    };
+
+    // Pool 2 * memoryType holds linear resources, 2 * memoryType + 1
+    // optimal ones.
+    std::array<Pool, 2 * VK_MAX_MEMORY_TYPES> mPools;
+
+    VkPhysicalDeviceMemoryProperties mMemoryProperties;
+
+    std::atomic<uint32_t>  mDeviceAllocationCount;
+
+    SharedPtrLogicalDevice mDevice;
+
+    VkDeviceSize           mBlockSize;
+    VkDeviceSize           mBufferImageGranularity;
+    VkDeviceSize           mNonCoherentAtomSize;
+    uint32_t               mMaxDeviceAllocationCount;
+
+    uint32_t
+    findMemoryType(uint32_t              const typeBits,
+                   VkMemoryPropertyFlags const required,
+                   VkMemoryPropertyFlags const preferred) const;
+
+    return_t
+    allocateDeviceMemory(VkDeviceSize const size,
+                         uint32_t     const memoryType,
+                         VkDeviceMemory&    memory,
+                         void*&             mapped);
+
+    void
+    freeDeviceMemory(VkDeviceMemory const memory);
+
+    return_t
+    allocateFromPool(VkMemoryRequirements const& requirements,
+                     uint32_t             const  memoryType,
+                     bool                 const  isLinear,
+                     Allocation&                 allocation);
+
+    return_t
+    allocateDedicated(VkMemoryRequirements const& requirements,
+                      uint32_t             const  memoryType,
+                      Allocation&                 allocation);
+
+    VkMappedMemoryRange
+    getMappedRange(Allocation   const& allocation,
+                   VkDeviceSize const  offset,
+                   VkDeviceSize const  size) const;
+
+    VkDeviceSize
+    getBlockSize(uint32_t const memoryType) const;
+
+    size_type
+    getPoolIndex(uint32_t const memoryType, bool const isLinear) const;
+
+    void
+    destroyMembers();
+};
+
+} // namespace vk
+} // namespace so
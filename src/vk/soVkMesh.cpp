@@ -0,0 +1,447 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+
+#include "soVkMesh.hpp"
+
+#include "cxx/soDebugCallback.hpp"
+#include "cxx/soProfiler.hpp"
+
+#include <assimp/Importer.hpp>
+#include <assimp/config.h>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+void
+writeFloats(unsigned char*       dst,
+            float const*         src,
+            so::size_type const  count)
+{
+  std::memcpy(dst, src, count * sizeof(float));
+}
+
+uint8_t
+toUnorm8(float const value)
+{
+  float const clamped{ std::min(std::max(value, 0.0f), 1.0f) };
+
+  return static_cast<uint8_t>(clamped * 255.0f + 0.5f);
+}
+
+} // namespace
+
+so::vk::Mesh::Mesh()
+  : mVertexBuffer(),
+    mIndexBuffer(),
+    mVertexFormat(),
+    mIndexType(VK_INDEX_TYPE_UINT16),
+    mSubMeshes(),
+    mBounds(),
+    mUploadTicket(0)
+{}
+
+so::vk::Mesh&
+so::vk::Mesh::operator=(Mesh&& other) noexcept
+{
+  if(this is_eq &other)
+  {
+    return *this;
+  }
+
+  mVertexBuffer = std::move(other.mVertexBuffer);
+  mIndexBuffer  = std::move(other.mIndexBuffer);
+  mVertexFormat = other.mVertexFormat;
+  mIndexType    = other.mIndexType;
+  mSubMeshes    = std::move(other.mSubMeshes);
+  mBounds       = other.mBounds;
+  mUploadTicket = other.mUploadTicket;
+
+  other.mVertexFormat = VertexFormat();
+  other.mSubMeshes.clear();
+  other.mUploadTicket = 0;
+
+  return *this;
+}
+
+so::return_t
+so::vk::Mesh::initialize(SharedPtrMemoryAllocator const& allocator,
+                         Uploader&                       uploader,
+                         std::string              const& filename)
+{
+  SO_PROFILE_ZONE("Mesh::initialize");
+
+  Assimp::Importer importer;
+
+  // Points and lines cannot be drawn with a triangle list pipeline.
+  importer.SetPropertyInteger(AI_CONFIG_PP_SBP_REMOVE,
+                              aiPrimitiveType_POINT bitor
+                              aiPrimitiveType_LINE);
+
+  aiScene const* scene
+    { importer.ReadFile(filename.c_str(),
+                        aiProcess_Triangulate            bitor
+                        aiProcess_SortByPType            bitor
+                        aiProcess_FindDegenerates        bitor
+                        aiProcess_PreTransformVertices   bitor
+                        aiProcess_GenSmoothNormals       bitor
+                        aiProcess_CalcTangentSpace       bitor
+                        aiProcess_JoinIdenticalVertices  bitor
+                        aiProcess_ImproveCacheLocality) };
+
+  if(scene is_eq nullptr
+     or (scene->mFlags bitand AI_SCENE_FLAGS_INCOMPLETE)
+     or scene->mNumMeshes is_eq 0)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to import " + filename + ": " +
+                   importer.GetErrorString(),
+                   Assimp::Importer::ReadFile);
+
+    return failure;
+  }
+
+  // The format is the union of the attributes of all meshes, the ones a mesh
+  // lacks are filled with defaults.
+  VertexFormat format{ VertexAttribute::position, VertexAttribute::normal };
+
+  size_type numVertices{ 0 };
+  size_type numIndices{ 0 };
+  bool      fitsUint16{ true };
+
+  std::vector<aiMesh const*> meshes;
+
+  for(uint32_t i{ 0 }; i < scene->mNumMeshes; ++i)
+  {
+    aiMesh const* mesh{ scene->mMeshes[i] };
+
+    if(not (mesh->mPrimitiveTypes bitand aiPrimitiveType_TRIANGLE)
+       or mesh->mNumVertices is_eq 0)
+    {
+      continue;
+    }
+
+    if(mesh->HasTextureCoords(0))
+    {
+      format.add(VertexAttribute::texCoord);
+    }
+
+    if(mesh->HasTangentsAndBitangents())
+    {
+      format.add(VertexAttribute::tangent);
+    }
+
+    if(mesh->HasVertexColors(0))
+    {
+      format.add(VertexAttribute::color);
+    }
+
+    numVertices += mesh->mNumVertices;
+    numIndices  += size_type{ mesh->mNumFaces } * 3;
+    fitsUint16   = fitsUint16 and
+                   mesh->mNumVertices <=
+                     size_type{ std::numeric_limits<uint16_t>::max() } + 1;
+
+    meshes.push_back(mesh);
+  }
+
+  if(meshes.empty()
+     or numVertices > std::numeric_limits<int32_t>::max()
+     or numIndices > std::numeric_limits<uint32_t>::max())
+  {
+    DEBUG_CALLBACK(error, filename + " has no triangles or too many.");
+
+    return failure;
+  }
+
+  uint32_t const  stride{ format.getStride() };
+  size_type const indexSize{ fitsUint16 ? sizeof(uint16_t)
+                                        : sizeof(uint32_t) };
+
+  std::vector<unsigned char> vertices(numVertices * stride);
+  std::vector<unsigned char> indices(numIndices * indexSize);
+
+  std::vector<SubMesh> subMeshes;
+
+  subMeshes.reserve(meshes.size());
+
+  MeshBounds bounds;
+
+  bounds.min.fill(std::numeric_limits<float>::max());
+  bounds.max.fill(std::numeric_limits<float>::lowest());
+
+  uint32_t const positionOffset{ format.getOffset(VertexAttribute::position) };
+  uint32_t const normalOffset{ format.getOffset(VertexAttribute::normal) };
+  uint32_t const texCoordOffset{ format.getOffset(VertexAttribute::texCoord) };
+  uint32_t const tangentOffset{ format.getOffset(VertexAttribute::tangent) };
+  uint32_t const colorOffset{ format.getOffset(VertexAttribute::color) };
+
+  size_type vertexOffset{ 0 };
+  size_type indexOffset{ 0 };
+
+  for(aiMesh const* mesh : meshes)
+  {
+    SubMesh subMesh;
+
+    subMesh.firstIndex    = static_cast<uint32_t>(indexOffset);
+    subMesh.vertexOffset  = static_cast<int32_t>(vertexOffset);
+    subMesh.vertexCount   = mesh->mNumVertices;
+    subMesh.materialIndex = mesh->mMaterialIndex;
+
+    subMesh.bounds.min.fill(std::numeric_limits<float>::max());
+    subMesh.bounds.max.fill(std::numeric_limits<float>::lowest());
+
+    for(uint32_t v{ 0 }; v < mesh->mNumVertices; ++v)
+    {
+      unsigned char* vertex{ vertices.data() + (vertexOffset + v) * stride };
+
+      aiVector3D const& position{ mesh->mVertices[v] };
+
+      float const xyz[]{ position.x, position.y, position.z };
+
+      writeFloats(vertex + positionOffset, xyz, 3);
+
+      for(size_type axis{ 0 }; axis < 3; ++axis)
+      {
+        bounds.min[axis] = std::min(bounds.min[axis], xyz[axis]);
+        bounds.max[axis] = std::max(bounds.max[axis], xyz[axis]);
+
+        subMesh.bounds.min[axis] = std::min(subMesh.bounds.min[axis],
+                                            xyz[axis]);
+        subMesh.bounds.max[axis] = std::max(subMesh.bounds.max[axis],
+                                            xyz[axis]);
+      }
+
+      // GenSmoothNormals only skips meshes that already have normals.
+      aiVector3D const& normal{ mesh->mNormals[v] };
+
+      float const nxyz[]{ normal.x, normal.y, normal.z };
+
+      writeFloats(vertex + normalOffset, nxyz, 3);
+
+      if(format.has(VertexAttribute::texCoord))
+      {
+        float uv[]{ 0.0f, 0.0f };
+
+        if(mesh->HasTextureCoords(0))
+        {
+          uv[0] = mesh->mTextureCoords[0][v].x;
+          uv[1] = mesh->mTextureCoords[0][v].y;
+        }
+
+        writeFloats(vertex + texCoordOffset, uv, 2);
+      }
+
+      if(format.has(VertexAttribute::tangent))
+      {
+        float tangent[]{ 1.0f, 0.0f, 0.0f, 1.0f };
+
+        if(mesh->HasTangentsAndBitangents())
+        {
+          aiVector3D const& t{ mesh->mTangents[v] };
+          aiVector3D const& b{ mesh->mBitangents[v] };
+
+          // The sign of dot(cross(n, t), b) tells mirrored UVs apart.
+          float const handedness
+            { (normal.y * t.z - normal.z * t.y) * b.x +
+              (normal.z * t.x - normal.x * t.z) * b.y +
+              (normal.x * t.y - normal.y * t.x) * b.z };
+
+          tangent[0] = t.x;
+          tangent[1] = t.y;
+          tangent[2] = t.z;
+          tangent[3] = handedness < 0.0f ? -1.0f : 1.0f;
+        }
+
+        writeFloats(vertex + tangentOffset, tangent, 4);
+      }
+
+      if(format.has(VertexAttribute::color))
+      {
+        uint8_t rgba[]{ 255, 255, 255, 255 };
+
+        if(mesh->HasVertexColors(0))
+        {
+          aiColor4D const& color{ mesh->mColors[0][v] };
+
+          rgba[0] = toUnorm8(color.r);
+          rgba[1] = toUnorm8(color.g);
+          rgba[2] = toUnorm8(color.b);
+          rgba[3] = toUnorm8(color.a);
+        }
+
+        std::memcpy(vertex + colorOffset, rgba, sizeof(rgba));
+      }
+    }
+
+    for(uint32_t f{ 0 }; f < mesh->mNumFaces; ++f)
+    {
+      aiFace const& face{ mesh->mFaces[f] };
+
+      // SortByPType leaves only triangles in meshes flagged as such.
+      if(face.mNumIndices not_eq 3)
+      {
+        continue;
+      }
+
+      for(uint32_t i{ 0 }; i < 3; ++i)
+      {
+        unsigned char* index{ indices.data() + indexOffset * indexSize };
+
+        if(fitsUint16)
+        {
+          auto const value{ static_cast<uint16_t>(face.mIndices[i]) };
+
+          std::memcpy(index, &value, sizeof(value));
+        }
+        else
+        {
+          uint32_t const value{ face.mIndices[i] };
+
+          std::memcpy(index, &value, sizeof(value));
+        }
+
+        ++indexOffset;
+      }
+    }
+
+    subMesh.indexCount = static_cast<uint32_t>(indexOffset) -
+                         subMesh.firstIndex;
+
+    vertexOffset += mesh->mNumVertices;
+
+    subMeshes.push_back(subMesh);
+  }
+
+  indices.resize(indexOffset * indexSize);
+
+  AllocationInfo allocationInfo{};
+
+  allocationInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+  Buffer vertexBuffer;
+  Buffer indexBuffer;
+
+  return_t result{ vertexBuffer.initialize(allocator,
+                                           vertices.size(),
+                                           VK_BUFFER_USAGE_VERTEX_BUFFER_BIT
+                                           bitor
+                                           VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                           allocationInfo) };
+
+  if(result is_eq success)
+  {
+    result = indexBuffer.initialize(allocator,
+                                    indices.size(),
+                                    VK_BUFFER_USAGE_INDEX_BUFFER_BIT bitor
+                                    VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                    allocationInfo);
+  }
+
+  if(result is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to create the buffers of " + filename + ".",
+                   Buffer::initialize);
+
+    return failure;
+  }
+
+  uint64_t ticket{ 0 };
+
+  result = uploader.uploadBufferInPieces(vertexBuffer,
+                                        0,
+                                        vertices.data(),
+                                        vertices.size(),
+                                        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                                        VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+                                        ticket);
+
+  if(result is_eq success)
+  {
+    result = uploader.uploadBufferInPieces(indexBuffer,
+                                          0,
+                                          indices.data(),
+                                          indices.size(),
+                                          VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                                          VK_ACCESS_INDEX_READ_BIT,
+                                          ticket);
+  }
+
+  if(result is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to upload " + filename + ".",
+                   Uploader::uploadBufferInPieces);
+
+    return failure;
+  }
+
+  mVertexBuffer = std::move(vertexBuffer);
+  mIndexBuffer  = std::move(indexBuffer);
+  mVertexFormat = format;
+  mIndexType    = fitsUint16 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+  mSubMeshes    = std::move(subMeshes);
+  mBounds       = bounds;
+  mUploadTicket = ticket;
+
+  return success;
+}
+
+void
+so::vk::Mesh::bind(VkCommandBuffer const commandBuffer) const
+{
+  VkBuffer const     vertexBuffer{ mVertexBuffer.getVkBuffer() };
+  VkDeviceSize const offset{ 0 };
+
+  vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, &offset);
+
+  vkCmdBindIndexBuffer(commandBuffer,
+                       mIndexBuffer.getVkBuffer(),
+                       0,
+                       mIndexType);
+}
+
+std::vector<so::vk::DrawIndexedCommand>
+so::vk::Mesh::getDrawCommands() const
+{
+  std::vector<DrawIndexedCommand> drawCommands;
+
+  drawCommands.reserve(mSubMeshes.size());
+
+  for(auto const& subMesh : mSubMeshes)
+  {
+    drawCommands.push_back({ subMesh.indexCount,
+                             1,
+                             subMesh.firstIndex,
+                             subMesh.vertexOffset,
+                             0 });
+  }
+
+  return drawCommands;
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      soVkMesh.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "soVkBuffer.hpp"
+#include "soVkUploader.hpp"
+#include "soVkVertexFormat.hpp"
+
+#include "cxx/soDefinitions.hpp"
+
+#include <array>
+#include <string>
+#include <vector>
+
+namespace so {
+namespace vk {
+
+/**
+ * @brief Parameters of a single indexed draw, laid out like
+ *        VkDrawIndexedIndirectCommand.
+ */
+struct
+DrawIndexedCommand
+{
+  uint32_t indexCount;
+  uint32_t instanceCount;
+  uint32_t firstIndex;
+  int32_t  vertexOffset;
+  uint32_t firstInstance;
+}; // struct DrawIndexedCommand
+
+/**
+ * @brief Axis aligned bounding box of the positions of a mesh.
+ */
+struct
+MeshBounds
+{
+  std::array<float, 3> min{ { 0.0f, 0.0f, 0.0f } };
+  std::array<float, 3> max{ { 0.0f, 0.0f, 0.0f } };
+}; // struct MeshBounds
+
+/**
+ * @brief A range of the index buffer drawn with one material. Indices are
+ *        relative to vertexOffset.
+ */
+struct
+SubMesh
+{
+  uint32_t   firstIndex{ 0 };
+  uint32_t   indexCount{ 0 };
+  int32_t    vertexOffset{ 0 };
+  uint32_t   vertexCount{ 0 };
+  uint32_t   materialIndex{ 0 };
+  MeshBounds bounds{};
+}; // struct SubMesh
+
+/**
+ * @brief Triangle meshes of a model file, imported with assimp into one
+ *        device local, interleaved vertex buffer and one index buffer.
+ *
+ * Node transforms are baked into the vertices. The vertex format holds
+ * positions and normals, plus texture coordinates, tangents and colors if any
+ * mesh of the file has them. Indices are 16 bit if no sub-mesh has more than
+ * 65536 vertices.
+ */
+class
+Mesh
+{
+  public:
+    Mesh();
+
+    Mesh(Mesh const& other) = delete;
+
+    Mesh(Mesh&& other) = delete;
+
+    ~Mesh() noexcept = default;
+
+    Mesh&
+    operator=(Mesh const& other) = delete;
+
+    Mesh&
+    operator=(Mesh&& other) noexcept;
+
+    /**
+     * @brief Imports filename and uploads it through uploader. The buffers
+     *        may be drawn once the upload ticket is complete.
+     */
+    return_t
+    initialize(SharedPtrMemoryAllocator const& allocator,
+               Uploader&                       uploader,
+               std::string              const& filename);
+
+    /**
+     * @brief Binds the vertex buffer to binding 0 and the index buffer.
+     */
+    void
+    bind(VkCommandBuffer const commandBuffer) const;
+
+    /**
+     * @brief One draw per sub-mesh.
+     */
+    std::vector<DrawIndexedCommand>
+    getDrawCommands() const;
+
+    inline bool isValid() const
+    { return mVertexBuffer.getVkBuffer() not_eq VK_NULL_HANDLE; }
+
+    inline VertexFormat const& getVertexFormat() const { return mVertexFormat; }
+
+    inline VkIndexType getVkIndexType() const { return mIndexType; }
+
+    inline Buffer const& getVertexBuffer() const { return mVertexBuffer; }
+
+    inline Buffer const& getIndexBuffer() const { return mIndexBuffer; }
+
+    inline std::vector<SubMesh> const& getSubMeshes() const
+    { return mSubMeshes; }
+
+    inline MeshBounds const& getBounds() const { return mBounds; }
+
+    inline uint64_t getUploadTicket() const { return mUploadTicket; }
+
+  private:
+    Buffer               mVertexBuffer;
+    Buffer               mIndexBuffer;
+
+    VertexFormat         mVertexFormat;
+    VkIndexType          mIndexType;
+
+    std::vector<SubMesh> mSubMeshes;
+    MeshBounds           mBounds;
+
+    uint64_t             mUploadTicket;
+};
+
+} // namespace vk
+} // namespace so
@@ -0,0 +1,394 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "soVkParallelCommandRecorder.hpp"
+
+#include "cxx/soDebugCallback.hpp"
+#include "cxx/soDefinitions.hpp"
+#include "cxx/soPoolAllocator.hpp"
+#include "cxx/soProfiler.hpp"
+#include "cxx/soScratchAllocator.hpp"
+
+#include <memory_resource>
+
+so::vk::ParallelCommandRecorder::ParallelCommandRecorder()
+  : mSlices(),
+    mMinDrawsPerSlice(64),
+    mJobSystem(nullptr),
+    mDevice(LogicalDevice::getSharedPtrNullDevice())
+{}
+
+so::vk::ParallelCommandRecorder::~ParallelCommandRecorder() noexcept
+{
+  destroyMembers();
+}
+
+so::return_t
+so::vk::ParallelCommandRecorder::initialize
+  (SharedPtrLogicalDevice const& device,
+   Surface                const& surface,
+   size_type              const  numFramesInFlight,
+   JobSystem&                    jobSystem)
+{
+  destroyMembers();
+
+  mDevice    = device;
+  mJobSystem = &jobSystem;
+
+  size_type const numSlices{ std::max(jobSystem.getNumThreads(),
+                                      size_type{ 1 }) };
+
+  VkDevice vkDevice{ mDevice->getVkDevice() };
+
+  for(size_type i{ 0 }; i < numSlices; ++i)
+  {
+    auto slice{ std::make_unique<Slice>() };
+
+    slice->commandPools.resize(numFramesInFlight);
+    slice->commandBuffers.resize(numFramesInFlight, VK_NULL_HANDLE);
+
+    for(size_type frame{ 0 }; frame < numFramesInFlight; ++frame)
+    {
+      auto& commandPool{ slice->commandPools[frame] };
+
+      commandPool = utils::mem::makePooledShared<CommandPool>();
+
+      return_t result{ commandPool->initialize
+                         (mDevice,
+                          surface,
+                          VK_COMMAND_POOL_CREATE_TRANSIENT_BIT) };
+
+      if(result is_eq failure)
+      {
+        DEBUG_CALLBACK(error,
+                       "Failed to create a command pool for a slice.",
+                       CommandPool::initialize);
+
+        return failure;
+      }
+
+      VkCommandBufferAllocateInfo allocInfo{};
+
+      allocInfo.sType              =
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+      allocInfo.commandPool        = commandPool->getVkCommandPool();
+      allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+      allocInfo.commandBufferCount = 1;
+
+      VkResult allocResult
+        { vkAllocateCommandBuffers(vkDevice,
+                                   &allocInfo,
+                                   &slice->commandBuffers[frame]) };
+
+      if(allocResult not_eq VK_SUCCESS)
+      {
+        DEBUG_CALLBACK(error,
+                       "Failed to allocate a secondary command buffer.",
+                       vkAllocateCommandBuffers);
+
+        return failure;
+      }
+    }
+
+    mSlices.push_back(std::move(slice));
+  }
+
+  return success;
+}
+
+so::return_t
+so::vk::ParallelCommandRecorder::record
+  (VkCommandBuffer          const  primaryCommandBuffer,
+   index_t                  const  frame,
+   VkFramebuffer            const  framebuffer,
+   RenderPass               const& renderPass,
+   SwapChain                const& swapChain,
+   Pipeline                 const& pipeline,
+   std::vector<DrawCommand> const& drawCommands)
+{
+  Task task;
+
+  task.drawCommands    = drawCommands.data();
+  task.numDrawCommands = drawCommands.size();
+
+  return recordTask(primaryCommandBuffer,
+                    frame,
+                    framebuffer,
+                    renderPass,
+                    swapChain,
+                    pipeline,
+                    task);
+}
+
+so::return_t
+so::vk::ParallelCommandRecorder::recordIndexed
+  (VkCommandBuffer                 const  primaryCommandBuffer,
+   index_t                         const  frame,
+   VkFramebuffer                   const  framebuffer,
+   RenderPass                      const& renderPass,
+   SwapChain                       const& swapChain,
+   Pipeline                        const& pipeline,
+   Mesh                            const& mesh,
+   std::array<float, 16>           const& transform,
+   std::vector<DrawIndexedCommand> const& drawCommands)
+{
+  Task task;
+
+  task.mesh                = &mesh;
+  task.drawIndexedCommands = drawCommands.data();
+  task.numDrawCommands     = drawCommands.size();
+  task.pipelineLayout      = pipeline.getVkPipelineLayout();
+  task.transform           = transform;
+
+  return recordTask(primaryCommandBuffer,
+                    frame,
+                    framebuffer,
+                    renderPass,
+                    swapChain,
+                    pipeline,
+                    task);
+}
+
+so::return_t
+so::vk::ParallelCommandRecorder::recordTask
+  (VkCommandBuffer const  primaryCommandBuffer,
+   index_t         const  frame,
+   VkFramebuffer   const  framebuffer,
+   RenderPass      const& renderPass,
+   SwapChain       const& swapChain,
+   Pipeline        const& pipeline,
+   Task                   task)
+{
+  SO_PROFILE_ZONE("ParallelCommandRecorder::record");
+
+  VkRenderPassBeginInfo renderPassInfo{};
+
+  renderPassInfo.sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+  renderPassInfo.renderPass        = renderPass.getVkRenderPass();
+  renderPassInfo.framebuffer       = framebuffer;
+  renderPassInfo.renderArea.offset = { 0, 0 };
+  renderPassInfo.renderArea.extent = swapChain.getVkExtent();
+
+  VkClearValue clearColor{ 0.0f, 0.0f, 0.0f, 1.0f };
+
+  renderPassInfo.clearValueCount   = 1;
+  renderPassInfo.pClearValues      = &clearColor;
+
+  vkCmdBeginRenderPass(primaryCommandBuffer,
+                       &renderPassInfo,
+                       VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+  size_type const numDrawCommands{ task.numDrawCommands };
+
+  size_type const numActiveSlices
+    { std::min(mSlices.size(),
+               (numDrawCommands + mMinDrawsPerSlice - 1) /
+                 mMinDrawsPerSlice) };
+
+  if(numActiveSlices > 0)
+  {
+    task.frame                       = frame;
+    task.inheritanceInfo             = {};
+    task.inheritanceInfo.sType       =
+      VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    task.inheritanceInfo.renderPass  = renderPass.getVkRenderPass();
+    task.inheritanceInfo.subpass     = 0;
+    task.inheritanceInfo.framebuffer = framebuffer;
+    task.pipeline                    = pipeline.getVkPipeline();
+    task.extent                      = swapChain.getVkExtent();
+    task.numActiveSlices             = numActiveSlices;
+
+    JobCounter counter;
+
+    for(size_type i{ 0 }; i < numActiveSlices; ++i)
+    {
+      mJobSystem->run([this, i, &task]
+                      { mSlices[i]->result = recordSlice(i, task); },
+                      &counter);
+    }
+
+    mJobSystem->wait(counter);
+
+    utils::mem::ScratchScope scratch;
+
+    std::pmr::vector<VkCommandBuffer> secondaryCommandBuffers
+      { scratch.getResource() };
+
+    secondaryCommandBuffers.reserve(numActiveSlices);
+
+    for(size_type i{ 0 }; i < numActiveSlices; ++i)
+    {
+      Slice const& slice{ *mSlices[i] };
+
+      if(slice.result is_eq failure)
+      {
+        DEBUG_CALLBACK(error,
+                       "A job failed to record its slice of draw commands.",
+                       ParallelCommandRecorder::recordSlice);
+
+        vkCmdEndRenderPass(primaryCommandBuffer);
+
+        return failure;
+      }
+
+      secondaryCommandBuffers.push_back
+        (slice.commandBuffers[static_cast<size_type>(frame)]);
+    }
+
+    vkCmdExecuteCommands
+      (primaryCommandBuffer,
+       static_cast<uint32_t>(secondaryCommandBuffers.size()),
+       secondaryCommandBuffers.data());
+  }
+
+  vkCmdEndRenderPass(primaryCommandBuffer);
+
+  return success;
+}
+
+so::return_t
+so::vk::ParallelCommandRecorder::recordSlice(size_type const  sliceIdx,
+                                             Task      const& task)
+{
+  SO_PROFILE_ZONE("ParallelCommandRecorder::recordSlice");
+
+  Slice&          slice{ *mSlices[sliceIdx] };
+  auto const      frame{ static_cast<size_type>(task.frame) };
+  VkCommandBuffer commandBuffer{ slice.commandBuffers[frame] };
+
+  if(slice.commandPools[frame]->reset() is_eq failure)
+  {
+    return failure;
+  }
+
+  VkCommandBufferBeginInfo beginInfo{};
+
+  beginInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT bitor
+                               VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+  beginInfo.pInheritanceInfo = &task.inheritanceInfo;
+
+  if(vkBeginCommandBuffer(commandBuffer, &beginInfo) not_eq VK_SUCCESS)
+  {
+    return failure;
+  }
+
+  // Contiguous slices keep the overall draw order identical to the list.
+  size_type const first{ task.numDrawCommands * sliceIdx /
+                         task.numActiveSlices };
+  size_type const last{ task.numDrawCommands * (sliceIdx + 1) /
+                        task.numActiveSlices };
+
+  vkCmdBindPipeline(commandBuffer,
+                    VK_PIPELINE_BIND_POINT_GRAPHICS,
+                    task.pipeline);
+
+  // Secondary command buffers don't inherit dynamic state.
+  VkViewport viewport{};
+
+  viewport.width    = static_cast<float>(task.extent.width);
+  viewport.height   = static_cast<float>(task.extent.height);
+  viewport.maxDepth = 1.0f;
+
+  VkRect2D scissor{};
+
+  scissor.extent = task.extent;
+
+  vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+  vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+  if(task.mesh not_eq nullptr)
+  {
+    task.mesh->bind(commandBuffer);
+
+    vkCmdPushConstants(commandBuffer,
+                       task.pipelineLayout,
+                       VK_SHADER_STAGE_VERTEX_BIT,
+                       0,
+                       sizeof(task.transform),
+                       task.transform.data());
+
+    for(size_type i{ first }; i < last; ++i)
+    {
+      DrawIndexedCommand const& draw{ task.drawIndexedCommands[i] };
+
+      vkCmdDrawIndexed(commandBuffer,
+                       draw.indexCount,
+                       draw.instanceCount,
+                       draw.firstIndex,
+                       draw.vertexOffset,
+                       draw.firstInstance);
+    }
+  }
+  else
+  {
+    for(size_type i{ first }; i < last; ++i)
+    {
+      DrawCommand const& draw{ task.drawCommands[i] };
+
+      vkCmdDraw(commandBuffer,
+                draw.vertexCount,
+                draw.instanceCount,
+                draw.firstVertex,
+                draw.firstInstance);
+    }
+  }
+
+  if(vkEndCommandBuffer(commandBuffer) not_eq VK_SUCCESS)
+  {
+    return failure;
+  }
+
+  return success;
+}
+
+void
+so::vk::ParallelCommandRecorder::destroyMembers()
+{
+  VkDevice device{ mDevice->getVkDevice() };
+
+  if(device not_eq VK_NULL_HANDLE)
+  {
+    for(auto& slice : mSlices)
+    {
+      size_type const numBuffers{ std::min(slice->commandPools.size(),
+                                           slice->commandBuffers.size()) };
+
+      for(size_type i{ 0 }; i < numBuffers; ++i)
+      {
+        if(slice->commandPools[i] and
+           (slice->commandBuffers[i] not_eq VK_NULL_HANDLE))
+        {
+          vkFreeCommandBuffers(device,
+                               slice->commandPools[i]->getVkCommandPool(),
+                               1,
+                               &slice->commandBuffers[i]);
+        }
+      }
+    }
+  }
+
+  mSlices.clear();
+
+  mJobSystem = nullptr;
+}
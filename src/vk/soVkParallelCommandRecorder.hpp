@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      soVkParallelCommandRecorder.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "soVkCommandPool.hpp"
+#include "soVkMesh.hpp"
+#include "soVkPipeline.hpp"
+
+#include "cxx/soJobSystem.hpp"
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace so {
+namespace vk {
+
+/**
+ * @brief Parameters of a single non-indexed draw, as passed to vkCmdDraw.
+ */
+struct
+DrawCommand
+{
+  uint32_t vertexCount;
+  uint32_t instanceCount;
+  uint32_t firstVertex;
+  uint32_t firstInstance;
+}; // struct DrawCommand
+
+/**
+ * @brief Records a draw list into secondary command buffers as jobs of a
+ *        JobSystem.
+ *
+ * The draw list is split into contiguous slices, up to one per thread of the
+ * job system, each recorded by a single job. Every slice owns a transient
+ * command pool and a secondary command buffer per frame in flight, so
+ * recording needs no synchronization between jobs. The primary command
+ * buffer executes the secondary ones in slice order. The result is therefore
+ * identical to recording the draw list on one thread.
+ */
+class
+ParallelCommandRecorder
+{
+  public:
+    ParallelCommandRecorder();
+
+    ParallelCommandRecorder(ParallelCommandRecorder const& other) = delete;
+
+    ParallelCommandRecorder(ParallelCommandRecorder&& other) = delete;
+
+    ~ParallelCommandRecorder() noexcept;
+
+    ParallelCommandRecorder&
+    operator=(ParallelCommandRecorder const& other) = delete;
+
+    ParallelCommandRecorder&
+    operator=(ParallelCommandRecorder&& other) = delete;
+
+    /**
+     * @param jobSystem Runs the slices and has to outlive the recorder.
+     */
+    return_t
+    initialize(SharedPtrLogicalDevice const& device,
+               Surface                const& surface,
+               size_type              const  numFramesInFlight,
+               JobSystem&                    jobSystem);
+
+    /**
+     * @brief Records a render pass into a primary command buffer, with the
+     *        draws recorded in parallel into secondary command buffers.
+     *
+     * The primary command buffer has to be in the recording state. The
+     * previous submission of the frame has to be finished.
+     */
+    return_t
+    record(VkCommandBuffer          const  primaryCommandBuffer,
+           index_t                  const  frame,
+           VkFramebuffer            const  framebuffer,
+           RenderPass               const& renderPass,
+           SwapChain                const& swapChain,
+           Pipeline                 const& pipeline,
+           std::vector<DrawCommand> const& drawCommands);
+
+    /**
+     * @brief Records indexed draws of mesh, which has to match the vertex
+     *        format of pipeline. transform is pushed as the column major
+     *        matrix of the mesh shaders.
+     */
+    return_t
+    recordIndexed
+      (VkCommandBuffer                 const  primaryCommandBuffer,
+       index_t                         const  frame,
+       VkFramebuffer                   const  framebuffer,
+       RenderPass                      const& renderPass,
+       SwapChain                       const& swapChain,
+       Pipeline                        const& pipeline,
+       Mesh                            const& mesh,
+       std::array<float, 16>           const& transform,
+       std::vector<DrawIndexedCommand> const& drawCommands);
+
+    inline size_type getNumSlices() const { return mSlices.size(); }
+
+    /**
+     * @brief Minimum number of draws per slice. Small draw lists are split
+     *        into fewer slices, since a job costs more than recording a
+     *        handful of draws.
+     */
+    inline void setMinDrawsPerSlice(size_type const minDrawsPerSlice)
+    { mMinDrawsPerSlice = std::max(minDrawsPerSlice, size_type{ 1 }); }
+
+  private:
+    struct
+    Slice
+    {
+      std::vector<SharedPtrCommandPool> commandPools;
+      std::vector<VkCommandBuffer>      commandBuffers;
+      return_t                          result{ success };
+    }; // struct Slice
+
+    struct
+    Task
+    {
+      index_t                        frame{ 0 };
+      VkCommandBufferInheritanceInfo inheritanceInfo{};
+      VkPipeline                     pipeline{ VK_NULL_HANDLE };
+      VkExtent2D                     extent{ 0, 0 };
+      DrawCommand const*             drawCommands{ nullptr };
+      size_type                      numDrawCommands{ 0 };
+      size_type                      numActiveSlices{ 0 };
+
+      // Set for indexed draws, which use drawIndexedCommands instead.
+      Mesh const*                    mesh{ nullptr };
+      DrawIndexedCommand const*      drawIndexedCommands{ nullptr };
+      VkPipelineLayout               pipelineLayout{ VK_NULL_HANDLE };
+      std::array<float, 16>          transform{};
+    }; // struct Task
+
+    std::vector<std::unique_ptr<Slice>> mSlices;
+
+    size_type                           mMinDrawsPerSlice;
+
+    JobSystem*                          mJobSystem;
+
+    SharedPtrLogicalDevice              mDevice;
+
+    /**
+     * @brief Shared by record and recordIndexed; task holds the draws.
+     */
+    return_t
+    recordTask(VkCommandBuffer const  primaryCommandBuffer,
+               index_t         const  frame,
+               VkFramebuffer   const  framebuffer,
+               RenderPass      const& renderPass,
+               SwapChain       const& swapChain,
+               Pipeline        const& pipeline,
+               Task                   task);
+
+    return_t
+    recordSlice(size_type const sliceIdx, Task const& task);
+
+    void
+    destroyMembers();
+
+}; // class ParallelCommandRecorder
+
+} // namespace vk
+} // namespace so
@@ -32,9 +32,15 @@
 std::array<char const*, 1> const DEVICE_EXTENSIONS
   ({ VK_KHR_SWAPCHAIN_EXTENSION_NAME });
 
+std::array<char const*, 3> const OPTIONAL_DEVICE_EXTENSIONS
+  ({ VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME,
+     VK_KHR_MAINTENANCE1_EXTENSION_NAME,
+     VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME });
+
 so::vk::PhysicalDevice::PhysicalDevice()
   : mPhysicalDevice(VK_NULL_HANDLE),
-    mInstance(Instance::getSharedPtrNullInstance())
+    mInstance(Instance::getSharedPtrNullInstance()),
+    mProperties()
 {}
 
 so::vk::PhysicalDevice&
@@ -47,9 +53,11 @@ so::vk::PhysicalDevice::operator=(PhysicalDevice&& other) noexcept
 
   mPhysicalDevice = other.mPhysicalDevice;
   mInstance       = other.mInstance;
+  mProperties     = other.mProperties;
 
   other.mPhysicalDevice = VK_NULL_HANDLE;
   other.mInstance       = Instance::getSharedPtrNullInstance();
+  other.mProperties     = VkPhysicalDeviceProperties{};
 
   return *this;
 }
@@ -84,7 +92,14 @@ so::vk::PhysicalDevice::initialize(SharedPtrInstance const& instance,
     }
   }
 
-  return mPhysicalDevice not_eq VK_NULL_HANDLE ? success : failure;
+  if(mPhysicalDevice is_eq VK_NULL_HANDLE)
+  {
+    return failure;
+  }
+
+  vkGetPhysicalDeviceProperties(mPhysicalDevice, &mProperties);
+
+  return success;
 }
 
 bool
@@ -55,6 +55,12 @@
 
 extern const std::array<const char*, 1> DEVICE_EXTENSIONS;
 
+/**
+ * Extensions enabled if the device supports them; query them with
+ * so::vk::LogicalDevice::isExtensionEnabled.
+ */
+extern const std::array<const char*, 3> OPTIONAL_DEVICE_EXTENSIONS;
+
 namespace so {
 namespace vk {
     
@@ -82,12 +88,21 @@ PhysicalDevice
 
     inline VkPhysicalDevice getVkPhysicalDevice() { return mPhysicalDevice; }
 
+    /**
+     * @brief Properties of the selected device, queried once during
+     *        initialization.
+     */
+    inline VkPhysicalDeviceProperties const&
+    getVkPhysicalDeviceProperties() const { return mProperties; }
+
     inline SharedPtrInstance
     getInstance() { return mInstance->shared_from_this(); }
 
   protected:
-    VkPhysicalDevice  mPhysicalDevice;
-    SharedPtrInstance mInstance;
+    VkPhysicalDevice           mPhysicalDevice;
+    SharedPtrInstance          mInstance;
+
+    VkPhysicalDeviceProperties mProperties;
 
     bool
     checkDeviceExtensionSupport(VkPhysicalDevice device);
@@ -26,11 +26,18 @@
 
 #include "cxx/soDebugCallback.hpp"
 #include "cxx/soFileSystem.hpp"
+#include "cxx/soPoolAllocator.hpp"
 
 so::vk::Pipeline::Pipeline()
   : mPipeline(VK_NULL_HANDLE),
     mPipelineLayout(VK_NULL_HANDLE),
-    mDevice(LogicalDevice::getSharedPtrNullDevice())
+    mDevice(LogicalDevice::getSharedPtrNullDevice()),
+    mPipelineCache(PipelineCache::getSharedPtrNullPipelineCache()),
+    mShaderModuleCache(ShaderModuleCache::getSharedPtrNullShaderModuleCache()),
+    mVertexFormat(),
+    mDescriptorSetLayouts(),
+    mShaderName(),
+    mCreationTime(0.0)
 {}
 
 so::vk::Pipeline::~Pipeline() noexcept
@@ -51,22 +58,54 @@ so::vk::Pipeline::operator=(Pipeline&& other) noexcept
   mPipeline       = other.mPipeline;
   mPipelineLayout = other.mPipelineLayout;
   mDevice         = other.mDevice;
+  mPipelineCache     = other.mPipelineCache;
+  mShaderModuleCache = other.mShaderModuleCache;
+  mVertexFormat      = other.mVertexFormat;
+  mCreationTime      = other.mCreationTime;
+
+  mDescriptorSetLayouts = std::move(other.mDescriptorSetLayouts);
+  mShaderName           = std::move(other.mShaderName);
 
   other.mPipeline       = VK_NULL_HANDLE;
   other.mPipelineLayout = VK_NULL_HANDLE;
   other.mDevice         = LogicalDevice::getSharedPtrNullDevice();
+  other.mPipelineCache  = PipelineCache::getSharedPtrNullPipelineCache();
+  other.mShaderModuleCache
+    = ShaderModuleCache::getSharedPtrNullShaderModuleCache();
 
   return *this;
 }
 
 so::return_t
-so::vk::Pipeline::initialize(SharedPtrLogicalDevice const& device,
-                             SwapChain              const& swapChain,
-														 RenderPass             const& renderPass)
+so::vk::Pipeline::initialize
+  (SharedPtrLogicalDevice     const& device,
+   RenderPass                 const& renderPass,
+   SharedPtrPipelineCache     const& pipelineCache,
+   SharedPtrShaderModuleCache const& shaderModuleCache,
+   VertexFormat               const& vertexFormat,
+   std::vector<VkDescriptorSetLayout> const& descriptorSetLayouts,
+   std::string                const& shaderName)
 {
-  mDevice = device;
+  mDevice               = device;
+  mPipelineCache        = pipelineCache;
+  mShaderModuleCache    = shaderModuleCache;
+  mVertexFormat         = vertexFormat;
+  mDescriptorSetLayouts = descriptorSetLayouts;
+  mShaderName           = shaderName;
+
+  bool const hasMeshAttributes
+    { mVertexFormat.has(VertexAttribute::position)
+      and mVertexFormat.has(VertexAttribute::normal) };
+
+  if(not mVertexFormat.isEmpty() and not hasMeshAttributes)
+  {
+    DEBUG_CALLBACK(error,
+                   "The mesh shaders need vertex positions and normals.");
+
+    return failure;
+  }
 
-  if(initializeMembers(swapChain, renderPass) is_eq failure)
+  if(initializeMembers(renderPass) is_eq failure)
   {
     DEBUG_CALLBACK(error,
                    "Failed to create a graphics pipeline during "
@@ -80,12 +119,11 @@ so::vk::Pipeline::initialize(SharedPtrLogicalDevice const& device,
 }
 
 so::return_t
-so::vk::Pipeline::reset(SwapChain  const& swapChain,
-                        RenderPass const& renderPass)
+so::vk::Pipeline::reset(RenderPass const& renderPass)
 {
   destroyMembers();
 
-  if(initializeMembers(swapChain, renderPass) is_eq failure)
+  if(initializeMembers(renderPass) is_eq failure)
   {
     DEBUG_CALLBACK(error,
                    "Failed to create a graphics pipeline while resetting.",
@@ -98,18 +136,22 @@ so::vk::Pipeline::reset(SwapChain  const& swapChain,
 }
 
 so::return_t
-so::vk::Pipeline::initializeMembers(SwapChain  const& swapChain,
-                                    RenderPass const& renderPass)
+so::vk::Pipeline::initializeMembers(RenderPass const& renderPass)
 {
-  ShaderModule vertShader{ mDevice,
-                           BIN_DIR + "/data/shaders/triangle/vert.spv" };
+  std::string const shaderName
+    { not mShaderName.empty() ? mShaderName
+                              : mVertexFormat.isEmpty() ? "triangle"
+                                                        : "mesh" };
+
+  std::string const shaderDir{ BIN_DIR + "/data/shaders/" + shaderName };
+
+  SharedPtrShaderModule vertShader
+    { getShaderModule(shaderDir + "/vert.spv") };
 
-  ShaderModule fragShader{ mDevice,
-                           BIN_DIR + "/data/shaders/triangle/frag.spv" };
+  SharedPtrShaderModule fragShader
+    { getShaderModule(shaderDir + "/frag.spv") };
 
-  bool const gotValidShaders
-               { (vertShader.getVkShaderModule() not_eq VK_NULL_HANDLE) and
-                 (fragShader.getVkShaderModule() not_eq VK_NULL_HANDLE) };
+  bool const gotValidShaders{ vertShader and fragShader };
  
   if(not gotValidShaders)
   {
@@ -123,7 +165,7 @@ so::vk::Pipeline::initializeMembers(SwapChain  const& swapChain,
   vertShaderStageInfo.sType  =
     VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
   vertShaderStageInfo.stage  = VK_SHADER_STAGE_VERTEX_BIT;
-  vertShaderStageInfo.module = vertShader.getVkShaderModule();
+  vertShaderStageInfo.module = vertShader->getVkShaderModule();
   vertShaderStageInfo.pName  = "main";
 
   VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
@@ -131,20 +173,28 @@ so::vk::Pipeline::initializeMembers(SwapChain  const& swapChain,
   fragShaderStageInfo.sType  =
     VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
   fragShaderStageInfo.stage  = VK_SHADER_STAGE_FRAGMENT_BIT;
-  fragShaderStageInfo.module = fragShader.getVkShaderModule();
+  fragShaderStageInfo.module = fragShader->getVkShaderModule();
   fragShaderStageInfo.pName  = "main";
 
   VkPipelineShaderStageCreateInfo shaderStages[]{ vertShaderStageInfo,
                                                   fragShaderStageInfo };
 
+  VkVertexInputBindingDescription const bindingDescription
+    { mVertexFormat.getVkBindingDescription() };
+
+  std::vector<VkVertexInputAttributeDescription> const attributeDescriptions
+    { mVertexFormat.getVkAttributeDescriptions() };
+
   VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
   
   vertexInputInfo.sType                           =
     VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-  vertexInputInfo.vertexBindingDescriptionCount   = 0;
-  vertexInputInfo.pVertexBindingDescriptions      = nullptr;
-  vertexInputInfo.vertexAttributeDescriptionCount = 0;
-  vertexInputInfo.pVertexAttributeDescriptions 		= nullptr;
+  vertexInputInfo.vertexBindingDescriptionCount   =
+    mVertexFormat.isEmpty() ? 0 : 1;
+  vertexInputInfo.pVertexBindingDescriptions      = &bindingDescription;
+  vertexInputInfo.vertexAttributeDescriptionCount =
+    static_cast<uint32_t>(attributeDescriptions.size());
+  vertexInputInfo.pVertexAttributeDescriptions 		= attributeDescriptions.data();
 
   VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
   
@@ -153,28 +203,25 @@ so::vk::Pipeline::initializeMembers(SwapChain  const& swapChain,
   inputAssembly.topology               = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
   inputAssembly.primitiveRestartEnable = VK_FALSE;
 
-  VkViewport viewport{};
-
-  viewport.x        = 0.0f;
-  viewport.y        = 0.0f;
-  viewport.width    = static_cast<float>(swapChain.getVkExtent().width);
-  viewport.height   = static_cast<float>(swapChain.getVkExtent().height);
-  viewport.minDepth = 0.0f;
-  viewport.maxDepth = 1.0f; 
-
-  VkRect2D scissor{};
-
-  scissor.offset = { 0, 0 };
-  scissor.extent = swapChain.getVkExtent();
-
+  // Set per command buffer, see dynamicStates below.
   VkPipelineViewportStateCreateInfo viewportState{};
 
   viewportState.sType         =
     VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
   viewportState.viewportCount = 1;
-  viewportState.pViewports    = &viewport;
+  viewportState.pViewports    = nullptr;
   viewportState.scissorCount  = 1;
-  viewportState.pScissors     = &scissor;
+  viewportState.pScissors     = nullptr;
+
+  VkDynamicState const dynamicStates[]{ VK_DYNAMIC_STATE_VIEWPORT,
+                                        VK_DYNAMIC_STATE_SCISSOR };
+
+  VkPipelineDynamicStateCreateInfo dynamicState{};
+
+  dynamicState.sType             =
+    VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+  dynamicState.dynamicStateCount = 2;
+  dynamicState.pDynamicStates    = dynamicStates;
 
   VkPipelineRasterizationStateCreateInfo rasterizer{};
 
@@ -185,7 +232,10 @@ so::vk::Pipeline::initializeMembers(SwapChain  const& swapChain,
   rasterizer.polygonMode             = VK_POLYGON_MODE_FILL;
   rasterizer.lineWidth               = 1.0f;
   rasterizer.cullMode                = VK_CULL_MODE_BACK_BIT;
-  rasterizer.frontFace               = VK_FRONT_FACE_CLOCKWISE;
+  // Model files wind counter-clockwise, the built-in triangle clockwise.
+  rasterizer.frontFace               = mVertexFormat.isEmpty()
+                                       ? VK_FRONT_FACE_CLOCKWISE
+                                       : VK_FRONT_FACE_COUNTER_CLOCKWISE;
   rasterizer.depthBiasEnable         = VK_FALSE;
   rasterizer.depthBiasConstantFactor = 0.0f; // Optional
   rasterizer.depthBiasClamp          = 0.0f; // Optional
@@ -228,14 +278,22 @@ so::vk::Pipeline::initializeMembers(SwapChain  const& swapChain,
   colorBlending.blendConstants[1] = 0.0f; // Optional
   colorBlending.blendConstants[2] = 0.0f; // Optional
 
+  // The transform of the mesh shaders, a mat4.
+  VkPushConstantRange pushConstantRange{};
+
+  pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+  pushConstantRange.offset     = 0;
+  pushConstantRange.size       = 16 * sizeof(float);
+
   VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
 
   pipelineLayoutInfo.sType                  =
     VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-  pipelineLayoutInfo.setLayoutCount         = 0;       // Optional
-  pipelineLayoutInfo.pSetLayouts            = nullptr; // Optional
-  pipelineLayoutInfo.pushConstantRangeCount = 0;       // Optional
-  pipelineLayoutInfo.pPushConstantRanges    = nullptr; // Optionali
+  pipelineLayoutInfo.setLayoutCount         =
+    static_cast<uint32_t>(mDescriptorSetLayouts.size());
+  pipelineLayoutInfo.pSetLayouts            = mDescriptorSetLayouts.data();
+  pipelineLayoutInfo.pushConstantRangeCount = mVertexFormat.isEmpty() ? 0 : 1;
+  pipelineLayoutInfo.pPushConstantRanges    = &pushConstantRange;
 
   auto vkDevice{ mDevice->getVkDevice() };
 
@@ -263,20 +321,24 @@ so::vk::Pipeline::initializeMembers(SwapChain  const& swapChain,
   pipelineInfo.pMultisampleState = &multisampling;
   pipelineInfo.pDepthStencilState = nullptr; // Optional
   pipelineInfo.pColorBlendState = &colorBlending;
-  pipelineInfo.pDynamicState = nullptr; // Optional
+  pipelineInfo.pDynamicState = &dynamicState;
   pipelineInfo.layout = mPipelineLayout;
   pipelineInfo.renderPass = renderPass.getVkRenderPass();
   pipelineInfo.subpass = 0;
   pipelineInfo.basePipelineHandle = VK_NULL_HANDLE; // Optional
   pipelineInfo.basePipelineIndex  = -1; // Optional
 
+  auto const creationStart{ std::chrono::steady_clock::now() };
+
   result = vkCreateGraphicsPipelines(vkDevice,
-                                     VK_NULL_HANDLE,
+                                     mPipelineCache->getVkPipelineCache(),
                                      1,
                                      &pipelineInfo,
                                      nullptr,
                                      &mPipeline);
 
+  mCreationTime = std::chrono::steady_clock::now() - creationStart;
+
   if(result not_eq VK_SUCCESS)
   {
     DEBUG_CALLBACK(error,
@@ -289,6 +351,26 @@ so::vk::Pipeline::initializeMembers(SwapChain  const& swapChain,
   return success;
 }
 
+so::vk::SharedPtrShaderModule
+so::vk::Pipeline::getShaderModule(std::string const& file)
+{
+  if(mShaderModuleCache not_eq
+     ShaderModuleCache::getSharedPtrNullShaderModuleCache())
+  {
+    return mShaderModuleCache->get(file);
+  }
+
+  auto shaderModule
+    { utils::mem::makePooledShared<ShaderModule>(mDevice, file) };
+
+  if(shaderModule->getVkShaderModule() is_eq VK_NULL_HANDLE)
+  {
+    return nullptr;
+  }
+
+  return shaderModule;
+}
+
 void
 so::vk::Pipeline::destroyMembers()
 {
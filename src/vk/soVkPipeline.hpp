@@ -52,8 +52,15 @@
 
 #include "soVkLogicalDevice.hpp"
 
+#include "soVkPipelineCache.hpp"
 #include "soVkRenderPass.hpp"
+#include "soVkShaderModuleCache.hpp"
 #include "soVkSwapChain.hpp"
+#include "soVkVertexFormat.hpp"
+
+#include <chrono>
+#include <string>
+#include <vector>
 
 namespace so {
 namespace vk {
@@ -76,17 +83,58 @@ Pipeline
     Pipeline&
     operator=(Pipeline&& other) noexcept;
    
+    /**
+     * Viewport and scissor are dynamic state, so the pipeline does not depend
+     * on the swap chain extent and survives resizes. They have to be set in
+     * every command buffer that binds the pipeline.
+     *
+     * @param pipelineCache     Cache shared by all pipelines, kept for resets.
+     * @param shaderModuleCache Source of the shader modules. Without one the
+     *                          SPIR-V is read from disk on every creation.
+     * @param vertexFormat      Layout of the vertex buffer at binding 0. An
+     *                          empty format draws the built-in triangle,
+     *                          any other one the mesh shaders, which need
+     *                          positions and normals and take a column major
+     *                          transform as a push constant.
+     * @param descriptorSetLayouts Layouts of the descriptor sets the shaders
+     *                          read, by set number. They have to outlive
+     *                          the pipeline.
+     * @param shaderName        Directory of the shaders in data/shaders.
+     *                          Empty picks the triangle or mesh shaders by
+     *                          vertexFormat; others have to take the same
+     *                          vertex inputs and push constants.
+     */
     return_t
-    initialize(SharedPtrLogicalDevice const& device,
-               SwapChain              const& swapChain,
-							 RenderPass             const& renderPass);
+    initialize(SharedPtrLogicalDevice     const& device,
+               RenderPass                 const& renderPass,
+               SharedPtrPipelineCache     const& pipelineCache =
+                 PipelineCache::getSharedPtrNullPipelineCache(),
+               SharedPtrShaderModuleCache const& shaderModuleCache =
+                 ShaderModuleCache::getSharedPtrNullShaderModuleCache(),
+               VertexFormat               const& vertexFormat =
+                 VertexFormat{},
+               std::vector<VkDescriptorSetLayout> const&
+                 descriptorSetLayouts = {},
+               std::string                const& shaderName = {});
 
     return_t
-    reset(SwapChain const& swapChain, RenderPass const& renderPass);
+    reset(RenderPass const& renderPass);
 
     inline VkPipeline getVkPipeline() const { return mPipeline; }
  
-    inline VkPipelineLayout getVkPipelineLayout() { return mPipelineLayout; }
+    inline VkPipelineLayout getVkPipelineLayout() const
+    { return mPipelineLayout; }
+
+    inline VertexFormat const& getVertexFormat() const { return mVertexFormat; }
+
+    inline std::vector<VkDescriptorSetLayout> const&
+    getVkDescriptorSetLayouts() const { return mDescriptorSetLayouts; }
+
+    /**
+     * @brief Time vkCreateGraphicsPipelines took for the last creation.
+     */
+    inline std::chrono::duration<double, std::milli>
+    getCreationTime() const { return mCreationTime; }
 
   private:
     VkPipeline                mPipeline;
@@ -94,9 +142,23 @@ Pipeline
 
     SharedPtrLogicalDevice    mDevice;
 
+    SharedPtrPipelineCache    mPipelineCache;
+
+    SharedPtrShaderModuleCache mShaderModuleCache;
+
+    VertexFormat              mVertexFormat;
+
+    std::vector<VkDescriptorSetLayout> mDescriptorSetLayouts;
+
+    std::string               mShaderName;
+
+    std::chrono::duration<double, std::milli> mCreationTime;
+
     return_t
-    initializeMembers(SwapChain  const& swapChain,
-                      RenderPass const& renderPass);
+    initializeMembers(RenderPass const& renderPass);
+
+    SharedPtrShaderModule
+    getShaderModule(std::string const& file);
 
     void
     destroyMembers();
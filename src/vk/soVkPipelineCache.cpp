@@ -0,0 +1,358 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "soVkPipelineCache.hpp"
+
+#include "cxx/soDebugCallback.hpp"
+#include "cxx/soDefinitions.hpp"
+#include "cxx/soPoolAllocator.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+constexpr uint32_t fileMagic{ 0x43504f53 }; // "SOPC"
+constexpr uint32_t fileVersion{ 1 };
+
+/**
+ * Precedes the data returned by vkGetPipelineCacheData in the cache file. The
+ * driver version is not part of the Vulkan cache header, so it is stored here.
+ */
+struct
+FileHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  uint32_t vendorID;
+  uint32_t deviceID;
+  uint32_t driverVersion;
+  uint8_t  pipelineCacheUUID[VK_UUID_SIZE];
+  uint64_t dataSize;
+};
+
+FileHeader
+makeFileHeader(VkPhysicalDeviceProperties const& properties,
+               uint64_t                   const  dataSize)
+{
+  FileHeader header{};
+
+  header.magic         = fileMagic;
+  header.version       = fileVersion;
+  header.vendorID      = properties.vendorID;
+  header.deviceID      = properties.deviceID;
+  header.driverVersion = properties.driverVersion;
+  header.dataSize      = dataSize;
+
+  std::memcpy(header.pipelineCacheUUID,
+              properties.pipelineCacheUUID,
+              VK_UUID_SIZE);
+
+  return header;
+}
+
+} // namespace
+
+so::vk::SharedPtrPipelineCache const&
+so::vk::PipelineCache::getSharedPtrNullPipelineCache()
+{
+  static SharedPtrPipelineCache pipelineCache
+    { utils::mem::makePooledShared<PipelineCache>() };
+
+  return pipelineCache;
+}
+
+so::vk::PipelineCache::PipelineCache()
+  : mPipelineCache(VK_NULL_HANDLE),
+    mDevice(LogicalDevice::getSharedPtrNullDevice()),
+    mFilename(),
+    mIsWarm(false)
+{}
+
+so::vk::PipelineCache::~PipelineCache() noexcept
+{
+  destroyMembers();
+}
+
+so::vk::PipelineCache&
+so::vk::PipelineCache::operator=(PipelineCache&& other) noexcept
+{
+  if(this is_eq &other)
+  {
+    return *this;
+  }
+
+  destroyMembers();
+
+  mPipelineCache = other.mPipelineCache;
+  mDevice        = other.mDevice;
+  mFilename      = std::move(other.mFilename);
+  mIsWarm        = other.mIsWarm;
+
+  other.mPipelineCache = VK_NULL_HANDLE;
+  other.mDevice        = LogicalDevice::getSharedPtrNullDevice();
+  other.mFilename      = std::string();
+  other.mIsWarm        = false;
+
+  return *this;
+}
+
+so::return_t
+so::vk::PipelineCache::initialize(SharedPtrLogicalDevice const& device,
+                                  std::string            const& filename)
+{
+  // Keeps what the previous cache learned before it is replaced.
+  if(mPipelineCache not_eq VK_NULL_HANDLE)
+  {
+    save();
+  }
+
+  destroyMembers();
+
+  mDevice   = device;
+  mFilename = filename;
+
+  std::vector<char> initialData;
+
+  mIsWarm = loadFile(initialData);
+
+  VkPipelineCacheCreateInfo createInfo{};
+
+  createInfo.sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+  createInfo.initialDataSize = mIsWarm ? initialData.size() : 0;
+  createInfo.pInitialData    = mIsWarm ? initialData.data() : nullptr;
+
+  VkResult result{ vkCreatePipelineCache(mDevice->getVkDevice(),
+                                         &createInfo,
+                                         nullptr,
+                                         &mPipelineCache) };
+
+  if(result not_eq VK_SUCCESS and mIsWarm)
+  {
+    DEBUG_CALLBACK(info,
+                   "The driver rejected the pipeline cache data, starting "
+                   "with an empty cache.");
+
+    mIsWarm = false;
+
+    createInfo.initialDataSize = 0;
+    createInfo.pInitialData    = nullptr;
+
+    result = vkCreatePipelineCache(mDevice->getVkDevice(),
+                                   &createInfo,
+                                   nullptr,
+                                   &mPipelineCache);
+  }
+
+  if(result not_eq VK_SUCCESS)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to create a pipeline cache.",
+                   vkCreatePipelineCache);
+
+    return failure;
+  }
+
+  return success;
+}
+
+so::return_t
+so::vk::PipelineCache::merge(PipelineCache const& other)
+{
+  VkPipelineCache srcCache{ other.getVkPipelineCache() };
+
+  VkResult result{ vkMergePipelineCaches(mDevice->getVkDevice(),
+                                         mPipelineCache,
+                                         1,
+                                         &srcCache) };
+
+  if(result not_eq VK_SUCCESS)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to merge pipeline caches.",
+                   vkMergePipelineCaches);
+
+    return failure;
+  }
+
+  return success;
+}
+
+so::return_t
+so::vk::PipelineCache::save() const
+{
+  if(mPipelineCache is_eq VK_NULL_HANDLE or mFilename.empty())
+  {
+    return failure;
+  }
+
+  VkDevice vkDevice{ mDevice->getVkDevice() };
+
+  std::size_t dataSize{ 0 };
+
+  VkResult result{ vkGetPipelineCacheData(vkDevice,
+                                          mPipelineCache,
+                                          &dataSize,
+                                          nullptr) };
+
+  std::vector<char> data(dataSize);
+
+  if(result is_eq VK_SUCCESS)
+  {
+    result = vkGetPipelineCacheData(vkDevice,
+                                    mPipelineCache,
+                                    &dataSize,
+                                    data.data());
+  }
+
+  if(result not_eq VK_SUCCESS)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to retrieve the pipeline cache data.",
+                   vkGetPipelineCacheData);
+
+    return failure;
+  }
+
+  FileHeader const header
+    { makeFileHeader(mDevice->getVkPhysicalDeviceProperties(), dataSize) };
+
+  std::string const tmpFilename{ mFilename + ".tmp" };
+
+  {
+    std::ofstream file(tmpFilename, std::ios::binary bitor std::ios::trunc);
+
+    file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+    file.write(data.data(), static_cast<std::streamsize>(dataSize));
+
+    if(not file.good())
+    {
+      DEBUG_CALLBACK(error,
+                     "Failed to write the pipeline cache to '" + tmpFilename +
+                     "'.");
+
+      return failure;
+    }
+  }
+
+  if(std::rename(tmpFilename.c_str(), mFilename.c_str()) not_eq 0)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to replace the pipeline cache '" + mFilename +
+                   "'.");
+
+    std::remove(tmpFilename.c_str());
+
+    return failure;
+  }
+
+  return success;
+}
+
+bool
+so::vk::PipelineCache::loadFile(std::vector<char>& data) const
+{
+  std::ifstream file(mFilename, std::ios::binary);
+
+  if(not file.is_open())
+  {
+    return false;
+  }
+
+  FileHeader header{};
+
+  file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+  VkPhysicalDeviceProperties const& properties
+    { mDevice->getVkPhysicalDeviceProperties() };
+
+  bool const isCompatible
+    { file.good()                                          and
+      header.magic         is_eq fileMagic                 and
+      header.version       is_eq fileVersion               and
+      header.vendorID      is_eq properties.vendorID       and
+      header.deviceID      is_eq properties.deviceID       and
+      header.driverVersion is_eq properties.driverVersion  and
+      std::memcmp(header.pipelineCacheUUID,
+                  properties.pipelineCacheUUID,
+                  VK_UUID_SIZE) is_eq 0 };
+
+  if(not isCompatible)
+  {
+    DEBUG_CALLBACK(info,
+                   "Ignoring pipeline cache '" + mFilename + "', it was "
+                   "written by a different device or driver.");
+
+    return false;
+  }
+
+  std::streampos const dataBegin{ file.tellg() };
+
+  file.seekg(0, std::ios::end);
+
+  std::streamoff const bytesRemaining{ file.tellg() - dataBegin };
+
+  file.seekg(dataBegin);
+
+  if(not file.good() or
+     bytesRemaining < 0 or
+     static_cast<uint64_t>(bytesRemaining) not_eq header.dataSize)
+  {
+    DEBUG_CALLBACK(info,
+                   "Ignoring pipeline cache '" + mFilename + "', its size "
+                   "does not match its header.");
+
+    return false;
+  }
+
+  data.resize(static_cast<std::vector<char>::size_type>(header.dataSize));
+
+  file.read(data.data(), static_cast<std::streamsize>(data.size()));
+
+  if(not file.good() or
+     file.gcount() not_eq static_cast<std::streamsize>(data.size()))
+  {
+    DEBUG_CALLBACK(info,
+                   "Ignoring truncated pipeline cache '" + mFilename + "'.");
+
+    data.clear();
+
+    return false;
+  }
+
+  return true;
+}
+
+void
+so::vk::PipelineCache::destroyMembers()
+{
+  VkDevice device{ mDevice->getVkDevice() };
+
+  if(device not_eq VK_NULL_HANDLE and mPipelineCache not_eq VK_NULL_HANDLE)
+  {
+    vkDestroyPipelineCache(device, mPipelineCache, nullptr);
+  }
+
+  mPipelineCache = VK_NULL_HANDLE;
+}
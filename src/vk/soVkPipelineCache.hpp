@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      soVkPipelineCache.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "soVkLogicalDevice.hpp"
+
+#include <string>
+
+namespace so {
+namespace vk {
+
+class
+PipelineCache;
+
+using SharedPtrPipelineCache = std::shared_ptr<PipelineCache>;
+
+/**
+ * @brief A VkPipelineCache persisted to disk between runs.
+ *
+ * The file starts with a header identifying the device and driver that
+ * produced it. Data from a different vendor, device, driver version or
+ * pipeline cache UUID is discarded and the cache starts out empty, since
+ * drivers may reject or, worse, misinterpret foreign cache data.
+ */
+class
+PipelineCache : public std::enable_shared_from_this<PipelineCache>
+{
+  public:
+    static SharedPtrPipelineCache const&
+    getSharedPtrNullPipelineCache();
+
+    PipelineCache();
+
+    PipelineCache(PipelineCache const& other) = delete;
+
+    PipelineCache(PipelineCache&& other) = delete;
+
+    ~PipelineCache() noexcept;
+
+    PipelineCache&
+    operator=(PipelineCache const& other) = delete;
+
+    PipelineCache&
+    operator=(PipelineCache&& other) noexcept;
+
+    /**
+     * @brief Creates the cache, seeded with the contents of filename if it
+     *        exists and was written for this device and driver. A cache
+     *        created before is saved and destroyed first.
+     */
+    return_t
+    initialize(SharedPtrLogicalDevice const& device,
+               std::string            const& filename);
+
+    /**
+     * @brief Merges other into this cache, e.g. a cache filled by another
+     *        thread with VK_PIPELINE_CACHE_CREATE_EXTERNALLY_SYNCHRONIZED_BIT.
+     */
+    return_t
+    merge(PipelineCache const& other);
+
+    /**
+     * @brief Writes the cache back to the file it was loaded from.
+     *
+     * The file is replaced atomically, so a crash while saving leaves the
+     * previous cache intact.
+     */
+    return_t
+    save() const;
+
+    /**
+     * @brief Whether valid data was loaded from disk, i.e. pipeline creation
+     *        is expected to be warm.
+     */
+    inline bool isWarm() const { return mIsWarm; }
+
+    inline VkPipelineCache getVkPipelineCache() const { return mPipelineCache; }
+
+  private:
+    VkPipelineCache        mPipelineCache;
+
+    SharedPtrLogicalDevice mDevice;
+
+    std::string            mFilename;
+
+    bool                   mIsWarm;
+
+    bool
+    loadFile(std::vector<char>& data) const;
+
+    void
+    destroyMembers();
+
+}; // class PipelineCache
+
+} // namespace vk
+} // namespace so
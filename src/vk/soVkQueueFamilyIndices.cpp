@@ -57,6 +57,16 @@ so::vk::QueueFamilyIndices::QueueFamilyIndices(VkPhysicalDevice        device,
       { 
         mGraphicsFamily = i;
       }
+
+      bool const isTransferOnly
+                   { (queueFamily.queueFlags bitand
+                      (VK_QUEUE_GRAPHICS_BIT bitor VK_QUEUE_COMPUTE_BIT bitor
+                       VK_QUEUE_TRANSFER_BIT)) is_eq VK_QUEUE_TRANSFER_BIT };
+
+      if(isTransferOnly and (mTransferFamily < 0))
+      {
+        mTransferFamily = i;
+      }
     }
 
     auto presentSupport = static_cast<VkBool32>(false);
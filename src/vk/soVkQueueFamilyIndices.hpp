@@ -59,7 +59,8 @@ class
 QueueFamilyIndices
 {
   public:
-    QueueFamilyIndices() : mGraphicsFamily(-1), mPresentFamily(-1) {}
+    QueueFamilyIndices()
+      : mGraphicsFamily(-1), mPresentFamily(-1), mTransferFamily(-1) {}
 
     QueueFamilyIndices(VkPhysicalDevice device, Surface const& surface);
 
@@ -71,12 +72,21 @@ QueueFamilyIndices
 
     inline void setPresentFamily(int value) { mPresentFamily = value; }
 
+    /**
+     * @brief A family supporting transfers but neither graphics nor compute,
+     *        usually backed by a dedicated DMA engine. -1 if there is none.
+     */
+    inline int getTransferFamily() { return mTransferFamily; }
+
+    inline void setTransferFamily(int value) { mTransferFamily = value; }
+
     inline bool isComplete()
       { return (mGraphicsFamily >= 0) && (mPresentFamily >= 0); }
 
   private:
     int mGraphicsFamily;
     int mPresentFamily;
+    int mTransferFamily;
 };
 
 } // namespace vk
@@ -0,0 +1,1141 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "soVkRenderGraph.hpp"
+
+#include "cxx/soDebugCallback.hpp"
+#include "cxx/soProfiler.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+struct
+AccessInfo
+{
+  VkPipelineStageFlags stages;
+  VkAccessFlags        access;
+  VkAccessFlags        writeAccess;
+  VkImageLayout        layout;
+  VkImageUsageFlags    usage;
+  bool                 isImageAccess;
+  bool                 isBufferAccess;
+};
+
+AccessInfo
+getAccessInfo(so::vk::ResourceAccess const access)
+{
+  using so::vk::ResourceAccess;
+
+  VkPipelineStageFlags const depthTests
+    { VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT bitor
+      VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT };
+
+  switch(access)
+  {
+    case ResourceAccess::colorAttachmentWrite:
+      return { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+               VK_ACCESS_COLOR_ATTACHMENT_READ_BIT bitor
+               VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+               VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+               VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+               VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+               true,
+               false };
+    case ResourceAccess::depthStencilAttachmentWrite:
+      return { depthTests,
+               VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT bitor
+               VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+               VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+               VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+               VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+               true,
+               false };
+    case ResourceAccess::depthStencilAttachmentRead:
+      return { depthTests,
+               VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+               0,
+               VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+               VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+               true,
+               false };
+    case ResourceAccess::vertexShaderRead:
+      return { VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+               VK_ACCESS_SHADER_READ_BIT,
+               0,
+               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+               VK_IMAGE_USAGE_SAMPLED_BIT,
+               true,
+               true };
+    case ResourceAccess::fragmentShaderRead:
+      return { VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+               VK_ACCESS_SHADER_READ_BIT,
+               0,
+               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+               VK_IMAGE_USAGE_SAMPLED_BIT,
+               true,
+               true };
+    case ResourceAccess::computeShaderRead:
+      return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+               VK_ACCESS_SHADER_READ_BIT,
+               0,
+               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+               VK_IMAGE_USAGE_SAMPLED_BIT,
+               true,
+               true };
+    case ResourceAccess::computeShaderWrite:
+      return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+               VK_ACCESS_SHADER_READ_BIT bitor VK_ACCESS_SHADER_WRITE_BIT,
+               VK_ACCESS_SHADER_WRITE_BIT,
+               VK_IMAGE_LAYOUT_GENERAL,
+               VK_IMAGE_USAGE_STORAGE_BIT,
+               true,
+               true };
+    case ResourceAccess::transferRead:
+      return { VK_PIPELINE_STAGE_TRANSFER_BIT,
+               VK_ACCESS_TRANSFER_READ_BIT,
+               0,
+               VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+               VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+               true,
+               true };
+    case ResourceAccess::transferWrite:
+      return { VK_PIPELINE_STAGE_TRANSFER_BIT,
+               VK_ACCESS_TRANSFER_WRITE_BIT,
+               VK_ACCESS_TRANSFER_WRITE_BIT,
+               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+               VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+               true,
+               true };
+    case ResourceAccess::indirectRead:
+      return { VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+               VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+               0,
+               VK_IMAGE_LAYOUT_UNDEFINED,
+               0,
+               false,
+               true };
+    case ResourceAccess::vertexInputRead:
+      return { VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+               VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT bitor
+               VK_ACCESS_INDEX_READ_BIT,
+               0,
+               VK_IMAGE_LAYOUT_UNDEFINED,
+               0,
+               false,
+               true };
+  }
+
+  return { 0, 0, 0, VK_IMAGE_LAYOUT_UNDEFINED, 0, false, false };
+}
+
+so::size_type const notUsed{ std::numeric_limits<so::size_type>::max() };
+
+} // namespace
+
+/*
+ * Synchronization state of a resource while compileBarriers walks the
+ * passes. writeStages and writeAccess describe the last write, or the last
+ * layout transition with no access to make available, readStages the reads
+ * since. visibleStages and visibleAccess are those the write has been made
+ * visible to.
+ */
+struct
+so::vk::RenderGraph::ResourceState
+{
+  VkImageLayout        layout{ VK_IMAGE_LAYOUT_UNDEFINED };
+  VkPipelineStageFlags writeStages{ 0 };
+  VkAccessFlags        writeAccess{ 0 };
+  VkPipelineStageFlags readStages{ 0 };
+  VkPipelineStageFlags visibleStages{ 0 };
+  VkAccessFlags        visibleAccess{ 0 };
+  bool                 isUsed{ false };
+};
+
+so::vk::RenderGraph::RenderGraph()
+  : mDevice(LogicalDevice::getSharedPtrNullDevice()),
+    mAllocator(MemoryAllocator::getSharedPtrNullMemoryAllocator()),
+    mDeletionQueue(nullptr),
+    mNumFrames(0),
+    mResources(),
+    mPasses(),
+    mFinalBarriers(),
+    mImageBarrierResources(),
+    mImageBarriers(),
+    mBufferBarrierResources(),
+    mBufferBarriers(),
+    mTransientMemory(),
+    mFrame(0),
+    mIsDirty(true),
+    mStatistics()
+{}
+
+so::vk::RenderGraph::~RenderGraph() noexcept
+{
+  releaseTransientImages();
+}
+
+so::return_t
+so::vk::RenderGraph::initialize
+  (SharedPtrLogicalDevice   const& device,
+   SharedPtrMemoryAllocator const& allocator,
+   DeletionQueue&                  deletionQueue,
+   size_type                const  numFramesInFlight)
+{
+  clear();
+
+  mDevice        = device;
+  mAllocator     = allocator;
+  mDeletionQueue = &deletionQueue;
+  mNumFrames     = numFramesInFlight;
+
+  if(mNumFrames is_eq 0)
+  {
+    DEBUG_CALLBACK(error, "A render graph needs at least one frame.");
+
+    return failure;
+  }
+
+  return success;
+}
+
+void
+so::vk::RenderGraph::clear()
+{
+  releaseTransientImages();
+
+  mResources.clear();
+  mPasses.clear();
+  mFinalBarriers = BarrierBatch{};
+
+  mImageBarrierResources.clear();
+  mImageBarriers.clear();
+  mBufferBarrierResources.clear();
+  mBufferBarriers.clear();
+
+  mIsDirty    = true;
+  mStatistics = RenderGraphStatistics{};
+}
+
+so::vk::RenderGraph::ResourceId
+so::vk::RenderGraph::importImage(std::string          const& name,
+                                 VkImageAspectFlags   const  aspect,
+                                 VkImageLayout        const  initialLayout,
+                                 VkPipelineStageFlags const  initialStages,
+                                 VkImageLayout        const  finalLayout)
+{
+  Resource resource{};
+
+  resource.name          = name;
+  resource.kind          = ResourceKind::importedImage;
+  resource.aspect        = aspect;
+  resource.initialLayout = initialLayout;
+  resource.initialStages = initialStages;
+  resource.finalLayout   = finalLayout;
+  resource.aliased       = invalidId;
+
+  mResources.push_back(std::move(resource));
+
+  mIsDirty = true;
+
+  return static_cast<ResourceId>(mResources.size() - 1);
+}
+
+so::vk::RenderGraph::ResourceId
+so::vk::RenderGraph::importBuffer(std::string const& name)
+{
+  Resource resource{};
+
+  resource.name    = name;
+  resource.kind    = ResourceKind::importedBuffer;
+  resource.aliased = invalidId;
+
+  mResources.push_back(std::move(resource));
+
+  mIsDirty = true;
+
+  return static_cast<ResourceId>(mResources.size() - 1);
+}
+
+so::vk::RenderGraph::ResourceId
+so::vk::RenderGraph::createImage(std::string        const& name,
+                                 VkFormat           const  format,
+                                 VkExtent2D         const  extent,
+                                 VkImageAspectFlags const  aspect)
+{
+  Resource resource{};
+
+  resource.name          = name;
+  resource.kind          = ResourceKind::transientImage;
+  resource.aspect        = aspect;
+  resource.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  resource.finalLayout   = VK_IMAGE_LAYOUT_UNDEFINED;
+  resource.format        = format;
+  resource.extent        = extent;
+  resource.aliased       = invalidId;
+
+  mResources.push_back(std::move(resource));
+
+  mIsDirty = true;
+
+  return static_cast<ResourceId>(mResources.size() - 1);
+}
+
+so::vk::RenderGraph::PassId
+so::vk::RenderGraph::addPass(std::string             const& name,
+                             std::vector<PassAccess>        accesses,
+                             record_t                       record)
+{
+  Pass pass{};
+
+  pass.name      = name;
+  pass.accesses  = std::move(accesses);
+  pass.record    = std::move(record);
+  pass.isEnabled = true;
+
+  mPasses.push_back(std::move(pass));
+
+  mIsDirty = true;
+
+  return static_cast<PassId>(mPasses.size() - 1);
+}
+
+void
+so::vk::RenderGraph::setPassEnabled(PassId const pass, bool const enabled)
+{
+  if((pass < mPasses.size()) and (mPasses[pass].isEnabled not_eq enabled))
+  {
+    mPasses[pass].isEnabled = enabled;
+
+    mIsDirty = true;
+  }
+}
+
+bool
+so::vk::RenderGraph::isPassEnabled(PassId const pass) const
+{
+  return (pass < mPasses.size()) and mPasses[pass].isEnabled;
+}
+
+void
+so::vk::RenderGraph::setImage(ResourceId  const resource,
+                              VkImage     const image,
+                              VkImageView const imageView)
+{
+  if((resource < mResources.size()) and
+     (mResources[resource].kind is_eq ResourceKind::importedImage))
+  {
+    mResources[resource].image     = image;
+    mResources[resource].imageView = imageView;
+  }
+}
+
+void
+so::vk::RenderGraph::setBuffer(ResourceId const resource,
+                               VkBuffer   const buffer)
+{
+  if((resource < mResources.size()) and
+     (mResources[resource].kind is_eq ResourceKind::importedBuffer))
+  {
+    mResources[resource].buffer = buffer;
+  }
+}
+
+so::return_t
+so::vk::RenderGraph::compile()
+{
+  SO_PROFILE_ZONE("RenderGraph::compile");
+
+  mStatistics = RenderGraphStatistics{};
+
+  for(Pass const& pass : mPasses)
+  {
+    if(pass.isEnabled and not isValid(pass))
+    {
+      return failure;
+    }
+  }
+
+  releaseTransientImages();
+
+  if(createTransientImages() is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to create the transient images of a render graph.",
+                   RenderGraph::createTransientImages);
+
+    return failure;
+  }
+
+  compileBarriers();
+
+  mIsDirty = false;
+
+  return success;
+}
+
+so::return_t
+so::vk::RenderGraph::execute(VkCommandBuffer const commandBuffer,
+                             index_t         const frame)
+{
+  SO_PROFILE_ZONE("RenderGraph::execute");
+
+  if(static_cast<size_type>(frame) >= mNumFrames)
+  {
+    DEBUG_CALLBACK(error, "Executed a render graph for an invalid frame.");
+
+    return failure;
+  }
+
+  if(mIsDirty and (compile() is_eq failure))
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to compile a render graph.",
+                   RenderGraph::compile);
+
+    return failure;
+  }
+
+  mFrame = frame;
+
+  for(Pass const& pass : mPasses)
+  {
+    if(not pass.isEnabled)
+    {
+      continue;
+    }
+
+    if(recordBarriers(commandBuffer, pass.barriers) is_eq failure)
+    {
+      return failure;
+    }
+
+    if(pass.record and (pass.record(commandBuffer) is_eq failure))
+    {
+      DEBUG_CALLBACK(error,
+                     "Failed to record the render graph pass " + pass.name +
+                     ".");
+
+      return failure;
+    }
+  }
+
+  return recordBarriers(commandBuffer, mFinalBarriers);
+}
+
+VkImage
+so::vk::RenderGraph::getVkImage(ResourceId const resource) const
+{
+  if(resource >= mResources.size())
+  {
+    return VK_NULL_HANDLE;
+  }
+
+  Resource const& image{ mResources[resource] };
+
+  if(image.kind is_eq ResourceKind::transientImage)
+  {
+    return image.images.empty()
+      ? VK_NULL_HANDLE
+      : image.images[static_cast<size_type>(mFrame)];
+  }
+
+  return image.image;
+}
+
+VkImageView
+so::vk::RenderGraph::getVkImageView(ResourceId const resource) const
+{
+  if(resource >= mResources.size())
+  {
+    return VK_NULL_HANDLE;
+  }
+
+  Resource const& image{ mResources[resource] };
+
+  if(image.kind is_eq ResourceKind::transientImage)
+  {
+    return image.imageViews.empty()
+      ? VK_NULL_HANDLE
+      : image.imageViews[static_cast<size_type>(mFrame)];
+  }
+
+  return image.imageView;
+}
+
+VkBuffer
+so::vk::RenderGraph::getVkBuffer(ResourceId const resource) const
+{
+  return resource < mResources.size() ? mResources[resource].buffer
+                                      : VK_NULL_HANDLE;
+}
+
+bool
+so::vk::RenderGraph::isValid(Pass const& pass) const
+{
+  std::vector<ResourceId> resources;
+
+  for(PassAccess const& access : pass.accesses)
+  {
+    if(access.resource >= mResources.size())
+    {
+      DEBUG_CALLBACK(error,
+                     "The render graph pass " + pass.name +
+                     " accesses an unknown resource.");
+
+      return false;
+    }
+
+    Resource   const& resource{ mResources[access.resource] };
+    AccessInfo const  accessInfo{ getAccessInfo(access.access) };
+
+    bool const isBuffer{ resource.kind is_eq ResourceKind::importedBuffer };
+
+    if(isBuffer ? not accessInfo.isBufferAccess : not accessInfo.isImageAccess)
+    {
+      DEBUG_CALLBACK(error,
+                     "The render graph pass " + pass.name +
+                     " accesses " + resource.name + " in a way its kind of "
+                     "resource does not support.");
+
+      return false;
+    }
+
+    resources.push_back(access.resource);
+  }
+
+  std::sort(resources.begin(), resources.end());
+
+  if(std::adjacent_find(resources.begin(), resources.end()) not_eq
+     resources.end())
+  {
+    DEBUG_CALLBACK(error,
+                   "The render graph pass " + pass.name +
+                   " accesses a resource more than once.");
+
+    return false;
+  }
+
+  return true;
+}
+
+so::return_t
+so::vk::RenderGraph::createTransientImages()
+{
+  // Lifetimes in enabled passes and the usage the accesses need.
+  std::vector<size_type>         firstPass(mResources.size(), notUsed);
+  std::vector<size_type>         lastPass(mResources.size(), 0);
+  std::vector<VkImageUsageFlags> usages(mResources.size(), 0);
+
+  for(size_type p{ 0 }; p < mPasses.size(); ++p)
+  {
+    if(not mPasses[p].isEnabled)
+    {
+      continue;
+    }
+
+    ++mStatistics.numEnabledPasses;
+
+    for(PassAccess const& access : mPasses[p].accesses)
+    {
+      firstPass[access.resource] = std::min(firstPass[access.resource], p);
+      lastPass[access.resource]  = p;
+      usages[access.resource]   |= getAccessInfo(access.access).usage;
+    }
+  }
+
+  std::vector<ResourceId> transients;
+
+  for(ResourceId r{ 0 }; r < mResources.size(); ++r)
+  {
+    mResources[r].aliased = invalidId;
+
+    if((mResources[r].kind is_eq ResourceKind::transientImage) and
+       (firstPass[r] not_eq notUsed))
+    {
+      transients.push_back(r);
+    }
+  }
+
+  std::stable_sort(transients.begin(),
+                   transients.end(),
+                   [&firstPass](ResourceId const lhs, ResourceId const rhs)
+                   { return firstPass[lhs] < firstPass[rhs]; });
+
+  /*
+   * A slot is a range of memory shared by images with disjoint lifetimes,
+   * grown to the largest of them. Images go into the free slot that fits
+   * them most tightly, or the largest free slot if none fits.
+   */
+  struct
+  Slot
+  {
+    VkMemoryRequirements requirements;
+    size_type            lastPass;
+    ResourceId           occupant;
+  };
+
+  std::vector<Slot>      slots;
+  std::vector<size_type> slotOfImage(mResources.size(), notUsed);
+
+  VkDevice const device{ mDevice->getVkDevice() };
+
+  for(ResourceId const r : transients)
+  {
+    Resource& resource{ mResources[r] };
+
+    resource.images.assign(mNumFrames, VK_NULL_HANDLE);
+    resource.imageViews.assign(mNumFrames, VK_NULL_HANDLE);
+
+    VkImageCreateInfo imageInfo{};
+
+    imageInfo.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType     = VK_IMAGE_TYPE_2D;
+    imageInfo.format        = resource.format;
+    imageInfo.extent        = { resource.extent.width,
+                                resource.extent.height,
+                                1 };
+    imageInfo.mipLevels     = 1;
+    imageInfo.arrayLayers   = 1;
+    imageInfo.samples       = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage         = usages[r];
+    imageInfo.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    for(VkImage& image : resource.images)
+    {
+      if(vkCreateImage(device, &imageInfo, nullptr, &image) not_eq VK_SUCCESS)
+      {
+        DEBUG_CALLBACK(error,
+                       "Failed to create the transient image " +
+                       resource.name + ".",
+                       vkCreateImage);
+
+        return failure;
+      }
+    }
+
+    // Images of all frames are created alike and have the same requirements.
+    VkMemoryRequirements requirements;
+
+    vkGetImageMemoryRequirements(device, resource.images[0], &requirements);
+
+    ++mStatistics.numTransientImages;
+    mStatistics.unaliasedTransientBytes += requirements.size;
+
+    size_type best{ slots.size() };
+
+    for(size_type s{ 0 }; s < slots.size(); ++s)
+    {
+      Slot const& slot{ slots[s] };
+
+      bool const isFree{ slot.lastPass < firstPass[r] and
+                         (slot.requirements.memoryTypeBits bitand
+                          requirements.memoryTypeBits) not_eq 0 };
+
+      if(not isFree)
+      {
+        continue;
+      }
+
+      if(best is_eq slots.size())
+      {
+        best = s;
+
+        continue;
+      }
+
+      VkDeviceSize const size{ slot.requirements.size };
+      VkDeviceSize const bestSize{ slots[best].requirements.size };
+
+      bool const fits{ size >= requirements.size };
+      bool const bestFits{ bestSize >= requirements.size };
+
+      if((fits and (not bestFits or (size < bestSize))) or
+         (not fits and not bestFits and (size > bestSize)))
+      {
+        best = s;
+      }
+    }
+
+    if(best is_eq slots.size())
+    {
+      slots.push_back({ requirements, lastPass[r], r });
+    }
+    else
+    {
+      Slot& slot{ slots[best] };
+
+      resource.aliased = slot.occupant;
+
+      slot.requirements.size = std::max(slot.requirements.size,
+                                        requirements.size);
+      slot.requirements.alignment = std::max(slot.requirements.alignment,
+                                             requirements.alignment);
+      slot.requirements.memoryTypeBits &= requirements.memoryTypeBits;
+      slot.lastPass = lastPass[r];
+      slot.occupant = r;
+    }
+
+    slotOfImage[r] = best;
+  }
+
+  mStatistics.numMemorySlots = slots.size();
+
+  AllocationInfo allocationInfo{};
+
+  allocationInfo.preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+  allocationInfo.isLinear       = false;
+
+  mTransientMemory.assign(mNumFrames, std::vector<Allocation>(slots.size()));
+
+  for(std::vector<Allocation>& frameMemory : mTransientMemory)
+  {
+    for(size_type s{ 0 }; s < slots.size(); ++s)
+    {
+      if(mAllocator->allocate(slots[s].requirements,
+                              allocationInfo,
+                              frameMemory[s]) is_eq failure)
+      {
+        DEBUG_CALLBACK(error,
+                       "Failed to allocate memory for transient images.",
+                       MemoryAllocator::allocate);
+
+        return failure;
+      }
+    }
+  }
+
+  for(Slot const& slot : slots)
+  {
+    mStatistics.transientBytes += slot.requirements.size;
+  }
+
+  for(ResourceId const r : transients)
+  {
+    Resource& resource{ mResources[r] };
+
+    for(size_type f{ 0 }; f < mNumFrames; ++f)
+    {
+      Allocation const& memory{ mTransientMemory[f][slotOfImage[r]] };
+
+      VkResult result{ vkBindImageMemory(device,
+                                         resource.images[f],
+                                         memory.memory,
+                                         memory.offset) };
+
+      if(result not_eq VK_SUCCESS)
+      {
+        DEBUG_CALLBACK(error,
+                       "Failed to bind the memory of a transient image.",
+                       vkBindImageMemory);
+
+        return failure;
+      }
+
+      VkImageViewCreateInfo viewInfo{};
+
+      viewInfo.sType                       =
+        VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+      viewInfo.image                       = resource.images[f];
+      viewInfo.viewType                    = VK_IMAGE_VIEW_TYPE_2D;
+      viewInfo.format                      = resource.format;
+      viewInfo.subresourceRange.aspectMask = resource.aspect;
+      viewInfo.subresourceRange.levelCount = 1;
+      viewInfo.subresourceRange.layerCount = 1;
+
+      result = vkCreateImageView(device,
+                                 &viewInfo,
+                                 nullptr,
+                                 &resource.imageViews[f]);
+
+      if(result not_eq VK_SUCCESS)
+      {
+        DEBUG_CALLBACK(error,
+                       "Failed to create the view of a transient image.",
+                       vkCreateImageView);
+
+        return failure;
+      }
+    }
+  }
+
+  return success;
+}
+
+void
+so::vk::RenderGraph::compileBarriers()
+{
+  mImageBarrierResources.clear();
+  mImageBarriers.clear();
+  mBufferBarrierResources.clear();
+  mBufferBarriers.clear();
+
+  std::vector<ResourceState> states(mResources.size());
+
+  for(size_type r{ 0 }; r < mResources.size(); ++r)
+  {
+    if(mResources[r].kind is_eq ResourceKind::importedImage)
+    {
+      states[r].layout      = mResources[r].initialLayout;
+      states[r].writeStages = mResources[r].initialStages;
+    }
+  }
+
+  for(Pass& pass : mPasses)
+  {
+    pass.barriers = BarrierBatch{};
+
+    if(not pass.isEnabled)
+    {
+      continue;
+    }
+
+    BarrierBatch& batch{ pass.barriers };
+
+    batch.firstImageBarrier  = mImageBarriers.size();
+    batch.firstBufferBarrier = mBufferBarriers.size();
+
+    for(PassAccess const& access : pass.accesses)
+    {
+      ResourceState& state{ states[access.resource] };
+
+      ResourceId const aliased{ mResources[access.resource].aliased };
+
+      // Wait for the last use of the memory by the image before.
+      if(not state.isUsed and (aliased not_eq invalidId))
+      {
+        state.writeStages = states[aliased].writeStages bitor
+                            states[aliased].readStages;
+        state.writeAccess = states[aliased].writeAccess;
+      }
+
+      state.isUsed = true;
+
+      addBarrier(access.resource, access.access, state, batch);
+    }
+
+    batch.numImageBarriers  = mImageBarriers.size() -
+                              batch.firstImageBarrier;
+    batch.numBufferBarriers = mBufferBarriers.size() -
+                              batch.firstBufferBarrier;
+
+    if(batch.dstStages not_eq 0)
+    {
+      ++mStatistics.numBarrierCalls;
+    }
+  }
+
+  mFinalBarriers = BarrierBatch{};
+
+  mFinalBarriers.firstImageBarrier  = mImageBarriers.size();
+  mFinalBarriers.firstBufferBarrier = mBufferBarriers.size();
+
+  for(ResourceId r{ 0 }; r < mResources.size(); ++r)
+  {
+    Resource      const& resource{ mResources[r] };
+    ResourceState const& state{ states[r] };
+
+    if((resource.kind not_eq ResourceKind::importedImage) or
+       (resource.finalLayout is_eq VK_IMAGE_LAYOUT_UNDEFINED) or
+       (resource.finalLayout is_eq state.layout))
+    {
+      continue;
+    }
+
+    VkImageMemoryBarrier barrier{};
+
+    barrier.sType                           =
+      VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask                   = state.writeAccess;
+    barrier.dstAccessMask                   = 0;
+    barrier.oldLayout                       = state.layout;
+    barrier.newLayout                       = resource.finalLayout;
+    barrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    barrier.subresourceRange.aspectMask     = resource.aspect;
+    barrier.subresourceRange.levelCount     = VK_REMAINING_MIP_LEVELS;
+    barrier.subresourceRange.layerCount     = VK_REMAINING_ARRAY_LAYERS;
+
+    mImageBarrierResources.push_back(r);
+    mImageBarriers.push_back(barrier);
+
+    mFinalBarriers.srcStages |= state.writeStages bitor state.readStages;
+    mFinalBarriers.dstStages |= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+  }
+
+  mFinalBarriers.numImageBarriers = mImageBarriers.size() -
+                                    mFinalBarriers.firstImageBarrier;
+
+  if(mFinalBarriers.dstStages not_eq 0)
+  {
+    ++mStatistics.numBarrierCalls;
+  }
+
+  mStatistics.numImageBarriers  = mImageBarriers.size();
+  mStatistics.numBufferBarriers = mBufferBarriers.size();
+}
+
+void
+so::vk::RenderGraph::addBarrier(ResourceId     const  resource,
+                                ResourceAccess const  access,
+                                ResourceState&        state,
+                                BarrierBatch&         batch)
+{
+  AccessInfo const accessInfo{ getAccessInfo(access) };
+
+  bool const isImage
+    { mResources[resource].kind not_eq ResourceKind::importedBuffer };
+
+  VkImageLayout const oldLayout{ state.layout };
+
+  bool const changesLayout{ isImage and (oldLayout not_eq accessInfo.layout) };
+
+  VkPipelineStageFlags srcStages{ 0 };
+  VkAccessFlags        srcAccess{ 0 };
+
+  if(changesLayout or (accessInfo.writeAccess not_eq 0))
+  {
+    // Overwriting waits for earlier reads and writes, a layout transition is
+    // a write of its own.
+    srcStages = state.writeStages bitor state.readStages;
+    srcAccess = state.writeAccess;
+
+    bool const isWrite{ accessInfo.writeAccess not_eq 0 };
+
+    state.layout        = isImage ? accessInfo.layout : oldLayout;
+    state.writeStages   = accessInfo.stages;
+    state.writeAccess   = accessInfo.writeAccess;
+    state.readStages    = isWrite ? 0 : accessInfo.stages;
+    state.visibleStages = isWrite ? 0 : accessInfo.stages;
+    state.visibleAccess = isWrite ? 0 : accessInfo.access;
+  }
+  else
+  {
+    bool const isVisible
+      { (accessInfo.stages bitand compl state.visibleStages) is_eq 0 and
+        (accessInfo.access bitand compl state.visibleAccess) is_eq 0 };
+
+    if(not isVisible)
+    {
+      srcStages = state.writeStages;
+      srcAccess = state.writeAccess;
+
+      state.visibleStages |= accessInfo.stages;
+      state.visibleAccess |= accessInfo.access;
+    }
+
+    state.readStages |= accessInfo.stages;
+  }
+
+  if((srcStages is_eq 0) and not changesLayout)
+  {
+    return;
+  }
+
+  batch.srcStages |= srcStages;
+  batch.dstStages |= accessInfo.stages;
+
+  // Without a write to make available, ordering the stages is enough.
+  if((srcAccess is_eq 0) and not changesLayout)
+  {
+    return;
+  }
+
+  if(isImage)
+  {
+    VkImageMemoryBarrier barrier{};
+
+    barrier.sType                       =
+      VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask               = srcAccess;
+    barrier.dstAccessMask               = accessInfo.access;
+    barrier.oldLayout                   = oldLayout;
+    barrier.newLayout                   = accessInfo.layout;
+    barrier.srcQueueFamilyIndex         = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex         = VK_QUEUE_FAMILY_IGNORED;
+    barrier.subresourceRange.aspectMask = mResources[resource].aspect;
+    barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+    barrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+
+    mImageBarrierResources.push_back(resource);
+    mImageBarriers.push_back(barrier);
+  }
+  else
+  {
+    VkBufferMemoryBarrier barrier{};
+
+    barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask       = srcAccess;
+    barrier.dstAccessMask       = accessInfo.access;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.offset              = 0;
+    barrier.size                = VK_WHOLE_SIZE;
+
+    mBufferBarrierResources.push_back(resource);
+    mBufferBarriers.push_back(barrier);
+  }
+}
+
+so::return_t
+so::vk::RenderGraph::recordBarriers(VkCommandBuffer const  commandBuffer,
+                                    BarrierBatch    const& batch)
+{
+  if(batch.dstStages is_eq 0)
+  {
+    return success;
+  }
+
+  for(size_type b{ batch.firstImageBarrier };
+      b < batch.firstImageBarrier + batch.numImageBarriers;
+      ++b)
+  {
+    mImageBarriers[b].image = getVkImage(mImageBarrierResources[b]);
+
+    if(mImageBarriers[b].image is_eq VK_NULL_HANDLE)
+    {
+      DEBUG_CALLBACK(error,
+                     "The render graph image " +
+                     mResources[mImageBarrierResources[b]].name +
+                     " has not been set.");
+
+      return failure;
+    }
+  }
+
+  for(size_type b{ batch.firstBufferBarrier };
+      b < batch.firstBufferBarrier + batch.numBufferBarriers;
+      ++b)
+  {
+    mBufferBarriers[b].buffer = getVkBuffer(mBufferBarrierResources[b]);
+
+    if(mBufferBarriers[b].buffer is_eq VK_NULL_HANDLE)
+    {
+      DEBUG_CALLBACK(error,
+                     "The render graph buffer " +
+                     mResources[mBufferBarrierResources[b]].name +
+                     " has not been set.");
+
+      return failure;
+    }
+  }
+
+  vkCmdPipelineBarrier
+    (commandBuffer,
+     batch.srcStages not_eq 0
+       ? batch.srcStages
+       : VkPipelineStageFlags{ VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT },
+     batch.dstStages,
+     0,
+     0,
+     nullptr,
+     static_cast<uint32_t>(batch.numBufferBarriers),
+     batch.numBufferBarriers > 0 ? &mBufferBarriers[batch.firstBufferBarrier]
+                                 : nullptr,
+     static_cast<uint32_t>(batch.numImageBarriers),
+     batch.numImageBarriers > 0 ? &mImageBarriers[batch.firstImageBarrier]
+                                : nullptr);
+
+  return success;
+}
+
+void
+so::vk::RenderGraph::releaseTransientImages()
+{
+  std::vector<VkImage>     images;
+  std::vector<VkImageView> imageViews;
+
+  for(Resource& resource : mResources)
+  {
+    for(VkImage const image : resource.images)
+    {
+      if(image not_eq VK_NULL_HANDLE)
+      {
+        images.push_back(image);
+      }
+    }
+
+    for(VkImageView const imageView : resource.imageViews)
+    {
+      if(imageView not_eq VK_NULL_HANDLE)
+      {
+        imageViews.push_back(imageView);
+      }
+    }
+
+    resource.images.clear();
+    resource.imageViews.clear();
+  }
+
+  std::vector<std::vector<Allocation>> memory{ std::move(mTransientMemory) };
+
+  mTransientMemory.clear();
+
+  if(images.empty() and imageViews.empty() and memory.empty())
+  {
+    return;
+  }
+
+  DeletionQueue::deleter_t deleter
+    { [device    = mDevice,
+       allocator = mAllocator,
+       images,
+       imageViews,
+       memory]() mutable
+      {
+        VkDevice const vkDevice{ device->getVkDevice() };
+
+        for(VkImageView const imageView : imageViews)
+        {
+          vkDestroyImageView(vkDevice, imageView, nullptr);
+        }
+
+        for(VkImage const image : images)
+        {
+          vkDestroyImage(vkDevice, image, nullptr);
+        }
+
+        for(std::vector<Allocation>& frameMemory : memory)
+        {
+          for(Allocation& allocation : frameMemory)
+          {
+            if(allocation.isValid())
+            {
+              allocator->free(allocation);
+            }
+          }
+        }
+      } };
+
+  if(mDeletionQueue not_eq nullptr)
+  {
+    mDeletionQueue->push(std::move(deleter));
+  }
+  else
+  {
+    deleter();
+  }
+}
@@ -0,0 +1,359 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      soVkRenderGraph.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "soVkDeletionQueue.hpp"
+#include "soVkLogicalDevice.hpp"
+#include "soVkMemoryAllocator.hpp"
+
+#include "cxx/soDefinitions.hpp"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace so {
+namespace vk {
+
+/**
+ * @brief How a pass uses a resource. Determines the pipeline stages, access
+ *        flags and, for images, the layout and usage.
+ */
+enum class
+ResourceAccess
+{
+  colorAttachmentWrite,        // Image.
+  depthStencilAttachmentWrite, // Image.
+  depthStencilAttachmentRead,  // Image.
+  vertexShaderRead,
+  fragmentShaderRead,
+  computeShaderRead,
+  computeShaderWrite,          // Storage image in GENERAL layout or buffer.
+  transferRead,
+  transferWrite,
+  indirectRead,                // Buffer.
+  vertexInputRead              // Buffer, vertices or indices.
+};
+
+struct
+PassAccess
+{
+  uint32_t       resource;
+  ResourceAccess access;
+};
+
+/**
+ * @brief What the last RenderGraph::compile produced. Byte counts are per
+ *        frame in flight.
+ */
+struct
+RenderGraphStatistics
+{
+  size_type    numEnabledPasses{ 0 };
+  size_type    numBarrierCalls{ 0 };
+  size_type    numImageBarriers{ 0 };
+  size_type    numBufferBarriers{ 0 };
+  size_type    numTransientImages{ 0 };
+  size_type    numMemorySlots{ 0 };
+  VkDeviceSize transientBytes{ 0 };
+  VkDeviceSize unaliasedTransientBytes{ 0 };
+}; // struct RenderGraphStatistics
+
+/**
+ * @brief Records passes in order and derives the barriers between them from
+ *        the resource accesses they declare.
+ *
+ * compile() walks the enabled passes once and tracks, per resource, the
+ * layout and the last write and reads. A pass only waits if it changes the
+ * layout, reads or overwrites a write that is not yet visible to it, or
+ * overwrites earlier reads, in which case an execution dependency suffices.
+ * All barriers a pass needs are merged into a single vkCmdPipelineBarrier
+ * before it, and imported images get into their final layout with one more
+ * call after the last pass.
+ *
+ * Transient images are owned by the graph and only live from the first to
+ * the last enabled pass using them. Images whose lifetimes do not overlap
+ * share memory; the first use of an image in shared memory waits for the
+ * last use of the previous one and discards its contents. Every frame in
+ * flight has its own transient images.
+ */
+class
+RenderGraph
+{
+  public:
+    using ResourceId = uint32_t;
+    using PassId     = uint32_t;
+    using record_t   = std::function<return_t(VkCommandBuffer)>;
+
+    static constexpr uint32_t invalidId{ ~0u };
+
+    RenderGraph();
+
+    RenderGraph(RenderGraph const& other) = delete;
+
+    RenderGraph(RenderGraph&& other) = delete;
+
+    ~RenderGraph() noexcept;
+
+    RenderGraph&
+    operator=(RenderGraph const& other) = delete;
+
+    RenderGraph&
+    operator=(RenderGraph&& other) = delete;
+
+    return_t
+    initialize(SharedPtrLogicalDevice   const& device,
+               SharedPtrMemoryAllocator const& allocator,
+               DeletionQueue&                  deletionQueue,
+               size_type                const  numFramesInFlight);
+
+    /**
+     * @brief Drops all passes and resources. Transient images are destroyed
+     *        once the frames using them have completed.
+     */
+    void
+    clear();
+
+    /**
+     * @brief Adds an image created outside of the graph, e.g. a swap chain
+     *        image. Its handle is set per frame with setImage.
+     *
+     * @param initialStages Stages the first pass has to wait for, e.g. those
+     *                      waiting for the semaphore of an acquired image.
+     * @param finalLayout   Layout after the last pass, UNDEFINED to keep the
+     *                      layout of the last pass.
+     */
+    ResourceId
+    importImage(std::string          const& name,
+                VkImageAspectFlags   const  aspect,
+                VkImageLayout        const  initialLayout,
+                VkPipelineStageFlags const  initialStages,
+                VkImageLayout        const  finalLayout);
+
+    /**
+     * @brief Adds a buffer created outside of the graph. Accesses of earlier
+     *        submissions have to be synchronized by the caller.
+     */
+    ResourceId
+    importBuffer(std::string const& name);
+
+    /**
+     * @brief Adds a 2D image with a single mip level owned by the graph. Its
+     *        usage is derived from the accesses of the passes.
+     */
+    ResourceId
+    createImage(std::string        const& name,
+                VkFormat           const  format,
+                VkExtent2D         const  extent,
+                VkImageAspectFlags const  aspect);
+
+    /**
+     * @brief Adds a pass recorded by record, which may look up the handles of
+     *        the resources of the executing frame with getVkImage and the
+     *        like. A pass must access each resource at most once.
+     */
+    PassId
+    addPass(std::string             const& name,
+            std::vector<PassAccess>        accesses,
+            record_t                       record);
+
+    void
+    setPassEnabled(PassId const pass, bool const enabled);
+
+    bool
+    isPassEnabled(PassId const pass) const;
+
+    void
+    setImage(ResourceId  const resource,
+             VkImage     const image,
+             VkImageView const imageView = VK_NULL_HANDLE);
+
+    void
+    setBuffer(ResourceId const resource, VkBuffer const buffer);
+
+    /**
+     * @brief Derives the barriers and creates the transient images. Called by
+     *        execute if passes or resources changed since.
+     */
+    return_t
+    compile();
+
+    /**
+     * @brief Records the enabled passes with their barriers. The previous
+     *        submission of frame has to be finished.
+     */
+    return_t
+    execute(VkCommandBuffer const commandBuffer, index_t const frame);
+
+    VkImage
+    getVkImage(ResourceId const resource) const;
+
+    VkImageView
+    getVkImageView(ResourceId const resource) const;
+
+    VkBuffer
+    getVkBuffer(ResourceId const resource) const;
+
+    inline RenderGraphStatistics const& getStatistics() const
+    { return mStatistics; }
+
+  private:
+    enum class
+    ResourceKind
+    {
+      importedImage,
+      importedBuffer,
+      transientImage
+    };
+
+    struct
+    Resource
+    {
+      std::string              name;
+      ResourceKind             kind;
+      VkImageAspectFlags       aspect;
+      VkImageLayout            initialLayout;
+      VkPipelineStageFlags     initialStages;
+      VkImageLayout            finalLayout;
+      VkFormat                 format;
+      VkExtent2D               extent;
+
+      VkImage                  image;
+      VkImageView              imageView;
+      VkBuffer                 buffer;
+
+      // Per frame in flight, transient images only.
+      std::vector<VkImage>     images;
+      std::vector<VkImageView> imageViews;
+
+      // The transient image that used the memory before, invalidId if none.
+      ResourceId               aliased;
+    }; // struct Resource
+
+    /**
+     * The barriers recorded with one vkCmdPipelineBarrier.
+     */
+    struct
+    BarrierBatch
+    {
+      VkPipelineStageFlags srcStages{ 0 };
+      VkPipelineStageFlags dstStages{ 0 };
+      size_type            firstImageBarrier{ 0 };
+      size_type            numImageBarriers{ 0 };
+      size_type            firstBufferBarrier{ 0 };
+      size_type            numBufferBarriers{ 0 };
+    }; // struct BarrierBatch
+
+    struct
+    Pass
+    {
+      std::string             name;
+      std::vector<PassAccess> accesses;
+      record_t                record;
+      bool                    isEnabled;
+      BarrierBatch            barriers;
+    }; // struct Pass
+
+    struct
+    ResourceState;
+
+    SharedPtrLogicalDevice          mDevice;
+    SharedPtrMemoryAllocator        mAllocator;
+    DeletionQueue*                  mDeletionQueue;
+    size_type                       mNumFrames;
+
+    std::vector<Resource>           mResources;
+    std::vector<Pass>               mPasses;
+    BarrierBatch                    mFinalBarriers;
+
+    // Handles are patched in by execute, from the resource of each barrier.
+    std::vector<ResourceId>         mImageBarrierResources;
+    std::vector<VkImageMemoryBarrier> mImageBarriers;
+    std::vector<ResourceId>         mBufferBarrierResources;
+    std::vector<VkBufferMemoryBarrier> mBufferBarriers;
+
+    // Per frame in flight, the memory shared by transient images.
+    std::vector<std::vector<Allocation>> mTransientMemory;
+
+    index_t                         mFrame;
+    bool                            mIsDirty;
+
+    RenderGraphStatistics           mStatistics;
+
+    bool
+    isValid(Pass const& pass) const;
+
+    return_t
+    createTransientImages();
+
+    void
+    compileBarriers();
+
+    void
+    addBarrier(ResourceId     const  resource,
+               ResourceAccess const  access,
+               ResourceState&        state,
+               BarrierBatch&         batch);
+
+    return_t
+    recordBarriers(VkCommandBuffer const  commandBuffer,
+                   BarrierBatch    const& batch);
+
+    /**
+     * @brief Hands the transient images and their memory to the deletion
+     *        queue.
+     */
+    void
+    releaseTransientImages();
+};
+
+} // namespace vk
+} // namespace so
@@ -100,8 +100,9 @@ so::vk::RenderPass::initializeMembers(SwapChain const& swapChain)
   colorAttachment.storeOp 			 = VK_ATTACHMENT_STORE_OP_STORE;
 	colorAttachment.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 	colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-  colorAttachment.initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
-  colorAttachment.finalLayout 	 = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+  // The render graph transitions the swap chain image around the pass.
+  colorAttachment.initialLayout  = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+  colorAttachment.finalLayout 	 = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
 	VkAttachmentReference colorAttachmentRef{};
 
@@ -114,16 +115,6 @@ so::vk::RenderPass::initializeMembers(SwapChain const& swapChain)
 	subpass.colorAttachmentCount = 1;
   subpass.pColorAttachments 	 = &colorAttachmentRef;
 
-  VkSubpassDependency dependency{};
-
-  dependency.srcSubpass    = VK_SUBPASS_EXTERNAL;
-  dependency.dstSubpass    = 0;
-  dependency.srcStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-  dependency.srcAccessMask = 0;
-  dependency.dstStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;  
-  dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT bitor
-                             VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
 	VkRenderPassCreateInfo renderPassInfo{};
 
   renderPassInfo.sType 					 = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -131,8 +122,6 @@ so::vk::RenderPass::initializeMembers(SwapChain const& swapChain)
   renderPassInfo.pAttachments 	 = &colorAttachment;
   renderPassInfo.subpassCount 	 = 1;
   renderPassInfo.pSubpasses 		 = &subpass;
-  renderPassInfo.dependencyCount = 1;
-  renderPassInfo.pDependencies   = &dependency;
 
 	auto vkDevice{ mDevice->getVkDevice() };
  
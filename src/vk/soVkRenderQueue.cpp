@@ -0,0 +1,576 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "soVkRenderQueue.hpp"
+
+#include "cxx/soDebugCallback.hpp"
+#include "cxx/soProfiler.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace {
+
+struct
+InstanceDescriptors
+{
+  VkDescriptorBufferInfo instances;
+  VkDescriptorBufferInfo frame;
+};
+
+// Bits of each field of a sort key, from the most significant ones.
+uint32_t const passBits{ 4 };
+uint32_t const pipelineBits{ 12 };
+uint32_t const materialBits{ 16 };
+uint32_t const meshBits{ 12 };
+uint32_t const depthBits{ 20 };
+
+static_assert(passBits + pipelineBits + materialBits + meshBits + depthBits
+                is_eq 64,
+              "The fields of a sort key have to fill 64 bits.");
+
+VkDeviceSize
+alignUp(VkDeviceSize const value, VkDeviceSize const alignment)
+{
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+/*
+ * Maps a float to an unsigned integer with the same order, so negative depths
+ * sort before positive ones.
+ */
+uint32_t
+getOrderedBits(float const value)
+{
+  uint32_t bits;
+
+  std::memcpy(&bits, &value, sizeof(bits));
+
+  return (bits bitand 0x80000000u) not_eq 0 ? ~bits : bits bitor 0x80000000u;
+}
+
+bool
+isSameDraw(so::vk::RenderItem const& lhs, so::vk::RenderItem const& rhs)
+{
+  return lhs.pass        is_eq rhs.pass     and
+         lhs.pipeline    is_eq rhs.pipeline and
+         lhs.material    is_eq rhs.material and
+         lhs.materialSet is_eq rhs.materialSet and
+         lhs.mesh        is_eq rhs.mesh     and
+         lhs.subMesh     is_eq rhs.subMesh;
+}
+
+} // namespace
+
+so::vk::RenderQueue::RenderQueue()
+  : mDevice(LogicalDevice::getSharedPtrNullDevice()),
+    mAllocator(MemoryAllocator::getSharedPtrNullMemoryAllocator()),
+    mDescriptorAllocator(nullptr),
+    mDeletionQueue(nullptr),
+    mInstanceSetLayout(),
+    mPipelines(),
+    mItems(),
+    mSortEntries(),
+    mSortScratch(),
+    mBatches(),
+    mMeshIds(),
+    mNumMeshIds(0),
+    mInstanceBuffer(),
+    mFrameUniforms(),
+    mRegionSize(0),
+    mCapacity(0),
+    mNumFrames(0),
+    mStatistics()
+{}
+
+so::return_t
+so::vk::RenderQueue::initialize
+  (SharedPtrLogicalDevice   const& device,
+   SharedPtrMemoryAllocator const& allocator,
+   DescriptorAllocator&            descriptorAllocator,
+   DeletionQueue&                  deletionQueue,
+   size_type                const  numFramesInFlight)
+{
+  mDevice              = device;
+  mAllocator           = allocator;
+  mDescriptorAllocator = &descriptorAllocator;
+  mDeletionQueue       = &deletionQueue;
+  mNumFrames           = numFramesInFlight;
+
+  mPipelines.clear();
+  mItems.clear();
+
+  mInstanceBuffer = Buffer{};
+  mRegionSize     = 0;
+  mCapacity       = 0;
+
+  DescriptorBinding instances;
+
+  instances.binding = 0;
+  instances.type    = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+  instances.stages  = VK_SHADER_STAGE_VERTEX_BIT;
+  instances.offset  = offsetof(InstanceDescriptors, instances);
+
+  DescriptorBinding frame;
+
+  frame.binding = 1;
+  frame.type    = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+  frame.stages  = VK_SHADER_STAGE_VERTEX_BIT;
+  frame.offset  = offsetof(InstanceDescriptors, frame);
+
+  if(mFrameUniforms.initialize(mAllocator, mNumFrames, 1) is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to create the render queue frame uniforms.",
+                   DynamicUniformBuffer<RenderQueueFrameUniforms>::initialize);
+
+    return failure;
+  }
+
+  if(mInstanceSetLayout.initialize(mDevice,
+                                   { instances, frame }) is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to create the render queue descriptor set "
+                   "layout.",
+                   DescriptorSetLayout::initialize);
+
+    return failure;
+  }
+
+  return success;
+}
+
+uint32_t
+so::vk::RenderQueue::addPipeline(Pipeline const& pipeline)
+{
+  if(mPipelines.size() >= maxPipelines)
+  {
+    DEBUG_CALLBACK(error, "The render queue holds too many pipelines.");
+
+    return maxPipelines;
+  }
+
+  mPipelines.push_back(&pipeline);
+
+  return static_cast<uint32_t>(mPipelines.size() - 1);
+}
+
+void
+so::vk::RenderQueue::clearPipelines()
+{
+  mPipelines.clear();
+  mItems.clear();
+}
+
+void
+so::vk::RenderQueue::clear()
+{
+  mItems.clear();
+}
+
+void
+so::vk::RenderQueue::submit(RenderItem const& item)
+{
+  bool const isValid{ item.pass     < maxPasses         and
+                      item.pipeline < mPipelines.size() and
+                      item.material < maxMaterials      and
+                      item.mesh     not_eq nullptr      and
+                      item.subMesh  < item.mesh->getSubMeshes().size() };
+
+  if(not isValid)
+  {
+    DEBUG_CALLBACK(error, "Dropped an invalid render item.");
+
+    return;
+  }
+
+  mItems.push_back(item);
+}
+
+so::return_t
+so::vk::RenderQueue::record(VkCommandBuffer       const  commandBuffer,
+                            index_t               const  frame,
+                            VkFramebuffer         const  framebuffer,
+                            RenderPass            const& renderPass,
+                            SwapChain             const& swapChain,
+                            std::array<float, 16> const& viewProjection)
+{
+  SO_PROFILE_ZONE("RenderQueue::record");
+
+  mStatistics          = RenderQueueStatistics{};
+  mStatistics.numItems = mItems.size();
+
+  sortItems();
+  buildBatches();
+
+  VkDescriptorSet instanceSet{ VK_NULL_HANDLE };
+
+  // Every frame in flight has its own region, selected by a dynamic offset.
+  uint32_t const frameOffset{ mFrameUniforms.getDynamicOffset(frame, 0) };
+
+  if(not mItems.empty())
+  {
+    mFrameUniforms[0].viewProjection = viewProjection;
+
+    if(writeInstances(frame) is_eq failure or
+       mFrameUniforms.flush(frame, 1) is_eq failure)
+    {
+      return failure;
+    }
+
+    InstanceDescriptors descriptors{};
+
+    descriptors.instances = { mInstanceBuffer.getVkBuffer(),
+                              static_cast<VkDeviceSize>(frame) * mRegionSize,
+                              mRegionSize };
+    descriptors.frame     = mFrameUniforms.getVkDescriptorBufferInfo();
+
+    if(mDescriptorAllocator->allocate(mInstanceSetLayout,
+                                      &descriptors,
+                                      instanceSet) is_eq failure)
+    {
+      DEBUG_CALLBACK(error,
+                     "Failed to allocate the render queue descriptor set.",
+                     DescriptorAllocator::allocate);
+
+      return failure;
+    }
+  }
+
+  VkRenderPassBeginInfo renderPassInfo{};
+
+  renderPassInfo.sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+  renderPassInfo.renderPass        = renderPass.getVkRenderPass();
+  renderPassInfo.framebuffer       = framebuffer;
+  renderPassInfo.renderArea.offset = { 0, 0 };
+  renderPassInfo.renderArea.extent = swapChain.getVkExtent();
+
+  VkClearValue clearColor{ 0.0f, 0.0f, 0.0f, 1.0f };
+
+  renderPassInfo.clearValueCount   = 1;
+  renderPassInfo.pClearValues      = &clearColor;
+
+  vkCmdBeginRenderPass(commandBuffer,
+                       &renderPassInfo,
+                       VK_SUBPASS_CONTENTS_INLINE);
+
+  VkViewport viewport{};
+
+  viewport.width    = static_cast<float>(swapChain.getVkExtent().width);
+  viewport.height   = static_cast<float>(swapChain.getVkExtent().height);
+  viewport.maxDepth = 1.0f;
+
+  VkRect2D scissor{};
+
+  scissor.extent = swapChain.getVkExtent();
+
+  vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+  vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+  recordBatches(commandBuffer, instanceSet, frameOffset);
+
+  vkCmdEndRenderPass(commandBuffer);
+
+  return success;
+}
+
+uint64_t
+so::vk::RenderQueue::getSortKey(RenderItem const& item, uint32_t const meshId)
+{
+  uint32_t const lowBits{ meshBits + depthBits };
+
+  uint64_t const state
+    { (static_cast<uint64_t>(item.pass)
+         << (pipelineBits + materialBits + lowBits)) bitor
+      (static_cast<uint64_t>(item.pipeline) << (materialBits + lowBits)) bitor
+      (static_cast<uint64_t>(item.material) << lowBits) };
+
+  if(item.isTranslucent)
+  {
+    return state bitor getOrderedBits(item.depth);
+  }
+
+  return state bitor
+         (static_cast<uint64_t>(meshId) << depthBits) bitor
+         (getOrderedBits(item.depth) >> (lowBits - depthBits));
+}
+
+uint32_t
+so::vk::RenderQueue::getMeshId(RenderItem const& item)
+{
+  auto const inserted{ mMeshIds.emplace(item.mesh, mNumMeshIds) };
+
+  if(inserted.second)
+  {
+    mNumMeshIds += static_cast<uint32_t>(item.mesh->getSubMeshes().size());
+  }
+
+  return std::min(inserted.first->second + item.subMesh, maxMeshIds - 1);
+}
+
+void
+so::vk::RenderQueue::sortItems()
+{
+  SO_PROFILE_ZONE("RenderQueue::sortItems");
+
+  size_type const numItems{ mItems.size() };
+
+  mSortEntries.resize(numItems);
+  mSortScratch.resize(numItems);
+
+  mMeshIds.clear();
+  mNumMeshIds = 0;
+
+  for(size_type i{ 0 }; i < numItems; ++i)
+  {
+    RenderItem const& item{ mItems[i] };
+
+    mSortEntries[i] = { getSortKey(item, getMeshId(item)),
+                        static_cast<uint32_t>(i) };
+  }
+
+  // Least significant digit first, one byte per pass. Every pass is stable,
+  // so items with equal keys keep their submission order. Passes over a
+  // byte all keys share, e.g. the pass of a single pass frame, are skipped.
+  for(uint32_t shift{ 0 }; shift < 64; shift += 8)
+  {
+    std::array<size_type, 256> offsets{};
+
+    for(auto const& entry : mSortEntries)
+    {
+      ++offsets[(entry.key >> shift) bitand 0xffu];
+    }
+
+    bool const isConstant
+      { std::any_of(offsets.begin(),
+                    offsets.end(),
+                    [numItems](size_type const count)
+                    { return count is_eq numItems; }) };
+
+    if(isConstant)
+    {
+      continue;
+    }
+
+    size_type sum{ 0 };
+
+    for(auto& offset : offsets)
+    {
+      size_type const count{ offset };
+
+      offset  = sum;
+      sum    += count;
+    }
+
+    for(auto const& entry : mSortEntries)
+    {
+      mSortScratch[offsets[(entry.key >> shift) bitand 0xffu]++] = entry;
+    }
+
+    mSortEntries.swap(mSortScratch);
+  }
+}
+
+void
+so::vk::RenderQueue::buildBatches()
+{
+  mBatches.clear();
+
+  for(size_type i{ 0 }; i < mSortEntries.size(); ++i)
+  {
+    RenderItem const& item{ mItems[mSortEntries[i].item] };
+
+    if(not mBatches.empty() and isSameDraw(*mBatches.back().item, item))
+    {
+      ++mBatches.back().instanceCount;
+    }
+    else
+    {
+      mBatches.push_back({ &item, static_cast<uint32_t>(i), 1 });
+    }
+  }
+}
+
+so::return_t
+so::vk::RenderQueue::reserve(size_type const numInstances)
+{
+  if(numInstances <= mCapacity)
+  {
+    return success;
+  }
+
+  size_type const capacity{ std::max({ numInstances,
+                                       2 * mCapacity,
+                                       size_type{ 256 } }) };
+
+  VkDeviceSize const alignment
+    { std::max(mDevice->getVkPhysicalDeviceProperties()
+                 .limits.minStorageBufferOffsetAlignment,
+               VkDeviceSize{ 4 }) };
+
+  VkDeviceSize const regionSize{ alignUp(capacity * sizeof(MeshInstance),
+                                         alignment) };
+
+  // Written every frame and read once per vertex.
+  AllocationInfo hostVisible{};
+
+  hostVisible.requiredFlags  = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+  hostVisible.preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+  // Frames in flight may still read the regions of the old buffer.
+  mDeletionQueue->retire(std::move(mInstanceBuffer));
+
+  mCapacity   = 0;
+  mRegionSize = 0;
+
+  return_t const result
+    { mInstanceBuffer.initialize(mAllocator,
+                                 regionSize * mNumFrames,
+                                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                 hostVisible) };
+
+  if(result is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to create the render queue instance buffer.",
+                   Buffer::initialize);
+
+    return failure;
+  }
+
+  mCapacity   = capacity;
+  mRegionSize = regionSize;
+
+  return success;
+}
+
+so::return_t
+so::vk::RenderQueue::writeInstances(index_t const frame)
+{
+  if(reserve(mItems.size()) is_eq failure)
+  {
+    return failure;
+  }
+
+  VkDeviceSize const offset{ static_cast<VkDeviceSize>(frame) * mRegionSize };
+
+  auto* const instances
+    { reinterpret_cast<MeshInstance*>
+        (static_cast<char*>(mInstanceBuffer.getMappedData()) + offset) };
+
+  for(size_type i{ 0 }; i < mSortEntries.size(); ++i)
+  {
+    RenderItem const& item{ mItems[mSortEntries[i].item] };
+
+    MeshInstance instance{};
+
+    instance.transform = item.transform;
+    instance.subMesh   = item.subMesh;
+
+    std::memcpy(instances + i, &instance, sizeof(instance));
+  }
+
+  return mInstanceBuffer.flush(offset,
+                               mSortEntries.size() * sizeof(MeshInstance));
+}
+
+void
+so::vk::RenderQueue::recordBatches(VkCommandBuffer const commandBuffer,
+                                   VkDescriptorSet const instanceSet,
+                                   uint32_t        const frameOffset)
+{
+  Pipeline const* boundPipeline{ nullptr };
+  VkDescriptorSet boundMaterialSet{ VK_NULL_HANDLE };
+  Mesh const*     boundMesh{ nullptr };
+
+  for(auto const& batch : mBatches)
+  {
+    RenderItem const& item{ *batch.item };
+    Pipeline   const& pipeline{ *mPipelines[item.pipeline] };
+
+    VkPipelineLayout const pipelineLayout{ pipeline.getVkPipelineLayout() };
+
+    if(&pipeline not_eq boundPipeline)
+    {
+      vkCmdBindPipeline(commandBuffer,
+                        VK_PIPELINE_BIND_POINT_GRAPHICS,
+                        pipeline.getVkPipeline());
+
+      // Layouts of different pipelines need not be compatible, so the sets
+      // are bound again.
+      vkCmdBindDescriptorSets(commandBuffer,
+                              VK_PIPELINE_BIND_POINT_GRAPHICS,
+                              pipelineLayout,
+                              0,
+                              1,
+                              &instanceSet,
+                              1,
+                              &frameOffset);
+
+      boundPipeline    = &pipeline;
+      boundMaterialSet = VK_NULL_HANDLE;
+
+      ++mStatistics.numPipelineBinds;
+      ++mStatistics.numDescriptorSetBinds;
+    }
+
+    if((item.materialSet not_eq VK_NULL_HANDLE) and
+       (item.materialSet not_eq boundMaterialSet))
+    {
+      vkCmdBindDescriptorSets(commandBuffer,
+                              VK_PIPELINE_BIND_POINT_GRAPHICS,
+                              pipelineLayout,
+                              1,
+                              1,
+                              &item.materialSet,
+                              0,
+                              nullptr);
+
+      boundMaterialSet = item.materialSet;
+
+      ++mStatistics.numDescriptorSetBinds;
+    }
+
+    if(item.mesh not_eq boundMesh)
+    {
+      item.mesh->bind(commandBuffer);
+
+      boundMesh = item.mesh;
+
+      ++mStatistics.numMeshBinds;
+    }
+
+    SubMesh const& subMesh{ item.mesh->getSubMeshes()[item.subMesh] };
+
+    vkCmdDrawIndexed(commandBuffer,
+                     subMesh.indexCount,
+                     batch.instanceCount,
+                     subMesh.firstIndex,
+                     subMesh.vertexOffset,
+                     batch.firstInstance);
+
+    ++mStatistics.numDraws;
+  }
+}
@@ -0,0 +1,297 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      soVkRenderQueue.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "soVkBuffer.hpp"
+#include "soVkDeletionQueue.hpp"
+#include "soVkDescriptorAllocator.hpp"
+#include "soVkDescriptorSetLayout.hpp"
+#include "soVkDynamicUniformBuffer.hpp"
+#include "soVkGpuDrivenRenderer.hpp"
+#include "soVkMesh.hpp"
+#include "soVkPipeline.hpp"
+
+#include "cxx/soDefinitions.hpp"
+
+#include <array>
+#include <unordered_map>
+#include <vector>
+
+namespace so {
+namespace vk {
+
+/**
+ * @brief A draw of one sub-mesh, as submitted to a RenderQueue.
+ */
+struct
+RenderItem
+{
+  std::array<float, 16> transform{};  // Column major model matrix.
+  Mesh const*           mesh{ nullptr };
+  uint32_t              subMesh{ 0 };
+  uint32_t              pass{ 0 };     // Below RenderQueue::maxPasses.
+  uint32_t              pipeline{ 0 }; // From RenderQueue::addPipeline.
+  uint32_t              material{ 0 }; // Below RenderQueue::maxMaterials.
+
+  // Bound at set 1 if not VK_NULL_HANDLE. Items with the same material have
+  // to use the same set.
+  VkDescriptorSet       materialSet{ VK_NULL_HANDLE };
+
+  // Ascending within a material, e.g. the view depth for front to back.
+  // Negate it to draw back to front.
+  float                 depth{ 0.0f };
+
+  // Translucent items are drawn strictly by depth within their material,
+  // opaque ones grouped by mesh first. Items of a material have to agree.
+  bool                  isTranslucent{ false };
+}; // struct RenderItem
+
+/**
+ * @brief Uniforms of a frame recorded by a RenderQueue.
+ */
+struct
+RenderQueueFrameUniforms
+{
+  std::array<float, 16> viewProjection{}; // Column major.
+}; // struct RenderQueueFrameUniforms
+
+/**
+ * @brief What the last RenderQueue::record issued.
+ */
+struct
+RenderQueueStatistics
+{
+  size_type numItems{ 0 };
+  size_type numDraws{ 0 };
+  size_type numPipelineBinds{ 0 };
+  size_type numDescriptorSetBinds{ 0 };
+  size_type numMeshBinds{ 0 };
+}; // struct RenderQueueStatistics
+
+/**
+ * @brief Sorts the draws of a frame by state and merges them into instanced
+ *        draws before they are recorded.
+ *
+ * Each submitted item gets a 64 bit key of, from the most significant bits,
+ * pass, pipeline, material, mesh and depth, and the keys are radix sorted.
+ * The mesh is a dense id of the mesh and sub-mesh of an opaque item, above
+ * the 20 most significant bits of its depth, so draws of the same mesh stay
+ * together and merge, while the depth still orders them coarsely. Translucent
+ * items use all 32 bits below the material for their depth instead. A run of
+ * sorted items with the same pipeline, material, mesh and sub-mesh becomes a
+ * single instanced vkCmdDrawIndexed, and pipelines, descriptor sets and
+ * vertex buffers are only bound when they change from one draw to the next.
+ *
+ * Model matrices are written in sorted order into a host visible storage
+ * buffer, one region per frame in flight, bound at set 0, binding 0. The
+ * RenderQueueFrameUniforms of a frame live in a DynamicUniformBuffer at
+ * binding 1, a dynamic uniform buffer whose region record selects with a
+ * dynamic offset, as in the queued shaders. Pipelines drawing items
+ * therefore have to be created with getInstanceSetLayout() at set 0.
+ */
+class
+RenderQueue
+{
+  public:
+    static constexpr uint32_t maxPasses{ 1u << 4 };
+    static constexpr uint32_t maxPipelines{ 1u << 12 };
+    static constexpr uint32_t maxMaterials{ 1u << 16 };
+    static constexpr uint32_t maxMeshIds{ 1u << 12 };
+
+    RenderQueue();
+
+    RenderQueue(RenderQueue const& other) = delete;
+
+    RenderQueue(RenderQueue&& other) = delete;
+
+    ~RenderQueue() noexcept = default;
+
+    RenderQueue&
+    operator=(RenderQueue const& other) = delete;
+
+    RenderQueue&
+    operator=(RenderQueue&& other) = delete;
+
+    return_t
+    initialize(SharedPtrLogicalDevice   const& device,
+               SharedPtrMemoryAllocator const& allocator,
+               DescriptorAllocator&            descriptorAllocator,
+               DeletionQueue&                  deletionQueue,
+               size_type                const  numFramesInFlight);
+
+    inline DescriptorSetLayout const& getInstanceSetLayout() const
+    { return mInstanceSetLayout; }
+
+    /**
+     * @brief Registers pipeline, which has to outlive the queue or the next
+     *        clearPipelines, for RenderItem::pipeline.
+     *
+     * @return The id of pipeline, maxPipelines if there are too many.
+     */
+    uint32_t
+    addPipeline(Pipeline const& pipeline);
+
+    void
+    clearPipelines();
+
+    /**
+     * @brief Drops the items of the previous frame.
+     */
+    void
+    clear();
+
+    /**
+     * @brief Queues item for the next record. Items with an invalid pass,
+     *        pipeline, material or sub-mesh are dropped with an error.
+     */
+    void
+    submit(RenderItem const& item);
+
+    inline size_type getNumItems() const { return mItems.size(); }
+
+    /**
+     * @brief Sorts and merges the items and records them in a render pass.
+     *        The command buffer has to be outside of a render pass and the
+     *        previous submission of frame finished.
+     */
+    return_t
+    record(VkCommandBuffer       const  commandBuffer,
+           index_t               const  frame,
+           VkFramebuffer         const  framebuffer,
+           RenderPass            const& renderPass,
+           SwapChain             const& swapChain,
+           std::array<float, 16> const& viewProjection);
+
+    inline RenderQueueStatistics const& getStatistics() const
+    { return mStatistics; }
+
+    /**
+     * @param meshId Dense id of the mesh and sub-mesh of item, below
+     *               maxMeshIds.
+     */
+    static uint64_t
+    getSortKey(RenderItem const& item, uint32_t const meshId);
+
+  private:
+    struct
+    SortEntry
+    {
+      uint64_t key;
+      uint32_t item;
+    }; // struct SortEntry
+
+    /**
+     * Consecutive instances drawn with one call.
+     */
+    struct
+    Batch
+    {
+      RenderItem const* item;
+      uint32_t          firstInstance;
+      uint32_t          instanceCount;
+    }; // struct Batch
+
+    SharedPtrLogicalDevice   mDevice;
+    SharedPtrMemoryAllocator mAllocator;
+    DescriptorAllocator*     mDescriptorAllocator;
+    DeletionQueue*           mDeletionQueue;
+
+    DescriptorSetLayout      mInstanceSetLayout;
+
+    std::vector<Pipeline const*> mPipelines;
+
+    std::vector<RenderItem>  mItems;
+    std::vector<SortEntry>   mSortEntries;
+    std::vector<SortEntry>   mSortScratch;
+    std::vector<Batch>       mBatches;
+
+    // First id of the sub-meshes of every mesh submitted this frame.
+    std::unordered_map<Mesh const*, uint32_t> mMeshIds;
+    uint32_t                 mNumMeshIds;
+
+    Buffer                   mInstanceBuffer;
+    DynamicUniformBuffer<RenderQueueFrameUniforms> mFrameUniforms;
+    VkDeviceSize             mRegionSize;
+    size_type                mCapacity;
+    size_type                mNumFrames;
+
+    RenderQueueStatistics    mStatistics;
+
+    /**
+     * @brief Id of the mesh and sub-mesh of item, assigned in submission
+     *        order. Ids beyond maxMeshIds share the last one.
+     */
+    uint32_t
+    getMeshId(RenderItem const& item);
+
+    void
+    sortItems();
+
+    void
+    buildBatches();
+
+    /**
+     * @brief Grows the instance buffer to hold numInstances per frame.
+     */
+    return_t
+    reserve(size_type const numInstances);
+
+    return_t
+    writeInstances(index_t const frame);
+
+    void
+    recordBatches(VkCommandBuffer const commandBuffer,
+                  VkDescriptorSet const instanceSet,
+                  uint32_t        const frameOffset);
+};
+
+} // namespace vk
+} // namespace so
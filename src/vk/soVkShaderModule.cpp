@@ -48,25 +48,14 @@ so::vk::ShaderModule::ShaderModule(SharedPtrLogicalDevice const& device,
     return;
   }
 
-  VkShaderModuleCreateInfo createInfo{};
-
-  createInfo.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-  createInfo.codeSize = shaderCode.size();
-  createInfo.pCode    = reinterpret_cast<uint32_t const*>(shaderCode.data());
-
-  VkResult const result(vkCreateShaderModule(device->getVkDevice(),
-                                             &createInfo,
-                                             nullptr,
-                                             &mShaderModule));
-
-  if(result not_eq VK_SUCCESS)
-  {
-    DEBUG_CALLBACK(error,
-                   "Failed to create shader module.",
-                   vkCreateShaderModule);
+  initializeMembers(shaderCode);
+}
 
-    mShaderModule = VK_NULL_HANDLE;
-  }
+so::vk::ShaderModule::ShaderModule(SharedPtrLogicalDevice const& device,
+                                   std::vector<char>      const& code)
+  : mShaderModule(VK_NULL_HANDLE), mDevice(device)
+{
+  initializeMembers(code);
 }
 
 so::vk::ShaderModule::~ShaderModule() noexcept
@@ -93,6 +82,30 @@ so::vk::ShaderModule::operator=(ShaderModule&& other) noexcept
   return *this;
 }
 
+void
+so::vk::ShaderModule::initializeMembers(std::vector<char> const& code)
+{
+  VkShaderModuleCreateInfo createInfo{};
+
+  createInfo.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+  createInfo.codeSize = code.size();
+  createInfo.pCode    = reinterpret_cast<uint32_t const*>(code.data());
+
+  VkResult const result(vkCreateShaderModule(mDevice->getVkDevice(),
+                                             &createInfo,
+                                             nullptr,
+                                             &mShaderModule));
+
+  if(result not_eq VK_SUCCESS)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to create shader module.",
+                   vkCreateShaderModule);
+
+    mShaderModule = VK_NULL_HANDLE;
+  }
+}
+
 
 void
 so::vk::ShaderModule::destroy_members()
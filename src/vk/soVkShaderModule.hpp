@@ -57,6 +57,11 @@
 
 namespace so {
 namespace vk {
+
+class
+ShaderModule;
+
+using SharedPtrShaderModule = std::shared_ptr<ShaderModule>;
     
 class
 ShaderModule
@@ -67,6 +72,12 @@ ShaderModule
     ShaderModule(SharedPtrLogicalDevice const& device,
                  std::string            const& file);
 
+    /**
+     * @brief Creates the module from SPIR-V code already in memory.
+     */
+    ShaderModule(SharedPtrLogicalDevice const& device,
+                 std::vector<char>      const& code);
+
     ShaderModule(ShaderModule const& other) = delete;
 
     ShaderModule(ShaderModule&& other) = delete;
@@ -78,12 +89,15 @@ ShaderModule
     ShaderModule&
     operator=(ShaderModule&& other) noexcept;
 
-    inline VkShaderModule getVkShaderModule() { return mShaderModule; }
+    inline VkShaderModule getVkShaderModule() const { return mShaderModule; }
 
   private:
     VkShaderModule         mShaderModule;
 
     SharedPtrLogicalDevice mDevice;
+
+    void
+    initializeMembers(std::vector<char> const& code);
     
     void
     destroy_members();
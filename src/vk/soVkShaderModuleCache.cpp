@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "soVkShaderModuleCache.hpp"
+
+#include "cxx/soDebugCallback.hpp"
+#include "cxx/soDefinitions.hpp"
+#include "cxx/soFileSystem.hpp"
+#include "cxx/soPoolAllocator.hpp"
+
+namespace {
+
+// 64 bit FNV-1a, good enough to tell SPIR-V blobs apart.
+uint64_t
+hashCode(std::vector<char> const& code)
+{
+  uint64_t hash{ 14695981039346656037ull };
+
+  for(char const byte : code)
+  {
+    hash ^= static_cast<uint8_t>(byte);
+    hash *= 1099511628211ull;
+  }
+
+  return hash;
+}
+
+} // namespace
+
+so::vk::SharedPtrShaderModuleCache const&
+so::vk::ShaderModuleCache::getSharedPtrNullShaderModuleCache()
+{
+  static SharedPtrShaderModuleCache cache
+    { utils::mem::makePooledShared<ShaderModuleCache>() };
+
+  return cache;
+}
+
+so::vk::ShaderModuleCache::ShaderModuleCache()
+  : mDevice(LogicalDevice::getSharedPtrNullDevice()),
+    mHashes(),
+    mEntries(),
+    mMutex()
+{}
+
+void
+so::vk::ShaderModuleCache::initialize(SharedPtrLogicalDevice const& device)
+{
+  std::lock_guard<std::mutex> lock{ mMutex };
+
+  mDevice = device;
+
+  mHashes.clear();
+  mEntries.clear();
+}
+
+so::vk::SharedPtrShaderModule
+so::vk::ShaderModuleCache::get(std::string const& file)
+{
+  std::lock_guard<std::mutex> lock{ mMutex };
+
+  auto const hashIt{ mHashes.find(file) };
+
+  if(hashIt not_eq mHashes.end())
+  {
+    return createModule(mEntries[hashIt->second]);
+  }
+
+  std::vector<char> code;
+
+  if(readBinaryFile(file, code) is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to load shader code from '" + file + "'.",
+                   readBinaryFile);
+
+    return nullptr;
+  }
+
+  uint64_t const hash{ hashCode(code) };
+
+  auto const entryIt{ mEntries.find(hash) };
+
+  if(entryIt is_eq mEntries.end())
+  {
+    mHashes.emplace(file, hash);
+
+    Entry& entry{ mEntries[hash] };
+
+    entry.code = std::move(code);
+
+    return createModule(entry);
+  }
+
+  if(entryIt->second.code not_eq code)
+  {
+    // A hash collision, extremely unlikely. Hand out an uncached module
+    // rather than the wrong one.
+    DEBUG_CALLBACK(verbose,
+                   "Shader code hash collision for '" + file + "'.");
+
+    auto module{ utils::mem::makePooledShared<ShaderModule>(mDevice, code) };
+
+    return module->getVkShaderModule() not_eq VK_NULL_HANDLE ? module
+                                                             : nullptr;
+  }
+
+  mHashes.emplace(file, hash);
+
+  return createModule(entryIt->second);
+}
+
+so::size_type
+so::vk::ShaderModuleCache::trim()
+{
+  std::lock_guard<std::mutex> lock{ mMutex };
+
+  size_type numDestroyed{ 0 };
+
+  for(auto& hashAndEntry : mEntries)
+  {
+    SharedPtrShaderModule& module{ hashAndEntry.second.module };
+
+    if(module and module.use_count() is_eq 1)
+    {
+      module.reset();
+
+      ++numDestroyed;
+    }
+  }
+
+  return numDestroyed;
+}
+
+so::size_type
+so::vk::ShaderModuleCache::size() const
+{
+  std::lock_guard<std::mutex> lock{ mMutex };
+
+  return mEntries.size();
+}
+
+so::vk::SharedPtrShaderModule
+so::vk::ShaderModuleCache::createModule(Entry& entry)
+{
+  if(not entry.module)
+  {
+    auto module
+      { utils::mem::makePooledShared<ShaderModule>(mDevice, entry.code) };
+
+    if(module->getVkShaderModule() is_eq VK_NULL_HANDLE)
+    {
+      return nullptr;
+    }
+
+    entry.module = std::move(module);
+  }
+
+  return entry.module;
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      soVkShaderModuleCache.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "soVkShaderModule.hpp"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace so {
+namespace vk {
+
+class
+ShaderModuleCache;
+
+using SharedPtrShaderModuleCache = std::shared_ptr<ShaderModuleCache>;
+
+/**
+ * @brief Shares shader modules of one device between pipelines.
+ *
+ * SPIR-V is read from disk once per path and process. Modules are keyed by
+ * a hash of their code, so identical code behind different paths yields the
+ * same module. The cache holds a reference to every module, so rebuilding a
+ * pipeline neither touches the file system nor calls vkCreateShaderModule.
+ */
+class
+ShaderModuleCache
+{
+  public:
+    static SharedPtrShaderModuleCache const&
+    getSharedPtrNullShaderModuleCache();
+
+    ShaderModuleCache();
+
+    ShaderModuleCache(ShaderModuleCache const& other) = delete;
+
+    ShaderModuleCache(ShaderModuleCache&& other) = delete;
+
+    ~ShaderModuleCache() noexcept = default;
+
+    ShaderModuleCache&
+    operator=(ShaderModuleCache const& other) = delete;
+
+    ShaderModuleCache&
+    operator=(ShaderModuleCache&& other) = delete;
+
+    void
+    initialize(SharedPtrLogicalDevice const& device);
+
+    /**
+     * @brief Returns the module for the SPIR-V file, loading it on first use.
+     *        Returns nullptr if the file cannot be read or compiled.
+     */
+    SharedPtrShaderModule
+    get(std::string const& file);
+
+    /**
+     * @brief Destroys modules that are only referenced by the cache. Their
+     *        code stays cached, so they are recreated without any file I/O.
+     * @return Number of destroyed modules.
+     */
+    size_type
+    trim();
+
+    size_type
+    size() const;
+
+  private:
+    struct
+    Entry
+    {
+      std::vector<char>     code;
+      SharedPtrShaderModule module;
+    };
+
+    SharedPtrLogicalDevice                    mDevice;
+
+    std::unordered_map<std::string, uint64_t> mHashes;
+
+    std::unordered_map<uint64_t, Entry>       mEntries;
+
+    mutable std::mutex                        mMutex;
+
+    SharedPtrShaderModule
+    createModule(Entry& entry);
+};
+
+} // namespace vk
+} // namespace so
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+#include "soVkStagingRing.hpp"
+
+#include "cxx/soDebugCallback.hpp"
+#include "cxx/soDefinitions.hpp"
+
+so::vk::StagingRing::StagingRing()
+  : mBuffer(),
+    mCapacity(0),
+    mHead(0),
+    mTail(0)
+{}
+
+so::vk::StagingRing&
+so::vk::StagingRing::operator=(StagingRing&& other) noexcept
+{
+  if(this is_eq &other)
+  {
+    return *this;
+  }
+
+  mBuffer   = std::move(other.mBuffer);
+  mCapacity = other.mCapacity;
+  mHead     = other.mHead;
+  mTail     = other.mTail;
+
+  other.mCapacity = 0;
+  other.mHead     = 0;
+  other.mTail     = 0;
+
+  return *this;
+}
+
+so::return_t
+so::vk::StagingRing::initialize(SharedPtrMemoryAllocator const& allocator,
+                                VkDeviceSize             const  capacity)
+{
+  mHead     = 0;
+  mTail     = 0;
+  mCapacity = capacity;
+
+  // Written once sequentially by the host, so uncached write-combined memory
+  // is fine; coherent memory saves the flush.
+  AllocationInfo allocationInfo{};
+
+  allocationInfo.requiredFlags  = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+  allocationInfo.preferredFlags = VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+  if(mBuffer.initialize(allocator,
+                        capacity,
+                        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                        allocationInfo) is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to create the staging buffer.",
+                   Buffer::initialize);
+
+    mCapacity = 0;
+
+    return failure;
+  }
+
+  return success;
+}
+
+so::return_t
+so::vk::StagingRing::allocate(VkDeviceSize const size,
+                              VkDeviceSize const alignment,
+                              VkDeviceSize&      offset)
+{
+  VkDeviceSize const headOffset{ mHead % mCapacity };
+
+  VkDeviceSize aligned{ (headOffset + alignment - 1) / alignment * alignment };
+
+  // Allocations never wrap around the end of the buffer, the rest of it is
+  // skipped instead.
+  if(aligned + size > mCapacity)
+  {
+    aligned = 0;
+  }
+
+  VkDeviceSize const padding{ aligned is_eq 0 and headOffset not_eq 0
+                                ? mCapacity - headOffset
+                                : aligned - headOffset };
+
+  if(getUsedBytes() + padding + size > mCapacity)
+  {
+    return failure;
+  }
+
+  mHead  += padding + size;
+  offset  = aligned;
+
+  return success;
+}
+
+void
+so::vk::StagingRing::release(uint64_t const position)
+{
+  mTail = position > mTail ? position : mTail;
+}
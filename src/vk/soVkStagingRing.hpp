@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      soVkStagingRing.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "soVkBuffer.hpp"
+
+namespace so {
+namespace vk {
+
+/**
+ * @brief A persistently mapped host visible buffer handed out as a ring.
+ *
+ * Positions grow monotonically; the offset into the buffer is the position
+ * modulo the capacity. Space is reclaimed in allocation order by releasing
+ * everything before a position, e.g. the head at the time a batch of copies
+ * was submitted, once the device is done reading it.
+ */
+class
+StagingRing
+{
+  public:
+    StagingRing();
+
+    StagingRing(StagingRing const& other) = delete;
+
+    StagingRing(StagingRing&& other) = delete;
+
+    ~StagingRing() noexcept = default;
+
+    StagingRing&
+    operator=(StagingRing const& other) = delete;
+
+    StagingRing&
+    operator=(StagingRing&& other) noexcept;
+
+    return_t
+    initialize(SharedPtrMemoryAllocator const& allocator,
+               VkDeviceSize             const  capacity);
+
+    /**
+     * @brief Reserves size bytes at an offset aligned to alignment. Fails
+     *        without side effects if there is not enough free space.
+     */
+    return_t
+    allocate(VkDeviceSize const size,
+             VkDeviceSize const alignment,
+             VkDeviceSize&      offset);
+
+    /**
+     * @brief Frees everything allocated before position.
+     */
+    void
+    release(uint64_t const position);
+
+    inline uint64_t getHead() const { return mHead; }
+
+    inline VkDeviceSize getCapacity() const { return mCapacity; }
+
+    inline VkDeviceSize getUsedBytes() const { return mHead - mTail; }
+
+    inline Buffer const& getBuffer() const { return mBuffer; }
+
+    inline void*
+    getMappedData(VkDeviceSize const offset) const
+    { return static_cast<char*>(mBuffer.getMappedData()) + offset; }
+
+  private:
+    Buffer       mBuffer;
+    VkDeviceSize mCapacity;
+    uint64_t     mHead;
+    uint64_t     mTail;
+};
+
+} // namespace vk
+} // namespace so
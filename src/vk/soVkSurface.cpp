@@ -23,9 +23,31 @@
 #include <soVkSurface.hpp>
 
 #include "cxx/soMemory.hpp"
+#include "cxx/soProfiler.hpp"
 
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
 #include <regex>
 
+namespace {
+
+bool
+equalsIgnoreCase(std::string const& lhs, std::string const& rhs)
+{
+  return std::equal(lhs.begin(),
+                    lhs.end(),
+                    rhs.begin(),
+                    rhs.end(),
+                    [](char const l, char const r)
+                    {
+                      return std::tolower(static_cast<unsigned char>(l)) is_eq
+                             std::tolower(static_cast<unsigned char>(r));
+                    });
+}
+
+} // namespace
+
 class
 so::vk::Surface::Impl
 {
@@ -74,16 +96,27 @@ so::vk::Surface::Impl
     Impl&
     operator=(Impl&& other) noexcept = delete;
 
+    /**
+     * Initializes the available providers and uses the first one that
+     * succeeds. SO_SURFACE_PROVIDER restricts this to the provider of the
+     * given name, e.g. "Headless" on machines without a display.
+     */
     so::return_t
     initialize()
     {
       bool   atLeastOneValidBackend(false);
   
       index_t idx(0);
+
+      char const* const requestedProvider{ std::getenv("SO_SURFACE_PROVIDER") };
   
       for(auto& provider : mProviders)
       {
-        if(provider.first.isAvailable())
+        bool const isRequested
+          { (requestedProvider is_eq nullptr) or
+            equalsIgnoreCase(provider.first.getName(), requestedProvider) };
+
+        if(provider.first.isAvailable() and isRequested)
         {
           std::string verbose("<VERBOSE> Starting initialization of surface "
                               "provider '");
@@ -139,45 +172,46 @@ so::vk::Surface::Impl
       return success;
     }
 
+    /**
+     * Only the provider in use contributes extensions; the others may have
+     * failed to initialize or need extensions the driver does not have.
+     */
     return_t
     getInstanceExtensions(std::vector<char const*>& instanceExtensions) const
     {
       instanceExtensions = std::vector<char const*>();
 
-      for(auto const& provider : mProviders)
-      {
-        return_t     result;
-        char const** providerExtensions{ nullptr };
-        size_type    count;
+      auto const idx{ static_cast<SurfaceProviders::size_type>
+                        (mCurrentProvider) };
 
-        provider.first(2,
-                       result,
-                       provider.second,
-                       &providerExtensions,
-                       &count);
+      auto const& provider{ mProviders[idx] };
 
-        if(result is_eq failure)
-        {
-          std::string error{ "<ERROR>   Failed to get instance extensions " };
+      return_t     result;
+      char const** providerExtensions{ nullptr };
+      size_type    count;
 
-          error += "for surface provider '";
-          error += provider.first.getName();
-          error += "'.";
+      provider.first(2,
+                     result,
+                     provider.second,
+                     &providerExtensions,
+                     &count);
 
-          std::cout << error << '\n';
+      if(result is_eq failure)
+      {
+        std::string error{ "<ERROR>   Failed to get instance extensions " };
 
-          continue;
-        }
+        error += "for surface provider '";
+        error += provider.first.getName();
+        error += "'.";
 
-        std::vector<char const*> providerInstanceExtensions
-                                   { providerExtensions,
-                                     providerExtensions + count };
-                
-        instanceExtensions.insert(instanceExtensions.end(),
-                                  providerInstanceExtensions.begin(),
-                                  providerInstanceExtensions.end());
+        std::cout << error << '\n';
+
+        return failure;
       }
 
+      instanceExtensions.assign(providerExtensions,
+                                providerExtensions + count);
+
       return success;
     }
 
@@ -271,6 +305,21 @@ so::vk::Surface::Impl
       return areResized;
     }
 
+    return_t
+    setWindowSize(size_type const width, size_type const height)
+    {
+      auto& module{ getModule() };
+
+      if(not module.hasSymbol(10))
+      {
+        return failure;
+      }
+
+      module(10, VoidReturn::getVoidReturn(), getHandle(), width, height);
+
+      return success;
+    }
+
     std::string const
     getName()
     {
@@ -315,6 +364,8 @@ so::vk::Surface::~Surface() noexcept = default;
 so::return_t
 so::vk::Surface::initialize()
 {
+  SO_PROFILE_ZONE("Surface::initialize");
+
   return mPImpl->initialize();
 }
 
@@ -330,12 +381,16 @@ so::vk::Surface::createWindow(std::string const& title,
                               size_type   const  width,
                               size_type   const  height)
 {
+  SO_PROFILE_ZONE("Surface::createWindow");
+
   return mPImpl->createWindow(title, width, height);
 }
 
 so::return_t
 so::vk::Surface::createSurface()
 {
+  SO_PROFILE_ZONE("Surface::createSurface");
+
   return mPImpl->createSurface(mInstance->getVkInstance());
 }
 
@@ -348,6 +403,8 @@ so::vk::Surface::windowIsClosed()
 void
 so::vk::Surface::pollEvents()
 {
+  SO_PROFILE_ZONE("Surface::pollEvents");
+
   mPImpl->pollEvents();
 }
 
@@ -366,9 +423,19 @@ so::vk::Surface::getWindowSize(size_type& width, size_type& height) const
 bool
 so::vk::Surface::framebuffersAreResized()
 {
+  SO_PROFILE_ZONE("Surface::framebuffersAreResized");
+
   return mPImpl->framebuffersAreResized();
 }
 
+so::return_t
+so::vk::Surface::setWindowSize(size_type const width, size_type const height)
+{
+  SO_PROFILE_ZONE("Surface::setWindowSize");
+
+  return mPImpl->setWindowSize(width, height);
+}
+
 void
 so::vk::Surface::setSharedPtrInstance(SharedPtrInstance const& instance)
 {
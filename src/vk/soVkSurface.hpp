@@ -104,9 +104,19 @@ Surface
     void
     getWindowSize(size_type& width, size_type& height) const;
 
+    /**
+     * @brief Whether the framebuffers were resized since the last call.
+     */
     bool
     framebuffersAreResized();
 
+    /**
+     * @brief Resizes the window. Fails if the surface provider does not
+     *        support resizing.
+     */
+    return_t
+    setWindowSize(size_type const width, size_type const height);
+
     void
     setSharedPtrInstance(SharedPtrInstance const& instance);
 
@@ -28,10 +28,15 @@
 #include "cxx/soDebugCallback.hpp"
 #include "cxx/soDefinitions.hpp"
 
+#include <algorithm>
+
 so::vk::SwapChain::SwapChain()
   : mSwapChain(VK_NULL_HANDLE),
+    mPresentPolicy(PresentPolicy::noTearing),
+    mPresentMode(VK_PRESENT_MODE_FIFO_KHR),
     mSwapChainExtent({ 0, 0 }),
     mSwapChainImageFormat(VK_FORMAT_UNDEFINED),
+    mImageUsage(0),
     mSwapChainImages(),
     mSwapChainImageViews(),
     mDevice(LogicalDevice::getSharedPtrNullDevice())
@@ -72,11 +77,29 @@ so::vk::SwapChain::initialize(SharedPtrLogicalDevice const& device,
 }
 
 so::return_t
-so::vk::SwapChain::reset(Surface const& surface)
+so::vk::SwapChain::reset(Surface const& surface, DeletionQueue& deletionQueue)
 {
-  destroyMembers();
+  VkSwapchainKHR const oldSwapChain{ mSwapChain };
 
-  if(initializeMembers(surface) is_eq failure)
+  return_t const swapChainResult{ initializeMembers(surface) };
+
+  // The old swap chain is retired even if creating the new one failed. Its
+  // image views have to go first.
+  deletionQueue.retire(std::move(mSwapChainImageViews));
+
+  if(oldSwapChain not_eq VK_NULL_HANDLE)
+  {
+    SharedPtrLogicalDevice device{ mDevice };
+
+    deletionQueue.push([device, oldSwapChain]
+                       {
+                         vkDestroySwapchainKHR(device->getVkDevice(),
+                                               oldSwapChain,
+                                               nullptr);
+                       });
+  }
+
+  if(swapChainResult is_eq failure)
   {
     DEBUG_CALLBACK(error,
                    "Failed to create swap chain.",
@@ -85,9 +108,10 @@ so::vk::SwapChain::reset(Surface const& surface)
     return failure;
   }
 
-  return_t result{ mSwapChainImageViews.reset(mSwapChainImages,
-                                              mSwapChainImageFormat,
-                                              VK_IMAGE_ASPECT_COLOR_BIT) };
+  return_t result{ mSwapChainImageViews.initialize(mDevice,
+                                                   mSwapChainImages,
+                                                   mSwapChainImageFormat,
+                                                   VK_IMAGE_ASPECT_COLOR_BIT) };
 
   if(result is_eq failure)
   {
@@ -117,15 +141,20 @@ so::vk::SwapChain::operator=(so::vk::SwapChain&& other) noexcept
   destroyMembers();
 
   mSwapChain            = other.mSwapChain;
+  mPresentPolicy        = other.mPresentPolicy;
+  mPresentMode          = other.mPresentMode;
   mSwapChainExtent      = other.mSwapChainExtent;
   mSwapChainImageFormat = other.mSwapChainImageFormat;
+  mImageUsage           = other.mImageUsage;
   mSwapChainImages      = other.mSwapChainImages;
   mSwapChainImageViews  = std::move(other.mSwapChainImageViews);
   mDevice               = other.mDevice;
 
   other.mSwapChain            = VK_NULL_HANDLE;
+  other.mPresentMode          = VK_PRESENT_MODE_FIFO_KHR;
   other.mSwapChainExtent      = { 0, 0 };
   other.mSwapChainImageFormat = VK_FORMAT_UNDEFINED;
+  other.mImageUsage           = 0;
   other.mSwapChainImages      = std::vector<VkImage>();
   other.mDevice               = LogicalDevice::getSharedPtrNullDevice();
   other.mSwapChainImageViews  = ImageViews();
@@ -166,21 +195,67 @@ VkPresentModeKHR
 so::vk::SwapChain::chooseSwapPresentMode
   (std::vector<VkPresentModeKHR> const& availablePresentModes)
 {
-  VkPresentModeKHR bestMode{ VK_PRESENT_MODE_FIFO_KHR};
+  std::vector<VkPresentModeKHR> preferredModes;
 
-  for(auto const& availablePresentMode : availablePresentModes)
+  switch(mPresentPolicy)
   {
-    if(availablePresentMode is_eq VK_PRESENT_MODE_MAILBOX_KHR)
-    {
-      bestMode = availablePresentMode;
-    }
-    else if(availablePresentMode is_eq VK_PRESENT_MODE_IMMEDIATE_KHR)
+    case PresentPolicy::lowLatency:
+      preferredModes = { VK_PRESENT_MODE_MAILBOX_KHR,
+                         VK_PRESENT_MODE_IMMEDIATE_KHR };
+      break;
+    case PresentPolicy::noTearing:
+      preferredModes = { VK_PRESENT_MODE_MAILBOX_KHR };
+      break;
+    case PresentPolicy::powerSaving:
+      break;
+  }
+
+  for(auto const preferredMode : preferredModes)
+  {
+    auto const it{ std::find(availablePresentModes.begin(),
+                             availablePresentModes.end(),
+                             preferredMode) };
+
+    if(it not_eq availablePresentModes.end())
     {
-      bestMode = availablePresentMode;
+      return preferredMode;
     }
   }
 
-  return bestMode;
+  // FIFO is the only mode every implementation has to support.
+  return VK_PRESENT_MODE_FIFO_KHR;
+}
+
+uint32_t
+so::vk::SwapChain::chooseImageCount
+  (VkSurfaceCapabilitiesKHR const& capabilities,
+   VkPresentModeKHR         const  presentMode)
+{
+  uint32_t imageCount{ capabilities.minImageCount };
+
+  if(presentMode is_eq VK_PRESENT_MODE_MAILBOX_KHR)
+  {
+    // Mailbox needs one image being displayed, one queued and one to render
+    // to, otherwise acquiring blocks just like FIFO.
+    imageCount = std::max(capabilities.minImageCount + 1, 3u);
+  }
+  else if((presentMode is_eq VK_PRESENT_MODE_FIFO_KHR) and
+          (mPresentPolicy is_eq PresentPolicy::noTearing))
+  {
+    // Plain triple buffering. Trades a frame of latency for throughput.
+    imageCount = capabilities.minImageCount + 1;
+  }
+
+  imageCount = std::max(imageCount, 2u);
+
+  bool const imageLimitDefined{ capabilities.maxImageCount > 0 };
+
+  if(imageLimitDefined and (imageCount > capabilities.maxImageCount))
+  {
+    imageCount = capabilities.maxImageCount;
+  }
+
+  return imageCount;
 }
 
 VkExtent2D
@@ -242,18 +317,7 @@ so::vk::SwapChain::initializeMembers(Surface const& surface)
                                       surface) };
 
   uint32_t imageCount
-    { swapChainSupport.getCapabilities().minImageCount + 1 };
-
-  uint32_t const maxImageCount
-    { swapChainSupport.getCapabilities().maxImageCount };
-  
-  bool const imageLimitDefined{ maxImageCount > 0 };
-  bool const maxSmallerMin{ imageCount > maxImageCount };
-
-  if(imageLimitDefined and maxSmallerMin)
-  {
-    imageCount = maxImageCount;
-  }
+    { chooseImageCount(swapChainSupport.getCapabilities(), presentMode) };
 
   VkSwapchainCreateInfoKHR createInfo{};
 
@@ -266,6 +330,13 @@ so::vk::SwapChain::initializeMembers(Surface const& surface)
   createInfo.imageArrayLayers = 1;
   createInfo.imageUsage       = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 
+  // Allows reading rendered frames back to the host, see FrameCapture.
+  if(swapChainSupport.getCapabilities().supportedUsageFlags bitand
+     VK_IMAGE_USAGE_TRANSFER_SRC_BIT)
+  {
+    createInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+  }
+
   QueueFamilyIndices indices{ physicalDevice, surface };
 
   uint32_t queueFamilyIndices[]
@@ -290,10 +361,16 @@ so::vk::SwapChain::initializeMembers(Surface const& surface)
   createInfo.clipped        = VK_TRUE;
   createInfo.oldSwapchain   = mSwapChain;
 
+  VkSwapchainKHR swapChain{ VK_NULL_HANDLE };
+
   VkResult const swapChainResult(vkCreateSwapchainKHR(vkDevice,
                                                       &createInfo,
                                                       nullptr,
-                                                      &mSwapChain));
+                                                      &swapChain));
+
+  // Whatever the result, the old swap chain is retired now and owned by the
+  // caller.
+  mSwapChain = swapChain;
 
   if(swapChainResult not_eq VK_SUCCESS)
   {
@@ -315,6 +392,8 @@ so::vk::SwapChain::initializeMembers(Surface const& surface)
 
   mSwapChainImageFormat = surfaceFormat.format;
   mSwapChainExtent      = extent;
+  mPresentMode          = presentMode;
+  mImageUsage           = createInfo.imageUsage;
  
   return success;
 }
@@ -50,6 +50,7 @@
 
 #pragma once
 
+#include "soVkDeletionQueue.hpp"
 #include "soVkImageViews.hpp"
 #include "soVkLogicalDevice.hpp"
 #include "soVkSurface.hpp"
@@ -58,6 +59,22 @@
 
 namespace so {
 namespace vk {
+
+/**
+ * @brief Trade-off the swap chain makes when choosing its present mode and
+ *        image count.
+ *
+ * lowLatency:  MAILBOX, then IMMEDIATE (may tear), then FIFO.
+ * noTearing:   MAILBOX, then FIFO. Never tears.
+ * powerSaving: FIFO with as few images as possible, i.e. the presentation
+ *              engine throttles the CPU and GPU to the refresh rate.
+ */
+enum class PresentPolicy
+{
+  lowLatency,
+  noTearing,
+  powerSaving
+}; // enum class PresentPolicy
     
 class
 SwapChain
@@ -81,8 +98,16 @@ SwapChain
     initialize(SharedPtrLogicalDevice const& device,
                Surface                const& surface);
 
+    /**
+     * @brief Recreates the swap chain, e.g. after a resize.
+     *
+     * The new swap chain is created with the current one as oldSwapchain, so
+     * the presentation engine can hand over without a stall. The old swap
+     * chain and its image views are retired through the deletion queue
+     * instead of waiting for the device to become idle.
+     */
     return_t
-    reset(Surface const& surface);
+    reset(Surface const& surface, DeletionQueue& deletionQueue);
 
     inline VkSwapchainKHR getVkSwapchainKHR() { return mSwapChain; }
 
@@ -90,6 +115,9 @@ SwapChain
 
     inline VkFormat getVkFormat() const { return mSwapChainImageFormat; }
 
+    inline VkImageUsageFlags
+    getVkImageUsage() const { return mImageUsage; }
+
     inline std::vector<VkImage> const&
     getVkImages() const { return mSwapChainImages; }
 
@@ -99,11 +127,26 @@ SwapChain
     inline SharedPtrLogicalDevice
     getDevice() { return mDevice->shared_from_this(); }
 
+    /**
+     * @brief Sets the present policy. Takes effect on the next initialize or
+     *        reset.
+     */
+    inline void
+    setPresentPolicy(PresentPolicy const policy) { mPresentPolicy = policy; }
+
+    inline PresentPolicy getPresentPolicy() const { return mPresentPolicy; }
+
+    inline VkPresentModeKHR getVkPresentMode() const { return mPresentMode; }
+
   private:
     VkSwapchainKHR         mSwapChain;
 
+    PresentPolicy          mPresentPolicy;
+    VkPresentModeKHR       mPresentMode;
+
     VkExtent2D             mSwapChainExtent;
     VkFormat               mSwapChainImageFormat;
+    VkImageUsageFlags      mImageUsage;
 
     std::vector<VkImage>   mSwapChainImages;
     ImageViews             mSwapChainImageViews;
@@ -119,6 +162,10 @@ SwapChain
     chooseSwapPresentMode
       (std::vector<VkPresentModeKHR> const& availablePresentModes);
 
+    uint32_t
+    chooseImageCount(VkSurfaceCapabilitiesKHR const& capabilities,
+                     VkPresentModeKHR         const  presentMode);
+
     VkExtent2D
     chooseSwapExtent(VkSurfaceCapabilitiesKHR const& capabilities,
                      Surface                  const& surface);
@@ -0,0 +1,741 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+
+#include "soVkTextureStreamer.hpp"
+
+#include "cxx/soDebugCallback.hpp"
+#include "cxx/soProfiler.hpp"
+#include "cxx/soScratchAllocator.hpp"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory_resource>
+#include <queue>
+#include <tuple>
+
+namespace {
+
+constexpr so::size_type bytesPerTexel{ 4 };
+
+/**
+ * Averages 2x2 blocks of an RGBA8 level, clamping at odd edges.
+ */
+void
+downsample(unsigned char const* src,
+           VkExtent2D    const  srcExtent,
+           unsigned char*       dst,
+           VkExtent2D    const  dstExtent)
+{
+  for(uint32_t y{ 0 }; y < dstExtent.height; ++y)
+  {
+    uint32_t const y0{ std::min(2 * y, srcExtent.height - 1) };
+    uint32_t const y1{ std::min(2 * y + 1, srcExtent.height - 1) };
+
+    for(uint32_t x{ 0 }; x < dstExtent.width; ++x)
+    {
+      uint32_t const x0{ std::min(2 * x, srcExtent.width - 1) };
+      uint32_t const x1{ std::min(2 * x + 1, srcExtent.width - 1) };
+
+      for(so::size_type c{ 0 }; c < bytesPerTexel; ++c)
+      {
+        auto const texel = [&](uint32_t const tx, uint32_t const ty)
+        {
+          return uint32_t{ src[(so::size_type{ ty } * srcExtent.width + tx) *
+                               bytesPerTexel + c] };
+        };
+
+        uint32_t const sum{ texel(x0, y0) + texel(x1, y0) +
+                            texel(x0, y1) + texel(x1, y1) };
+
+        dst[(so::size_type{ y } * dstExtent.width + x) * bytesPerTexel + c] =
+          static_cast<unsigned char>((sum + 2) / 4);
+      }
+    }
+  }
+}
+
+VkDeviceSize
+getLevelSize(VkExtent2D const extent)
+{
+  return VkDeviceSize{ extent.width } * extent.height * bytesPerTexel;
+}
+
+} // namespace
+
+so::vk::TextureStreamer::TextureStreamer()
+  : mTextures(),
+    mSampler(VK_NULL_HANDLE),
+    mBudget(0),
+    mMaxUploadBytesPerUpdate(VkDeviceSize{ 16 } << 20),
+    mEvictionDelay(120),
+    mMinResidentSize(64),
+    mUpdateCount(0),
+    mStreamedInBytes(0),
+    mEvictions(0),
+    mDevice(LogicalDevice::getSharedPtrNullDevice()),
+    mAllocator(MemoryAllocator::getSharedPtrNullMemoryAllocator()),
+    mUploader(nullptr),
+    mDeletionQueue(nullptr)
+{}
+
+so::vk::TextureStreamer::~TextureStreamer() noexcept
+{
+  destroyMembers();
+}
+
+void
+so::vk::TextureStreamer::destroyMembers()
+{
+  VkDevice device{ mDevice->getVkDevice() };
+
+  if(device is_eq VK_NULL_HANDLE)
+  {
+    return;
+  }
+
+  // Textures are only destroyed with the streamer, once the device is idle.
+  for(auto& texture : mTextures)
+  {
+    for(Residency* residency : { &texture->resident, &texture->pending })
+    {
+      if(residency->view not_eq VK_NULL_HANDLE)
+      {
+        vkDestroyImageView(device, residency->view, nullptr);
+
+        residency->view = VK_NULL_HANDLE;
+      }
+    }
+  }
+
+  mTextures.clear();
+
+  if(mSampler not_eq VK_NULL_HANDLE)
+  {
+    vkDestroySampler(device, mSampler, nullptr);
+
+    mSampler = VK_NULL_HANDLE;
+  }
+}
+
+so::return_t
+so::vk::TextureStreamer::initialize
+  (SharedPtrLogicalDevice   const& device,
+   SharedPtrMemoryAllocator const& allocator,
+   Uploader&                       uploader,
+   DeletionQueue&                  deletionQueue,
+   VkDeviceSize             const  budget,
+   uint32_t                 const  minResidentSize)
+{
+  destroyMembers();
+
+  mDevice          = device;
+  mAllocator       = allocator;
+  mUploader        = &uploader;
+  mDeletionQueue   = &deletionQueue;
+  mBudget          = budget;
+  mMinResidentSize = std::max(minResidentSize, 1u);
+
+  VkSamplerCreateInfo samplerInfo{};
+
+  samplerInfo.sType            = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+  samplerInfo.magFilter        = VK_FILTER_LINEAR;
+  samplerInfo.minFilter        = VK_FILTER_LINEAR;
+  samplerInfo.mipmapMode       = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+  samplerInfo.addressModeU     = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+  samplerInfo.addressModeV     = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+  samplerInfo.addressModeW     = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+  samplerInfo.anisotropyEnable = VK_TRUE;
+  samplerInfo.maxAnisotropy    =
+    std::min(16.0f,
+             mDevice->getVkPhysicalDeviceProperties()
+               .limits.maxSamplerAnisotropy);
+  samplerInfo.minLod           = 0.0f;
+  samplerInfo.maxLod           = VK_LOD_CLAMP_NONE;
+
+  VkResult result{ vkCreateSampler(mDevice->getVkDevice(),
+                                   &samplerInfo,
+                                   nullptr,
+                                   &mSampler) };
+
+  if(result not_eq VK_SUCCESS)
+  {
+    DEBUG_CALLBACK(error, "Failed to create the texture sampler.",
+                   vkCreateSampler);
+
+    return failure;
+  }
+
+  return success;
+}
+
+so::return_t
+so::vk::TextureStreamer::load(std::string const& filename,
+                              TextureHandle&     handle,
+                              bool        const  isSrgb)
+{
+  SO_PROFILE_ZONE("TextureStreamer::load");
+
+  int width{ 0 };
+  int height{ 0 };
+  int channels{ 0 };
+
+  stbi_uc* decoded{ stbi_load(filename.c_str(),
+                              &width,
+                              &height,
+                              &channels,
+                              STBI_rgb_alpha) };
+
+  if(decoded is_eq nullptr)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to decode " + filename + ": " +
+                   stbi_failure_reason(),
+                   stbi_load);
+
+    return failure;
+  }
+
+  auto texture{ std::make_unique<Texture>() };
+
+  texture->format = isSrgb ? VK_FORMAT_R8G8B8A8_SRGB
+                           : VK_FORMAT_R8G8B8A8_UNORM;
+
+  VkExtent2D extent{ static_cast<uint32_t>(width),
+                     static_cast<uint32_t>(height) };
+
+  VkDeviceSize totalSize{ 0 };
+
+  for(VkExtent2D level{ extent }; ; )
+  {
+    texture->mipOffsets.push_back(totalSize);
+    texture->mipExtents.push_back(level);
+
+    totalSize += getLevelSize(level);
+
+    if(level.width is_eq 1 and level.height is_eq 1)
+    {
+      break;
+    }
+
+    level = { std::max(level.width / 2, 1u), std::max(level.height / 2, 1u) };
+  }
+
+  texture->pixels.resize(static_cast<size_type>(totalSize));
+
+  std::memcpy(texture->pixels.data(),
+              decoded,
+              static_cast<size_type>(getLevelSize(extent)));
+
+  stbi_image_free(decoded);
+
+  for(size_type level{ 1 }; level < texture->mipExtents.size(); ++level)
+  {
+    downsample(texture->pixels.data() + texture->mipOffsets[level - 1],
+               texture->mipExtents[level - 1],
+               texture->pixels.data() + texture->mipOffsets[level],
+               texture->mipExtents[level]);
+  }
+
+  // Levels that do not fit into the staging ring could never be uploaded.
+  VkDeviceSize const maxLevelSize
+    { mUploader->getStagingRing().getCapacity() / 2 };
+
+  size_type dropped{ 0 };
+
+  while(getLevelSize(texture->mipExtents[dropped]) > maxLevelSize)
+  {
+    ++dropped;
+  }
+
+  if(dropped > 0)
+  {
+    DEBUG_CALLBACK(info,
+                   filename + " is too large to stream, dropping its " +
+                   std::to_string(dropped) + " finest mip levels.");
+
+    VkDeviceSize const offset{ texture->mipOffsets[dropped] };
+
+    texture->pixels.erase(texture->pixels.begin(),
+                          texture->pixels.begin() +
+                            static_cast<std::ptrdiff_t>(offset));
+    texture->mipOffsets.erase(texture->mipOffsets.begin(),
+                              texture->mipOffsets.begin() +
+                                static_cast<std::ptrdiff_t>(dropped));
+    texture->mipExtents.erase(texture->mipExtents.begin(),
+                              texture->mipExtents.begin() +
+                                static_cast<std::ptrdiff_t>(dropped));
+
+    for(auto& mipOffset : texture->mipOffsets)
+    {
+      mipOffset -= offset;
+    }
+  }
+
+  auto const numMips{ static_cast<uint32_t>(texture->mipExtents.size()) };
+
+  texture->tailMip = numMips - 1;
+
+  for(uint32_t level{ 0 }; level < numMips; ++level)
+  {
+    VkExtent2D const& levelExtent{ texture->mipExtents[level] };
+
+    if(std::max(levelExtent.width, levelExtent.height) <= mMinResidentSize)
+    {
+      texture->tailMip = level;
+
+      break;
+    }
+  }
+
+  texture->resident.firstMip = numMips;
+  texture->requestedMip      = texture->tailMip;
+  texture->wantedMip         = texture->tailMip;
+  texture->wantedUpdate      = mUpdateCount;
+
+  if(stream(*texture, texture->tailMip) is_eq failure)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to upload the mip tail of " + filename + ".",
+                   TextureStreamer::stream);
+
+    return failure;
+  }
+
+  handle = static_cast<TextureHandle>(mTextures.size());
+
+  mTextures.push_back(std::move(texture));
+
+  return success;
+}
+
+void
+so::vk::TextureStreamer::reportUsage(TextureHandle const handle,
+                                     float         const screenSize)
+{
+  if(handle >= mTextures.size() or not (screenSize > 0.0f))
+  {
+    return;
+  }
+
+  VkExtent2D const& extent{ mTextures[handle]->mipExtents.front() };
+
+  float const texelsPerPixel
+    { static_cast<float>(std::max(extent.width, extent.height)) /
+      screenSize };
+
+  uint32_t const mipLevel
+    { texelsPerPixel > 1.0f
+        ? static_cast<uint32_t>(std::floor(std::log2(texelsPerPixel)))
+        : 0u };
+
+  requestMip(handle, mipLevel);
+}
+
+void
+so::vk::TextureStreamer::requestMip(TextureHandle const handle,
+                                    uint32_t      const mipLevel)
+{
+  if(handle >= mTextures.size())
+  {
+    return;
+  }
+
+  Texture& texture{ *mTextures[handle] };
+
+  texture.requestedMip = std::min({ texture.requestedMip,
+                                    mipLevel,
+                                    texture.tailMip });
+}
+
+void
+so::vk::TextureStreamer::update()
+{
+  SO_PROFILE_ZONE("TextureStreamer::update");
+
+  ++mUpdateCount;
+
+  size_type const numTextures{ mTextures.size() };
+
+  // The temporaries of an update come from the thread's scratch memory
+  // instead of the heap.
+  utils::mem::ScratchScope scratch;
+
+  std::pmr::vector<uint32_t> targets(numTextures, scratch.getResource());
+
+  VkDeviceSize total{ 0 };
+
+  for(size_type i{ 0 }; i < numTextures; ++i)
+  {
+    Texture& texture{ *mTextures[i] };
+
+    if(texture.isPending and mUploader->isComplete(texture.pendingTicket))
+    {
+      retire(texture.resident);
+
+      texture.resident.image    = std::move(texture.pending.image);
+      texture.resident.view     = texture.pending.view;
+      texture.resident.firstMip = texture.pending.firstMip;
+      texture.pending.view      = VK_NULL_HANDLE;
+      texture.isPending         = false;
+    }
+
+    // Finer levels are taken at once, coarser ones only after evictionDelay,
+    // so a texture briefly out of view keeps its levels.
+    if(texture.requestedMip <= texture.wantedMip
+       or mUpdateCount - texture.wantedUpdate > mEvictionDelay)
+    {
+      texture.wantedMip    = texture.requestedMip;
+      texture.wantedUpdate = mUpdateCount;
+    }
+
+    texture.requestedMip = texture.tailMip;
+
+    targets[i] = texture.wantedMip;
+    total     += getResidentSize(texture, targets[i]);
+  }
+
+  // Take levels from the textures used least recently until the targets fit.
+  using Candidate = std::tuple<uint64_t, uint32_t, size_type>;
+
+  std::priority_queue<Candidate,
+                      std::pmr::vector<Candidate>,
+                      std::greater<Candidate>> candidates
+    { std::greater<Candidate>{},
+      std::pmr::vector<Candidate>{ scratch.getResource() } };
+
+  for(size_type i{ 0 }; i < numTextures; ++i)
+  {
+    if(targets[i] < mTextures[i]->tailMip)
+    {
+      candidates.emplace(mTextures[i]->wantedUpdate, targets[i], i);
+    }
+  }
+
+  while(total > mBudget and not candidates.empty())
+  {
+    size_type const i{ std::get<2>(candidates.top()) };
+
+    candidates.pop();
+
+    Texture const& texture{ *mTextures[i] };
+
+    total -= getResidentSize(texture, targets[i]) -
+             getResidentSize(texture, targets[i] + 1);
+
+    ++targets[i];
+
+    if(targets[i] < texture.tailMip)
+    {
+      candidates.emplace(texture.wantedUpdate, targets[i], i);
+    }
+  }
+
+  // Evictions first, then uploads for the textures used most recently.
+  std::pmr::vector<size_type> order(numTextures, scratch.getResource());
+
+  for(size_type i{ 0 }; i < numTextures; ++i)
+  {
+    order[i] = i;
+  }
+
+  std::sort(order.begin(),
+            order.end(),
+            [this, &targets](size_type const a, size_type const b)
+            {
+              Texture const& ta{ *mTextures[a] };
+              Texture const& tb{ *mTextures[b] };
+
+              bool const evictsA{ targets[a] > ta.resident.firstMip };
+              bool const evictsB{ targets[b] > tb.resident.firstMip };
+
+              return std::make_tuple(not evictsA, tb.wantedUpdate, a) <
+                     std::make_tuple(not evictsB, ta.wantedUpdate, b);
+            });
+
+  VkDeviceSize uploadBudget{ mMaxUploadBytesPerUpdate };
+  bool         hasUploaded{ false };
+
+  for(size_type const i : order)
+  {
+    Texture&       texture{ *mTextures[i] };
+    uint32_t const current{ texture.resident.firstMip };
+
+    if(texture.isPending or targets[i] is_eq current)
+    {
+      continue;
+    }
+
+    uint32_t firstMip{ targets[i] };
+
+    if(firstMip < current)
+    {
+      // Stream as many levels as the upload budget allows, but at least one
+      // per update.
+      while(firstMip < current - 1
+            and getResidentSize(texture, firstMip) > uploadBudget)
+      {
+        ++firstMip;
+      }
+
+      VkDeviceSize const size{ getResidentSize(texture, firstMip) };
+
+      if(size > uploadBudget and hasUploaded)
+      {
+        continue;
+      }
+
+      uploadBudget -= std::min(size, uploadBudget);
+      hasUploaded   = true;
+    }
+
+    if(stream(texture, firstMip) is_eq failure)
+    {
+      DEBUG_CALLBACK(error,
+                     "Failed to change the residency of a texture.",
+                     TextureStreamer::stream);
+
+      continue;
+    }
+
+    if(firstMip > current)
+    {
+      ++mEvictions;
+    }
+    else
+    {
+      mStreamedInBytes += getResidentSize(texture, firstMip);
+    }
+  }
+}
+
+VkImageView
+so::vk::TextureStreamer::getVkImageView(TextureHandle const handle) const
+{
+  return handle < mTextures.size() ? mTextures[handle]->resident.view
+                                   : VK_NULL_HANDLE;
+}
+
+uint32_t
+so::vk::TextureStreamer::getResidentMip(TextureHandle const handle) const
+{
+  return handle < mTextures.size() ? mTextures[handle]->resident.firstMip
+                                   : 0;
+}
+
+so::vk::TextureStreamingStatistics
+so::vk::TextureStreamer::getStatistics() const
+{
+  TextureStreamingStatistics statistics;
+
+  statistics.textureCount    = mTextures.size();
+  statistics.budget          = mBudget;
+  statistics.streamedInBytes = mStreamedInBytes;
+  statistics.evictions       = mEvictions;
+
+  for(auto const& texture : mTextures)
+  {
+    statistics.residentBytes += texture->resident.image.getAllocation().size;
+
+    if(texture->isPending)
+    {
+      statistics.residentBytes += texture->pending.image.getAllocation().size;
+    }
+
+    if(texture->resident.firstMip > texture->wantedMip)
+    {
+      ++statistics.starvedTextures;
+    }
+  }
+
+  return statistics;
+}
+
+VkDeviceSize
+so::vk::TextureStreamer::getResidentSize(Texture  const& texture,
+                                         uint32_t const  firstMip)
+{
+  return texture.pixels.size() - texture.mipOffsets[firstMip];
+}
+
+so::return_t
+so::vk::TextureStreamer::stream(Texture& texture, uint32_t const firstMip)
+{
+  SO_PROFILE_ZONE("TextureStreamer::stream");
+
+  auto const numMips{ static_cast<uint32_t>(texture.mipExtents.size()) };
+  uint32_t const numLevels{ numMips - firstMip };
+
+  VkImageCreateInfo imageInfo{};
+
+  imageInfo.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+  imageInfo.imageType     = VK_IMAGE_TYPE_2D;
+  imageInfo.format        = texture.format;
+  imageInfo.extent        = { texture.mipExtents[firstMip].width,
+                              texture.mipExtents[firstMip].height,
+                              1 };
+  imageInfo.mipLevels     = numLevels;
+  imageInfo.arrayLayers   = 1;
+  imageInfo.samples       = VK_SAMPLE_COUNT_1_BIT;
+  imageInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
+  imageInfo.usage         = VK_IMAGE_USAGE_TRANSFER_DST_BIT bitor
+                            VK_IMAGE_USAGE_SAMPLED_BIT;
+  imageInfo.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+  imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+  AllocationInfo allocationInfo{};
+
+  allocationInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+  Residency residency;
+
+  residency.firstMip = firstMip;
+
+  if(residency.image.initialize(mAllocator,
+                                imageInfo,
+                                allocationInfo) is_eq failure)
+  {
+    return failure;
+  }
+
+  // Consecutive levels share an upload as long as they fit into the ring.
+  VkDeviceSize const maxUploadSize
+    { mUploader->getStagingRing().getCapacity() / 2 };
+
+  uint64_t ticket{ 0 };
+
+  for(uint32_t first{ firstMip }; first < numMips; )
+  {
+    VkDeviceSize const offset{ texture.mipOffsets[first] };
+
+    std::vector<VkBufferImageCopy> regions;
+
+    uint32_t last{ first };
+
+    do
+    {
+      VkBufferImageCopy region{};
+
+      region.bufferOffset                    =
+        texture.mipOffsets[last] - offset;
+      region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+      region.imageSubresource.mipLevel       = last - firstMip;
+      region.imageSubresource.baseArrayLayer = 0;
+      region.imageSubresource.layerCount     = 1;
+      region.imageExtent                     =
+        { texture.mipExtents[last].width, texture.mipExtents[last].height, 1 };
+
+      regions.push_back(region);
+
+      ++last;
+    }
+    while(last < numMips and
+          texture.mipOffsets[last] +
+            getLevelSize(texture.mipExtents[last]) - offset <= maxUploadSize);
+
+    VkDeviceSize const end{ last < numMips ? texture.mipOffsets[last]
+                                           : texture.pixels.size() };
+
+    return_t const result
+      { mUploader->uploadImage(residency.image,
+                               texture.pixels.data() + offset,
+                               end - offset,
+                               regions,
+                               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                               VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                               VK_ACCESS_SHADER_READ_BIT,
+                               ticket) };
+
+    if(result is_eq failure)
+    {
+      return failure;
+    }
+
+    first = last;
+  }
+
+  VkImageViewCreateInfo viewInfo{};
+
+  viewInfo.sType                           =
+    VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+  viewInfo.image                           = residency.image.getVkImage();
+  viewInfo.viewType                        = VK_IMAGE_VIEW_TYPE_2D;
+  viewInfo.format                          = texture.format;
+  viewInfo.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+  viewInfo.subresourceRange.baseMipLevel   = 0;
+  viewInfo.subresourceRange.levelCount     = numLevels;
+  viewInfo.subresourceRange.baseArrayLayer = 0;
+  viewInfo.subresourceRange.layerCount     = 1;
+
+  VkResult const viewResult{ vkCreateImageView(mDevice->getVkDevice(),
+                                               &viewInfo,
+                                               nullptr,
+                                               &residency.view) };
+
+  if(viewResult not_eq VK_SUCCESS)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to create a texture image view.",
+                   vkCreateImageView);
+
+    // The uploads may still write to the image.
+    mDeletionQueue->retire(std::move(residency.image));
+
+    return failure;
+  }
+
+  texture.pending.image    = std::move(residency.image);
+  texture.pending.view     = residency.view;
+  texture.pending.firstMip = firstMip;
+  texture.pendingTicket    = ticket;
+  texture.isPending        = true;
+
+  return success;
+}
+
+void
+so::vk::TextureStreamer::retire(Residency& residency)
+{
+  if(residency.view not_eq VK_NULL_HANDLE)
+  {
+    SharedPtrLogicalDevice device{ mDevice };
+    VkImageView            view{ residency.view };
+
+    // Deleters run in order, so the view goes before its image.
+    mDeletionQueue->push([device, view]()
+                         { vkDestroyImageView(device->getVkDevice(),
+                                              view,
+                                              nullptr); });
+
+    residency.view = VK_NULL_HANDLE;
+  }
+
+  if(residency.image.getVkImage() not_eq VK_NULL_HANDLE)
+  {
+    mDeletionQueue->retire(std::move(residency.image));
+  }
+}
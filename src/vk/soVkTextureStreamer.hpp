@@ -0,0 +1,270 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      soVkTextureStreamer.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "soVkDeletionQueue.hpp"
+#include "soVkImage.hpp"
+#include "soVkUploader.hpp"
+
+#include "cxx/soDefinitions.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace so {
+namespace vk {
+
+using TextureHandle = uint32_t;
+
+constexpr TextureHandle invalidTexture{ ~0u };
+
+struct
+TextureStreamingStatistics
+{
+  size_type    textureCount{ 0 };
+  VkDeviceSize budget{ 0 };
+  VkDeviceSize residentBytes{ 0 };
+
+  // Textures whose finest resident mip is coarser than their usage asks for,
+  // because of the budget or because their upload is still in flight.
+  size_type    starvedTextures{ 0 };
+
+  uint64_t     streamedInBytes{ 0 };
+  uint64_t     evictions{ 0 };
+};
+
+/**
+ * @brief Keeps the mip levels of 2D textures resident in device memory as far
+ *        as the renderer uses them and a memory budget allows.
+ *
+ * A texture starts with its mip tail, the levels no larger than
+ * minResidentSize, and streams finer levels once reportUsage() asks for
+ * them. Residency changes by replacing the image of a texture with one that
+ * holds a different range of levels, uploaded through the Uploader while the
+ * old image keeps being sampled, so there are no stalls. If the levels asked
+ * for exceed the budget, the textures used least recently lose their finest
+ * levels first; levels no longer asked for are evicted after evictionDelay
+ * frames.
+ *
+ * Decoded levels stay in host memory, the budget only covers device memory.
+ * Every level has to fit into half the staging ring of the uploader; finer
+ * ones are dropped on load. Not thread safe, it is meant to be driven by the
+ * thread recording frames.
+ */
+class
+TextureStreamer
+{
+  public:
+    TextureStreamer();
+
+    TextureStreamer(TextureStreamer const& other) = delete;
+
+    TextureStreamer(TextureStreamer&& other) = delete;
+
+    ~TextureStreamer() noexcept;
+
+    TextureStreamer&
+    operator=(TextureStreamer const& other) = delete;
+
+    TextureStreamer&
+    operator=(TextureStreamer&& other) = delete;
+
+    /**
+     * @param deletionQueue Destroys replaced images once the frames sampling
+     *                      them have completed. Has to outlive the streamer.
+     */
+    return_t
+    initialize(SharedPtrLogicalDevice   const& device,
+               SharedPtrMemoryAllocator const& allocator,
+               Uploader&                       uploader,
+               DeletionQueue&                  deletionQueue,
+               VkDeviceSize             const  budget = VkDeviceSize{ 256 }
+                                                        << 20,
+               uint32_t                 const  minResidentSize = 64);
+
+    /**
+     * @brief Decodes an image file with stb_image and uploads its mip tail.
+     *        The texture can be sampled once getVkImageView returns a view.
+     */
+    return_t
+    load(std::string const& filename,
+         TextureHandle&     handle,
+         bool        const  isSrgb = true);
+
+    /**
+     * @brief Tells the streamer a texture is drawn this frame, covering about
+     *        screenSize pixels along its larger axis. Picks the mip level
+     *        that samples about one texel per pixel.
+     */
+    void
+    reportUsage(TextureHandle const handle, float const screenSize);
+
+    /**
+     * @brief Asks for the mip level mipLevel of a texture this frame.
+     */
+    void
+    requestMip(TextureHandle const handle, uint32_t const mipLevel);
+
+    /**
+     * @brief Swaps in finished uploads, then fits the levels asked for since
+     *        the last update into the budget and starts the uploads and
+     *        evictions that follow. Call once per frame, after setting the
+     *        submitted frames of the deletion queue.
+     */
+    void
+    update();
+
+    /**
+     * @brief View of all resident levels, VK_NULL_HANDLE until the mip tail
+     *        is uploaded. Changes when the residency does.
+     */
+    VkImageView
+    getVkImageView(TextureHandle const handle) const;
+
+    /**
+     * @brief Finest resident mip level, in levels of the full chain.
+     */
+    uint32_t
+    getResidentMip(TextureHandle const handle) const;
+
+    inline VkSampler getVkSampler() const { return mSampler; }
+
+    inline void setBudget(VkDeviceSize const budget) { mBudget = budget; }
+
+    inline VkDeviceSize getBudget() const { return mBudget; }
+
+    /**
+     * @brief Bytes uploaded per update at most, apart from mip tails.
+     */
+    inline void setMaxUploadBytesPerUpdate(VkDeviceSize const maxBytes)
+    { mMaxUploadBytesPerUpdate = maxBytes; }
+
+    /**
+     * @brief Updates a level has to go without being asked for before it
+     *        is evicted.
+     */
+    inline void setEvictionDelay(uint64_t const evictionDelay)
+    { mEvictionDelay = evictionDelay; }
+
+    TextureStreamingStatistics
+    getStatistics() const;
+
+  private:
+    struct
+    Residency
+    {
+      Image       image;
+      VkImageView view{ VK_NULL_HANDLE };
+      uint32_t    firstMip{ 0 };
+    };
+
+    struct
+    Texture
+    {
+      // All levels, finest first, tightly packed.
+      std::vector<unsigned char> pixels;
+      std::vector<VkDeviceSize>  mipOffsets;
+      std::vector<VkExtent2D>    mipExtents;
+      VkFormat                   format{ VK_FORMAT_R8G8B8A8_SRGB };
+      uint32_t                   tailMip{ 0 };
+
+      Residency                  resident;
+      Residency                  pending;
+      uint64_t                   pendingTicket{ 0 };
+      bool                       isPending{ false };
+
+      uint32_t                   requestedMip{ 0 };
+      uint32_t                   wantedMip{ 0 };
+      uint64_t                   wantedUpdate{ 0 };
+    };
+
+    std::vector<std::unique_ptr<Texture>> mTextures;
+
+    VkSampler                mSampler;
+
+    VkDeviceSize             mBudget;
+    VkDeviceSize             mMaxUploadBytesPerUpdate;
+    uint64_t                 mEvictionDelay;
+    uint32_t                 mMinResidentSize;
+
+    uint64_t                 mUpdateCount;
+    uint64_t                 mStreamedInBytes;
+    uint64_t                 mEvictions;
+
+    SharedPtrLogicalDevice   mDevice;
+    SharedPtrMemoryAllocator mAllocator;
+    Uploader*                mUploader;
+    DeletionQueue*           mDeletionQueue;
+
+    /**
+     * @brief Device bytes of the levels from firstMip on, estimated from the
+     *        pixel data.
+     */
+    static VkDeviceSize
+    getResidentSize(Texture const& texture, uint32_t const firstMip);
+
+    /**
+     * @brief Creates an image with the levels from firstMip on and starts
+     *        uploading them into texture.pending.
+     */
+    return_t
+    stream(Texture& texture, uint32_t const firstMip);
+
+    void
+    retire(Residency& residency);
+
+    void
+    destroyMembers();
+};
+
+} // namespace vk
+} // namespace so
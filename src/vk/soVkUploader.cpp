@@ -0,0 +1,709 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+
+#include "soVkUploader.hpp"
+
+#include "cxx/soDebugCallback.hpp"
+#include "cxx/soDefinitions.hpp"
+#include "cxx/soPoolAllocator.hpp"
+#include "cxx/soProfiler.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+/**
+ * @brief Size in bytes of a texel block of one aspect of format, which
+ *        bufferOffset of a copy into an image of that format must be a
+ *        multiple of. Returns 0 for formats not in the table.
+ */
+VkDeviceSize
+getTexelBlockSize(VkFormat const format)
+{
+  struct
+  FormatRange
+  {
+    VkDeviceSize blockSize;
+    VkFormat     first;
+    VkFormat     last;
+  };
+
+  // Depth/stencil formats are copied one aspect at a time and only need the
+  // 4 byte alignment any copy offset must have.
+  static constexpr FormatRange ranges[]{
+    {  1, VK_FORMAT_R4G4_UNORM_PACK8,        VK_FORMAT_R4G4_UNORM_PACK8 },
+    {  2, VK_FORMAT_R4G4B4A4_UNORM_PACK16,   VK_FORMAT_A1R5G5B5_UNORM_PACK16 },
+    {  1, VK_FORMAT_R8_UNORM,                VK_FORMAT_R8_SRGB },
+    {  2, VK_FORMAT_R8G8_UNORM,              VK_FORMAT_R8G8_SRGB },
+    {  3, VK_FORMAT_R8G8B8_UNORM,            VK_FORMAT_B8G8R8_SRGB },
+    {  4, VK_FORMAT_R8G8B8A8_UNORM,
+          VK_FORMAT_A2B10G10R10_SINT_PACK32 },
+    {  2, VK_FORMAT_R16_UNORM,               VK_FORMAT_R16_SFLOAT },
+    {  4, VK_FORMAT_R16G16_UNORM,            VK_FORMAT_R16G16_SFLOAT },
+    {  6, VK_FORMAT_R16G16B16_UNORM,         VK_FORMAT_R16G16B16_SFLOAT },
+    {  8, VK_FORMAT_R16G16B16A16_UNORM,      VK_FORMAT_R16G16B16A16_SFLOAT },
+    {  4, VK_FORMAT_R32_UINT,                VK_FORMAT_R32_SFLOAT },
+    {  8, VK_FORMAT_R32G32_UINT,             VK_FORMAT_R32G32_SFLOAT },
+    { 12, VK_FORMAT_R32G32B32_UINT,          VK_FORMAT_R32G32B32_SFLOAT },
+    { 16, VK_FORMAT_R32G32B32A32_UINT,       VK_FORMAT_R32G32B32A32_SFLOAT },
+    {  8, VK_FORMAT_R64_UINT,                VK_FORMAT_R64_SFLOAT },
+    { 16, VK_FORMAT_R64G64_UINT,             VK_FORMAT_R64G64_SFLOAT },
+    { 24, VK_FORMAT_R64G64B64_UINT,          VK_FORMAT_R64G64B64_SFLOAT },
+    { 32, VK_FORMAT_R64G64B64A64_UINT,       VK_FORMAT_R64G64B64A64_SFLOAT },
+    {  4, VK_FORMAT_B10G11R11_UFLOAT_PACK32, VK_FORMAT_E5B9G9R9_UFLOAT_PACK32 },
+    {  4, VK_FORMAT_D16_UNORM,               VK_FORMAT_D32_SFLOAT_S8_UINT },
+    {  8, VK_FORMAT_BC1_RGB_UNORM_BLOCK,     VK_FORMAT_BC1_RGBA_SRGB_BLOCK },
+    { 16, VK_FORMAT_BC2_UNORM_BLOCK,         VK_FORMAT_BC3_SRGB_BLOCK },
+    {  8, VK_FORMAT_BC4_UNORM_BLOCK,         VK_FORMAT_BC4_SNORM_BLOCK },
+    { 16, VK_FORMAT_BC5_UNORM_BLOCK,         VK_FORMAT_BC7_SRGB_BLOCK },
+    {  8, VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK,
+          VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK },
+    { 16, VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK,
+          VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK },
+    {  8, VK_FORMAT_EAC_R11_UNORM_BLOCK,     VK_FORMAT_EAC_R11_SNORM_BLOCK },
+    { 16, VK_FORMAT_EAC_R11G11_UNORM_BLOCK,
+          VK_FORMAT_ASTC_12x12_SRGB_BLOCK } };
+
+  for(auto const& range : ranges)
+  {
+    if(format >= range.first and format <= range.last)
+    {
+      return range.blockSize;
+    }
+  }
+
+  return 0;
+}
+
+VkDeviceSize
+getLeastCommonMultiple(VkDeviceSize const a, VkDeviceSize const b)
+{
+  VkDeviceSize divisor{ a };
+  VkDeviceSize remainder{ b };
+
+  while(remainder not_eq 0)
+  {
+    VkDeviceSize const next{ divisor % remainder };
+
+    divisor   = remainder;
+    remainder = next;
+  }
+
+  return divisor is_eq 0 ? 0 : a / divisor * b;
+}
+
+} // namespace
+
+so::vk::Uploader::Uploader()
+  : mBatches(),
+    mFences(),
+    mSubmittedBatches(),
+    mRecordingBatch(0),
+    mStagingRing(),
+    mPendingBufferAcquires(),
+    mPendingImageAcquires(),
+    mPendingAcquireStages(0),
+    mLastTicket(0),
+    mRetiredTicket(0),
+    mCompletedTicket(0),
+    mCopyAlignment(16),
+    mDevice(LogicalDevice::getSharedPtrNullDevice()),
+    mQueue(VK_NULL_HANDLE),
+    mQueueFamily(VK_QUEUE_FAMILY_IGNORED),
+    mGraphicsFamily(VK_QUEUE_FAMILY_IGNORED)
+{}
+
+so::vk::Uploader::~Uploader() noexcept
+{
+  destroyMembers();
+}
+
+void
+so::vk::Uploader::destroyMembers()
+{
+  // The command buffers and the staging ring must outlive their batches.
+  while(retireOldest(true)) {}
+
+  mBatches.clear();
+}
+
+so::return_t
+so::vk::Uploader::initialize(SharedPtrLogicalDevice   const& device,
+                             SharedPtrMemoryAllocator const& allocator,
+                             VkDeviceSize             const  stagingSize,
+                             size_type                const  numBatches)
+{
+  mDevice         = device;
+  mGraphicsFamily = mDevice->getGraphicsQueueFamily();
+
+  if(mDevice->getTransferVkQueue() not_eq VK_NULL_HANDLE)
+  {
+    mQueue       = mDevice->getTransferVkQueue();
+    mQueueFamily = mDevice->getTransferQueueFamily();
+  }
+  else
+  {
+    mQueue       = mDevice->getGraphicsVkQueue();
+    mQueueFamily = mGraphicsFamily;
+  }
+
+  // Copy offsets have to be multiples of 4. Image copies additionally align
+  // to the texel block size of the image format, see uploadImage().
+  VkPhysicalDeviceLimits const& limits{
+    mDevice->getVkPhysicalDeviceProperties().limits };
+
+  mCopyAlignment = std::max(limits.optimalBufferCopyOffsetAlignment,
+                            VkDeviceSize{ 16 });
+
+  return_t result{ mStagingRing.initialize(allocator, stagingSize) };
+
+  if(result is_eq failure)
+  {
+    DEBUG_CALLBACK(error, "Failed to create the staging ring.");
+
+    return failure;
+  }
+
+  result = mFences.initialize(mDevice, numBatches);
+
+  if(result is_eq failure)
+  {
+    return failure;
+  }
+
+  mBatches.resize(numBatches);
+
+  VkDevice vkDevice{ mDevice->getVkDevice() };
+
+  for(auto& batch : mBatches)
+  {
+    batch.commandPool = utils::mem::makePooledShared<CommandPool>();
+
+    result = batch.commandPool->initializeForQueueFamily
+               (mDevice,
+                mQueueFamily,
+                VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+
+    if(result is_eq failure)
+    {
+      return failure;
+    }
+
+    VkCommandBufferAllocateInfo allocInfo{};
+
+    allocInfo.sType              =
+      VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool        = batch.commandPool->getVkCommandPool();
+    allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+
+    VkResult vkResult{ vkAllocateCommandBuffers(vkDevice,
+                                                &allocInfo,
+                                                &batch.commandBuffer) };
+
+    if(vkResult not_eq VK_SUCCESS)
+    {
+      DEBUG_CALLBACK(error,
+                     "Failed to allocate an upload command buffer.",
+                     vkAllocateCommandBuffers);
+
+      return failure;
+    }
+  }
+
+  return success;
+}
+
+so::return_t
+so::vk::Uploader::uploadBuffer(Buffer               const& buffer,
+                               VkDeviceSize         const  offset,
+                               void                 const* data,
+                               VkDeviceSize         const  size,
+                               VkPipelineStageFlags const  dstStage,
+                               VkAccessFlags        const  dstAccess,
+                               uint64_t&                   ticket)
+{
+  SO_PROFILE_ZONE("Uploader::uploadBuffer");
+
+  VkDeviceSize stagingOffset{ 0 };
+
+  if(allocateStaging(size, mCopyAlignment, stagingOffset) is_eq failure
+     or beginBatch() is_eq failure)
+  {
+    return failure;
+  }
+
+  std::memcpy(mStagingRing.getMappedData(stagingOffset),
+              data,
+              static_cast<std::size_t>(size));
+
+  mStagingRing.getBuffer().flush(stagingOffset, size);
+
+  Batch& batch{ mBatches[mRecordingBatch] };
+
+  VkBufferCopy region{};
+
+  region.srcOffset = stagingOffset;
+  region.dstOffset = offset;
+  region.size      = size;
+
+  vkCmdCopyBuffer(batch.commandBuffer,
+                  mStagingRing.getBuffer().getVkBuffer(),
+                  buffer.getVkBuffer(),
+                  1,
+                  &region);
+
+  VkBufferMemoryBarrier barrier{};
+
+  barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+  barrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask       = dstAccess;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.buffer              = buffer.getVkBuffer();
+  barrier.offset              = offset;
+  barrier.size                = size;
+
+  if(not usesTransferQueue())
+  {
+    // Later submissions to the same queue are ordered after this barrier.
+    vkCmdPipelineBarrier(batch.commandBuffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         dstStage,
+                         0,
+                         0, nullptr,
+                         1, &barrier,
+                         0, nullptr);
+  }
+  else
+  {
+    barrier.dstAccessMask       = 0;
+    barrier.srcQueueFamilyIndex = mQueueFamily;
+    barrier.dstQueueFamilyIndex = mGraphicsFamily;
+
+    vkCmdPipelineBarrier(batch.commandBuffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                         0,
+                         0, nullptr,
+                         1, &barrier,
+                         0, nullptr);
+
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = dstAccess;
+
+    batch.bufferAcquires.push_back(barrier);
+    batch.acquireStages |= dstStage;
+  }
+
+  ticket = batch.ticket;
+
+  return success;
+}
+
+so::return_t
+so::vk::Uploader::uploadBufferInPieces(Buffer               const& buffer,
+                                       VkDeviceSize         const  offset,
+                                       void                 const* data,
+                                       VkDeviceSize         const  size,
+                                       VkPipelineStageFlags const  dstStage,
+                                       VkAccessFlags        const  dstAccess,
+                                       uint64_t&                   ticket)
+{
+  VkDeviceSize const pieceSize
+    { std::max(mStagingRing.getCapacity() / 2, VkDeviceSize{ 1 }) };
+
+  auto const bytes{ static_cast<unsigned char const*>(data) };
+
+  for(VkDeviceSize piece{ 0 }; piece < size; piece += pieceSize)
+  {
+    return_t const result{ uploadBuffer(buffer,
+                                        offset + piece,
+                                        bytes + piece,
+                                        std::min(pieceSize, size - piece),
+                                        dstStage,
+                                        dstAccess,
+                                        ticket) };
+
+    if(result is_eq failure)
+    {
+      return failure;
+    }
+  }
+
+  return success;
+}
+
+so::return_t
+so::vk::Uploader::uploadImage(Image                          const& image,
+                              void                           const* data,
+                              VkDeviceSize                   const  size,
+                              std::vector<VkBufferImageCopy> const& regions,
+                              VkImageLayout                  const  finalLayout,
+                              VkPipelineStageFlags           const  dstStage,
+                              VkAccessFlags                  const  dstAccess,
+                              uint64_t&                             ticket)
+{
+  SO_PROFILE_ZONE("Uploader::uploadImage");
+
+  if(regions.empty())
+  {
+    DEBUG_CALLBACK(error, "An image upload needs at least one region.");
+
+    return failure;
+  }
+
+  VkDeviceSize stagingOffset{ 0 };
+
+  // Texel blocks of 3, 6, 12 or 24 bytes do not divide 16. The lcm of all
+  // block sizes, 96, covers formats missing from the table.
+  VkDeviceSize const blockSize{ getTexelBlockSize(image.getVkFormat()) };
+
+  VkDeviceSize const alignment
+    { getLeastCommonMultiple(mCopyAlignment,
+                             blockSize not_eq 0 ? blockSize
+                                                : VkDeviceSize{ 96 }) };
+
+  if(allocateStaging(size, alignment, stagingOffset) is_eq failure
+     or beginBatch() is_eq failure)
+  {
+    return failure;
+  }
+
+  std::memcpy(mStagingRing.getMappedData(stagingOffset),
+              data,
+              static_cast<std::size_t>(size));
+
+  mStagingRing.getBuffer().flush(stagingOffset, size);
+
+  Batch& batch{ mBatches[mRecordingBatch] };
+
+  std::vector<VkBufferImageCopy> copies{ regions };
+
+  VkImageAspectFlags aspectMask{ 0 };
+  uint32_t           firstMip{ ~0u };
+  uint32_t           lastMip{ 0 };
+  uint32_t           firstLayer{ ~0u };
+  uint32_t           lastLayer{ 0 };
+
+  for(auto& copy : copies)
+  {
+    VkImageSubresourceLayers const& layers{ copy.imageSubresource };
+
+    copy.bufferOffset += stagingOffset;
+    aspectMask        |= layers.aspectMask;
+    firstMip           = std::min(firstMip, layers.mipLevel);
+    lastMip            = std::max(lastMip, layers.mipLevel);
+    firstLayer         = std::min(firstLayer, layers.baseArrayLayer);
+    lastLayer          = std::max(lastLayer, layers.baseArrayLayer +
+                                             layers.layerCount - 1);
+  }
+
+  VkImageMemoryBarrier barrier{};
+
+  barrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  barrier.srcAccessMask       = 0;
+  barrier.dstAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED;
+  barrier.newLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.image               = image.getVkImage();
+
+  // Only the subresources written here are transitioned, so an image may be
+  // filled by several uploads, e.g. one per mip level.
+  barrier.subresourceRange.aspectMask     = aspectMask;
+  barrier.subresourceRange.baseMipLevel   = firstMip;
+  barrier.subresourceRange.levelCount     = lastMip - firstMip + 1;
+  barrier.subresourceRange.baseArrayLayer = firstLayer;
+  barrier.subresourceRange.layerCount     = lastLayer - firstLayer + 1;
+
+  vkCmdPipelineBarrier(batch.commandBuffer,
+                       VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       0,
+                       0, nullptr,
+                       0, nullptr,
+                       1, &barrier);
+
+  vkCmdCopyBufferToImage(batch.commandBuffer,
+                         mStagingRing.getBuffer().getVkBuffer(),
+                         image.getVkImage(),
+                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                         static_cast<uint32_t>(copies.size()),
+                         copies.data());
+
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = dstAccess;
+  barrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.newLayout     = finalLayout;
+
+  if(not usesTransferQueue())
+  {
+    vkCmdPipelineBarrier(batch.commandBuffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         dstStage,
+                         0,
+                         0, nullptr,
+                         0, nullptr,
+                         1, &barrier);
+  }
+  else
+  {
+    // The release and the acquire have to perform the same transition.
+    barrier.dstAccessMask       = 0;
+    barrier.srcQueueFamilyIndex = mQueueFamily;
+    barrier.dstQueueFamilyIndex = mGraphicsFamily;
+
+    vkCmdPipelineBarrier(batch.commandBuffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                         0,
+                         0, nullptr,
+                         0, nullptr,
+                         1, &barrier);
+
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = dstAccess;
+
+    batch.imageAcquires.push_back(barrier);
+    batch.acquireStages |= dstStage;
+  }
+
+  ticket = batch.ticket;
+
+  return success;
+}
+
+so::return_t
+so::vk::Uploader::submit()
+{
+  if(mBatches.empty() or not mBatches[mRecordingBatch].isRecording)
+  {
+    return success;
+  }
+
+  SO_PROFILE_ZONE("Uploader::submit");
+
+  Batch&  batch{ mBatches[mRecordingBatch] };
+  VkFence fence{ mFences[static_cast<index_t>(mRecordingBatch)] };
+
+  batch.isRecording = false;
+
+  VkResult result{ vkEndCommandBuffer(batch.commandBuffer) };
+
+  if(result not_eq VK_SUCCESS)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to record an upload command buffer.",
+                   vkEndCommandBuffer);
+
+    return failure;
+  }
+
+  vkResetFences(mDevice->getVkDevice(), 1, &fence);
+
+  VkSubmitInfo submitInfo{};
+
+  submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers    = &batch.commandBuffer;
+
+  result = vkQueueSubmit(mQueue, 1, &submitInfo, fence);
+
+  if(result not_eq VK_SUCCESS)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to submit an upload command buffer.",
+                   vkQueueSubmit);
+
+    return failure;
+  }
+
+  batch.stagingEnd  = mStagingRing.getHead();
+  batch.isSubmitted = true;
+
+  mSubmittedBatches.push_back(mRecordingBatch);
+
+  mRecordingBatch = (mRecordingBatch + 1) % mBatches.size();
+
+  return success;
+}
+
+void
+so::vk::Uploader::acquire(VkCommandBuffer const commandBuffer)
+{
+  SO_PROFILE_ZONE("Uploader::acquire");
+
+  while(retireOldest(false)) {}
+
+  if(not mPendingBufferAcquires.empty() or not mPendingImageAcquires.empty())
+  {
+    vkCmdPipelineBarrier
+      (commandBuffer,
+       VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+       mPendingAcquireStages,
+       0,
+       0, nullptr,
+       static_cast<uint32_t>(mPendingBufferAcquires.size()),
+       mPendingBufferAcquires.data(),
+       static_cast<uint32_t>(mPendingImageAcquires.size()),
+       mPendingImageAcquires.data());
+
+    mPendingBufferAcquires.clear();
+    mPendingImageAcquires.clear();
+    mPendingAcquireStages = 0;
+  }
+
+  mCompletedTicket = mRetiredTicket;
+}
+
+so::return_t
+so::vk::Uploader::allocateStaging(VkDeviceSize const size,
+                                  VkDeviceSize const alignment,
+                                  VkDeviceSize&      offset)
+{
+  if(size > mStagingRing.getCapacity())
+  {
+    DEBUG_CALLBACK(error, "Upload does not fit into the staging ring.");
+
+    return failure;
+  }
+
+  while(mStagingRing.allocate(size, alignment, offset) is_eq failure)
+  {
+    // Everything allocated so far has to be in flight to be reclaimable.
+    if(submit() is_eq failure or not retireOldest(true))
+    {
+      return failure;
+    }
+  }
+
+  return success;
+}
+
+so::return_t
+so::vk::Uploader::beginBatch()
+{
+  if(mBatches.empty())
+  {
+    DEBUG_CALLBACK(error, "The uploader has not been initialized.");
+
+    return failure;
+  }
+
+  Batch& batch{ mBatches[mRecordingBatch] };
+
+  if(batch.isRecording)
+  {
+    return success;
+  }
+
+  // Batches are reused round robin, the oldest one is next.
+  while(batch.isSubmitted)
+  {
+    if(not retireOldest(true))
+    {
+      DEBUG_CALLBACK(error, "Failed to wait for an upload batch.");
+
+      return failure;
+    }
+  }
+
+  if(batch.commandPool->reset() is_eq failure)
+  {
+    return failure;
+  }
+
+  VkCommandBufferBeginInfo beginInfo{};
+
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+  VkResult result{ vkBeginCommandBuffer(batch.commandBuffer, &beginInfo) };
+
+  if(result not_eq VK_SUCCESS)
+  {
+    DEBUG_CALLBACK(error,
+                   "Failed to begin an upload command buffer.",
+                   vkBeginCommandBuffer);
+
+    return failure;
+  }
+
+  batch.isRecording   = true;
+  batch.ticket        = ++mLastTicket;
+  batch.acquireStages = 0;
+
+  return success;
+}
+
+bool
+so::vk::Uploader::retireOldest(bool const wait)
+{
+  if(mSubmittedBatches.empty())
+  {
+    return false;
+  }
+
+  size_type const index{ mSubmittedBatches.front() };
+
+  Batch&   batch{ mBatches[index] };
+  VkFence  fence{ mFences[static_cast<index_t>(index)] };
+  VkDevice device{ mDevice->getVkDevice() };
+
+  VkResult result{ wait ? vkWaitForFences(device,
+                                          1,
+                                          &fence,
+                                          VK_TRUE,
+                                          std::numeric_limits<uint64_t>::max())
+                        : vkGetFenceStatus(device, fence) };
+
+  if(result not_eq VK_SUCCESS)
+  {
+    return false;
+  }
+
+  mStagingRing.release(batch.stagingEnd);
+
+  mPendingBufferAcquires.insert(mPendingBufferAcquires.end(),
+                                batch.bufferAcquires.begin(),
+                                batch.bufferAcquires.end());
+  mPendingImageAcquires.insert(mPendingImageAcquires.end(),
+                               batch.imageAcquires.begin(),
+                               batch.imageAcquires.end());
+  mPendingAcquireStages |= batch.acquireStages;
+
+  batch.bufferAcquires.clear();
+  batch.imageAcquires.clear();
+  batch.isSubmitted = false;
+
+  mRetiredTicket = batch.ticket;
+
+  mSubmittedBatches.pop_front();
+
+  return true;
+}
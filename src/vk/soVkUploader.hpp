@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      soVkUploader.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "soVkCommandPool.hpp"
+#include "soVkFences.hpp"
+#include "soVkImage.hpp"
+#include "soVkStagingRing.hpp"
+
+#include <deque>
+#include <vector>
+
+namespace so {
+namespace vk {
+
+/**
+ * @brief Streams data into device local buffers and images through a
+ *        staging ring, on the transfer-only queue if the device has one.
+ *
+ * Uploads are recorded into batches. submit() sends the recording batch off,
+ * signalling a fence of its own, so uploads overlap rendering instead of
+ * stalling the graphics queue. Once the fence of a batch has signalled, its
+ * staging space is reclaimed and acquire() records the acquiring half of
+ * the queue family ownership transfers into a graphics command buffer.
+ * Fences are used instead of timeline semaphores since the engine targets
+ * Vulkan 1.0.
+ *
+ * Each upload returns a ticket. A resource may be used by commands recorded
+ * after the acquire() that made its ticket complete. Destination resources
+ * need VK_SHARING_MODE_EXCLUSIVE and a TRANSFER_DST usage. The uploader is
+ * meant to be used from the thread that submits frames; without a transfer
+ * family it submits to the graphics queue.
+ */
+class
+Uploader
+{
+  public:
+    Uploader();
+
+    Uploader(Uploader const& other) = delete;
+
+    Uploader(Uploader&& other) = delete;
+
+    ~Uploader() noexcept;
+
+    Uploader&
+    operator=(Uploader const& other) = delete;
+
+    Uploader&
+    operator=(Uploader&& other) = delete;
+
+    return_t
+    initialize(SharedPtrLogicalDevice   const& device,
+               SharedPtrMemoryAllocator const& allocator,
+               VkDeviceSize             const  stagingSize = VkDeviceSize{ 32 }
+                                                             << 20,
+               size_type                const  numBatches = 4);
+
+    inline bool usesTransferQueue() const
+    { return mQueueFamily not_eq mGraphicsFamily; }
+
+    /**
+     * @param dstStage  Stages the buffer is used in afterwards.
+     * @param dstAccess Accesses the buffer is used with afterwards.
+     */
+    return_t
+    uploadBuffer(Buffer               const& buffer,
+                 VkDeviceSize         const  offset,
+                 void                 const* data,
+                 VkDeviceSize         const  size,
+                 VkPipelineStageFlags const  dstStage,
+                 VkAccessFlags        const  dstAccess,
+                 uint64_t&                   ticket);
+
+    /**
+     * @brief uploadBuffer in pieces of at most half the staging ring, so
+     *        data larger than the ring does not need to fit in at once.
+     */
+    return_t
+    uploadBufferInPieces(Buffer               const& buffer,
+                         VkDeviceSize         const  offset,
+                         void                 const* data,
+                         VkDeviceSize         const  size,
+                         VkPipelineStageFlags const  dstStage,
+                         VkAccessFlags        const  dstAccess,
+                         uint64_t&                   ticket);
+
+    /**
+     * @brief Copies data into image and transitions the subresources the
+     *        regions write, from the first to the last mip level and array
+     *        layer, from an undefined layout to finalLayout.
+     *
+     * @param regions Copies to record, with bufferOffset relative to data.
+     */
+    return_t
+    uploadImage(Image                          const& image,
+                void                           const* data,
+                VkDeviceSize                   const  size,
+                std::vector<VkBufferImageCopy> const& regions,
+                VkImageLayout                  const  finalLayout,
+                VkPipelineStageFlags           const  dstStage,
+                VkAccessFlags                  const  dstAccess,
+                uint64_t&                             ticket);
+
+    /**
+     * @brief Submits the uploads recorded since the last call.
+     */
+    return_t
+    submit();
+
+    /**
+     * @brief Reclaims finished batches and records the acquire barriers of
+     *        their uploads into commandBuffer, outside of a render pass.
+     */
+    void
+    acquire(VkCommandBuffer const commandBuffer);
+
+    inline bool isComplete(uint64_t const ticket) const
+    { return ticket <= mCompletedTicket; }
+
+    inline StagingRing const& getStagingRing() const { return mStagingRing; }
+
+  private:
+    struct
+    Batch
+    {
+      SharedPtrCommandPool               commandPool;
+      VkCommandBuffer                    commandBuffer{ VK_NULL_HANDLE };
+      uint64_t                           ticket{ 0 };
+      uint64_t                           stagingEnd{ 0 };
+      bool                               isRecording{ false };
+      bool                               isSubmitted{ false };
+      std::vector<VkBufferMemoryBarrier> bufferAcquires;
+      std::vector<VkImageMemoryBarrier>  imageAcquires;
+      VkPipelineStageFlags               acquireStages{ 0 };
+    };
+
+    std::vector<Batch>                 mBatches;
+    Fences<>                           mFences;
+
+    // Batches in submission order.
+    std::deque<size_type>              mSubmittedBatches;
+
+    size_type                          mRecordingBatch;
+
+    StagingRing                        mStagingRing;
+
+    std::vector<VkBufferMemoryBarrier> mPendingBufferAcquires;
+    std::vector<VkImageMemoryBarrier>  mPendingImageAcquires;
+    VkPipelineStageFlags               mPendingAcquireStages;
+
+    uint64_t                           mLastTicket;
+    uint64_t                           mRetiredTicket;
+    uint64_t                           mCompletedTicket;
+
+    VkDeviceSize                       mCopyAlignment;
+
+    SharedPtrLogicalDevice             mDevice;
+    VkQueue                            mQueue;
+    uint32_t                           mQueueFamily;
+    uint32_t                           mGraphicsFamily;
+
+    return_t
+    allocateStaging(VkDeviceSize const  size,
+                    VkDeviceSize const  alignment,
+                    VkDeviceSize&       offset);
+
+    return_t
+    beginBatch();
+
+    /**
+     * @brief Retires the oldest submitted batch, waiting for it if wait is
+     *        set. Returns false if it is still executing.
+     */
+    bool
+    retireOldest(bool const wait);
+
+    void
+    destroyMembers();
+};
+
+} // namespace vk
+} // namespace so
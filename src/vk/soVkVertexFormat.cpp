@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+
+
+#include "soVkVertexFormat.hpp"
+
+namespace {
+
+constexpr so::vk::VertexAttribute allAttributes[]
+  { so::vk::VertexAttribute::position,
+    so::vk::VertexAttribute::normal,
+    so::vk::VertexAttribute::texCoord,
+    so::vk::VertexAttribute::tangent,
+    so::vk::VertexAttribute::color };
+
+} // namespace
+
+so::vk::VertexFormat::VertexFormat()
+  : mAttributes(0)
+{}
+
+so::vk::VertexFormat::VertexFormat
+  (std::initializer_list<VertexAttribute> attributes)
+  : mAttributes(0)
+{
+  for(auto const attribute : attributes)
+  {
+    add(attribute);
+  }
+}
+
+VkFormat
+so::vk::VertexFormat::getVkFormat(VertexAttribute const attribute)
+{
+  switch(attribute)
+  {
+    case VertexAttribute::position:
+    case VertexAttribute::normal:
+      return VK_FORMAT_R32G32B32_SFLOAT;
+    case VertexAttribute::texCoord:
+      return VK_FORMAT_R32G32_SFLOAT;
+    case VertexAttribute::tangent:
+      return VK_FORMAT_R32G32B32A32_SFLOAT;
+    case VertexAttribute::color:
+      return VK_FORMAT_R8G8B8A8_UNORM;
+    case VertexAttribute::count:
+      break;
+  }
+
+  return VK_FORMAT_UNDEFINED;
+}
+
+uint32_t
+so::vk::VertexFormat::getSize(VertexAttribute const attribute)
+{
+  switch(attribute)
+  {
+    case VertexAttribute::position:
+    case VertexAttribute::normal:
+      return 3 * sizeof(float);
+    case VertexAttribute::texCoord:
+      return 2 * sizeof(float);
+    case VertexAttribute::tangent:
+      return 4 * sizeof(float);
+    case VertexAttribute::color:
+      return 4;
+    case VertexAttribute::count:
+      break;
+  }
+
+  return 0;
+}
+
+uint32_t
+so::vk::VertexFormat::getStride() const
+{
+  uint32_t stride{ 0 };
+
+  for(auto const attribute : allAttributes)
+  {
+    if(has(attribute))
+    {
+      stride += getSize(attribute);
+    }
+  }
+
+  return stride;
+}
+
+uint32_t
+so::vk::VertexFormat::getOffset(VertexAttribute const attribute) const
+{
+  uint32_t offset{ 0 };
+
+  for(auto const other : allAttributes)
+  {
+    if(other is_eq attribute)
+    {
+      break;
+    }
+
+    if(has(other))
+    {
+      offset += getSize(other);
+    }
+  }
+
+  return offset;
+}
+
+VkVertexInputBindingDescription
+so::vk::VertexFormat::getVkBindingDescription(uint32_t const binding) const
+{
+  VkVertexInputBindingDescription description{};
+
+  description.binding   = binding;
+  description.stride    = getStride();
+  description.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+  return description;
+}
+
+std::vector<VkVertexInputAttributeDescription>
+so::vk::VertexFormat::getVkAttributeDescriptions(uint32_t const binding) const
+{
+  std::vector<VkVertexInputAttributeDescription> descriptions;
+
+  uint32_t offset{ 0 };
+
+  for(auto const attribute : allAttributes)
+  {
+    if(not has(attribute))
+    {
+      continue;
+    }
+
+    VkVertexInputAttributeDescription description{};
+
+    description.location = static_cast<uint32_t>(attribute);
+    description.binding  = binding;
+    description.format   = getVkFormat(attribute);
+    description.offset   = offset;
+
+    descriptions.push_back(description);
+
+    offset += getSize(attribute);
+  }
+
+  return descriptions;
+}
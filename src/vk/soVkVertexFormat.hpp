@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2018 by Bennet Carstensen
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ *  @file      soVkVertexFormat.hpp
+ *  @author    Bennet Carstensen
+ *  @date      2018
+ *  @copyright Copyright (c) 2017-2018 Bennet Carstensen
+ *
+ *             Permission is hereby granted, free of charge, to any person
+ *             obtaining a copy of this software and associated documentation
+ *             files (the "Software"), to deal in the Software without
+ *             restriction, including without limitation the rights to use,
+ *             copy, modify, merge, publish, distribute, sublicense, and/or
+ *             sell copies of the Software, and to permit persons to whom the
+ *             Software is furnished to do so, subject to the following
+ *             conditions:
+ *
+ *             The above copyright notice and this permission notice shall be
+ *             included in all copies or substantial portions of the Software.
+ *
+ *             THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *             EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *             OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *             NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *             HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ *             WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *             FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ *             OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "cxx/soDefinitions.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <initializer_list>
+#include <vector>
+
+namespace so {
+namespace vk {
+
+/**
+ * @brief Attributes of an interleaved vertex. The value of an attribute is
+ *        its shader location, so shaders see the same locations whatever
+ *        subset of attributes a mesh provides.
+ */
+enum class
+VertexAttribute : uint32_t
+{
+  position = 0, //!< 3 floats
+  normal   = 1, //!< 3 floats
+  texCoord = 2, //!< 2 floats
+  tangent  = 3, //!< 4 floats, w is the handedness of the bitangent
+  color    = 4, //!< RGBA8 unorm
+  count    = 5
+};
+
+/**
+ * @brief The set of attributes of an interleaved vertex, in the order of
+ *        VertexAttribute, and the vertex input state it maps to.
+ */
+class
+VertexFormat
+{
+  public:
+    VertexFormat();
+
+    explicit VertexFormat(std::initializer_list<VertexAttribute> attributes);
+
+    static VkFormat
+    getVkFormat(VertexAttribute const attribute);
+
+    static uint32_t
+    getSize(VertexAttribute const attribute);
+
+    inline bool
+    has(VertexAttribute const attribute) const
+    { return (mAttributes bitand getBit(attribute)) not_eq 0; }
+
+    inline void
+    add(VertexAttribute const attribute)
+    { mAttributes |= getBit(attribute); }
+
+    inline bool isEmpty() const { return mAttributes is_eq 0; }
+
+    /**
+     * @brief Size of a vertex in bytes.
+     */
+    uint32_t
+    getStride() const;
+
+    /**
+     * @brief Offset of attribute within a vertex. The attribute has to be
+     *        part of the format.
+     */
+    uint32_t
+    getOffset(VertexAttribute const attribute) const;
+
+    VkVertexInputBindingDescription
+    getVkBindingDescription(uint32_t const binding = 0) const;
+
+    std::vector<VkVertexInputAttributeDescription>
+    getVkAttributeDescriptions(uint32_t const binding = 0) const;
+
+    inline bool
+    operator==(VertexFormat const& other) const
+    { return mAttributes is_eq other.mAttributes; }
+
+    inline bool
+    operator!=(VertexFormat const& other) const
+    { return not (*this is_eq other); }
+
+  private:
+    uint32_t mAttributes;
+
+    static inline uint32_t
+    getBit(VertexAttribute const attribute)
+    { return 1u << static_cast<uint32_t>(attribute); }
+};
+
+} // namespace vk
+} // namespace so